@@ -0,0 +1,313 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+extern "C" __declspec(dllimport) unsigned short __stdcall
+RtlCaptureStackBackTrace(unsigned long skip, unsigned long count, void** frames, unsigned long* hash);
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <cxxabi.h>
+#define ALLOC_TRACKER_HAS_SYMBOLS
+#endif
+
+// ============================================================================
+// ALLOC TRACKER - heap allocations per frame, sampled by call site
+// ============================================================================
+// Replaces the global operator new / delete (all forms, C++14) with versions
+// that count calls and bytes before forwarding to malloc / free. Counting is
+// always on and costs a few relaxed atomic adds per allocation; the thread
+// that calls markRenderThread() additionally keeps a per-frame count, which
+// endFrame() rolls over into lastFrameAllocs / lastFrameBytes.
+//
+// Call-site sampling (sampling = true, --alloc-track) captures a short
+// backtrace for every sampleEvery-th allocation, hashes the return
+// addresses and accumulates count and bytes per distinct stack in a fixed
+// open-addressing table, so the tracker itself never allocates.
+// printTopSites() lists the busiest stacks as allocations per sampled
+// frame; frames are symbolized with backtrace_symbols on glibc / macOS and
+// printed as raw addresses elsewhere (resolve them against the PDB).
+//
+// The operators are defined in the one translation unit that defines
+// ALLOC_TRACKER_IMPLEMENTATION before including this header (like
+// stb_image). Define ALLOC_TRACKER_COMPILED_OUT there to keep the default
+// allocator.
+// ============================================================================
+
+const int ALLOC_SITE_SLOTS = 4096;          // power of two
+const int ALLOC_SITE_DEPTH = 8;             // frames kept per call site
+const int ALLOC_SITE_SKIP = 2;              // onAlloc + operator new
+
+struct AllocSite {
+    uint64_t hash;
+    void* frames[ALLOC_SITE_DEPTH];
+    int depth;
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t renderCount;        // of count, made on the render thread
+};
+
+class AllocTracker {
+public:
+    std::atomic<bool> sampling;
+    int sampleEvery = 1;
+
+    // All threads since startup
+    std::atomic<uint64_t> totalAllocs, totalFrees, totalBytes;
+
+    // Render thread, last completed frame
+    uint64_t lastFrameAllocs = 0, lastFrameBytes = 0;
+
+    AllocTracker() : sampling(false), totalAllocs(0), totalFrees(0), totalBytes(0),
+                     sampleTick(0), droppedSites(0), sampledFrames(0) {
+        lock.clear();
+    }
+
+    static AllocTracker& instance() {
+        static AllocTracker tracker;
+        return tracker;
+    }
+
+    void markRenderThread() { renderThread() = true; }
+
+    // End of each frame on the render thread
+    void endFrame() {
+        lastFrameAllocs = frameAllocs;
+        lastFrameBytes = frameBytes;
+        frameAllocs = frameBytes = 0;
+        if (sampling.load(std::memory_order_relaxed)) sampledFrames++;
+    }
+
+    uint64_t liveAllocs() const {
+        return totalAllocs.load(std::memory_order_relaxed) - totalFrees.load(std::memory_order_relaxed);
+    }
+
+    void onAlloc(size_t bytes) {
+        totalAllocs.fetch_add(1, std::memory_order_relaxed);
+        totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+        bool render = renderThread();
+        if (render) {
+            frameAllocs++;
+            frameBytes += bytes;
+        }
+        if (!sampling.load(std::memory_order_relaxed)) return;
+        if (sampleEvery > 1 && sampleTick.fetch_add(1, std::memory_order_relaxed) % sampleEvery != 0) return;
+        bool& busy = inHook();
+        if (busy) return;           // the capture itself allocated
+        busy = true;
+        recordSite(bytes, render);
+        busy = false;
+    }
+
+    void onFree() { totalFrees.fetch_add(1, std::memory_order_relaxed); }
+
+    void resetSites() {
+        acquire();
+        memset(sites, 0, sizeof(sites));
+        droppedSites = 0;
+        sampledFrames = 0;
+        lock.clear(std::memory_order_release);
+    }
+
+    // Busiest call sites by allocation count, as averages per sampled frame
+    // (sampled allocations are scaled back up by sampleEvery)
+    void printTopSites(std::ostream& out, int top = 10, bool renderOnly = false) {
+        acquire();
+        int order[ALLOC_SITE_SLOTS];
+        int n = 0;
+        for (int i = 0; i < ALLOC_SITE_SLOTS; i++)
+            if (siteCount(sites[i], renderOnly) > 0) order[n++] = i;
+        for (int i = 1; i < n; i++) {                 // insertion sort, no allocation
+            int v = order[i], j = i;
+            while (j > 0 && siteCount(sites[order[j - 1]], renderOnly) < siteCount(sites[v], renderOnly)) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = v;
+        }
+        double frames = sampledFrames > 0 ? (double)sampledFrames : 1.0;
+        char line[160];
+        snprintf(line, sizeof(line), "  Top allocation sites%s over %llu frames (1 in %d sampled, %d stacks%s):",
+                 renderOnly ? " on the render thread" : "", (unsigned long long)sampledFrames,
+                 sampleEvery, n, droppedSites ? ", table full" : "");
+        out << line << std::endl;
+        for (int k = 0; k < n && k < top; k++) {
+            const AllocSite& s = sites[order[k]];
+            double count = (double)siteCount(s, renderOnly) * sampleEvery;
+            snprintf(line, sizeof(line), "  %2d. %8.0f allocs %9.3f/frame %10.0f bytes  (%s)",
+                     k + 1, count, count / frames, (double)s.bytes * sampleEvery,
+                     s.renderCount == s.count ? "render" : s.renderCount ? "mixed" : "other threads");
+            out << line << std::endl;
+            printFrames(out, s);
+        }
+        lock.clear(std::memory_order_release);
+    }
+
+private:
+    uint64_t frameAllocs = 0, frameBytes = 0;
+    std::atomic<uint64_t> sampleTick;
+    std::atomic_flag lock;
+    AllocSite sites[ALLOC_SITE_SLOTS];
+    int droppedSites;
+    uint64_t sampledFrames;
+
+    static bool& renderThread() { static thread_local bool v = false; return v; }
+    static bool& inHook() { static thread_local bool v = false; return v; }
+
+    static uint64_t siteCount(const AllocSite& s, bool renderOnly) { return renderOnly ? s.renderCount : s.count; }
+
+    void acquire() {
+        while (lock.test_and_set(std::memory_order_acquire)) {}
+    }
+
+    static int capture(void** frames, int max) {
+#if defined(_WIN32)
+        return (int)RtlCaptureStackBackTrace(ALLOC_SITE_SKIP, (unsigned long)max, frames, NULL);
+#elif defined(ALLOC_TRACKER_HAS_SYMBOLS)
+        void* raw[ALLOC_SITE_DEPTH + ALLOC_SITE_SKIP];
+        int n = backtrace(raw, max + ALLOC_SITE_SKIP) - ALLOC_SITE_SKIP;
+        if (n <= 0) return 0;
+        memcpy(frames, raw + ALLOC_SITE_SKIP, n * sizeof(void*));
+        return n;
+#else
+        (void)frames; (void)max;
+        return 0;
+#endif
+    }
+
+    void recordSite(size_t bytes, bool render) {
+        void* frames[ALLOC_SITE_DEPTH];
+        int depth = capture(frames, ALLOC_SITE_DEPTH);
+        uint64_t h = 1469598103934665603ull;          // FNV-1a over return addresses
+        for (int i = 0; i < depth; i++) {
+            h ^= (uint64_t)(uintptr_t)frames[i];
+            h *= 1099511628211ull;
+        }
+        if (h == 0) h = 1;
+
+        acquire();
+        int slot = (int)(h & (ALLOC_SITE_SLOTS - 1));
+        for (int probe = 0; probe < ALLOC_SITE_SLOTS; probe++, slot = (slot + 1) & (ALLOC_SITE_SLOTS - 1)) {
+            AllocSite& s = sites[slot];
+            if (s.hash == 0) {
+                s.hash = h;
+                s.depth = depth;
+                memcpy(s.frames, frames, depth * sizeof(void*));
+            }
+            if (s.hash == h) {
+                s.count++;
+                s.bytes += bytes;
+                if (render) s.renderCount++;
+                lock.clear(std::memory_order_release);
+                return;
+            }
+        }
+        droppedSites++;
+        lock.clear(std::memory_order_release);
+    }
+
+    static void printFrames(std::ostream& out, const AllocSite& s) {
+#if defined(ALLOC_TRACKER_HAS_SYMBOLS)
+        char** names = backtrace_symbols(s.frames, s.depth);     // malloc, not operator new
+        for (int i = 0; i < s.depth; i++) {
+            out << "        " << demangle(names ? names[i] : "?") << std::endl;
+        }
+        free(names);
+#else
+        for (int i = 0; i < s.depth; i++) {
+            char line[32];
+            snprintf(line, sizeof(line), "        %p", s.frames[i]);
+            out << line << std::endl;
+        }
+#endif
+    }
+
+#if defined(ALLOC_TRACKER_HAS_SYMBOLS)
+    // "module(_ZN3Foo3barEv+0x1c) [0x...]" -> "Foo::bar() +0x1c  (module)"
+    static const char* demangle(const char* entry) {
+        static thread_local char out[200];     // long template names are cut
+        const char* open = strchr(entry, '(');
+        const char* plus = open ? strchr(open, '+') : NULL;
+        const char* close = open ? strchr(open, ')') : NULL;
+        if (!open || !plus || !close || plus == open + 1) return entry;
+        char mangled[256];
+        size_t len = (size_t)(plus - open - 1);
+        if (len >= sizeof(mangled)) len = sizeof(mangled) - 1;
+        memcpy(mangled, open + 1, len);
+        mangled[len] = '\0';
+        int status = 0;
+        char* name = abi::__cxa_demangle(mangled, NULL, NULL, &status);
+        // Fields capped to fit out: 120 + 1 + 24 + 3 + 48 + 1 < 200
+        int offset = (int)std::min<ptrdiff_t>(close - plus, 24);
+        int module = (int)std::min<ptrdiff_t>(open - entry, 48);
+        snprintf(out, sizeof(out), "%.120s %.*s  (%.*s)", status == 0 && name ? name : mangled,
+                 offset, plus, module, entry);
+        free(name);
+        return out;
+    }
+#endif
+};
+
+inline AllocTracker& allocTracker() { return AllocTracker::instance(); }
+
+#endif
+
+// ============================================================================
+// Global operator new / delete, compiled into one translation unit only
+// ============================================================================
+#if defined(ALLOC_TRACKER_IMPLEMENTATION) && !defined(ALLOC_TRACKER_COMPILED_OUT) && !defined(ALLOC_TRACKER_OPERATORS_DEFINED)
+#define ALLOC_TRACKER_OPERATORS_DEFINED
+
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    allocTracker().onAlloc(size);
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    allocTracker().onAlloc(size);
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(size ? size : 1);
+    if (p) allocTracker().onAlloc(size);
+    return p;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(size ? size : 1);
+    if (p) allocTracker().onAlloc(size);
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    allocTracker().onFree();
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    if (!p) return;
+    allocTracker().onFree();
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete[](p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete[](p); }
+
+#endif
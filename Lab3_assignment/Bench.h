@@ -0,0 +1,384 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cctype>
+#include <cmath>
+#include "FrameStats.h"
+
+// ============================================================================
+// BENCH - scripted, deterministic benchmark runs
+// ============================================================================
+// A bench script is a JSON file with a list of phases; each phase lasts a
+// number of frames, holds some keys down for its whole duration and presses
+// others once on its first frame:
+//
+//   { "name": "chase-cruise", "dt": 0.016667,
+//     "phases": [ { "name": "accelerate", "frames": 180, "hold": ["W"] },
+//                 { "name": "lights off", "frames": 120, "hold": ["W"],
+//                   "press": ["1", "2"] },
+//                 { "name": "look around", "frames": 120, "look": [90, 10] } ] }
+//
+// "look" is scripted mouse look, yaw and pitch in degrees per second: the
+// app feeds it in per frame as if the mouse were moving at that rate.
+//
+// While a script runs, the app reads held keys from here instead of GLFW
+// and sends presses through key_callback, so a run depends only on the
+// script (with --fixed-dt, the simulation step is the script's dt instead
+// of the wall clock). Key names are GLFW names without the GLFW_KEY_
+// prefix; keys that need a window (M, ESCAPE) are rejected.
+//
+// Every frame's FrameRecord is filed under its phase; writeResults() emits
+// per-phase timing percentiles, counter means and the raw frame times as
+// JSON, so runs of different builds can be compared offline with
+// tools/bench_compare.py. submit_ms is the render queue's CPU submit time
+// (sort excluded) under the submission mode named in "submit". latency_ms
+// is input-to-photon over the frames that showed new input, and
+// frame_ms_sd the frame-time standard deviation, under the simulation
+// threading named in "sim" (see SimThread.h). view_age_ms is how old the
+// mouse look in the drawn view was at the swap, in phases with "look";
+// "late_latch" says whether the view was rebuilt just before submission
+// (see CameraBlock.h).
+// ============================================================================
+
+struct BenchPhase {
+    std::string name;
+    int frames = 0;
+    std::vector<int> hold;
+    std::vector<int> press;
+    float look[2] = { 0.0f, 0.0f };     // degrees per second: yaw, pitch
+    std::vector<FrameRecord> records;
+    std::vector<double> glCalls;
+    std::vector<double> submitMs;
+};
+
+class Bench {
+public:
+    std::string name;
+    std::string path;
+    float dt = 1.0f / 60.0f;
+    std::vector<BenchPhase> phases;
+    std::vector<std::pair<std::string, double> > finalState;   // filled by the app
+    double startupMs = 0.0;                                     // launch to first frame
+    std::string submitMode = "uniforms";                        // render queue backend
+    std::string simMode = "serial";                             // serial, thread or lockstep
+    bool lateLatch = false;                                     // view rebuilt before submit
+
+    bool active() const { return !phases.empty(); }
+
+    int totalFrames() const {
+        int n = 0;
+        for (const auto& p : phases) n += p.frames;
+        return n;
+    }
+
+    bool load(const std::string& scriptPath) {
+        std::ifstream in(scriptPath.c_str());
+        if (!in) {
+            std::cout << "Bench: cannot open " << scriptPath << std::endl;
+            return false;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        text = ss.str();
+        pos = 0;
+        error.clear();
+        path = scriptPath;
+        phases.clear();
+        parseScript();
+        if (error.empty() && phases.empty()) error = "no phases";
+        if (!error.empty()) {
+            std::cout << "Bench: " << scriptPath << ": " << error << std::endl;
+            phases.clear();
+            return false;
+        }
+        reserveRun(totalFrames());
+        std::cout << "Bench: " << name << " (" << phases.size() << " phases, "
+                  << totalFrames() << " frames, dt " << dt << ")" << std::endl;
+        return true;
+    }
+
+    // Reserve every record up front so a run does not allocate per frame
+    void reserveRun(int runFrames) {
+        int loops = (runFrames + totalFrames() - 1) / totalFrames();
+        for (auto& p : phases) {
+            p.records.reserve(p.frames * loops);
+            p.glCalls.reserve(p.frames * loops);
+            p.submitMs.reserve(p.frames * loops);
+        }
+    }
+
+    // Selects the phase for this frame (scripts loop when run longer).
+    // Returns the keys to press on this frame.
+    const std::vector<int>& beginFrame(int frame) {
+        static const std::vector<int> none;
+        int f = frame % totalFrames();
+        for (size_t i = 0; i < phases.size(); i++) {
+            if (f < phases[i].frames) {
+                current = (int)i;
+                return f == 0 ? phases[i].press : none;
+            }
+            f -= phases[i].frames;
+        }
+        return none;
+    }
+
+    // Scripted mouse look of the current phase, degrees per second
+    const float* lookRate() const {
+        static const float none[2] = { 0.0f, 0.0f };
+        return current < 0 ? none : phases[current].look;
+    }
+
+    bool held(int key) const {
+        if (current < 0) return false;
+        const std::vector<int>& h = phases[current].hold;
+        return std::find(h.begin(), h.end(), key) != h.end();
+    }
+
+    void record(const FrameRecord& r, uint64_t glCallCount, double submitMs) {
+        if (current < 0) return;
+        phases[current].records.push_back(r);
+        phases[current].glCalls.push_back((double)glCallCount);
+        phases[current].submitMs.push_back(submitMs);
+    }
+
+    bool writeResults(const std::string& outPath, const char* backend, bool fixedDt) {
+        FILE* f = fopen(outPath.c_str(), "w");
+        if (!f) {
+            std::cout << "Bench: cannot write " << outPath << std::endl;
+            return false;
+        }
+        fprintf(f, "{\n  \"bench\": \"%s\",\n  \"script\": \"%s\",\n  \"backend\": \"%s\",\n",
+                name.c_str(), path.c_str(), backend);
+        fprintf(f, "  \"dt\": %.6f,\n  \"fixed_dt\": %s,\n  \"submit\": \"%s\",\n  \"sim\": \"%s\",\n"
+                   "  \"late_latch\": %s,\n  \"startup_ms\": %.3f,\n  \"phases\": [\n",
+                dt, fixedDt ? "true" : "false", submitMode.c_str(), simMode.c_str(),
+                lateLatch ? "true" : "false", startupMs);
+        for (size_t i = 0; i < phases.size(); i++) {
+            const BenchPhase& p = phases[i];
+            fprintf(f, "    {\"name\": \"%s\", \"frames\": %d, \"stutters\": %d,\n",
+                    p.name.c_str(), (int)p.records.size(), stutters(p));
+            writeTiming(f, "frame_ms", column(p, &FrameRecord::frameMs), ",\n");
+            writeTiming(f, "sim_ms", column(p, &FrameRecord::simMs), ",\n");
+            writeTiming(f, "render_ms", column(p, &FrameRecord::renderMs), ",\n");
+            writeTiming(f, "submit_ms", p.submitMs, ",\n");
+            writeTiming(f, "latency_ms", column(p, &FrameRecord::latencyMs), ",\n");
+            writeTiming(f, "view_age_ms", column(p, &FrameRecord::viewAgeMs), ",\n");
+            fprintf(f, "     \"frame_ms_sd\": %.4f,\n", stdDev(column(p, &FrameRecord::frameMs)));
+            fprintf(f, "     \"frame_ms_samples\": [");
+            for (size_t k = 0; k < p.records.size(); k++)
+                fprintf(f, "%s%.4f", k ? "," : "", p.records[k].frameMs);
+            fprintf(f, "],\n");
+            fprintf(f, "     \"draws\": %.1f, \"triangles\": %.1f, \"uniforms\": %.1f, \"gl_calls\": %.1f}%s\n",
+                    mean(counter(p, &FrameRecord::draws)), mean(counter(p, &FrameRecord::triangles)),
+                    mean(counter(p, &FrameRecord::uniforms)), mean(p.glCalls),
+                    i + 1 < phases.size() ? "," : "");
+        }
+        fprintf(f, "  ],\n  \"final_state\": {");
+        for (size_t i = 0; i < finalState.size(); i++)
+            fprintf(f, "%s\"%s\": %.6f", i ? ", " : "", finalState[i].first.c_str(), finalState[i].second);
+        fprintf(f, "}\n}\n");
+        fclose(f);
+        std::cout << "Bench: results written to " << outPath << std::endl;
+        return true;
+    }
+
+    void printTable(std::ostream& out) const {
+        char line[220];
+        snprintf(line, sizeof(line), "  %-20s %6s %9s %9s %9s %9s %7s %7s %9s %10s %8s %8s", "phase", "frames",
+                 "frame p50", "p95", "p99", "max", "sd", "draws", "tris", "submit us", "lat p50", "age p50");
+        out << line << std::endl;
+        for (const auto& p : phases) {
+            std::vector<double> v = column(p, &FrameRecord::frameMs);
+            std::sort(v.begin(), v.end());
+            std::vector<double> submit = p.submitMs;
+            std::sort(submit.begin(), submit.end());
+            std::vector<double> latency = column(p, &FrameRecord::latencyMs);
+            std::sort(latency.begin(), latency.end());
+            std::vector<double> age = column(p, &FrameRecord::viewAgeMs);
+            std::sort(age.begin(), age.end());
+            snprintf(line, sizeof(line), "  %-20s %6d %9.3f %9.3f %9.3f %9.3f %7.3f %7.0f %9.0f %10.1f %8.3f %8.3f",
+                     p.name.c_str(), (int)p.records.size(), rank(v, 50), rank(v, 95), rank(v, 99),
+                     v.empty() ? 0.0 : v.back(), stdDev(v), mean(counter(p, &FrameRecord::draws)),
+                     mean(counter(p, &FrameRecord::triangles)), rank(submit, 50) * 1000.0, rank(latency, 50),
+                     rank(age, 50));
+            out << line << std::endl;
+        }
+    }
+
+private:
+    std::string text;
+    size_t pos = 0;
+    std::string error;
+    int current = -1;
+
+    // ------------------------------------------------------------ statistics
+    // Negative values are missing samples (latencyMs, viewAgeMs)
+    static std::vector<double> column(const BenchPhase& p, double FrameRecord::*field) {
+        std::vector<double> v;
+        for (const auto& r : p.records) if (r.*field >= 0.0) v.push_back(r.*field);
+        return v;
+    }
+    static std::vector<double> counter(const BenchPhase& p, int FrameRecord::*field) {
+        std::vector<double> v;
+        for (const auto& r : p.records) v.push_back((double)(r.*field));
+        return v;
+    }
+    static int stutters(const BenchPhase& p) {
+        int n = 0;
+        for (const auto& r : p.records) if (r.stutter) n++;
+        return n;
+    }
+    static double mean(const std::vector<double>& v) {
+        double s = 0.0;
+        for (double x : v) s += x;
+        return v.empty() ? 0.0 : s / v.size();
+    }
+    static double stdDev(const std::vector<double>& v) {
+        if (v.size() < 2) return 0.0;
+        double m = mean(v), s = 0.0;
+        for (double x : v) s += (x - m) * (x - m);
+        return std::sqrt(s / (v.size() - 1));
+    }
+    // Nearest rank on sorted values, as in FrameStats
+    static double rank(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        return sorted[(size_t)(p / 100.0 * (sorted.size() - 1) + 0.5)];
+    }
+    static void writeTiming(FILE* f, const char* key, std::vector<double> v, const char* tail) {
+        std::sort(v.begin(), v.end());
+        fprintf(f, "     \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s",
+                key, mean(v), rank(v, 50), rank(v, 95), rank(v, 99), v.empty() ? 0.0 : v.back(), tail);
+    }
+
+    // -------------------------------------------------------------- parsing
+    // Just enough JSON for bench scripts: objects, arrays, strings, numbers
+    void parseScript() {
+        expect('{');
+        while (error.empty() && !peek('}')) {
+            std::string key = parseString();
+            expect(':');
+            if (key == "name") name = parseString();
+            else if (key == "dt") dt = (float)parseNumber();
+            else if (key == "phases") parsePhases();
+            else skipValue();
+            if (!peek('}')) expect(',');
+        }
+        expect('}');
+    }
+
+    void parsePhases() {
+        expect('[');
+        while (error.empty() && !peek(']')) {
+            BenchPhase p;
+            expect('{');
+            while (error.empty() && !peek('}')) {
+                std::string key = parseString();
+                expect(':');
+                if (key == "name") p.name = parseString();
+                else if (key == "frames") p.frames = (int)parseNumber();
+                else if (key == "hold") parseKeys(p.hold);
+                else if (key == "press") parseKeys(p.press);
+                else if (key == "look") parseLook(p.look);
+                else skipValue();
+                if (!peek('}')) expect(',');
+            }
+            expect('}');
+            if (p.frames <= 0 && error.empty()) error = "phase '" + p.name + "' needs frames > 0";
+            phases.push_back(p);
+            if (!peek(']')) expect(',');
+        }
+        expect(']');
+    }
+
+    void parseKeys(std::vector<int>& keys) {
+        expect('[');
+        while (error.empty() && !peek(']')) {
+            std::string k = parseString();
+            int code = keyCode(k);
+            if (code < 0 && error.empty()) error = "unsupported key '" + k + "'";
+            keys.push_back(code);
+            if (!peek(']')) expect(',');
+        }
+        expect(']');
+    }
+
+    void parseLook(float* look) {
+        expect('[');
+        look[0] = (float)parseNumber();
+        expect(',');
+        look[1] = (float)parseNumber();
+        expect(']');
+    }
+
+    // GLFW key codes for the names scripts may use
+    static int keyCode(const std::string& k) {
+        if (k.size() == 1 && (isupper((unsigned char)k[0]) || isdigit((unsigned char)k[0])))
+            return k[0] == 'M' ? -1 : k[0];          // GLFW_KEY_A.. and GLFW_KEY_0.. are ASCII
+        static const struct { const char* name; int code; } named[] = {
+            { "SPACE", 32 }, { "RIGHT", 262 }, { "LEFT", 263 }, { "DOWN", 264 }, { "UP", 265 },
+            { "TAB", 258 }, { "LEFT_SHIFT", 340 }, { "LEFT_CONTROL", 341 },
+        };
+        for (const auto& n : named) if (k == n.name) return n.code;
+        return -1;
+    }
+
+    void skipWs() { while (pos < text.size() && isspace((unsigned char)text[pos])) pos++; }
+    bool peek(char c) { skipWs(); return pos < text.size() && text[pos] == c; }
+    void expect(char c) {
+        if (!error.empty()) return;
+        if (peek(c)) { pos++; return; }
+        error = std::string("expected '") + c + "' at offset " + std::to_string(pos);
+    }
+
+    std::string parseString() {
+        std::string s;
+        expect('"');
+        while (error.empty() && pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+            s += text[pos++];
+        }
+        expect('"');
+        return s;
+    }
+
+    double parseNumber() {
+        skipWs();
+        const char* start = text.c_str() + pos;
+        char* end = NULL;
+        double v = strtod(start, &end);
+        if (end == start && error.empty()) error = "expected a number at offset " + std::to_string(pos);
+        pos += end - start;
+        return v;
+    }
+
+    void skipValue() {
+        skipWs();
+        if (pos >= text.size()) { error = "unexpected end of file"; return; }
+        char c = text[pos];
+        if (c == '"') { parseString(); return; }
+        if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            pos++;
+            while (error.empty() && !peek(close)) {
+                if (c == '{') { parseString(); expect(':'); }
+                skipValue();
+                if (!peek(close)) expect(',');
+            }
+            expect(close);
+            return;
+        }
+        if (isalpha((unsigned char)c)) { while (pos < text.size() && isalpha((unsigned char)text[pos])) pos++; return; }
+        parseNumber();
+    }
+};
+
+#endif
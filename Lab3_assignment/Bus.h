@@ -2,10 +2,64 @@
 #define BUS_H
 
 #include "Primitives.h"
-#include "Shader.h"
+#include "RenderQueue.h"
+#include "Ecs.h"
+#include "CameraMath.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+// ============================================================================
+// BUS - the hover bus as scene entities, posed by an ECS system
+// ============================================================================
+// build() turns every part of the bus into an entity: its mesh (a vertex
+// range of the shared cube, cylinder or torus), its transform relative to
+// the bus, its material and the conditions it is drawn under (interior
+// visible, entry steps out, jet on, body texture on). Parts that move carry
+// an animation: the door and fan hinges, the sliding windows, the interior
+// lights, the hover glow pulses and the jet flame layers and sparks, each
+// driven by the bus state the way the immediate draw code computed it.
+//
+// The "bus pose" system (addSystems) runs in the scene schedule: it places
+// every part under parent and evaluates the animations, on a job beside the
+// city's systems. draw() then records the parts whose conditions hold into
+// the render queue, on the render thread.
+// ============================================================================
+
+// Texture handles a part's material can name
+enum BusTexture {
+    BUS_TEX_FLOOR = 0, BUS_TEX_CARPET, BUS_TEX_FABRIC, BUS_TEX_WALL, BUS_TEX_DASHBOARD, BUS_TEX_BODY,
+    BUS_TEX_COUNT
+};
+
+// EcsBusPart::show bits: all must hold for the part to be drawn
+enum BusShow {
+    BUS_SHOW_INTERIOR = 1,          // interiorVisible
+    BUS_SHOW_STEPS = 2,             // front door more than half open
+    BUS_SHOW_JET = 4,               // jetEngineOn
+    BUS_SHOW_BODY_TEXTURE = 8       // texBusBody set
+};
+
+enum BusAnimationKind {
+    BUS_ANIM_HINGE = 0,             // turns by channel + phase degrees about Y at position
+    BUS_ANIM_WINDOW,                // slides down by windowOpenAmount[index]
+    BUS_ANIM_LIGHT,                 // lightColor or lightOffColor
+    BUS_ANIM_PULSE,                 // scale pulses with channel along scaleAxes
+    BUS_ANIM_FLAME,                 // flame layer: param = length, radius, frequency offset
+    BUS_ANIM_SPARK                  // flame spark number index
+};
+
+// Per-frame values animations read (EcsAnimation::channel / colorChannel)
+enum BusChannel {
+    BUS_CHANNEL_ONE = 0,
+    BUS_CHANNEL_FRONT_DOOR,
+    BUS_CHANNEL_FAN,
+    BUS_CHANNEL_FLAME_GLOW,
+    BUS_CHANNEL_GLOW_PULSE,
+    BUS_CHANNEL_PAD_BRIGHTNESS,
+    BUS_CHANNEL_BELLY_GLOW,
+    BUS_CHANNEL_COUNT
+};
+
 class Bus {
 public:
     // Primitives (shared across components)
@@ -21,6 +75,7 @@ public:
     float wheelRotation = 0.0f;    // Kept for compatibility but unused
     float steeringAngle = 0.0f;    // Kept for compatibility but unused
     bool lightOn = true;
+    bool interiorVisible = true;   // false when the camera cannot see inside (skips interior draws)
 
     // Jet engine / hover state
     bool jetEngineOn = false;       // True when bus moves forward
@@ -51,7 +106,8 @@ public:
     glm::vec3 hoverPadColor = glm::vec3(0.3f, 0.6f, 0.9f);
     glm::vec3 hoverGlowColor = glm::vec3(0.4f, 0.7f, 1.0f);
 
-    // ==================== TEXTURE IDs (set from assignment.cpp) ====================
+    // ==================== TEXTURE HANDLES (set from assignment.cpp) ====================
+    // Handles into the TextureCache; the render queue resolves them at submit
     unsigned int texFloor = 0;
     unsigned int texCarpet = 0;
     unsigned int texFabric = 0;
@@ -59,129 +115,108 @@ public:
     unsigned int texDashboard = 0;
     unsigned int texBusBody = 0;
 
+    // ==================== SCENE ENTITIES (built by build()) ====================
+    EcsWorld* world = nullptr;
+    glm::mat4 parent = glm::mat4(1.0f);   // bus transform the pose system places the parts under
+
     void init() {
         cube.init();
         cylinder.init(36);
         torus.init(0.3f, 0.05f, 24, 12);
     }
 
-    // Helper: draw with texture bound
-    void drawTextured(const Shader& shader, glm::mat4 model, glm::vec3 color,
-                      unsigned int texID, int mode,
-                      Cube& shape) {
-        if (texID != 0) {
-            shader.setInt("textureMode", mode);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texID);
-            shader.setInt("textureSampler", 0);
-        }
-        shape.draw(shader, model, color);
-        if (texID != 0) {
-            shader.setInt("textureMode", 0);
-        }
+    // One entity per part, in world (after init(), which makes the meshes)
+    void build(EcsWorld& sceneWorld) {
+        world = &sceneWorld;
+        buildExterior();
+        buildInterior();
+        buildJetEngine();
+        buildHoverSkirts();
     }
 
-    void drawTexturedCyl(const Shader& shader, glm::mat4 model, glm::vec3 color,
-                         unsigned int texID, int mode) {
-        if (texID != 0) {
-            shader.setInt("textureMode", mode);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texID);
-            shader.setInt("textureSampler", 0);
-        }
-        cylinder.draw(shader, model, color);
-        if (texID != 0) {
-            shader.setInt("textureMode", 0);
-        }
+    void addSystems(EcsSchedule& schedule) {
+        schedule.add("bus pose", EcsMaskOf<EcsBusPart>::value, 0, EcsMaskOf<EcsTransform, EcsAnimation>::value,
+                     EcsMaskOf<EcsWorldTransform, EcsMaterial>::value, &Bus::poseSystem, this);
     }
 
-    void draw(const Shader& shader, glm::mat4 parentTransform) {
-        drawExterior(shader, parentTransform);
-        drawInterior(shader, parentTransform);
-        drawJetEngine(shader, parentTransform);
-        drawHoverSkirts(shader, parentTransform);
+    // Records the parts the pose system placed; render thread, after the
+    // schedule ran. Texture slots resolve to the current handles, so
+    // switching textures off and on needs no rebuild.
+    void draw(RenderQueue& queue) {
+        const unsigned int handles[BUS_TEX_COUNT] = {
+            texFloor, texCarpet, texFabric, texWall, texDashboard, texBusBody
+        };
+        int active = activeShow();
+        world->each<EcsWorldTransform, EcsMeshRange, EcsMaterial, EcsBusPart>(
+            [&](int n, const EcsWorldTransform* xform, const EcsMeshRange* mesh, const EcsMaterial* material,
+                const EcsBusPart* part) {
+                for (int i = 0; i < n; i++) {
+                    if (part[i].show & ~active) continue;
+                    const EcsMaterial& m = material[i];
+                    int id = m.texture >= 0 ? queue.material(handles[m.texture], m.textureMode)
+                           : m.emissive ? queue.material(0, 0, true) : 0;
+                    const EcsMeshRange& r = mesh[i];
+                    queue.drawRange(r.vao, r.vbo, r.first, r.count, xform[i].world, m.color, id,
+                                    (RenderBlend)m.blend, m.alpha);
+                }
+            });
     }
 
-    void drawExterior(const Shader& shader, glm::mat4 parent) {
-        glm::mat4 model;
-
+    void buildExterior() {
         // ==================== MAIN BODY (Coach Bus - Flat Front) ====================
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5f, 0.0f));
-        model = glm::scale(model, glm::vec3(10.0f, 3.0f, 3.0f));
-        cube.draw(shader, model, bodyColor);
+        addPart(cube, box(glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(10.0f, 3.0f, 3.0f)), bodyColor);
 
         // Roof
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.15f, 0.0f));
-        model = glm::scale(model, glm::vec3(10.2f, 0.3f, 3.1f));
-        cube.draw(shader, model, roofColor);
+        addPart(cube, box(glm::vec3(0.0f, 2.15f, 0.0f), glm::vec3(10.2f, 0.3f, 3.1f)), roofColor);
 
         // ==================== BUS SIDE PANELS (textured with bus name) ====================
-        // Left side panel overlay
-        if (texBusBody != 0) {
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5f, -1.52f));
-            model = glm::scale(model, glm::vec3(9.8f, 1.8f, 0.02f));
-            drawTextured(shader, model, bodyColor, texBusBody, 1, cube);
-
-            // Right side panel overlay
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.5f, 1.52f));
-            model = glm::scale(model, glm::vec3(9.8f, 1.8f, 0.02f));
-            drawTextured(shader, model, bodyColor, texBusBody, 1, cube);
+        // Left and right side panel overlays, only while the texture is on
+        for (int side = -1; side <= 1; side += 2) {
+            EcsEntity e = addPart(cube, box(glm::vec3(0.0f, 0.5f, side * 1.52f), glm::vec3(9.8f, 1.8f, 0.02f)),
+                                  bodyColor, BUS_SHOW_BODY_TEXTURE);
+            texture(e, BUS_TEX_BODY, 1);
         }
 
         // ==================== WINDOWS ====================
-        // Left side windows
-        for (int i = 0; i < 5; i++) {
-            float yOffset = windowOpenAmount[i] * 0.4f;
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-2.8f + i * 1.5f, 1.2f - yOffset, -1.51f));
-            model = glm::scale(model, glm::vec3(1.2f, 1.0f - yOffset, 0.05f));
-            cube.draw(shader, model, windowColor);
-        }
-
-        // Right side windows
-        for (int i = 0; i < 5; i++) {
-            float yOffset = windowOpenAmount[5 + i] * 0.4f;
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-2.8f + i * 1.5f, 1.2f - yOffset, 1.51f));
-            model = glm::scale(model, glm::vec3(1.2f, 1.0f - yOffset, 0.05f));
-            cube.draw(shader, model, windowColor);
+        // Left side windows, then right; each slides down as it opens
+        for (int w = 0; w < 10; w++) {
+            EcsEntity e = addPart(cube, glm::mat4(1.0f), windowColor, 0, BUS_ANIM_WINDOW);
+            EcsAnimation& a = animation(e);
+            a.index = (uint8_t)w;
+            a.position = glm::vec3(-2.8f + (w % 5) * 1.5f, 1.2f, w < 5 ? -1.51f : 1.51f);
+            a.scale = glm::vec3(1.2f, 1.0f, 0.05f);
         }
 
         // Front windshield
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-5.01f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.05f, 1.8f, 2.5f));
-        cube.draw(shader, model, windowColor);
+        addPart(cube, box(glm::vec3(-5.01f, 1.0f, 0.0f), glm::vec3(0.05f, 1.8f, 2.5f)), windowColor);
 
         // Rear window
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.01f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.05f, 1.5f, 2.2f));
-        cube.draw(shader, model, windowColor);
+        addPart(cube, box(glm::vec3(5.01f, 1.0f, 0.0f), glm::vec3(0.05f, 1.5f, 2.2f)), windowColor);
 
         // ==================== DOOR ====================
-        glm::mat4 frontDoorPivot = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.5f, 0.0f, 1.5f));
-        frontDoorPivot = glm::rotate(frontDoorPivot, glm::radians(frontDoorAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::translate(frontDoorPivot, glm::vec3(0.5f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(1.0f, 1.8f, 0.08f));
-        cube.draw(shader, model, doorColor);
+        // Hinged at its front edge
+        {
+            EcsEntity e = addPart(cube, box(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(1.0f, 1.8f, 0.08f)),
+                                  doorColor, 0, BUS_ANIM_HINGE);
+            EcsAnimation& a = animation(e);
+            a.channel = BUS_CHANNEL_FRONT_DOOR;
+            a.position = glm::vec3(-4.5f, 0.0f, 1.5f);
+        }
 
         // ==================== HEADLIGHTS & TAILLIGHTS ====================
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-5.01f, 0.0f, -1.0f));
-        model = glm::scale(model, glm::vec3(0.1f, 0.4f, 0.5f));
-        cube.draw(shader, model, glm::vec3(1.0f, 1.0f, 0.7f));
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-5.01f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.1f, 0.4f, 0.5f));
-        cube.draw(shader, model, glm::vec3(1.0f, 1.0f, 0.7f));
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.01f, 0.0f, -1.0f));
-        model = glm::scale(model, glm::vec3(0.1f, 0.4f, 0.5f));
-        cube.draw(shader, model, glm::vec3(0.8f, 0.1f, 0.1f));
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.01f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.1f, 0.4f, 0.5f));
-        cube.draw(shader, model, glm::vec3(0.8f, 0.1f, 0.1f));
+        for (int side = -1; side <= 1; side += 2) {
+            addPart(cube, box(glm::vec3(-5.01f, 0.0f, side * 1.0f), glm::vec3(0.1f, 0.4f, 0.5f)),
+                    glm::vec3(1.0f, 1.0f, 0.7f));
+        }
+        for (int side = -1; side <= 1; side += 2) {
+            addPart(cube, box(glm::vec3(5.01f, 0.0f, side * 1.0f), glm::vec3(0.1f, 0.4f, 0.5f)),
+                    glm::vec3(0.8f, 0.1f, 0.1f));
+        }
     }
 
-    void drawInterior(const Shader& shader, glm::mat4 parent) {
-        glm::mat4 model;
+    // Drawn only while interiorVisible
+    void buildInterior() {
+        const int in = BUS_SHOW_INTERIOR;
 
         // Colors for interior elements
         glm::vec3 fabricColor = glm::vec3(0.15f, 0.25f, 0.45f);
@@ -192,30 +227,24 @@ public:
         glm::vec3 rackColor = glm::vec3(0.5f, 0.5f, 0.52f);
 
         // ==================== INTERIOR CEILING (covers exterior roof, prevents z-fighting) ====================
-    model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.92f, 0.0f));
-    model = glm::scale(model, glm::vec3(9.5f, 0.05f, 2.55f));
-    cube.draw(shader, model, glm::vec3(0.92f, 0.90f, 0.88f));  // Off-white ceiling
+        addPart(cube, box(glm::vec3(0.0f, 1.92f, 0.0f), glm::vec3(9.5f, 0.05f, 2.55f)),
+                glm::vec3(0.92f, 0.90f, 0.88f), in);  // Off-white ceiling
 
-    // ==================== FLOOR (textured) ====================
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.9f, 0.0f));
-        model = glm::scale(model, glm::vec3(9.5f, 0.1f, 2.6f));
-        drawTextured(shader, model, floorColor, texFloor, 3, cube);
+        // ==================== FLOOR (textured) ====================
+        texture(addPart(cube, box(glm::vec3(0.0f, -0.9f, 0.0f), glm::vec3(9.5f, 0.1f, 2.6f)), floorColor, in),
+                BUS_TEX_FLOOR, 3);
 
         // Aisle carpet (textured)
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.84f, 0.0f));
-        model = glm::scale(model, glm::vec3(9.0f, 0.02f, 0.6f));
-        drawTextured(shader, model, carpetColor, texCarpet, 1, cube);
+        texture(addPart(cube, box(glm::vec3(0.0f, -0.84f, 0.0f), glm::vec3(9.0f, 0.02f, 0.6f)), carpetColor, in),
+                BUS_TEX_CARPET, 1);
 
         // ==================== INTERIOR WALL PANELS (textured) ====================
-        // Left wall panel
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.3f, -1.49f));
-        model = glm::scale(model, glm::vec3(9.5f, 2.5f, 0.02f));
-        drawTextured(shader, model, glm::vec3(0.85f, 0.85f, 0.85f), texWall, 3, cube);
-
-        // Right wall panel
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.3f, 1.49f));
-        model = glm::scale(model, glm::vec3(9.5f, 2.5f, 0.02f));
-        drawTextured(shader, model, glm::vec3(0.85f, 0.85f, 0.85f), texWall, 3, cube);
+        // Left and right wall panels
+        for (int side = -1; side <= 1; side += 2) {
+            texture(addPart(cube, box(glm::vec3(0.0f, 0.3f, side * 1.49f), glm::vec3(9.5f, 2.5f, 0.02f)),
+                            glm::vec3(0.85f, 0.85f, 0.85f), in),
+                    BUS_TEX_WALL, 3);
+        }
 
         // ==================== PASSENGER SEATS (textured cushions) ====================
         float seatY = -0.5f;
@@ -226,45 +255,42 @@ public:
             float zPos = (side == 0) ? -0.85f : 0.85f;
             float zBack = (side == 0) ? -1.1f : 1.1f;
             float zArm = (side == 0) ? -0.55f : 0.55f;
-            
+
             for (int i = 0; i < numSeats; i++) {
                 float xPos = -3.2f + i * seatSpacing;
 
                 // Seat cushion (textured fabric)
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY, zPos));
-                model = glm::scale(model, glm::vec3(0.8f, 0.25f, 0.7f));
-                drawTextured(shader, model, cushionColor, texFabric, 3, cube);
+                texture(addPart(cube, box(glm::vec3(xPos, seatY, zPos), glm::vec3(0.8f, 0.25f, 0.7f)),
+                                cushionColor, in),
+                        BUS_TEX_FABRIC, 3);
 
                 // Seat frame/base
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY - 0.2f, zPos));
-                model = glm::scale(model, glm::vec3(0.75f, 0.15f, 0.65f));
-                cube.draw(shader, model, armrestColor);
+                addPart(cube, box(glm::vec3(xPos, seatY - 0.2f, zPos), glm::vec3(0.75f, 0.15f, 0.65f)),
+                        armrestColor, in);
 
                 // Seat back (textured fabric)
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY + 0.55f, zBack));
-                model = glm::scale(model, glm::vec3(0.75f, 0.85f, 0.12f));
-                drawTextured(shader, model, fabricColor, texFabric, 3, cube);
+                texture(addPart(cube, box(glm::vec3(xPos, seatY + 0.55f, zBack), glm::vec3(0.75f, 0.85f, 0.12f)),
+                                fabricColor, in),
+                        BUS_TEX_FABRIC, 3);
 
                 // Backrest cushion (textured fabric)
                 float cushionZ = (side == 0) ? zBack + 0.08f : zBack - 0.08f;
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY + 0.5f, cushionZ));
-                model = glm::scale(model, glm::vec3(0.65f, 0.7f, 0.08f));
-                drawTextured(shader, model, cushionColor, texFabric, 3, cube);
+                texture(addPart(cube, box(glm::vec3(xPos, seatY + 0.5f, cushionZ), glm::vec3(0.65f, 0.7f, 0.08f)),
+                                cushionColor, in),
+                        BUS_TEX_FABRIC, 3);
 
                 // Headrest
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY + 1.1f, zBack));
-                model = glm::scale(model, glm::vec3(0.4f, 0.25f, 0.15f));
-                drawTextured(shader, model, fabricColor, texFabric, 3, cube);
+                texture(addPart(cube, box(glm::vec3(xPos, seatY + 1.1f, zBack), glm::vec3(0.4f, 0.25f, 0.15f)),
+                                fabricColor, in),
+                        BUS_TEX_FABRIC, 3);
 
                 // Inner armrest
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY + 0.15f, zArm));
-                model = glm::scale(model, glm::vec3(0.7f, 0.08f, 0.1f));
-                cube.draw(shader, model, armrestColor);
+                addPart(cube, box(glm::vec3(xPos, seatY + 0.15f, zArm), glm::vec3(0.7f, 0.08f, 0.1f)),
+                        armrestColor, in);
 
                 // Seat leg
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(xPos, seatY - 0.45f, zPos));
-                model = glm::scale(model, glm::vec3(0.08f, 0.35f, 0.08f));
-                cylinder.draw(shader, model, metalColor);
+                addPart(cylinder, box(glm::vec3(xPos, seatY - 0.45f, zPos), glm::vec3(0.08f, 0.35f, 0.08f)),
+                        metalColor, in);
             }
         }
 
@@ -272,313 +298,217 @@ public:
         for (int side = 0; side < 2; side++) {
             float zRail = (side == 0) ? -0.3f : 0.3f;
             // Horizontal grab bar only — no vertical support posts
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.6f, zRail));
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.6f, zRail));
             model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
             model = glm::scale(model, glm::vec3(0.05f, 8.0f, 0.05f));
-            cylinder.draw(shader, model, metalColor);
-            // Removed vertical posts (they looked like unwanted pillars)
+            addPart(cylinder, model, metalColor, in);
         }
 
         // ==================== LUGGAGE RACKS ====================
         for (int side = 0; side < 2; side++) {
             float zRack = (side == 0) ? -1.2f : 1.2f;
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.5f, zRack));
-            model = glm::scale(model, glm::vec3(8.5f, 0.05f, 0.4f));
-            cube.draw(shader, model, rackColor);
+            addPart(cube, box(glm::vec3(0.0f, 1.5f, zRack), glm::vec3(8.5f, 0.05f, 0.4f)), rackColor, in);
 
             float backZ = (side == 0) ? zRack - 0.15f : zRack + 0.15f;
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.65f, backZ));
-            model = glm::scale(model, glm::vec3(8.5f, 0.35f, 0.05f));
-            cube.draw(shader, model, rackColor);
+            addPart(cube, box(glm::vec3(0.0f, 1.65f, backZ), glm::vec3(8.5f, 0.35f, 0.05f)), rackColor, in);
         }
 
         // ==================== DRIVER AREA (textured dashboard) ====================
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.3f, 0.3f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 1.2f, 2.4f));
-        drawTextured(shader, model, dashboardColor, texDashboard, 1, cube);
+        texture(addPart(cube, box(glm::vec3(-4.3f, 0.3f, 0.0f), glm::vec3(0.8f, 1.2f, 2.4f)), dashboardColor, in),
+                BUS_TEX_DASHBOARD, 1);
 
         // Instrument panel (textured dashboard)
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.0f, 0.6f, -0.3f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.4f, 0.8f));
-        drawTextured(shader, model, glm::vec3(0.1f, 0.1f, 0.1f), texDashboard, 1, cube);
+        texture(addPart(cube, box(glm::vec3(-4.0f, 0.6f, -0.3f), glm::vec3(0.3f, 0.4f, 0.8f)),
+                        glm::vec3(0.1f, 0.1f, 0.1f), in),
+                BUS_TEX_DASHBOARD, 1);
 
         // Driver seat
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.8f, seatY + 0.1f, -0.6f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.25f, 0.8f));
-        drawTextured(shader, model, cushionColor, texFabric, 3, cube);
+        texture(addPart(cube, box(glm::vec3(-3.8f, seatY + 0.1f, -0.6f), glm::vec3(0.9f, 0.25f, 0.8f)),
+                        cushionColor, in),
+                BUS_TEX_FABRIC, 3);
 
         // Driver seat back
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.8f, seatY + 0.65f, -1.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 1.0f, 0.15f));
-        drawTextured(shader, model, fabricColor, texFabric, 3, cube);
+        texture(addPart(cube, box(glm::vec3(-3.8f, seatY + 0.65f, -1.0f), glm::vec3(0.85f, 1.0f, 0.15f)),
+                        fabricColor, in),
+                BUS_TEX_FABRIC, 3);
 
         // Driver seat legs
         for (int s = -1; s <= 1; s += 2) {
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.8f + s * 0.35f, seatY - 0.3f, -0.6f));
-            model = glm::scale(model, glm::vec3(0.07f, 0.45f, 0.07f));
-            cube.draw(shader, model, glm::vec3(0.25f, 0.25f, 0.25f));
+            addPart(cube, box(glm::vec3(-3.8f + s * 0.35f, seatY - 0.3f, -0.6f), glm::vec3(0.07f, 0.45f, 0.07f)),
+                    glm::vec3(0.25f, 0.25f, 0.25f), in);
         }
 
         // Driver seat headrest
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.8f, seatY + 1.35f, -1.0f));
-        model = glm::scale(model, glm::vec3(0.45f, 0.28f, 0.13f));
-        drawTextured(shader, model, fabricColor, texFabric, 3, cube);
+        texture(addPart(cube, box(glm::vec3(-3.8f, seatY + 1.35f, -1.0f), glm::vec3(0.45f, 0.28f, 0.13f)),
+                        fabricColor, in),
+                BUS_TEX_FABRIC, 3);
 
         // ==================== STEERING WHEEL ====================
         // Column — tilted toward driver (toward -X and up)
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.1f, 0.55f, -0.6f));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-4.1f, 0.55f, -0.6f));
         model = glm::rotate(model, glm::radians(35.0f), glm::vec3(0.0f, 0.0f, 1.0f));  // tilt forward
         model = glm::scale(model, glm::vec3(0.06f, 0.45f, 0.06f));
-        cylinder.draw(shader, model, steeringColor);
+        addPart(cylinder, model, steeringColor, in);
 
         // Torus ring — faces the driver (lies in XZ plane, rotated so ring is upright toward driver)
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.85f, 0.9f, -0.6f));
+        model = glm::translate(glm::mat4(1.0f), glm::vec3(-3.85f, 0.9f, -0.6f));
         model = glm::rotate(model, glm::radians(55.0f), glm::vec3(0.0f, 0.0f, 1.0f));  // match column tilt
         model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));  // face driver
         model = glm::scale(model, glm::vec3(0.65f, 0.65f, 0.65f));
-        torus.draw(shader, model, steeringColor);
+        addPart(torus, model, steeringColor, in);
 
         // Center hub
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-3.85f, 0.9f, -0.6f));
-        model = glm::scale(model, glm::vec3(0.08f, 0.08f, 0.08f));
-        cylinder.draw(shader, model, steeringColor);
+        addPart(cylinder, box(glm::vec3(-3.85f, 0.9f, -0.6f), glm::vec3(0.08f, 0.08f, 0.08f)), steeringColor, in);
 
         // ==================== CEILING FANS ====================
+        // Hub and blades turn about the fan's axis by fanRotation, the second
+        // fan 45 degrees ahead of the first
         glm::vec3 metalColorLocal = glm::vec3(0.7f, 0.7f, 0.75f);
         for (int f = 0; f < 2; f++) {
-            float fanX = -1.5f + f * 3.0f;
-            glm::mat4 fanBase = parent * glm::translate(glm::mat4(1.0f), glm::vec3(fanX, 1.85f, 0.0f));
-            fanBase = glm::rotate(fanBase, glm::radians(fanRotation + f * 45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-
-            model = glm::scale(fanBase, glm::vec3(0.15f, 0.1f, 0.15f));
-            cylinder.draw(shader, model, metalColorLocal);
+            glm::vec3 fanBase(-1.5f + f * 3.0f, 1.85f, 0.0f);
+            EcsEntity e = addPart(cylinder, glm::scale(glm::mat4(1.0f), glm::vec3(0.15f, 0.1f, 0.15f)),
+                                  metalColorLocal, in, BUS_ANIM_HINGE);
+            fanBlade(e, fanBase, f);
 
             for (int i = 0; i < 4; i++) {
-                glm::mat4 blade = glm::rotate(fanBase, glm::radians(90.0f * i), glm::vec3(0.0f, 1.0f, 0.0f));
+                glm::mat4 blade = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f * i), glm::vec3(0.0f, 1.0f, 0.0f));
                 blade = glm::translate(blade, glm::vec3(0.3f, 0.0f, 0.0f));
                 blade = glm::scale(blade, glm::vec3(0.45f, 0.03f, 0.12f));
-                cube.draw(shader, blade, fanColor);
+                fanBlade(addPart(cube, blade, fanColor, in, BUS_ANIM_HINGE), fanBase, f);
             }
         }
 
         // ==================== INTERIOR LIGHTS (pulled down to avoid z-fighting with roof) ====================
-        glm::vec3 currentLightColor = lightOn ? lightColor : lightOffColor;
+        // lightColor while lightOn, lightOffColor otherwise
         for (int side = 0; side < 2; side++) {
             float zLight = (side == 0) ? -0.8f : 0.8f;
             // Y=1.88 instead of 1.95 — avoids z-fighting with exterior roof at Y~2.0
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.88f, zLight));
-            model = glm::scale(model, glm::vec3(8.0f, 0.04f, 0.15f));
-            cube.draw(shader, model, currentLightColor);
+            EcsAnimation& a = animation(addPart(cube, glm::mat4(1.0f), lightColor, in, BUS_ANIM_LIGHT));
+            a.position = glm::vec3(0.0f, 1.88f, zLight);
+            a.scale = glm::vec3(8.0f, 0.04f, 0.15f);
+        }
+        {
+            EcsAnimation& a = animation(addPart(cylinder, glm::mat4(1.0f), lightColor, in, BUS_ANIM_LIGHT));
+            a.position = glm::vec3(0.0f, 1.88f, 0.0f);
+            a.scale = glm::vec3(0.5f, 0.08f, 0.5f);
         }
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.88f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.5f, 0.08f, 0.5f));
-        cylinder.draw(shader, model, currentLightColor);
 
         // ==================== ENTRY STEPS ====================
-        if (frontDoorAngle > 45.0f) {
-            glm::vec3 metalColorSteps = glm::vec3(0.7f, 0.7f, 0.75f);
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.5f, -1.2f, 1.8f));
-            model = glm::scale(model, glm::vec3(0.8f, 0.15f, 0.5f));
-            cube.draw(shader, model, metalColorSteps);
-            
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(-4.5f, -0.9f, 1.6f));
-            model = glm::scale(model, glm::vec3(0.8f, 0.15f, 0.5f));
-            cube.draw(shader, model, metalColorSteps);
-        }
+        // Only while the front door is more than half open
+        glm::vec3 metalColorSteps = glm::vec3(0.7f, 0.7f, 0.75f);
+        addPart(cube, box(glm::vec3(-4.5f, -1.2f, 1.8f), glm::vec3(0.8f, 0.15f, 0.5f)), metalColorSteps,
+                in | BUS_SHOW_STEPS);
+        addPart(cube, box(glm::vec3(-4.5f, -0.9f, 1.6f), glm::vec3(0.8f, 0.15f, 0.5f)), metalColorSteps,
+                in | BUS_SHOW_STEPS);
     }
 
     // ==================== JET ENGINE (rear mounted) ====================
-    void drawJetEngine(const Shader& shader, glm::mat4 parent) {
-        glm::mat4 model;
+    void buildJetEngine() {
         glm::vec3 metalColor = glm::vec3(0.7f, 0.7f, 0.75f);
 
-        glm::mat4 engineBase = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.8f, 0.5f, 0.0f));
-
-        model = engineBase;
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(1.4f, 1.8f, 1.4f));
-        cylinder.draw(shader, model, jetHousingColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.5f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(1.5f, 0.3f, 1.5f));
-        cylinder.draw(shader, model, jetInnerRingColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(6.9f, 0.5f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(1.1f, 0.4f, 1.1f));
-        cylinder.draw(shader, model, jetNozzleColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(7.1f, 0.5f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(2.8f, 2.8f, 2.8f));
-        torus.draw(shader, model, jetNozzleColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(6.5f, 0.5f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.5f, 1.2f, 0.5f));
-        cylinder.draw(shader, model, glm::vec3(0.15f, 0.15f, 0.18f));
+        addPart(cylinder, sideways(glm::vec3(5.8f, 0.5f, 0.0f), glm::vec3(1.4f, 1.8f, 1.4f)), jetHousingColor);
+        addPart(cylinder, sideways(glm::vec3(5.0f, 0.5f, 0.0f), glm::vec3(1.5f, 0.3f, 1.5f)), jetInnerRingColor);
+        addPart(cylinder, sideways(glm::vec3(6.9f, 0.5f, 0.0f), glm::vec3(1.1f, 0.4f, 1.1f)), jetNozzleColor);
+        addPart(torus, sideways(glm::vec3(7.1f, 0.5f, 0.0f), glm::vec3(2.8f, 2.8f, 2.8f)), jetNozzleColor);
+        addPart(cylinder, sideways(glm::vec3(6.5f, 0.5f, 0.0f), glm::vec3(0.5f, 1.2f, 0.5f)),
+                glm::vec3(0.15f, 0.15f, 0.18f));
 
         // Support struts
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.3f, 1.4f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.15f, 0.3f));
-        cube.draw(shader, model, metalColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.3f, -0.4f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.15f, 0.3f));
-        cube.draw(shader, model, metalColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.3f, 0.5f, -0.9f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.3f, 0.15f));
-        cube.draw(shader, model, metalColor);
-
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(5.3f, 0.5f, 0.9f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.3f, 0.15f));
-        cube.draw(shader, model, metalColor);
+        addPart(cube, box(glm::vec3(5.3f, 1.4f, 0.0f), glm::vec3(0.8f, 0.15f, 0.3f)), metalColor);
+        addPart(cube, box(glm::vec3(5.3f, -0.4f, 0.0f), glm::vec3(0.8f, 0.15f, 0.3f)), metalColor);
+        addPart(cube, box(glm::vec3(5.3f, 0.5f, -0.9f), glm::vec3(0.8f, 0.3f, 0.15f)), metalColor);
+        addPart(cube, box(glm::vec3(5.3f, 0.5f, 0.9f), glm::vec3(0.8f, 0.3f, 0.15f)), metalColor);
 
         // Fin
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(6.0f, 1.5f, 0.0f));
-        model = glm::scale(model, glm::vec3(1.5f, 0.4f, 0.08f));
-        cube.draw(shader, model, jetHousingColor);
+        addPart(cube, box(glm::vec3(6.0f, 1.5f, 0.0f), glm::vec3(1.5f, 0.4f, 0.08f)), jetHousingColor);
 
         // --- JET FLAME ---
-        if (jetEngineOn) {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-            glDepthMask(GL_FALSE);
-
-            shader.setBool("isEmissive", true);
+        // Additive, emissive layers, only while jetEngineOn; the queue draws
+        // them after every opaque part
+        const float nozzleX = 7.15f;
+        glm::mat4 alongX = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        {
+            EcsEntity e = addPart(cylinder, alongX, glm::vec3(1.0f, 0.95f, 0.85f), BUS_SHOW_JET, BUS_ANIM_PULSE);
+            glow(e, 0.9f);
+            EcsAnimation& a = animation(e);
+            a.channel = BUS_CHANNEL_FLAME_GLOW;
+            a.position = glm::vec3(nozzleX, 0.5f, 0.0f);
+            a.scale = glm::vec3(0.95f, 0.08f, 0.95f);
+            a.scaleAxes = glm::vec3(1.0f, 0.0f, 1.0f);
+        }
 
-            float t = jetFlameFlicker;
-            float nozzleX = 7.15f;
+        struct FlameLayer {
+            float lengthScale;
+            float radiusScale;
+            float freqOffset;
+            float alphaVal;
+            glm::vec3 color;
+        };
 
-            float glowPulse = 0.85f + 0.15f * sin(t * 25.0f);
-            shader.setFloat("alpha", 0.9f);
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(nozzleX, 0.5f, 0.0f));
-            model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            model = glm::scale(model, glm::vec3(0.95f * glowPulse, 0.08f, 0.95f * glowPulse));
-            cylinder.draw(shader, model, glm::vec3(1.0f, 0.95f, 0.85f));
-
-            struct FlameLayer {
-                float lengthScale;
-                float radiusScale;
-                float freqOffset;
-                float alphaVal;
-                glm::vec3 color;
-            };
-
-            FlameLayer layers[] = {
-                { 1.0f,  0.20f, 0.0f, 0.95f, glm::vec3(1.0f, 0.97f, 0.85f) },
-                { 0.92f, 0.28f, 2.1f, 0.85f, glm::vec3(1.0f, 0.92f, 0.55f) },
-                { 0.85f, 0.38f, 4.3f, 0.75f, flameColorCore },
-                { 0.78f, 0.45f, 6.7f, 0.65f, glm::vec3(1.0f, 0.75f, 0.2f) },
-                { 0.68f, 0.55f, 8.9f, 0.55f, flameColorMid },
-                { 0.60f, 0.65f, 11.3f, 0.45f, glm::vec3(1.0f, 0.4f, 0.08f) },
-                { 0.50f, 0.78f, 13.7f, 0.35f, flameColorOuter },
-                { 0.40f, 0.90f, 16.1f, 0.25f, glm::vec3(0.8f, 0.15f, 0.03f) },
-                { 0.30f, 1.05f, 18.9f, 0.15f, glm::vec3(0.5f, 0.08f, 0.02f) },
-            };
-
-            int numLayers = sizeof(layers) / sizeof(layers[0]);
-
-            for (int i = 0; i < numLayers; i++) {
-                FlameLayer& L = layers[i];
-                float baseLen = 3.0f * L.lengthScale;
-                float turbulence = 0.5f * sin(t * (14.0f + L.freqOffset))
-                                 + 0.25f * sin(t * (21.0f + L.freqOffset * 0.7f))
-                                 + 0.15f * sin(t * (33.0f + L.freqOffset * 1.3f));
-                float len = baseLen + turbulence * L.lengthScale;
-                if (len < 0.2f) len = 0.2f;
-
-                float rad = L.radiusScale * (0.45f + 0.06f * sin(t * (17.0f + L.freqOffset * 0.5f)));
-                float yOff = 0.03f * sin(t * (9.0f + L.freqOffset * 0.3f));
-                float zOff = 0.03f * sin(t * (7.0f + L.freqOffset * 0.6f));
-
-                shader.setFloat("alpha", L.alphaVal);
-                model = parent * glm::translate(glm::mat4(1.0f),
-                    glm::vec3(nozzleX + len * 0.5f, 0.5f + yOff, zOff));
-                model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-                model = glm::scale(model, glm::vec3(rad, len, rad));
-                cylinder.draw(shader, model, L.color);
-            }
+        FlameLayer layers[] = {
+            { 1.0f,  0.20f, 0.0f, 0.95f, glm::vec3(1.0f, 0.97f, 0.85f) },
+            { 0.92f, 0.28f, 2.1f, 0.85f, glm::vec3(1.0f, 0.92f, 0.55f) },
+            { 0.85f, 0.38f, 4.3f, 0.75f, flameColorCore },
+            { 0.78f, 0.45f, 6.7f, 0.65f, glm::vec3(1.0f, 0.75f, 0.2f) },
+            { 0.68f, 0.55f, 8.9f, 0.55f, flameColorMid },
+            { 0.60f, 0.65f, 11.3f, 0.45f, glm::vec3(1.0f, 0.4f, 0.08f) },
+            { 0.50f, 0.78f, 13.7f, 0.35f, flameColorOuter },
+            { 0.40f, 0.90f, 16.1f, 0.25f, glm::vec3(0.8f, 0.15f, 0.03f) },
+            { 0.30f, 1.05f, 18.9f, 0.15f, glm::vec3(0.5f, 0.08f, 0.02f) },
+        };
 
-            // Sparks
-            shader.setFloat("alpha", 0.9f);
-            for (int s = 0; s < 5; s++) {
-                float sparkPhase = t * (20.0f + s * 7.3f) + s * 1.7f;
-                float sparkX = nozzleX + 0.5f + fmod(sparkPhase * 0.8f, 2.5f);
-                float sparkY = 0.5f + 0.15f * sin(sparkPhase * 3.0f);
-                float sparkZ = 0.12f * sin(sparkPhase * 2.5f + s * 0.9f);
-                float sparkSize = 0.04f + 0.02f * sin(sparkPhase * 5.0f);
-
-                model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(sparkX, sparkY, sparkZ));
-                model = glm::scale(model, glm::vec3(sparkSize, sparkSize, sparkSize));
-                cylinder.draw(shader, model, glm::vec3(1.0f, 0.95f, 0.7f));
-            }
+        int numLayers = sizeof(layers) / sizeof(layers[0]);
+
+        for (int i = 0; i < numLayers; i++) {
+            FlameLayer& L = layers[i];
+            EcsEntity e = addPart(cylinder, alongX, L.color, BUS_SHOW_JET, BUS_ANIM_FLAME);
+            glow(e, L.alphaVal);
+            EcsAnimation& a = animation(e);
+            a.position = glm::vec3(nozzleX, 0.5f, 0.0f);
+            a.param[0] = L.lengthScale;
+            a.param[1] = L.radiusScale;
+            a.param[2] = L.freqOffset;
+        }
 
-            shader.setBool("isEmissive", false);
-            shader.setFloat("alpha", 1.0f);
-            glDepthMask(GL_TRUE);
-            glDisable(GL_BLEND);
+        // Sparks
+        for (int s = 0; s < 5; s++) {
+            EcsEntity e = addPart(cylinder, glm::mat4(1.0f), glm::vec3(1.0f, 0.95f, 0.7f), BUS_SHOW_JET,
+                                  BUS_ANIM_SPARK);
+            glow(e, 0.9f);
+            EcsAnimation& a = animation(e);
+            a.index = (uint8_t)s;
+            a.position = glm::vec3(nozzleX, 0.5f, 0.0f);
         }
     }
 
     // ==================== HOVER SKIRTS / PADS ====================
-    void drawHoverSkirts(const Shader& shader, glm::mat4 parent) {
-        glm::mat4 model;
-
+    void buildHoverSkirts() {
         float padPositions[4][2] = {
             {-3.5f, -1.3f}, {-3.5f,  1.3f},
             { 3.5f, -1.3f}, { 3.5f,  1.3f}
         };
 
-        float glowPulse = 0.8f + 0.2f * sin(hoverTime * 5.0f);
-        float padBrightness = 0.7f + 0.3f * sin(hoverTime * 3.0f);
-
         for (int i = 0; i < 4; i++) {
             float px = padPositions[i][0];
             float pz = padPositions[i][1];
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(px, -1.1f, pz));
-            model = glm::scale(model, glm::vec3(1.0f, 0.15f, 0.8f));
-            cylinder.draw(shader, model, jetHousingColor);
+            addPart(cylinder, box(glm::vec3(px, -1.1f, pz), glm::vec3(1.0f, 0.15f, 0.8f)), jetHousingColor);
         }
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-        glDepthMask(GL_FALSE);
-        shader.setBool("isEmissive", true);
-
+        // Additive glow under each pad and along the belly, pulsing with hoverTime
         for (int i = 0; i < 4; i++) {
             float px = padPositions[i][0];
             float pz = padPositions[i][1];
 
-            shader.setFloat("alpha", 0.7f);
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(px, -1.25f, pz));
-            model = glm::scale(model, glm::vec3(0.85f * glowPulse, 0.06f, 0.65f * glowPulse));
-            cylinder.draw(shader, model, hoverPadColor * padBrightness);
-
-            shader.setFloat("alpha", 0.5f);
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(px, -1.2f, pz));
-            model = glm::scale(model, glm::vec3(2.0f * glowPulse, 1.5f * glowPulse, 2.0f * glowPulse));
-            torus.draw(shader, model, hoverGlowColor * padBrightness);
-
-            shader.setFloat("alpha", 0.85f);
-            model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(px, -1.3f, pz));
-            model = glm::scale(model, glm::vec3(0.35f, 0.04f, 0.35f));
-            cylinder.draw(shader, model, glm::vec3(0.6f, 0.85f, 1.0f) * glowPulse);
+            pulse(cylinder, glm::vec3(px, -1.25f, pz), glm::vec3(0.85f, 0.06f, 0.65f), glm::vec3(1.0f, 0.0f, 1.0f),
+                  BUS_CHANNEL_GLOW_PULSE, hoverPadColor, BUS_CHANNEL_PAD_BRIGHTNESS, 0.7f);
+            pulse(torus, glm::vec3(px, -1.2f, pz), glm::vec3(2.0f, 1.5f, 2.0f), glm::vec3(1.0f),
+                  BUS_CHANNEL_GLOW_PULSE, hoverGlowColor, BUS_CHANNEL_PAD_BRIGHTNESS, 0.5f);
+            pulse(cylinder, glm::vec3(px, -1.3f, pz), glm::vec3(0.35f, 0.04f, 0.35f), glm::vec3(0.0f),
+                  BUS_CHANNEL_ONE, glm::vec3(0.6f, 0.85f, 1.0f), BUS_CHANNEL_GLOW_PULSE, 0.85f);
         }
 
-        float bellyGlow = 0.6f + 0.15f * sin(hoverTime * 4.0f);
-        shader.setFloat("alpha", 0.4f);
-        model = parent * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.15f, 0.0f));
-        model = glm::scale(model, glm::vec3(8.0f, 0.04f, 1.0f));
-        cube.draw(shader, model, hoverPadColor * bellyGlow);
-
-        shader.setBool("isEmissive", false);
-        shader.setFloat("alpha", 1.0f);
-        glDepthMask(GL_TRUE);
-        glDisable(GL_BLEND);
+        pulse(cube, glm::vec3(0.0f, -1.15f, 0.0f), glm::vec3(8.0f, 0.04f, 1.0f), glm::vec3(0.0f),
+              BUS_CHANNEL_ONE, hoverPadColor, BUS_CHANNEL_BELLY_GLOW, 0.4f);
     }
 
     // ==================== INTERACTIVE METHODS ====================
@@ -616,6 +546,16 @@ public:
         hoverBobOffset = 0.15f * sin(hoverTime * 2.5f);
     }
 
+    // Whether the interior can be seen from eye (world space, under parent):
+    // through an open door or window, or from inside the body
+    bool interiorSeenFrom(const glm::vec3& eye) const {
+        if (frontDoorAngle > 0.0f || middleDoorAngle > 0.0f) return true;
+        for (float amount : windowOpenAmount)
+            if (amount > 0.0f) return true;
+        glm::vec3 p = glm::vec3(glm::inverse(parent) * glm::vec4(eye, 1.0f));
+        return fabs(p.x) <= 5.1f && p.y >= -1.0f && p.y <= 2.3f && fabs(p.z) <= 1.55f;
+    }
+
     void updateWheels(float movementSpeed) {
         // No-op: hover vehicle has no wheels
     }
@@ -625,6 +565,189 @@ public:
         cylinder.cleanup();
         torus.cleanup();
     }
+
+private:
+    // T(at) * S(size): most parts are a placed, scaled unit mesh
+    static glm::mat4 box(const glm::vec3& at, const glm::vec3& size) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), at), size);
+    }
+
+    // As box(), with the mesh's Y axis turned onto X (the jet engine parts)
+    static glm::mat4 sideways(const glm::vec3& at, const glm::vec3& size) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), at);
+        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::scale(model, size);
+    }
+
+    // A part drawn when every show condition holds; kind >= 0 animates it
+    // (fill in animation(e))
+    template <typename Primitive>
+    EcsEntity addPart(const Primitive& shape, const glm::mat4& local, const glm::vec3& color, int show = 0,
+                      int kind = -1) {
+        EcsMask mask = EcsMaskOf<EcsTransform, EcsWorldTransform, EcsMeshRange, EcsMaterial, EcsBusPart>::value;
+        if (kind >= 0) mask |= EcsMaskOf<EcsAnimation>::value;
+        EcsEntity e = world->create(mask);
+        world->get<EcsTransform>(e).local = local;
+        EcsMeshRange& r = world->get<EcsMeshRange>(e);
+        r.mesh = -1;
+        r.vao = shape.VAO;
+        r.vbo = shape.VBO;
+        r.first = 0;
+        r.count = shape.vertexCount;
+        EcsMaterial& m = world->get<EcsMaterial>(e);
+        m.color = color;
+        m.alpha = 1.0f;
+        m.texture = -1;
+        m.blend = RENDER_OPAQUE;
+        world->get<EcsBusPart>(e).show = (unsigned char)show;
+        if (kind >= 0) {
+            EcsAnimation& a = world->get<EcsAnimation>(e);
+            a.kind = (uint8_t)kind;
+            a.channel = a.colorChannel = BUS_CHANNEL_ONE;
+            a.scale = glm::vec3(1.0f);
+            a.color = color;
+        }
+        return e;
+    }
+
+    EcsAnimation& animation(EcsEntity e) { return world->get<EcsAnimation>(e); }
+
+    void texture(EcsEntity e, BusTexture slot, int textureMode) {
+        EcsMaterial& m = world->get<EcsMaterial>(e);
+        m.texture = (int16_t)slot;
+        m.textureMode = (int8_t)textureMode;
+    }
+
+    // Additive and emissive
+    void glow(EcsEntity e, float alpha) {
+        EcsMaterial& m = world->get<EcsMaterial>(e);
+        m.blend = RENDER_ADDITIVE;
+        m.emissive = 1;
+        m.alpha = alpha;
+    }
+
+    // A hover glow: size scaled by channel along axes, color by colorChannel
+    template <typename Primitive>
+    void pulse(const Primitive& shape, const glm::vec3& at, const glm::vec3& size, const glm::vec3& axes,
+               BusChannel channel, const glm::vec3& color, BusChannel colorChannel, float alpha) {
+        EcsEntity e = addPart(shape, glm::mat4(1.0f), color, 0, BUS_ANIM_PULSE);
+        glow(e, alpha);
+        EcsAnimation& a = animation(e);
+        a.channel = (uint8_t)channel;
+        a.colorChannel = (uint8_t)colorChannel;
+        a.position = at;
+        a.scale = size;
+        a.scaleAxes = axes;
+    }
+
+    void fanBlade(EcsEntity e, const glm::vec3& fanBase, int fan) {
+        EcsAnimation& a = animation(e);
+        a.channel = BUS_CHANNEL_FAN;
+        a.position = fanBase;
+        a.phase = fan * 45.0f;
+    }
+
+    // The values animations read this frame
+    void channels(float ch[BUS_CHANNEL_COUNT]) const {
+        ch[BUS_CHANNEL_ONE] = 1.0f;
+        ch[BUS_CHANNEL_FRONT_DOOR] = frontDoorAngle;
+        ch[BUS_CHANNEL_FAN] = fanRotation;
+        ch[BUS_CHANNEL_FLAME_GLOW] = 0.85f + 0.15f * sin(jetFlameFlicker * 25.0f);
+        ch[BUS_CHANNEL_GLOW_PULSE] = 0.8f + 0.2f * sin(hoverTime * 5.0f);
+        ch[BUS_CHANNEL_PAD_BRIGHTNESS] = 0.7f + 0.3f * sin(hoverTime * 3.0f);
+        ch[BUS_CHANNEL_BELLY_GLOW] = 0.6f + 0.15f * sin(hoverTime * 4.0f);
+    }
+
+    // world = parent * T(at) * R_y(angle) * local * S(scale)
+    void animate(const EcsAnimation& a, const glm::mat4& local, const float ch[BUS_CHANNEL_COUNT],
+                 glm::mat4& out, glm::vec3& color) const {
+        glm::vec3 at = a.position, scale = a.scale;
+        float angle = 0.0f;
+        color = a.color * ch[a.colorChannel];
+        float t = jetFlameFlicker;
+        switch (a.kind) {
+        case BUS_ANIM_HINGE:
+            angle = ch[a.channel] + a.phase;
+            break;
+        case BUS_ANIM_WINDOW: {
+            float yOffset = windowOpenAmount[a.index] * 0.4f;
+            at.y -= yOffset;
+            scale.y -= yOffset;
+            break;
+        }
+        case BUS_ANIM_LIGHT:
+            if (!lightOn) color = lightOffColor;
+            break;
+        case BUS_ANIM_PULSE:
+            scale *= glm::mix(glm::vec3(1.0f), glm::vec3(ch[a.channel]), a.scaleAxes);
+            break;
+        case BUS_ANIM_FLAME: {
+            float lengthScale = a.param[0], radiusScale = a.param[1], freqOffset = a.param[2];
+            float baseLen = 3.0f * lengthScale;
+            float turbulence = 0.5f * sin(t * (14.0f + freqOffset))
+                             + 0.25f * sin(t * (21.0f + freqOffset * 0.7f))
+                             + 0.15f * sin(t * (33.0f + freqOffset * 1.3f));
+            float len = baseLen + turbulence * lengthScale;
+            if (len < 0.2f) len = 0.2f;
+
+            float rad = radiusScale * (0.45f + 0.06f * sin(t * (17.0f + freqOffset * 0.5f)));
+            float yOff = 0.03f * sin(t * (9.0f + freqOffset * 0.3f));
+            float zOff = 0.03f * sin(t * (7.0f + freqOffset * 0.6f));
+            at = glm::vec3(a.position.x + len * 0.5f, a.position.y + yOff, zOff);
+            scale = glm::vec3(rad, len, rad);
+            break;
+        }
+        case BUS_ANIM_SPARK: {
+            int s = a.index;
+            float sparkPhase = t * (20.0f + s * 7.3f) + s * 1.7f;
+            at.x = a.position.x + 0.5f + fmod(sparkPhase * 0.8f, 2.5f);
+            at.y = a.position.y + 0.15f * sin(sparkPhase * 3.0f);
+            at.z = 0.12f * sin(sparkPhase * 2.5f + s * 0.9f);
+            scale = glm::vec3(0.04f + 0.02f * sin(sparkPhase * 5.0f));
+            break;
+        }
+        }
+        float c = 1.0f, s = 0.0f;
+        if (angle != 0.0f) {
+            c = cos(glm::radians(angle));
+            s = sin(glm::radians(angle));
+        }
+        glm::mat4 placed(glm::vec4(c, 0.0f, -s, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+                         glm::vec4(s, 0.0f, c, 0.0f), glm::vec4(at, 1.0f));
+        glm::mat4 scaled = local, model;
+        for (int k = 0; k < 3; k++) scaled[k] *= scale[k];
+        mulMat4(placed, scaled, model);
+        mulMat4(parent, model, out);
+    }
+
+    // The show conditions that hold this frame
+    int activeShow() const {
+        return (interiorVisible ? BUS_SHOW_INTERIOR : 0) | (frontDoorAngle > 45.0f ? BUS_SHOW_STEPS : 0)
+             | (jetEngineOn ? BUS_SHOW_JET : 0) | (texBusBody != 0 ? BUS_SHOW_BODY_TEXTURE : 0);
+    }
+
+    // The world transform under parent of every part drawn this frame;
+    // animated parts also their color. Runs in the scene schedule, reading
+    // the state set before it. Hidden parts keep their last pose.
+    static void poseSystem(void* data) {
+        Bus& bus = *(Bus*)data;
+        float ch[BUS_CHANNEL_COUNT];
+        bus.channels(ch);
+        const glm::mat4 parent = bus.parent;
+        const int active = bus.activeShow();
+        bus.world->each<EcsTransform, EcsWorldTransform, EcsBusPart>(
+            [&parent, active](int n, const EcsTransform* local, EcsWorldTransform* xform, const EcsBusPart* part) {
+                for (int i = 0; i < n; i++)
+                    if (!(part[i].show & ~active)) mulMat4(parent, local[i].local, xform[i].world);
+            }, EcsMaskOf<EcsAnimation>::value);
+        bus.world->each<EcsAnimation, EcsTransform, EcsWorldTransform, EcsMaterial, EcsBusPart>(
+            [&bus, &ch, active](int n, const EcsAnimation* anim, const EcsTransform* local, EcsWorldTransform* xform,
+                                EcsMaterial* material, const EcsBusPart* part) {
+                for (int i = 0; i < n; i++)
+                    if (!(part[i].show & ~active))
+                        bus.animate(anim[i], local[i].local, ch, xform[i].world, material[i].color);
+            });
+    }
 };
 
 #endif
@@ -0,0 +1,92 @@
+#ifndef CAMERA_BLOCK_H
+#define CAMERA_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstring>
+#include <iostream>
+#include "GpuRegistry.h"
+
+// ============================================================================
+// CAMERA BLOCK - view and projection in a uniform buffer, latched late
+// ============================================================================
+// shader.vert and shader.frag read view, projection and the eye position
+// from the std140 block "Camera" at binding point CAMERA_BLOCK_BINDING
+// instead of plain uniforms, so the camera can be replaced without touching
+// any program's uniform state.
+//
+// The block is written once per frame, by latch(), right before the render
+// queue's submit(). Everything recorded earlier in the frame (culling, sort
+// keys, instance lists) used the snapshot's camera; the view the draws are
+// actually issued with is the one passed to latch(), which the app rebuilds
+// from the freshest mouse look it has. All draws are deferred to submit(),
+// so none of them can see an older block. Culling is not redone: a view
+// turned by a frame's worth of mouse motion can leave a sliver at the
+// screen edge with parts culled against the earlier one.
+//
+// A latch() that changes the block respecifies the whole (small) buffer, so
+// the driver can hand out fresh storage instead of waiting for last frame's
+// draws to finish reading the old contents; one that does not is skipped.
+// ============================================================================
+
+const GLuint CAMERA_BLOCK_BINDING = 0;
+
+// std140 layout of the "Camera" block
+struct CameraBlockData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 eyePos;           // xyz: viewPos
+};
+
+class CameraBlock {
+public:
+    unsigned int buffer = 0;
+    int latches = 0;            // latch() calls so far
+    int uploads = 0;            // of those, the ones that changed the block
+
+    void init() {
+        buffer = gpuRegistry().genBuffer("camera block");
+        // glBindBufferBase binds the generic GL_UNIFORM_BUFFER target as well;
+        // nothing else uses that target, so latch() writes without rebinding
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlockData), NULL, GL_STREAM_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, buffer, sizeof(CameraBlockData));
+    }
+
+    // Points a program's "Camera" block at the binding (GLSL 330 has no
+    // layout(binding = ...) for blocks)
+    void attach(unsigned int program) {
+        GLuint index = glGetUniformBlockIndex(program, "Camera");
+        if (index == GL_INVALID_INDEX) {
+            std::cout << "Camera block: program " << program << " has no \"Camera\" block" << std::endl;
+            return;
+        }
+        glUniformBlockBinding(program, index, CAMERA_BLOCK_BINDING);
+    }
+
+    void latch(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos) {
+        CameraBlockData data;
+        data.view = view;
+        data.projection = projection;
+        data.eyePos = glm::vec4(viewPos, 1.0f);
+        latches++;
+        // Like the shader's redundant-uniform filter: a still camera costs nothing
+        if (valid && std::memcmp(&data, &last, sizeof(data)) == 0) return;
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(data), &data, GL_STREAM_DRAW);
+        last = data;
+        valid = true;
+        uploads++;
+    }
+
+    void cleanup() {
+        gpuRegistry().deleteBuffer(buffer);
+        valid = false;
+    }
+
+private:
+    CameraBlockData last;       // contents of the buffer, once valid
+    bool valid = false;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef CAMERA_MATH_H
+#define CAMERA_MATH_H
+
+#include <glm/glm.hpp>
+
+// ============================================================================
+// CUSTOM lookAt
+// ============================================================================
+// Right-handed view matrix, same result as glm::lookAt. Kept in a header so
+// tools/glm_bench.cpp can time and cross-check it.
+inline glm::mat4 myLookAt(glm::vec3 eye, glm::vec3 center, glm::vec3 up) {
+    glm::vec3 f = glm::normalize(center - eye);
+    glm::vec3 s = glm::normalize(glm::cross(f, up));
+    glm::vec3 u = glm::cross(s, f);
+    glm::mat4 result(1.0f);
+    result[0][0] = s.x;   result[1][0] = s.y;   result[2][0] = s.z;
+    result[0][1] = u.x;   result[1][1] = u.y;   result[2][1] = u.z;
+    result[0][2] = -f.x;  result[1][2] = -f.y;  result[2][2] = -f.z;
+    result[3][0] = -glm::dot(s, eye);
+    result[3][1] = -glm::dot(u, eye);
+    result[3][2] =  glm::dot(f, eye);
+    return result;
+}
+
+// ============================================================================
+// MATRIX PRODUCT
+// ============================================================================
+// out = a * b over plain floats, written out so the per-part loops (Bus pose,
+// SoftRaster draw setup) do not depend on glm's operator* being inlined; out
+// may alias neither input.
+inline void mulMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+    const float* A = &a[0][0];
+    const float* B = &b[0][0];
+    float* O = &out[0][0];
+    for (int c = 0; c < 4; c++) {
+        float b0 = B[c * 4], b1 = B[c * 4 + 1], b2 = B[c * 4 + 2], b3 = B[c * 4 + 3];
+        for (int r = 0; r < 4; r++)
+            O[c * 4 + r] = A[r] * b0 + A[4 + r] * b1 + A[8 + r] * b2 + A[12 + r] * b3;
+    }
+}
+
+// ============================================================================
+// VIEW FRUSTUM
+// ============================================================================
+// The six clip planes of projection * view (Gribb & Hartmann), normalized,
+// normals pointing inwards. Used to cull bounding spheres before drawing.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    void extract(const glm::mat4& m) {
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        planes[0] = row3 + row0;    // left
+        planes[1] = row3 - row0;    // right
+        planes[2] = row3 + row1;    // bottom
+        planes[3] = row3 - row1;    // top
+        planes[4] = row3 + row2;    // near
+        planes[5] = row3 - row2;    // far
+        for (int i = 0; i < 6; i++) planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+
+    // False only when the sphere is entirely outside one plane
+    bool sphereVisible(const glm::vec3& center, float radius) const {
+        for (int i = 0; i < 6; i++) {
+            if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) return false;
+        }
+        return true;
+    }
+};
+
+#endif
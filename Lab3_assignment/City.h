@@ -0,0 +1,445 @@
+#ifndef CITY_H
+#define CITY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "CameraMath.h"
+#include "Ecs.h"
+#include "FrameArena.h"
+#include "InstanceBatch.h"
+#include "JobSystem.h"
+
+// ============================================================================
+// CITY - road, grass and buildings as ECS entities, updated on the job system
+// ============================================================================
+// Every part (one cube, cylinder or cone) is an entity of the scene world
+// (Ecs.h) with its local transform, an origin, world transform, bounds,
+// mesh, material and a visibility flag. Parts are built per node (a road
+// segment, a building block): addNode() records where the node stands and
+// the node's parts take its position as their origin. Road segment parts
+// also carry their segment offset, which puts them in an archetype of their
+// own, created first, so entity order is the old part order: road first,
+// then buildings in the order they were added.
+//
+// The city's systems (addSystems) run in the scene schedule between
+// beginUpdate() and endUpdate():
+//   road follow    road origins snap to the segment under the bus
+//   transforms     world = origin * local, and a bounding sphere
+//   culling        sphere against the view frustum; counts visible parts
+//                  per chunk and mesh
+// The transform and culling systems walk the parts in fixed-size chunks of
+// contiguous rows on the job system; endUpdate() then writes the visible
+// parts into each mesh's instance array at offsets from a prefix sum over
+// the chunk counts. Each chunk writes its own slice, so the instance order
+// is the entity order whatever the thread count, and nothing is locked. The
+// chunk counts and the instance lists are taken from the frame arena on the
+// render thread. update() runs the three systems alone, for the job bench.
+//
+// generateBlocks() adds a grid of procedural blocks off the road for
+// stress runs (--city-blocks, --job-bench).
+// ============================================================================
+
+const float ROAD_WIDTH = 8.0f;
+const float ROAD_SEGMENT_LEN = 20.0f;
+const int   VISIBLE_SEGMENTS = 30;        // segments ahead + behind
+const float GRASS_WIDTH = 50.0f;
+const float BUILDING_ZONE_START = 6.0f;   // distance from road center
+const float BUILDING_ZONE_END = 40.0f;
+const int   BUILDINGS_PER_SEGMENT = 6;    // buildings per side per segment
+
+const float CITY_BLOCK_SIZE = 30.0f;      // generated block pitch
+const int   CITY_BLOCK_COLUMNS = 8;       // generated blocks per row, half each side
+const int   CITY_MIN_CHUNK = 256;         // parts per job
+const int   CITY_MAX_CHUNKS = 1024;       // larger cities get larger chunks
+
+// Simple deterministic hash for building placement
+inline unsigned int cityHash(int x, int y) {
+    unsigned int h = (unsigned int)x * 374761393u + (unsigned int)y * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177;
+    return h ^ (h >> 16);
+}
+
+inline float cityRand(int seed, int id) {
+    return (float)(cityHash(seed, id) % 10000) / 10000.0f;
+}
+
+// Pre-defined bright color palette for buildings
+const glm::vec3 buildingPalette[] = {
+    glm::vec3(0.85f, 0.2f, 0.2f),   // Red
+    glm::vec3(0.2f, 0.65f, 0.9f),   // Blue
+    glm::vec3(0.2f, 0.8f, 0.3f),    // Green
+    glm::vec3(0.9f, 0.85f, 0.1f),   // Yellow
+    glm::vec3(0.7f, 0.3f, 0.85f),   // Purple
+    glm::vec3(0.95f, 0.55f, 0.1f),  // Orange
+    glm::vec3(0.1f, 0.85f, 0.75f),  // Cyan
+    glm::vec3(0.85f, 0.15f, 0.55f), // Pink
+    glm::vec3(0.5f, 0.5f, 0.85f),   // Periwinkle
+    glm::vec3(0.3f, 0.75f, 0.5f),   // Teal
+};
+const int NUM_PALETTE_COLORS = 10;
+
+enum CityMesh { CITY_CUBE = 0, CITY_CYLINDER, CITY_CONE, CITY_MESH_COUNT };
+
+// Texture-array materials; the app maps them to layers each frame
+enum CityMaterial {
+    CITY_UNTEXTURED = -1,
+    CITY_ROAD = 0, CITY_GRASS, CITY_CONTAINER, CITY_WALL,
+    CITY_MATERIAL_COUNT
+};
+
+// Bounding radius of each unit mesh: cube [-0.5, 0.5]^3, cylinder and
+// cone radius 1 over y in [-0.5, 0.5]
+const float cityMeshRadius[CITY_MESH_COUNT] = { 0.8660254f, 1.1180340f, 1.1180340f };
+
+const int CITY_FIXED_NODE = 1 << 30;      // roadSegment of a node that does not move
+
+// Placement of a node's parts; build time only
+struct CityNode {
+    glm::vec3 position;
+    int roadSegment;                      // segment offset from the bus, or CITY_FIXED_NODE
+};
+
+// world = origin * local, and the bounding sphere of mesh under it. Origins
+// are pure translations, so the offset is added to column 3 of local instead
+// of taking a product.
+inline void cityPartTransform(const glm::mat4& local, const glm::vec3& at, int mesh, glm::mat4& m,
+                              glm::vec4& bounds) {
+    m = local;
+    m[3].x += at.x * m[3].w;
+    m[3].y += at.y * m[3].w;
+    m[3].z += at.z * m[3].w;
+    float s0 = m[0].x * m[0].x + m[0].y * m[0].y + m[0].z * m[0].z;
+    float s1 = m[1].x * m[1].x + m[1].y * m[1].y + m[1].z * m[1].z;
+    float s2 = m[2].x * m[2].x + m[2].y * m[2].y + m[2].z * m[2].z;
+    float radius = std::sqrt(std::max(s0, std::max(s1, s2))) * cityMeshRadius[mesh];
+    bounds = glm::vec4(m[3].x, m[3].y, m[3].z, radius);
+}
+
+const EcsMask CITY_PART_COMPONENTS = EcsMaskOf<EcsTransform, EcsOrigin, EcsWorldTransform, EcsBounds,
+                                               EcsMeshRange, EcsMaterial, EcsCityPart>::value;
+
+struct CityStats {
+    int parts = 0;
+    int visible = 0;
+    int chunks = 0;
+    int meshVisible[CITY_MESH_COUNT] = { 0, 0, 0 };
+    double updateMs = 0.0;
+};
+
+class City {
+public:
+    std::vector<CityNode> nodes;
+    EcsWorld* world = nullptr;
+    bool culling = true;
+    CityStats lastStats;
+
+    // Parts are created in world, which must outlive the city
+    void init(EcsWorld& sceneWorld) {
+        world = &sceneWorld;
+        parts.include = EcsMaskOf<EcsCityPart>::value;
+        roadParts.include = EcsMaskOf<EcsCityPart, EcsRoadSegment>::value;
+        parts.chunks.reserve(CITY_MAX_CHUNKS + 16);
+    }
+
+    int partCount() const { return world->count(parts.include); }
+
+    int addNode(const glm::vec3& position, int roadSegment = CITY_FIXED_NODE) {
+        CityNode n = { position, roadSegment };
+        nodes.push_back(n);
+        return (int)nodes.size() - 1;
+    }
+
+    void addPart(int node, const glm::mat4& local, const glm::vec3& color, CityMesh mesh,
+                 int material, int textureMode) {
+        const CityNode& n = nodes[node];
+        bool road = n.roadSegment != CITY_FIXED_NODE;
+        EcsEntity e = world->create(CITY_PART_COMPONENTS | (road ? EcsMaskOf<EcsRoadSegment>::value : 0));
+        world->get<EcsTransform>(e).local = local;
+        world->get<EcsOrigin>(e).position = n.position;
+        if (road) world->get<EcsRoadSegment>(e).offset = n.roadSegment;
+        world->get<EcsMeshRange>(e).mesh = mesh;
+        EcsMaterial& m = world->get<EcsMaterial>(e);
+        m.color = color;
+        m.alpha = 1.0f;
+        m.texture = (int16_t)material;
+        m.textureMode = (int8_t)textureMode;
+    }
+
+    // The road runs along the X-axis; VISIBLE_SEGMENTS + 1 segments around
+    // the bus, each with road, dashed divider and a grass strip per side
+    void addRoad() {
+        for (int seg = -VISIBLE_SEGMENTS / 2; seg <= VISIBLE_SEGMENTS / 2; seg++) {
+            int node = addNode(glm::vec3(0.0f), seg);
+
+            // --- ROAD SEGMENT ---
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ROAD_SEGMENT_LEN * 0.5f, -0.05f, 0.0f));
+            model = glm::scale(model, glm::vec3(ROAD_SEGMENT_LEN, 0.1f, ROAD_WIDTH));
+            addPart(node, model, glm::vec3(0.08f, 0.08f, 0.08f), CITY_CUBE, CITY_ROAD, 1);
+
+            // --- WHITE DASHED CENTER DIVIDER ---
+            int numDashes = 4;
+            float dashLen = ROAD_SEGMENT_LEN / (numDashes * 2.0f);
+            for (int d = 0; d < numDashes; d++) {
+                float dx = d * (dashLen * 2.0f) + dashLen * 0.5f;
+                model = glm::translate(glm::mat4(1.0f), glm::vec3(dx, 0.01f, 0.0f));
+                model = glm::scale(model, glm::vec3(dashLen * 0.8f, 0.02f, 0.15f));
+                addPart(node, model, glm::vec3(1.0f, 1.0f, 1.0f), CITY_CUBE, CITY_UNTEXTURED, 0);
+            }
+
+            // --- GRASS STRIPS (both sides) ---
+            for (int side = -1; side <= 1; side += 2) {
+                float grassZ = side * (ROAD_WIDTH * 0.5f + GRASS_WIDTH * 0.5f);
+                model = glm::translate(glm::mat4(1.0f), glm::vec3(ROAD_SEGMENT_LEN * 0.5f, -0.1f, grassZ));
+                model = glm::scale(model, glm::vec3(ROAD_SEGMENT_LEN, 0.1f, GRASS_WIDTH));
+                addPart(node, model, glm::vec3(0.15f, 0.45f, 0.1f), CITY_CUBE, CITY_GRASS, 3);
+            }
+        }
+    }
+
+    // The hand-placed buildings along the start of the road; each type
+    // appears twice. Parts are relative to the building's ground center.
+    void addLandmarks() {
+        // --- STACKED CUBES #1 (left side, near start) ---
+        {
+            int node = addNode(glm::vec3(-15.0f, 0.0f, -10.0f));
+            glm::vec3 colors[] = {
+                glm::vec3(0.85f, 0.2f, 0.2f),
+                glm::vec3(0.2f, 0.65f, 0.9f),
+                glm::vec3(0.9f, 0.85f, 0.1f)
+            };
+            float sizes[][3] = { {3.0f, 3.0f, 3.0f}, {2.5f, 2.5f, 2.5f}, {2.0f, 2.0f, 2.0f} };
+            addStack(node, sizes, colors, 3);
+        }
+
+        // --- STACKED CUBES #2 (right side, further along) ---
+        {
+            int node = addNode(glm::vec3(-50.0f, 0.0f, 12.0f));
+            glm::vec3 colors[] = {
+                glm::vec3(0.95f, 0.55f, 0.1f),
+                glm::vec3(0.7f, 0.3f, 0.85f)
+            };
+            float sizes[][3] = { {3.5f, 4.0f, 3.5f}, {2.5f, 3.0f, 2.5f} };
+            addStack(node, sizes, colors, 2);
+        }
+
+        // --- TALL BUILDINGS WITH WINDOWS on the road-facing side ---
+        addTower(addNode(glm::vec3(-25.0f, 0.0f, 10.0f)), glm::vec3(4.0f, 12.0f, 4.0f),
+                 glm::vec3(0.7f, 0.3f, 0.85f), 5, 2.0f, 1.8f, glm::vec2(0.8f, 1.0f), -1.0f);
+        addTower(addNode(glm::vec3(-60.0f, 0.0f, -11.0f)), glm::vec3(5.0f, 15.0f, 5.0f),
+                 glm::vec3(0.2f, 0.65f, 0.9f), 6, 2.4f, 2.0f, glm::vec2(0.9f, 1.1f), 1.0f);
+
+        // --- CONE-TOPPED TOWERS ---
+        addConeTower(addNode(glm::vec3(-40.0f, 0.0f, -12.0f)), 2.0f, 8.0f, 3.0f,
+                     glm::vec3(0.1f, 0.85f, 0.75f), glm::vec3(0.95f, 0.55f, 0.1f));
+        addConeTower(addNode(glm::vec3(-75.0f, 0.0f, 13.0f)), 1.5f, 6.0f, 2.5f,
+                     glm::vec3(0.85f, 0.15f, 0.55f), glm::vec3(0.2f, 0.8f, 0.3f));
+    }
+
+    // Rows of CITY_BLOCK_COLUMNS blocks beyond the building zone, half on
+    // each side of the road, running down -X; 1-4 random buildings a block
+    void generateBlocks(int blocks) {
+        for (int b = 0; b < blocks; b++) {
+            int row = b / CITY_BLOCK_COLUMNS, column = b % CITY_BLOCK_COLUMNS;
+            float side = (column & 1) ? 1.0f : -1.0f;
+            float z = side * (BUILDING_ZONE_END + CITY_BLOCK_SIZE * (0.5f + column / 2));
+            int node = addNode(glm::vec3(-row * CITY_BLOCK_SIZE, 0.0f, z));
+            int buildings = 1 + (int)(cityHash(b, 0) % 4);
+            for (int k = 0; k < buildings; k++) {
+                int id = b * 4 + k;
+                glm::vec3 color = buildingPalette[cityHash(id, 1) % NUM_PALETTE_COLORS];
+                float w = 4.0f + cityRand(id, 2) * 4.0f, h = 6.0f + cityRand(id, 3) * 24.0f;
+                glm::vec3 at((k & 1) ? 7.0f : -7.0f, 0.0f, (k & 2) ? 7.0f : -7.0f);
+                if (cityHash(id, 4) % 5 == 0) {
+                    addConeTower(node, w * 0.4f, h * 0.6f, w * 0.5f, color,
+                                 buildingPalette[cityHash(id, 5) % NUM_PALETTE_COLORS], at);
+                } else {
+                    int rows = std::max(1, (int)(h / 2.0f) - 1);
+                    addTower(node, glm::vec3(w, h, w), color, rows, w * 0.6f, 1.8f,
+                             glm::vec2(w * 0.2f, 1.0f), -side, at);
+                }
+            }
+        }
+    }
+
+    // Road follow, transforms and culling, in that order
+    void addSystems(EcsSchedule& schedule) {
+        EcsMask part = EcsMaskOf<EcsCityPart>::value;
+        schedule.add("city road follow", roadParts.include, 0, EcsMaskOf<EcsRoadSegment>::value,
+                     EcsMaskOf<EcsOrigin>::value, &City::roadSystem, this);
+        schedule.add("city transforms", part, 0, EcsMaskOf<EcsTransform, EcsOrigin, EcsMeshRange>::value,
+                     EcsMaskOf<EcsWorldTransform, EcsBounds>::value, &City::transformSystem, this);
+        schedule.add("city culling", part, 0, EcsMaskOf<EcsBounds, EcsMeshRange>::value,
+                     EcsMaskOf<EcsCityPart>::value, &City::cullSystem, this);
+    }
+
+    // Before the systems run: this frame's inputs, chunks and arena arrays.
+    // layers maps CityMaterial to a texture array layer (< 0 while not
+    // loaded).
+    void beginUpdate(JobSystem& jobSystem, float busX, const glm::mat4& viewProj,
+                     const float layers[CITY_MATERIAL_COUNT]) {
+        t0 = std::chrono::steady_clock::now();
+        jobs = &jobSystem;
+        int count = partCount();
+        chunkSize = std::max(CITY_MIN_CHUNK, (count + CITY_MAX_CHUNKS - 1) / CITY_MAX_CHUNKS);
+        lastStats.parts = parts.split(*world, chunkSize);
+        chunkCounts = frameArena().allocArray<int>(parts.chunks.size() * CITY_MESH_COUNT);
+
+        // Road segments snap to the segment boundary under the bus
+        segStart = floor(busX / ROAD_SEGMENT_LEN) * ROAD_SEGMENT_LEN;
+        frustum.extract(viewProj);
+        for (int i = 0; i < CITY_MATERIAL_COUNT; i++) materialLayer[i] = layers[i];
+    }
+
+    // After the systems: out[mesh] receives the visible instances,
+    // replacing what it held
+    void endUpdate(FrameVector<InstanceData>* out[CITY_MESH_COUNT]) {
+        // Prefix sum: where each chunk's instances of each mesh start
+        int chunks = (int)parts.chunks.size();
+        int totals[CITY_MESH_COUNT] = { 0, 0, 0 };
+        for (int c = 0; c < chunks; c++) {
+            for (int m = 0; m < CITY_MESH_COUNT; m++) {
+                int n = chunkCounts[c * CITY_MESH_COUNT + m];
+                chunkCounts[c * CITY_MESH_COUNT + m] = totals[m];
+                totals[m] += n;
+            }
+        }
+        InstanceData* dst[CITY_MESH_COUNT];
+        for (int m = 0; m < CITY_MESH_COUNT; m++) {
+            frameReset(*out[m], totals[m]);
+            out[m]->resize(totals[m]);
+            dst[m] = out[m]->data();
+        }
+
+        parts.run<EcsWorldTransform, EcsMeshRange, EcsMaterial, EcsCityPart>(*jobs,
+            [this, &dst](int c, int n, const EcsWorldTransform* xform, const EcsMeshRange* mesh,
+                         const EcsMaterial* material, const EcsCityPart* part) {
+                writeChunk(c, n, xform, mesh, material, part, dst);
+            });
+
+        lastStats.chunks = chunks;
+        lastStats.visible = 0;
+        for (int m = 0; m < CITY_MESH_COUNT; m++) {
+            lastStats.meshVisible[m] = totals[m];
+            lastStats.visible += totals[m];
+        }
+        lastStats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    // The city's systems on their own (no schedule)
+    void update(JobSystem& jobSystem, float busX, const glm::mat4& viewProj,
+                const float layers[CITY_MATERIAL_COUNT], FrameVector<InstanceData>* out[CITY_MESH_COUNT]) {
+        beginUpdate(jobSystem, busX, viewProj, layers);
+        roadSystem(this);
+        transformSystem(this);
+        cullSystem(this);
+        endUpdate(out);
+    }
+
+private:
+    EcsQuery parts, roadParts;
+    JobSystem* jobs = nullptr;
+    std::chrono::steady_clock::time_point t0;
+    float segStart = 0.0f;
+    int* chunkCounts = nullptr;             // [chunk][mesh] counts, then offsets (frame arena)
+    int chunkSize = CITY_MIN_CHUNK;
+    Frustum frustum;
+    float materialLayer[CITY_MATERIAL_COUNT];
+
+    void addStack(int node, float sizes[][3], const glm::vec3* colors, int count) {
+        float yOff = 0.0f;
+        for (int c = 0; c < count; c++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, yOff + sizes[c][1] * 0.5f, 0.0f));
+            model = glm::scale(model, glm::vec3(sizes[c][0], sizes[c][1], sizes[c][2]));
+            addPart(node, model, colors[c], CITY_CUBE, CITY_CONTAINER, 1);
+            yOff += sizes[c][1];
+        }
+    }
+
+    // Box with two columns of windows on the face towards facing (-1 = -Z)
+    void addTower(int node, const glm::vec3& size, const glm::vec3& color, int rows, float columnGap,
+                  float firstRow, const glm::vec2& window, float facing,
+                  const glm::vec3& at = glm::vec3(0.0f)) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), at + glm::vec3(0.0f, size.y * 0.5f, 0.0f));
+        model = glm::scale(model, size);
+        addPart(node, model, color, CITY_CUBE, CITY_WALL, 3);
+        for (int wr = 0; wr < rows; wr++) {
+            for (int wc = 0; wc < 2; wc++) {
+                glm::vec3 p = at + glm::vec3(-columnGap * 0.5f + wc * columnGap, firstRow + wr * 2.0f,
+                                             facing * size.z * 0.52f);
+                glm::mat4 wModel = glm::translate(glm::mat4(1.0f), p);
+                wModel = glm::scale(wModel, glm::vec3(window.x, window.y, 0.05f));
+                addPart(node, wModel, glm::vec3(0.05f, 0.08f, 0.15f), CITY_CUBE, CITY_UNTEXTURED, 0);
+            }
+        }
+    }
+
+    // Cylinder from 0 to towerH with a cone roof on top (no overlap)
+    void addConeTower(int node, float radius, float towerH, float coneH, const glm::vec3& bodyColor,
+                      const glm::vec3& roofColor, const glm::vec3& at = glm::vec3(0.0f)) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), at + glm::vec3(0.0f, towerH * 0.5f, 0.0f));
+        model = glm::scale(model, glm::vec3(radius * 2.0f, towerH, radius * 2.0f));
+        addPart(node, model, bodyColor, CITY_CYLINDER, CITY_CONTAINER, 3);
+        model = glm::translate(glm::mat4(1.0f), at + glm::vec3(0.0f, towerH + coneH * 0.5f, 0.0f));
+        model = glm::scale(model, glm::vec3(radius * 2.8f, coneH, radius * 2.8f));
+        addPart(node, model, roofColor, CITY_CONE, CITY_UNTEXTURED, 0);
+    }
+
+    static void roadSystem(void* data) {
+        City& city = *(City*)data;
+        float segStart = city.segStart;
+        city.world->each<EcsOrigin, EcsRoadSegment>([segStart](int n, EcsOrigin* origin, const EcsRoadSegment* road) {
+            for (int i = 0; i < n; i++) origin[i].position.x = segStart + road[i].offset * ROAD_SEGMENT_LEN;
+        });
+    }
+
+    static void transformSystem(void* data) {
+        City& city = *(City*)data;
+        city.parts.run<EcsTransform, EcsOrigin, EcsMeshRange, EcsWorldTransform, EcsBounds>(*city.jobs,
+            [](int, int n, const EcsTransform* local, const EcsOrigin* origin, const EcsMeshRange* mesh,
+               EcsWorldTransform* xform, EcsBounds* bounds) {
+                for (int i = 0; i < n; i++)
+                    cityPartTransform(local[i].local, origin[i].position, mesh[i].mesh, xform[i].world, bounds[i].sphere);
+            });
+    }
+
+    static void cullSystem(void* data) {
+        City& city = *(City*)data;
+        city.parts.run<EcsBounds, EcsMeshRange, EcsCityPart>(*city.jobs,
+            [&city](int c, int n, const EcsBounds* bounds, const EcsMeshRange* mesh, EcsCityPart* part) {
+                int counts[CITY_MESH_COUNT] = { 0, 0, 0 };
+                for (int i = 0; i < n; i++) {
+                    const glm::vec4& s = bounds[i].sphere;
+                    bool in = !city.culling || city.frustum.sphereVisible(glm::vec3(s), s.w);
+                    part[i].visible = in;
+                    counts[mesh[i].mesh] += in;
+                }
+                int* chunk = &city.chunkCounts[c * CITY_MESH_COUNT];
+                for (int m = 0; m < CITY_MESH_COUNT; m++) chunk[m] = counts[m];
+            });
+    }
+
+    // Visible parts of chunk c into the instance arrays
+    void writeChunk(int c, int n, const EcsWorldTransform* xform, const EcsMeshRange* mesh,
+                    const EcsMaterial* material, const EcsCityPart* part,
+                    InstanceData* const dst[CITY_MESH_COUNT]) const {
+        int offset[CITY_MESH_COUNT];
+        for (int m = 0; m < CITY_MESH_COUNT; m++) offset[m] = chunkCounts[c * CITY_MESH_COUNT + m];
+        for (int i = 0; i < n; i++) {
+            if (!part[i].visible) continue;
+            const EcsMaterial& p = material[i];
+            int k = mesh[i].mesh;
+            // Untextured when the layer is not available yet
+            float layer = p.texture >= 0 ? materialLayer[p.texture] : -1.0f;
+            InstanceData& d = dst[k][offset[k]++];
+            d.model = xform[i].world;
+            d.color = p.color;
+            d.material = glm::vec2(layer, layer >= 0.0f ? (float)p.textureMode : 0.0f);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,442 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "JobSystem.h"
+#include "Profiler.h"
+
+// ============================================================================
+// ECS - archetype entity / component storage for scene objects
+// ============================================================================
+// An entity is a handle (index + generation) to one row of an archetype:
+// the table of every entity with exactly the same set of components (its
+// mask). An archetype keeps one column per component, a plain array of that
+// component, so a system that reads bounds walks 16-byte records back to
+// back instead of striding over whole objects. Rows are packed: destroy()
+// moves the last row into the hole.
+//
+// Components are plain structs with a fixed EcsComponentType; their sizes
+// are all the storage knows about them (columns are byte arrays, rows are
+// moved with memcpy). Archetypes never go away, so their order - the order
+// masks were first created in - and the row order inside them are stable:
+// queries visit entities in creation order per archetype.
+//
+//   each<C...>(fn)       fn(n, C* ...) once per non-empty archetype that has
+//                        all of C, on the calling thread
+//   EcsQuery             the matching rows cut into chunks of at most a given
+//                        size; run<C...>(jobs, fn) calls fn(chunk, n, C* ...)
+//                        for every chunk on the job system
+//   EcsSchedule          systems with the components they read and write,
+//                        run in order; consecutive systems whose queries share
+//                        no archetype, or only read what they share, form a
+//                        stage and run as concurrent jobs
+//
+// Creating and destroying entities is for the thread that owns the world,
+// outside run(). After the scene is built nothing here allocates: queries
+// and schedules reuse their arrays.
+// ============================================================================
+
+enum EcsComponentType {
+    ECS_TRANSFORM = 0,
+    ECS_ORIGIN,
+    ECS_ROAD_SEGMENT,
+    ECS_WORLD_TRANSFORM,
+    ECS_BOUNDS,
+    ECS_MESH_RANGE,
+    ECS_MATERIAL,
+    ECS_ANIMATION,
+    ECS_CITY_PART,
+    ECS_BUS_PART,
+    ECS_COMPONENT_COUNT
+};
+
+typedef uint32_t EcsMask;                 // one bit per EcsComponentType
+typedef uint32_t EcsEntity;               // [31:24] generation, [23:0] index
+
+const EcsEntity ECS_NULL = 0xFFFFFFFFu;
+const int ECS_MAX_ENTITIES = 1 << 24;
+const int ECS_MIN_ROWS = 64;              // first allocation of an archetype
+const int ECS_MAX_SYSTEMS = 32;
+
+// Placement relative to the origin (or the parent the owner supplies)
+struct EcsTransform {
+    glm::mat4 local;
+};
+
+// A pure translation applied to the local transform (the city's nodes)
+struct EcsOrigin {
+    glm::vec3 position;
+};
+
+// Road segment offset from the segment under the bus
+struct EcsRoadSegment {
+    int offset;
+};
+
+struct EcsWorldTransform {
+    glm::mat4 world;
+};
+
+struct EcsBounds {
+    glm::vec4 sphere;                     // xyz center, w radius
+};
+
+// What to draw: an instanced city mesh, or a vertex range of its own
+struct EcsMeshRange {
+    int mesh;                             // CityMesh, or -1 for a direct draw
+    unsigned int vao, vbo;
+    int first, count;
+};
+
+struct EcsMaterial {
+    glm::vec3 color;
+    float alpha;
+    int16_t texture;                      // owner's texture slot, -1 = none
+    int8_t textureMode;
+    uint8_t blend;                        // RenderBlend
+    uint8_t emissive;
+};
+
+// Procedural motion; kind and channels are interpreted by the system of the
+// entity's owner (Bus.h). world = parent * T(translation) * R_y(angle) *
+// local * S(scale), where the kind decides translation, angle and scale.
+struct EcsAnimation {
+    uint8_t kind;
+    uint8_t channel;                      // drives the angle or the scale
+    uint8_t colorChannel;                 // scales the color
+    uint8_t index;
+    glm::vec3 position;
+    glm::vec3 scale;
+    glm::vec3 scaleAxes;                  // 1 where channel scales the scale
+    glm::vec3 color;
+    float phase;
+    float param[3];
+};
+
+struct EcsCityPart {
+    unsigned char visible;                // culling result this frame
+};
+
+struct EcsBusPart {
+    unsigned char show;                   // conditions that must hold to draw it
+};
+
+template <typename T> struct EcsComponentId;
+template <> struct EcsComponentId<EcsTransform>      { static const int value = ECS_TRANSFORM; };
+template <> struct EcsComponentId<EcsOrigin>         { static const int value = ECS_ORIGIN; };
+template <> struct EcsComponentId<EcsRoadSegment>    { static const int value = ECS_ROAD_SEGMENT; };
+template <> struct EcsComponentId<EcsWorldTransform> { static const int value = ECS_WORLD_TRANSFORM; };
+template <> struct EcsComponentId<EcsBounds>         { static const int value = ECS_BOUNDS; };
+template <> struct EcsComponentId<EcsMeshRange>      { static const int value = ECS_MESH_RANGE; };
+template <> struct EcsComponentId<EcsMaterial>       { static const int value = ECS_MATERIAL; };
+template <> struct EcsComponentId<EcsAnimation>      { static const int value = ECS_ANIMATION; };
+template <> struct EcsComponentId<EcsCityPart>       { static const int value = ECS_CITY_PART; };
+template <> struct EcsComponentId<EcsBusPart>        { static const int value = ECS_BUS_PART; };
+
+const size_t ecsComponentSize[ECS_COMPONENT_COUNT] = {
+    sizeof(EcsTransform), sizeof(EcsOrigin), sizeof(EcsRoadSegment), sizeof(EcsWorldTransform),
+    sizeof(EcsBounds), sizeof(EcsMeshRange), sizeof(EcsMaterial), sizeof(EcsAnimation),
+    sizeof(EcsCityPart), sizeof(EcsBusPart)
+};
+
+template <typename... C> struct EcsMaskOf;
+template <> struct EcsMaskOf<> {
+    static const EcsMask value = 0;
+};
+template <typename T, typename... R> struct EcsMaskOf<T, R...> {
+    static const EcsMask value = (1u << EcsComponentId<T>::value) | EcsMaskOf<R...>::value;
+};
+
+// ----------------------------------------------------------------------------
+// Archetype: the entities with one mask, one column per component in it
+// ----------------------------------------------------------------------------
+struct EcsArchetype {
+    EcsMask mask = 0;
+    int count = 0, capacity = 0;
+    std::vector<EcsEntity> entities;                        // per row
+    std::vector<unsigned char> columns[ECS_COMPONENT_COUNT];   // empty unless in mask
+
+    bool matches(EcsMask include, EcsMask exclude) const {
+        return (mask & include) == include && (mask & exclude) == 0;
+    }
+
+    template <typename T>
+    T* column() { return (T*)columns[EcsComponentId<T>::value].data(); }
+
+    void reserve(int rows) {
+        if (rows <= capacity) return;
+        capacity = rows;
+        entities.resize(rows);
+        for (int c = 0; c < ECS_COMPONENT_COUNT; c++)
+            if (mask & (1u << c)) columns[c].resize(rows * ecsComponentSize[c]);
+    }
+};
+
+class EcsWorld {
+public:
+    std::vector<std::unique_ptr<EcsArchetype> > archetypes;   // creation order
+
+    // A new entity with every component of mask zero-filled
+    EcsEntity create(EcsMask mask) {
+        int at = archetype(mask);
+        EcsArchetype& a = *archetypes[at];
+        if (a.count == a.capacity) a.reserve(std::max(ECS_MIN_ROWS, a.capacity * 2));
+        int row = a.count++;
+        for (int c = 0; c < ECS_COMPONENT_COUNT; c++)
+            if (mask & (1u << c)) memset(&a.columns[c][row * ecsComponentSize[c]], 0, ecsComponentSize[c]);
+
+        uint32_t index;
+        if (freeList.empty() && locations.size() == (size_t)ECS_MAX_ENTITIES) {
+            a.count--;
+            std::cout << "ECS: more than " << ECS_MAX_ENTITIES << " entities" << std::endl;
+            return ECS_NULL;
+        }
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = (uint32_t)locations.size();
+            locations.push_back(Location());
+        }
+        Location& l = locations[index];
+        l.archetype = at;
+        l.row = row;
+        EcsEntity e = (l.generation << 24) | index;
+        a.entities[row] = e;
+        alive_++;
+        return e;
+    }
+
+    // Moves the archetype's last row into e's
+    void destroy(EcsEntity e) {
+        if (!alive(e)) return;
+        Location& l = locations[e & 0xFFFFFF];
+        EcsArchetype& a = *archetypes[l.archetype];
+        int last = --a.count;
+        if (l.row != last) {
+            for (int c = 0; c < ECS_COMPONENT_COUNT; c++) {
+                if (!(a.mask & (1u << c))) continue;
+                size_t size = ecsComponentSize[c];
+                memcpy(&a.columns[c][l.row * size], &a.columns[c][last * size], size);
+            }
+            EcsEntity moved = a.entities[last];
+            a.entities[l.row] = moved;
+            locations[moved & 0xFFFFFF].row = l.row;
+        }
+        l.archetype = -1;
+        l.generation = (l.generation + 1) & 0xFF;
+        freeList.push_back(e & 0xFFFFFF);
+        alive_--;
+    }
+
+    bool alive(EcsEntity e) const {
+        uint32_t index = e & 0xFFFFFF;
+        return e != ECS_NULL && index < locations.size() && locations[index].archetype >= 0
+            && locations[index].generation == (e >> 24);
+    }
+
+    template <typename T>
+    bool has(EcsEntity e) const {
+        return alive(e) && (archetypes[locations[e & 0xFFFFFF].archetype]->mask & EcsMaskOf<T>::value) != 0;
+    }
+
+    // e must be alive and have T
+    template <typename T>
+    T& get(EcsEntity e) {
+        const Location& l = locations[e & 0xFFFFFF];
+        return archetypes[l.archetype]->column<T>()[l.row];
+    }
+
+    template <typename T>
+    void set(EcsEntity e, const T& value) { get<T>(e) = value; }
+
+    // Room for rows more entities of mask, so building does not regrow
+    void reserve(EcsMask mask, int rows) {
+        EcsArchetype& a = *archetypes[archetype(mask)];
+        a.reserve(a.count + rows);
+        locations.reserve(locations.size() + rows);
+    }
+
+    int size() const { return alive_; }
+
+    int count(EcsMask include, EcsMask exclude = 0) const {
+        int n = 0;
+        for (auto& a : archetypes)
+            if (a->matches(include, exclude)) n += a->count;
+        return n;
+    }
+
+    template <typename... C, typename F>
+    void each(const F& fn, EcsMask exclude = 0) {
+        for (auto& a : archetypes) {
+            if (a->count == 0 || !a->matches(EcsMaskOf<C...>::value, exclude)) continue;
+            fn(a->count, a->template column<C>()...);
+        }
+    }
+
+    size_t bytes() const {
+        size_t n = locations.capacity() * sizeof(Location);
+        for (auto& a : archetypes) {
+            n += a->entities.capacity() * sizeof(EcsEntity);
+            for (auto& c : a->columns) n += c.capacity();
+        }
+        return n;
+    }
+
+private:
+    struct Location {
+        int archetype = -1;               // -1 = free
+        int row = 0;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Location> locations;      // by entity index
+    std::vector<uint32_t> freeList;
+    int alive_ = 0;
+
+    // Index of mask's archetype, created on first use
+    int archetype(EcsMask mask) {
+        for (size_t i = 0; i < archetypes.size(); i++)
+            if (archetypes[i]->mask == mask) return (int)i;
+        archetypes.emplace_back(new EcsArchetype());
+        archetypes.back()->mask = mask;
+        return (int)archetypes.size() - 1;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Query: matching rows in chunks for the job system. split() walks the
+// archetypes in order, so chunk order is entity order and a chunk never
+// spans two archetypes.
+// ----------------------------------------------------------------------------
+struct EcsChunk {
+    EcsArchetype* archetype;
+    int begin, end;
+};
+
+class EcsQuery {
+public:
+    EcsMask include = 0, exclude = 0;
+    std::vector<EcsChunk> chunks;
+
+    // Returns the number of rows; keeps the chunk array's storage
+    int split(EcsWorld& world, int rowsPerChunk) {
+        chunks.clear();
+        int rows = 0;
+        for (auto& a : world.archetypes) {
+            if (!a->matches(include, exclude)) continue;
+            for (int b = 0; b < a->count; b += rowsPerChunk) {
+                EcsChunk c = { a.get(), b, std::min(b + rowsPerChunk, a->count) };
+                chunks.push_back(c);
+            }
+            rows += a->count;
+        }
+        return rows;
+    }
+
+    // fn(chunk, n, C* ...) with the columns starting at the chunk's first row
+    template <typename... C, typename F>
+    void run(JobSystem& jobs, const F& fn) const {
+        jobs.parallelFor((int)chunks.size(), 1, [this, &fn](int first, int last) {
+            for (int c = first; c < last; c++) {
+                const EcsChunk& k = chunks[c];
+                fn(c, k.end - k.begin, (k.archetype->template column<C>() + k.begin)...);
+            }
+        });
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Schedule: systems run in the order added. Two systems conflict when some
+// archetype matches both queries and one writes a component the other reads
+// or writes; a system that conflicts with none of the current stage joins
+// it. A stage of one runs inline, a larger one as one job per system (each
+// may use the job system itself, e.g. through EcsQuery::run).
+// ----------------------------------------------------------------------------
+typedef void (*EcsSystemFn)(void* data);
+
+struct EcsSystem {
+    const char* name;
+    EcsMask include, exclude;             // the entities it touches
+    EcsMask reads, writes;
+    EcsSystemFn fn;
+    void* data;
+    double ms;                            // last run
+};
+
+class EcsSchedule {
+public:
+    int stageCount = 0;                   // in the last run()
+
+    void add(const char* name, EcsMask include, EcsMask exclude, EcsMask reads, EcsMask writes,
+             EcsSystemFn fn, void* data) {
+        if (count == ECS_MAX_SYSTEMS) {
+            std::cout << "ECS schedule: too many systems, " << name << " dropped" << std::endl;
+            return;
+        }
+        EcsSystem s = { name, include, exclude, reads, writes, fn, data, 0.0 };
+        systems[count++] = s;
+    }
+
+    int systemCount() const { return count; }
+    const EcsSystem& system(int i) const { return systems[i]; }
+
+    void run(EcsWorld& world, JobSystem& jobs) {
+        stageCount = 0;
+        int begin = 0;
+        while (begin < count) {
+            int end = begin + 1;
+            while (end < count && !conflictsWithStage(world, begin, end)) end++;
+            runStage(jobs, begin, end);
+            stageCount++;
+            begin = end;
+        }
+    }
+
+private:
+    EcsSystem systems[ECS_MAX_SYSTEMS];
+    int count = 0;
+
+    static bool conflict(const EcsWorld& world, const EcsSystem& a, const EcsSystem& b) {
+        if (!(a.writes & (b.reads | b.writes)) && !(b.writes & a.reads)) return false;
+        for (auto& t : world.archetypes)
+            if (t->matches(a.include, a.exclude) && t->matches(b.include, b.exclude)) return true;
+        return false;
+    }
+
+    bool conflictsWithStage(const EcsWorld& world, int begin, int candidate) const {
+        for (int i = begin; i < candidate; i++)
+            if (conflict(world, systems[i], systems[candidate])) return true;
+        return false;
+    }
+
+    static void runSystem(void* data, int, int) {
+        EcsSystem& s = *(EcsSystem*)data;
+        PROFILE_ZONE(s.name);
+        auto t0 = std::chrono::steady_clock::now();
+        s.fn(s.data);
+        s.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void runStage(JobSystem& jobs, int begin, int end) {
+        if (end - begin == 1) {
+            runSystem(&systems[begin], 0, 0);
+            return;
+        }
+        JobCounter done;
+        for (int i = begin; i < end; i++) {
+            Job job = { &EcsSchedule::runSystem, &systems[i], 0, 0, &done, nullptr };
+            jobs.run(job);
+        }
+        jobs.wait(done);
+    }
+};
+
+#endif
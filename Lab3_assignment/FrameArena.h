@@ -0,0 +1,190 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <iostream>
+
+// ============================================================================
+// FRAME ARENA - per-frame bump allocator for transient render data
+// ============================================================================
+// Two blocks used in alternate frames: beginFrame() switches to the other
+// block and rewinds it, so whatever frame N allocated stays valid through
+// frame N + 1 and is reclaimed, all at once, at the start of frame N + 2.
+// alloc() is a pointer bump; nothing is ever freed one allocation at a time.
+//
+// A request that does not fit the block goes to the heap instead (an
+// overflow, counted; the blocks chain them and free them on the rewind) and
+// the next rewind of each block regrows it to the largest frame seen, so
+// after a frame or two of a bigger scene the arena is big enough again and
+// the heap is left alone. highWater is the most one frame has asked for.
+//
+// FrameAllocator<T> hands out frameArena() memory to standard containers;
+// FrameVector<T> is a std::vector on it. Its deallocate() does nothing, so
+// a FrameVector must not carry storage from one frame into a later one:
+// frameReset() drops the old storage (without touching it) and reserves
+// fresh storage in the current frame. Owners call it where a frame's use of
+// the vector starts or ends; reserving last frame's size up front keeps the
+// vector from regrowing, which would leave each outgrown copy behind in the
+// block until the rewind.
+//
+// Render thread only: jobs may read and write what it allocated, but every
+// alloc() and beginFrame() happens on the thread that runs the frame.
+// ============================================================================
+
+const size_t FRAME_ARENA_BYTES = 1024 * 1024;     // per block, before any regrowth
+const size_t FRAME_ARENA_ALIGN = 16;              // alignment of blocks and overflows
+
+struct FrameArenaStats {
+    size_t bytes = 0;           // handed out this frame, alignment padding included
+    int allocs = 0;
+    int overflows = 0;          // allocs that went to the heap
+    size_t overflowBytes = 0;
+};
+
+class FrameArena {
+public:
+    FrameArenaStats stats, lastFrameStats;
+    size_t highWater = 0;       // most bytes one frame asked for
+    int totalOverflows = 0;
+    int regrows = 0;            // blocks reallocated to fit a bigger frame
+
+    ~FrameArena() { cleanup(); }
+
+    void init(size_t bytesPerBlock) {
+        cleanup();
+        wanted = roundUp(bytesPerBlock);
+        for (int i = 0; i < 2; i++) resize(blocks[i], wanted);
+        current = 0;
+        head = blocks[0].base;
+        std::cout << "Frame arena: 2 x " << wanted / 1024 << " KB" << std::endl;
+    }
+
+    // Start of a frame: rewinds the block frame N - 2 used
+    void beginFrame() {
+        size_t used = stats.bytes;
+        if (used > highWater) highWater = used;
+        if (used > wanted) wanted = roundUp(used + used / 4);
+        totalOverflows += stats.overflows;
+        lastFrameStats = stats;
+        stats = FrameArenaStats();
+
+        current ^= 1;
+        Block& b = blocks[current];
+        releaseOverflows(b);
+        if (b.capacity < wanted) {
+            resize(b, wanted);
+            regrows++;
+        }
+        head = b.base;
+    }
+
+    // bytes aligned to align (a power of two, at most FRAME_ARENA_ALIGN);
+    // never null
+    void* alloc(size_t bytes, size_t align) {
+        Block& b = blocks[current];
+        stats.allocs++;
+        if (b.base) {
+            unsigned char* at = (unsigned char*)(((uintptr_t)head + align - 1) & ~(uintptr_t)(align - 1));
+            unsigned char* end = b.base + b.capacity;
+            if (at <= end && bytes <= (size_t)(end - at)) {
+                stats.bytes += (size_t)(at + bytes - head);
+                head = at + bytes;
+                return at;
+            }
+        }
+        // Does not fit: a heap block of its own, freed with this block's rewind
+        Overflow* o = (Overflow*)::operator new(sizeof(Overflow) + bytes);
+        o->next = b.overflows;
+        b.overflows = o;
+        stats.bytes += bytes;
+        stats.overflows++;
+        stats.overflowBytes += bytes;
+        return o + 1;
+    }
+
+    template <typename T>
+    T* allocArray(size_t count) { return (T*)alloc(count * sizeof(T), alignof(T)); }
+
+    size_t bytesPerBlock() const { return blocks[current].capacity; }
+
+    void cleanup() {
+        for (int i = 0; i < 2; i++) {
+            releaseOverflows(blocks[i]);
+            resize(blocks[i], 0);
+        }
+        head = nullptr;
+    }
+
+private:
+    // Header of an overflow allocation; sized so the data after it stays aligned
+    struct alignas(FRAME_ARENA_ALIGN) Overflow {
+        Overflow* next;
+    };
+
+    struct Block {
+        unsigned char* base = nullptr;
+        size_t capacity = 0;
+        Overflow* overflows = nullptr;
+    };
+
+    Block blocks[2];
+    int current = 0;
+    unsigned char* head = nullptr;      // next free byte of blocks[current]
+    size_t wanted = 0;                  // capacity the next rewind grows a block to
+
+    static size_t roundUp(size_t bytes) { return (bytes + 65535) / 65536 * 65536; }
+
+    static void resize(Block& b, size_t bytes) {
+        ::operator delete(b.base);
+        b.base = bytes ? (unsigned char*)::operator new(bytes) : nullptr;
+        b.capacity = bytes;
+    }
+
+    static void releaseOverflows(Block& b) {
+        while (b.overflows) {
+            Overflow* next = b.overflows->next;
+            ::operator delete(b.overflows);
+            b.overflows = next;
+        }
+    }
+};
+
+inline FrameArena& frameArena() {
+    static FrameArena arena;
+    return arena;
+}
+
+// ----------------------------------------------------------------------------
+// Standard allocator over frameArena(). Stateless, so every instance is
+// interchangeable and containers swap and move freely.
+// ----------------------------------------------------------------------------
+template <typename T>
+struct FrameAllocator {
+    typedef T value_type;
+
+    FrameAllocator() {}
+    template <typename U> FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t n) { return frameArena().allocArray<T>(n); }
+    void deallocate(T*, size_t) {}      // reclaimed by the rewind
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T> >;
+
+// Empties v and gives it room for reserve elements in the current frame
+template <typename T>
+void frameReset(FrameVector<T>& v, size_t reserve = 0) {
+    FrameVector<T>().swap(v);
+    if (reserve) v.reserve(reserve);
+}
+
+#endif
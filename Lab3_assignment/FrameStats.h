@@ -0,0 +1,241 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// ============================================================================
+// FRAME STATS - rolling frame-time window, percentiles, stutter detection
+// ============================================================================
+// Each frame is split into three marks:
+//   beginFrame()  top of the loop
+//   endSim()      input and simulation done, rendering starts
+//   endFrame()    after the buffer swap
+// sim = begin..endSim, render = endSim..endFrame, and frame = endFrame to
+// endFrame of the previous frame (the presented interval, so waiting in
+// vsync or the event poll is included).
+//
+// The last FRAME_STATS_WINDOW frames are kept in a ring; summary() gives
+// p50/p95/p99/max of each timing over that window. A frame is a stutter when
+// it takes more than FRAME_STATS_STUTTER x the window median (checked
+// against the window before the frame is added, once it holds at least
+// FRAME_STATS_MIN_SAMPLES frames).
+//
+// openLog() streams one record per frame to disk for offline analysis:
+// CSV when the path ends in ".csv", JSON Lines otherwise. Counters (draw
+// calls, triangles, uniform writes) are passed in by the caller.
+//
+// latency is input-to-photon: from when the input the presented state was
+// simulated from was sampled to the end of the buffer swap (the caller's
+// estimate; -1 when the frame showed no new input, left out of percentiles).
+// viewAge is the same for the camera alone: from when the mouse look the
+// drawn view was built from was sampled to the end of the swap (-1 when the
+// camera is not mouse-driven); the late-latched view shortens it.
+// tools/frame_stats.py prints a summary table from either format.
+// ============================================================================
+
+const int FRAME_STATS_WINDOW = 512;
+const int FRAME_STATS_MIN_SAMPLES = 16;
+const double FRAME_STATS_STUTTER = 2.0;
+
+struct FrameRecord {
+    int frame = 0;
+    double frameMs = 0.0;
+    double simMs = 0.0;
+    double renderMs = 0.0;
+    double latencyMs = -1.0;
+    double viewAgeMs = -1.0;
+    int draws = 0;
+    int triangles = 0;
+    int uniforms = 0;
+    bool stutter = false;
+};
+
+struct FramePercentiles {
+    double p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+struct FrameSummary {
+    int samples = 0;
+    int stutters = 0;      // stutter frames still in the window
+    int latencySamples = 0, viewAgeSamples = 0;
+    double frameStdDev = 0.0;
+    FramePercentiles frame, sim, render, latency, viewAge;
+};
+
+class FrameStats {
+public:
+    long long totalStutters = 0;
+
+    FrameStats() : ring(FRAME_STATS_WINDOW) { scratch.reserve(FRAME_STATS_WINDOW); }
+    ~FrameStats() { closeLog(); }
+
+    void beginFrame() {
+        frameStart = now();
+        if (!haveLastEnd) { lastEnd = frameStart; haveLastEnd = true; }
+    }
+
+    void endSim() { simEnd = now(); }
+
+    // Finishes the frame and returns its record (stutter flag set)
+    const FrameRecord& endFrame(int draws, int triangles, int uniforms, double latencyMs = -1.0,
+                                double viewAgeMs = -1.0) {
+        Clock::time_point end = now();
+        FrameRecord r;
+        r.frame = frameNumber++;
+        r.frameMs = ms(lastEnd, end);
+        r.simMs = ms(frameStart, simEnd);
+        r.renderMs = ms(simEnd, end);
+        r.latencyMs = latencyMs;
+        r.viewAgeMs = viewAgeMs;
+        r.draws = draws;
+        r.triangles = triangles;
+        r.uniforms = uniforms;
+        lastEnd = end;
+
+        if (count >= FRAME_STATS_MIN_SAMPLES)
+            r.stutter = r.frameMs > FRAME_STATS_STUTTER * percentile(&FrameRecord::frameMs, 50.0);
+        if (r.stutter) totalStutters++;
+
+        FrameRecord& slot = ring[head];
+        slot = r;
+        head = (head + 1) % FRAME_STATS_WINDOW;
+        if (count < FRAME_STATS_WINDOW) count++;
+        writeRecord(slot);
+        return slot;
+    }
+
+    int sampleCount() const { return count; }
+
+    // i = 0 is the most recent frame, up to sampleCount() - 1
+    const FrameRecord& recent(int i) const {
+        return ring[(head - 1 - i + 2 * FRAME_STATS_WINDOW) % FRAME_STATS_WINDOW];
+    }
+
+    FrameSummary summary() {
+        FrameSummary s;
+        s.samples = count;
+        if (count == 0) return s;
+        s.frame = percentiles(&FrameRecord::frameMs);
+        s.sim = percentiles(&FrameRecord::simMs);
+        s.render = percentiles(&FrameRecord::renderMs);
+        s.latency = percentiles(&FrameRecord::latencyMs);
+        s.viewAge = percentiles(&FrameRecord::viewAgeMs);
+        double sum = 0.0, sq = 0.0;
+        for (int i = 0; i < count; i++) {
+            if (ring[i].latencyMs >= 0.0) s.latencySamples++;
+            if (ring[i].viewAgeMs >= 0.0) s.viewAgeSamples++;
+            sum += ring[i].frameMs;
+            sq += ring[i].frameMs * ring[i].frameMs;
+        }
+        double mean = sum / count;
+        s.frameStdDev = std::sqrt(std::max(0.0, sq / count - mean * mean));
+        for (int i = 0; i < count; i++)
+            if (ring[i].stutter) s.stutters++;
+        return s;
+    }
+
+    // ------------------------------------------------------------ log export
+    bool openLog(const std::string& path) {
+        closeLog();
+        log = fopen(path.c_str(), "w");
+        if (!log) {
+            std::cout << "Frame stats: cannot write " << path << std::endl;
+            return false;
+        }
+        csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        if (csv) fputs("frame,frame_ms,sim_ms,render_ms,latency_ms,view_age_ms,draws,triangles,uniforms,stutter\n", log);
+        logPath = path;
+        std::cout << "Frame stats: logging to " << path << (csv ? " (CSV)" : " (JSON Lines)") << std::endl;
+        return true;
+    }
+
+    void closeLog() {
+        if (!log) return;
+        fclose(log);
+        log = NULL;
+        std::cout << "Frame stats: wrote " << frameNumber << " frames to " << logPath << std::endl;
+    }
+
+    bool logging() const { return log != NULL; }
+
+    void printSummary(std::ostream& out) {
+        FrameSummary s = summary();
+        char line[160];
+        snprintf(line, sizeof(line), "  Frame ms (last %d): %8s %8s %8s %8s", s.samples, "p50", "p95", "p99", "max");
+        out << line << std::endl;
+        printRow(out, "frame", s.frame);
+        printRow(out, "sim", s.sim);
+        printRow(out, "render", s.render);
+        if (s.latencySamples > 0) printRow(out, "input latency", s.latency);
+        if (s.viewAgeSamples > 0) printRow(out, "view age", s.viewAge);
+        snprintf(line, sizeof(line), "    %-16s %8.2f", "frame std dev", s.frameStdDev);
+        out << line << std::endl;
+        out << "  Stutters (> " << FRAME_STATS_STUTTER << "x median): " << s.stutters
+            << " in window, " << totalStutters << " total" << std::endl;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<FrameRecord> ring;
+    std::vector<double> scratch;
+    int head = 0, count = 0, frameNumber = 0;
+    Clock::time_point frameStart, simEnd, lastEnd;
+    bool haveLastEnd = false;
+    FILE* log = NULL;
+    bool csv = false;
+    std::string logPath;
+
+    static Clock::time_point now() { return Clock::now(); }
+    static double ms(Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    }
+
+    // Nearest-rank percentile of one field over the window (negative
+    // values are missing samples)
+    double percentile(double FrameRecord::*field, double p) {
+        scratch.clear();
+        for (int i = 0; i < count; i++)
+            if (ring[i].*field >= 0.0) scratch.push_back(ring[i].*field);
+        if (scratch.empty()) return 0.0;
+        size_t rank = (size_t)(p / 100.0 * (scratch.size() - 1) + 0.5);
+        std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+        return scratch[rank];
+    }
+
+    FramePercentiles percentiles(double FrameRecord::*field) {
+        FramePercentiles r;
+        r.p50 = percentile(field, 50.0);
+        r.p95 = percentile(field, 95.0);
+        r.p99 = percentile(field, 99.0);
+        r.max = percentile(field, 100.0);
+        return r;
+    }
+
+    static void printRow(std::ostream& out, const char* name, const FramePercentiles& p) {
+        char line[160];
+        snprintf(line, sizeof(line), "    %-16s %8.2f %8.2f %8.2f %8.2f", name, p.p50, p.p95, p.p99, p.max);
+        out << line << std::endl;
+    }
+
+    void writeRecord(const FrameRecord& r) {
+        if (!log) return;
+        if (csv) {
+            fprintf(log, "%d,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d,%d\n", r.frame, r.frameMs, r.simMs, r.renderMs,
+                    r.latencyMs, r.viewAgeMs, r.draws, r.triangles, r.uniforms, r.stutter ? 1 : 0);
+        } else {
+            fprintf(log, "{\"frame\":%d,\"frame_ms\":%.4f,\"sim_ms\":%.4f,\"render_ms\":%.4f,\"latency_ms\":%.4f,"
+                         "\"view_age_ms\":%.4f,\"draws\":%d,\"triangles\":%d,\"uniforms\":%d,\"stutter\":%s}\n",
+                    r.frame, r.frameMs, r.simMs, r.renderMs, r.latencyMs, r.viewAgeMs, r.draws, r.triangles, r.uniforms,
+                    r.stutter ? "true" : "false");
+        }
+    }
+};
+
+#endif
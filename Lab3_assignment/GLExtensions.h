@@ -0,0 +1,96 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+#include <cstring>
+#include <iostream>
+
+// ============================================================================
+// GL EXTENSIONS - optional entry points beyond glad's GL 3.3 core table
+// ============================================================================
+// glad was generated for 3.3 core only, so the draw calls the render queue
+// can use on newer drivers are declared and loaded here instead, through the
+// same loader (glfwGetProcAddress). load() runs once after gladLoadGLLoader:
+//
+//   baseInstance       GL 4.2 or ARB_base_instance:
+//                      glDrawArraysInstancedBaseInstance
+//   multiDrawIndirect  GL 4.3 or ARB_multi_draw_indirect (+ draw_indirect):
+//                      glMultiDrawArraysIndirect
+//   bufferStorage      GL 4.4 or ARB_buffer_storage: glBufferStorage, for
+//                      persistently mapped buffers (StreamRing.h)
+//
+// A feature is only reported when its entry point also resolved. The GL
+// trace wraps these pointers like the glad table (GLTrace.h); the null
+// backend answers them with stubs and reports both features.
+// ============================================================================
+
+// Tokens and signatures from glcorearb.h, under local names so they never
+// clash with a header that does declare them
+const GLenum GL_EXT_DRAW_INDIRECT_BUFFER = 0x8F3F;
+const GLbitfield GL_EXT_MAP_PERSISTENT_BIT = 0x0040;
+const GLbitfield GL_EXT_MAP_COHERENT_BIT = 0x0080;
+typedef void (APIENTRYP GLDrawArraysInstancedBaseInstanceFn)(GLenum mode, GLint first, GLsizei count,
+                                                             GLsizei instancecount, GLuint baseinstance);
+typedef void (APIENTRYP GLMultiDrawArraysIndirectFn)(GLenum mode, const void* indirect,
+                                                     GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP GLBufferStorageFn)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void* (*GLExtensionLoader)(const char* name);
+
+// Layout of one glMultiDrawArraysIndirect command
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+class GLExtensions {
+public:
+    int version = 0;                 // major * 10 + minor
+    bool baseInstance = false;
+    bool multiDrawIndirect = false;
+    bool bufferStorage = false;
+
+    GLDrawArraysInstancedBaseInstanceFn drawArraysInstancedBaseInstance = nullptr;
+    GLMultiDrawArraysIndirectFn multiDrawArraysIndirect = nullptr;
+    GLBufferStorageFn bufferStorageFn = nullptr;
+
+    void load(GLExtensionLoader loader) {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        version = major * 10 + minor;
+
+        drawArraysInstancedBaseInstance =
+            (GLDrawArraysInstancedBaseInstanceFn)loader("glDrawArraysInstancedBaseInstance");
+        multiDrawArraysIndirect = (GLMultiDrawArraysIndirectFn)loader("glMultiDrawArraysIndirect");
+        bufferStorageFn = (GLBufferStorageFn)loader("glBufferStorage");
+
+        baseInstance = drawArraysInstancedBaseInstance &&
+                       (version >= 42 || has("GL_ARB_base_instance"));
+        multiDrawIndirect = multiDrawArraysIndirect && baseInstance &&
+                            (version >= 43 || (has("GL_ARB_multi_draw_indirect") && has("GL_ARB_draw_indirect")));
+        bufferStorage = bufferStorageFn && (version >= 44 || has("GL_ARB_buffer_storage"));
+        std::cout << "GL " << major << "." << minor << ": base instance "
+                  << (baseInstance ? "yes" : "no") << ", multi-draw indirect "
+                  << (multiDrawIndirect ? "yes" : "no") << ", buffer storage "
+                  << (bufferStorage ? "yes" : "no") << std::endl;
+    }
+
+    bool has(const char* name) const {
+        GLint n = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+        for (GLint i = 0; i < n; i++) {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (ext && strcmp(ext, name) == 0) return true;
+        }
+        return false;
+    }
+};
+
+inline GLExtensions& glExtensions() {
+    static GLExtensions extensions;
+    return extensions;
+}
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include "GLExtensions.h"
+
+// ============================================================================
+// GL STATE - shadow of bound objects, fixed-function toggles and uniforms
+// ============================================================================
+// Every bind / enable / uniform write in the app goes through glState(), which
+// remembers what was last sent to the driver and drops calls that would not
+// change anything. Shadows start out "unknown", so the first call of each
+// kind is always issued.
+//
+// Anything that deletes a GL object must call forgetTexture() /
+// forgetVertexArray() / forgetProgram(): GL silently unbinds deleted names
+// and may hand the same name out again, which would otherwise leave a stale
+// shadow. invalidate() drops every shadow (after code that talks to GL
+// directly).
+//
+// Counters are per frame: beginFrame() moves the running totals into the
+// lastFrame* fields shown by the status print. Draw calls also go through
+// here so the frame stats can count draws and triangles. Setting `enabled` to false
+// passes every call through (for A/B comparison) while still counting.
+// ============================================================================
+
+const int GL_STATE_MAX_UNITS = 16;
+const unsigned int GL_STATE_UNKNOWN = 0xFFFFFFFFu;
+
+struct GLStateCounters {
+    int issued = 0;
+    int skipped = 0;
+};
+
+class GLState {
+public:
+    bool enabled = true;
+
+    // Running counters for the current frame, by category
+    GLStateCounters binds, toggles, uniforms;
+    // Totals of the last finished frame
+    GLStateCounters lastFrameBinds, lastFrameToggles, lastFrameUniforms;
+    // Draw calls and triangles submitted (current frame / last frame)
+    int draws = 0, triangles = 0;
+    int lastFrameDraws = 0, lastFrameTriangles = 0;
+
+    GLState() { invalidate(); }
+
+    void beginFrame() {
+        lastFrameBinds = binds;
+        lastFrameToggles = toggles;
+        lastFrameUniforms = uniforms;
+        lastFrameDraws = draws;
+        lastFrameTriangles = triangles;
+        binds = toggles = uniforms = GLStateCounters();
+        draws = triangles = 0;
+    }
+
+    int lastFrameIssued() const {
+        return lastFrameBinds.issued + lastFrameToggles.issued + lastFrameUniforms.issued;
+    }
+    int lastFrameSkipped() const {
+        return lastFrameBinds.skipped + lastFrameToggles.skipped + lastFrameUniforms.skipped;
+    }
+
+    void invalidate() {
+        program = GL_STATE_UNKNOWN;
+        vertexArray = GL_STATE_UNKNOWN;
+        activeUnit = GL_STATE_UNKNOWN;
+        for (int u = 0; u < GL_STATE_MAX_UNITS; u++) {
+            for (int t = 0; t < TARGET_COUNT; t++) textures[u][t] = GL_STATE_UNKNOWN;
+            samplers[u] = GL_STATE_UNKNOWN;
+        }
+        blend = depthTest = cullFace = -1;
+        depthWrite = -1;
+        blendSrc = blendDst = GL_STATE_UNKNOWN;
+        uniformValues.clear();
+    }
+
+    // ---------------------------------------------------------------- objects
+    void useProgram(unsigned int id) {
+        if (!changed(program, id, binds)) return;
+        glUseProgram(id);
+    }
+
+    void bindVertexArray(unsigned int id) {
+        if (!changed(vertexArray, id, binds)) return;
+        glBindVertexArray(id);
+    }
+
+    // unit is an index (0, 1, ...), not GL_TEXTUREn
+    void activeTexture(unsigned int unit) {
+        if (!changed(activeUnit, unit, binds)) return;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    void bindTexture(unsigned int unit, GLenum target, unsigned int id) {
+        int t = targetIndex(target);
+        if (t < 0 || unit >= (unsigned int)GL_STATE_MAX_UNITS) {
+            // Target or unit not shadowed: pass through
+            activeTexture(unit);
+            glBindTexture(target, id);
+            binds.issued++;
+            return;
+        }
+        if (!changed(textures[unit][t], id, binds)) return;
+        activeTexture(unit);
+        glBindTexture(target, id);
+    }
+
+    // As bindTexture(), but unit is left active even when the bind is
+    // skipped: glTexImage/TexParameter/GetTexImage act on the active unit
+    void bindForEdit(unsigned int unit, GLenum target, unsigned int id) {
+        activeTexture(unit);
+        bindTexture(unit, target, id);
+    }
+
+    void bindSampler(unsigned int unit, unsigned int id) {
+        if (unit >= (unsigned int)GL_STATE_MAX_UNITS) binds.issued++;
+        else if (!changed(samplers[unit], id, binds)) return;
+        glBindSampler(unit, id);
+    }
+
+    // ---------------------------------------------------------- fixed function
+    void enable(GLenum cap)  { setCap(cap, true); }
+    void disable(GLenum cap) { setCap(cap, false); }
+
+    void depthMask(bool write) {
+        if (enabled && depthWrite == (int)write) { toggles.skipped++; return; }
+        depthWrite = write;
+        toggles.issued++;
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void blendFunc(GLenum src, GLenum dst) {
+        if (enabled && blendSrc == src && blendDst == dst) { toggles.skipped++; return; }
+        blendSrc = src;
+        blendDst = dst;
+        toggles.issued++;
+        glBlendFunc(src, dst);
+    }
+
+    // ------------------------------------------------------------------ draws
+    void drawArrays(GLenum mode, GLint first, GLsizei count) {
+        countDraw(mode, count, 1);
+        glDrawArrays(mode, first, count);
+    }
+
+    void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+        countDraw(mode, count, instances);
+        glDrawArraysInstanced(mode, first, count, instances);
+    }
+
+    // Optional entry points (GLExtensions.h); check the feature flag first
+    void drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instances,
+                                         GLuint baseInstance) {
+        countDraw(mode, count, instances);
+        glExtensions().drawArraysInstancedBaseInstance(mode, first, count, instances, baseInstance);
+    }
+
+    // One call for drawCount commands in the bound GL_DRAW_INDIRECT_BUFFER;
+    // vertexTotal (sum of count * instanceCount) is only for the counters
+    void multiDrawArraysIndirect(GLenum mode, size_t offset, GLsizei drawCount, int vertexTotal) {
+        countDraw(mode, vertexTotal, 1);
+        glExtensions().multiDrawArraysIndirect(mode, (const void*)offset, drawCount, 0);
+    }
+
+    // --------------------------------------------------------------- uniforms
+    // True if `bytes` at `data` differ from the last value written to this
+    // program/location, in which case the caller issues the glUniform call.
+    // Location -1 (optimized out / unknown name) is always skipped.
+    bool uniformChanged(unsigned int prog, int location, const void* data, size_t bytes) {
+        if (location < 0) { uniforms.skipped++; return false; }
+        UniformValue& v = uniformValues[((uint64_t)prog << 32) | (uint32_t)location];
+        if (enabled && v.size == bytes && std::memcmp(v.data, data, bytes) == 0) {
+            uniforms.skipped++;
+            return false;
+        }
+        if (bytes <= sizeof(v.data)) {
+            std::memcpy(v.data, data, bytes);
+            v.size = bytes;
+        } else {
+            v.size = 0;     // too large to shadow; always issue
+        }
+        uniforms.issued++;
+        return true;
+    }
+
+    // ------------------------------------------------------------- deletions
+    void forgetTexture(unsigned int id) {
+        for (int u = 0; u < GL_STATE_MAX_UNITS; u++)
+            for (int t = 0; t < TARGET_COUNT; t++)
+                if (textures[u][t] == id) textures[u][t] = GL_STATE_UNKNOWN;
+    }
+
+    void forgetVertexArray(unsigned int id) {
+        if (vertexArray == id) vertexArray = GL_STATE_UNKNOWN;
+    }
+
+    void forgetSampler(unsigned int id) {
+        for (int u = 0; u < GL_STATE_MAX_UNITS; u++)
+            if (samplers[u] == id) samplers[u] = GL_STATE_UNKNOWN;
+    }
+
+    void forgetProgram(unsigned int id) {
+        if (program == id) program = GL_STATE_UNKNOWN;
+        for (auto it = uniformValues.begin(); it != uniformValues.end();) {
+            if ((unsigned int)(it->first >> 32) == id) it = uniformValues.erase(it);
+            else ++it;
+        }
+    }
+
+private:
+    enum { TARGET_2D, TARGET_2D_ARRAY, TARGET_3D, TARGET_BUFFER, TARGET_COUNT };
+
+    struct UniformValue {
+        float data[16];     // up to a mat4
+        size_t size = 0;
+    };
+
+    unsigned int program, vertexArray, activeUnit;
+    unsigned int textures[GL_STATE_MAX_UNITS][TARGET_COUNT];
+    unsigned int samplers[GL_STATE_MAX_UNITS];
+    int blend, depthTest, cullFace, depthWrite;     // -1 unknown, else 0/1
+    GLenum blendSrc, blendDst;
+    std::unordered_map<uint64_t, UniformValue> uniformValues;
+
+    bool changed(unsigned int& shadow, unsigned int value, GLStateCounters& c) {
+        if (enabled && shadow == value) { c.skipped++; return false; }
+        shadow = value;
+        c.issued++;
+        return true;
+    }
+
+    void countDraw(GLenum mode, GLsizei count, GLsizei instances) {
+        draws++;
+        if (mode == GL_TRIANGLES) triangles += (count / 3) * instances;
+    }
+
+    void setCap(GLenum cap, bool on) {
+        int* shadow = cap == GL_BLEND ? &blend
+                    : cap == GL_DEPTH_TEST ? &depthTest
+                    : cap == GL_CULL_FACE ? &cullFace : nullptr;
+        if (shadow && enabled && *shadow == (int)on) { toggles.skipped++; return; }
+        if (shadow) *shadow = on;
+        toggles.issued++;
+        if (on) glEnable(cap); else glDisable(cap);
+    }
+
+    static int targetIndex(GLenum target) {
+        switch (target) {
+            case GL_TEXTURE_2D:       return TARGET_2D;
+            case GL_TEXTURE_2D_ARRAY: return TARGET_2D_ARRAY;
+            case GL_TEXTURE_3D:       return TARGET_3D;
+            case GL_TEXTURE_BUFFER:   return TARGET_BUFFER;
+            default:                  return -1;
+        }
+    }
+};
+
+// The one tracker for the GL context
+inline GLState& glState() {
+    static GLState state;
+    return state;
+}
+
+#endif
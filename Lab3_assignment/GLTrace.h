@@ -0,0 +1,324 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdint>
+#include "GLExtensions.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GL_TRACE_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GL_TRACE_HAS_RDTSC 1
+#endif
+
+// ============================================================================
+// GL TRACE - interposer over the glad function-pointer table
+// ============================================================================
+// glad resolves every entry point into a global pointer (glad_glDrawArrays,
+// ...) and the gl* names are macros over those pointers. install() saves the
+// pointers listed in GL_TRACE_ENTRY_POINTS and replaces them with hooks, so
+// every call in the app passes through here without touching call sites.
+//
+// Modes:
+//   GL_TRACE_COUNT  forward to the driver, count calls per entry point
+//   GL_TRACE_TIME   as COUNT, plus CPU time per entry point (rdtsc where
+//                   available, steady_clock otherwise)
+//   GL_TRACE_NULL   no driver at all: calls are counted and answered by
+//                   stubs (fresh object names, successful compiles, scratch
+//                   memory for mapped buffers), so a frame can run on a
+//                   machine without a GL context. Call install() instead of
+//                   gladLoadGLLoader.
+//
+// endFrame() closes the per-frame histogram; printHistogram() prints the
+// last frame by entry point. Hooks are only installed for the entry points
+// in the list below, which covers everything Lab3_assignment calls; in
+// GL_TRACE_NULL mode anything else is still a null pointer. Entry points
+// loaded outside glad (GLExtensions.h) have their own list and are wrapped
+// in place, so install after glExtensions().load().
+// ============================================================================
+
+#define GL_TRACE_ENTRY_POINTS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindBufferBase) X(BindSampler) X(BindTexture) \
+    X(BindVertexArray) X(BlendFunc) X(BufferData) X(BufferSubData) X(Clear) \
+    X(ClearColor) X(ClientWaitSync) X(CompileShader) X(CopyBufferSubData) X(CreateProgram) X(CreateShader) \
+    X(DeleteBuffers) X(DeleteProgram) X(DeleteSamplers) X(DeleteShader) X(DeleteSync) \
+    X(DeleteTextures) X(DeleteVertexArrays) X(DepthMask) X(Disable) \
+    X(DrawArrays) X(DrawArraysInstanced) X(DrawElements) X(Enable) \
+    X(EnableVertexAttribArray) X(FenceSync) X(FlushMappedBufferRange) \
+    X(GenBuffers) X(GenSamplers) X(GenTextures) \
+    X(GenVertexArrays) X(GenerateMipmap) X(GetError) X(GetIntegerv) \
+    X(GetProgramInfoLog) X(GetProgramiv) X(GetShaderInfoLog) X(GetShaderiv) \
+    X(GetString) X(GetStringi) X(GetTexImage) X(GetUniformBlockIndex) X(GetUniformLocation) X(LinkProgram) \
+    X(MapBufferRange) X(PixelStorei) X(SamplerParameteri) X(ShaderSource) \
+    X(TexBuffer) X(TexImage2D) X(TexImage3D) X(TexParameteri) X(TexSubImage2D) \
+    X(Uniform1f) X(Uniform1i) X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) \
+    X(UniformBlockBinding) X(UniformMatrix2fv) X(UniformMatrix3fv) X(UniformMatrix4fv) \
+    X(UnmapBuffer) X(UseProgram) X(VertexAttribDivisor) \
+    X(VertexAttribIPointer) X(VertexAttribPointer) X(Viewport)
+
+// (name, GLExtensions member)
+#define GL_TRACE_EXTENSION_ENTRY_POINTS(X) \
+    X(DrawArraysInstancedBaseInstance, drawArraysInstancedBaseInstance) \
+    X(MultiDrawArraysIndirect, multiDrawArraysIndirect) \
+    X(BufferStorage, bufferStorageFn)
+
+enum GLTraceSlot {
+#define GL_TRACE_SLOT(name) GL_TRACE_SLOT_##name,
+#define GL_TRACE_EXTENSION_SLOT(name, member) GL_TRACE_SLOT_##name,
+    GL_TRACE_ENTRY_POINTS(GL_TRACE_SLOT)
+    GL_TRACE_EXTENSION_ENTRY_POINTS(GL_TRACE_EXTENSION_SLOT)
+#undef GL_TRACE_EXTENSION_SLOT
+#undef GL_TRACE_SLOT
+    GL_TRACE_SLOT_COUNT
+};
+
+enum GLTraceMode {
+    GL_TRACE_OFF,
+    GL_TRACE_COUNT,
+    GL_TRACE_TIME,
+    GL_TRACE_NULL
+};
+
+struct GLTraceStats {
+    uint64_t calls[GL_TRACE_SLOT_COUNT];
+    uint64_t ticks[GL_TRACE_SLOT_COUNT];
+    void clear() {
+        std::memset(calls, 0, sizeof(calls));
+        std::memset(ticks, 0, sizeof(ticks));
+    }
+};
+
+class GLTrace {
+public:
+    GLTraceMode mode = GL_TRACE_OFF;
+    GLTraceStats current, lastFrame;
+    uint64_t frames = 0;
+    double nsPerTick = 1.0;
+
+    GLTrace() { current.clear(); lastFrame.clear(); }
+
+    static uint64_t ticks() {
+#ifdef GL_TRACE_HAS_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void endFrame() {
+        lastFrame = current;
+        current.clear();
+        frames++;
+    }
+
+    uint64_t lastFrameCalls() const {
+        uint64_t n = 0;
+        for (int i = 0; i < GL_TRACE_SLOT_COUNT; i++) n += lastFrame.calls[i];
+        return n;
+    }
+
+    double lastFrameMicroseconds() const {
+        uint64_t t = 0;
+        for (int i = 0; i < GL_TRACE_SLOT_COUNT; i++) t += lastFrame.ticks[i];
+        return t * nsPerTick / 1000.0;
+    }
+
+    // Last frame by entry point, most-called first
+    void printHistogram(std::ostream& out) const {
+        std::vector<int> order;
+        uint64_t maxCalls = 0;
+        for (int i = 0; i < GL_TRACE_SLOT_COUNT; i++) {
+            if (lastFrame.calls[i] == 0) continue;
+            order.push_back(i);
+            maxCalls = std::max(maxCalls, lastFrame.calls[i]);
+        }
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            return lastFrame.calls[a] > lastFrame.calls[b];
+        });
+        out << "  GL calls, frame " << frames << " (" << modeName() << "): "
+            << lastFrameCalls() << " calls";
+        if (mode == GL_TRACE_TIME) out << ", " << std::fixed << std::setprecision(1)
+                                       << lastFrameMicroseconds() << " us in driver";
+        out << std::endl;
+        for (int i : order) {
+            int bar = (int)(40 * lastFrame.calls[i] / maxCalls);
+            out << "    " << std::left << std::setw(26) << slotName(i) << std::right
+                << std::setw(7) << lastFrame.calls[i];
+            if (mode == GL_TRACE_TIME) {
+                double us = lastFrame.ticks[i] * nsPerTick / 1000.0;
+                out << std::setw(10) << std::fixed << std::setprecision(1) << us << " us";
+            }
+            out << "  " << std::string(std::max(1, bar), '#') << std::endl;
+        }
+    }
+
+    const char* modeName() const {
+        switch (mode) {
+            case GL_TRACE_COUNT: return "count";
+            case GL_TRACE_TIME:  return "time";
+            case GL_TRACE_NULL:  return "null";
+            default:             return "off";
+        }
+    }
+
+    static const char* slotName(int slot) {
+        static const char* names[] = {
+#define GL_TRACE_NAME(name) "gl" #name,
+#define GL_TRACE_EXTENSION_NAME(name, member) "gl" #name,
+            GL_TRACE_ENTRY_POINTS(GL_TRACE_NAME)
+            GL_TRACE_EXTENSION_ENTRY_POINTS(GL_TRACE_EXTENSION_NAME)
+#undef GL_TRACE_EXTENSION_NAME
+#undef GL_TRACE_NAME
+        };
+        return names[slot];
+    }
+
+    // --- null backend state ---
+    unsigned int nextName = 1;
+    std::unordered_map<std::string, int> nullLocations;
+    std::unordered_map<GLenum, std::vector<unsigned char> > nullMapped;   // per target
+};
+
+inline GLTrace& glTrace() {
+    static GLTrace trace;
+    return trace;
+}
+
+// ----------------------------------------------------------------------------
+// Hooks: one per entry point, generated from the glad pointer type
+// ----------------------------------------------------------------------------
+template <int Slot, typename F> struct GLTraceHook;
+
+template <int Slot, typename R, typename... Args>
+struct GLTraceHook<Slot, R (APIENTRYP)(Args...)> {
+    typedef R (APIENTRYP Fn)(Args...);
+
+    static Fn& real() {
+        static Fn fn = nullptr;
+        return fn;
+    }
+
+    static R APIENTRY count(Args... args) {
+        glTrace().current.calls[Slot]++;
+        return real()(args...);
+    }
+
+    static R APIENTRY timed(Args... args) {
+        GLTrace& t = glTrace();
+        t.current.calls[Slot]++;
+        struct Timer {
+            uint64_t start, *total;
+            ~Timer() { *total += GLTrace::ticks() - start; }
+        } timer = { GLTrace::ticks(), &t.current.ticks[Slot] };
+        return real()(args...);
+    }
+
+    // Default null-backend answer: zero / nothing
+    static R APIENTRY stub(Args...) {
+        return R();
+    }
+};
+
+// Null-backend answers for calls whose results the app relies on
+struct GLTraceNull {
+    static void APIENTRY genNames(GLsizei n, GLuint* names) {
+        for (GLsizei i = 0; i < n; i++) names[i] = glTrace().nextName++;
+    }
+    static GLuint APIENTRY createShader(GLenum) { return glTrace().nextName++; }
+    static GLuint APIENTRY createProgram() { return glTrace().nextName++; }
+    static void APIENTRY getObjectiv(GLuint, GLenum pname, GLint* params) {
+        // Compile/link status succeeds, logs are empty
+        *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+    }
+    static GLint APIENTRY getUniformLocation(GLuint program, const GLchar* name) {
+        std::string key = std::to_string(program) + ":" + name;
+        auto& locs = glTrace().nullLocations;
+        auto it = locs.find(key);
+        if (it != locs.end()) return it->second;
+        int loc = (int)locs.size();
+        locs[key] = loc;
+        return loc;
+    }
+    // One scratch block per target, so a mapping stays valid while another
+    // target is mapped (the stream ring keeps its buffer mapped)
+    static void* APIENTRY mapBufferRange(GLenum target, GLintptr, GLsizeiptr length, GLbitfield) {
+        auto& scratch = glTrace().nullMapped[target];
+        if (scratch.size() < (size_t)length) scratch.resize((size_t)length);
+        return scratch.data();
+    }
+    static GLboolean APIENTRY unmapBuffer(GLenum) { return GL_TRUE; }
+    static const GLubyte* APIENTRY getString(GLenum) { return (const GLubyte*)"null"; }
+};
+
+// Install hooks over the glad table. COUNT/TIME need glad loaded already;
+// NULL fills the table itself.
+inline void installGLTrace(GLTraceMode mode) {
+    GLTrace& t = glTrace();
+    t.mode = mode;
+    if (mode == GL_TRACE_OFF) return;
+
+#define GL_TRACE_INSTALL(name)                                                         \
+    {                                                                                  \
+        typedef GLTraceHook<GL_TRACE_SLOT_##name, decltype(glad_gl##name)> Hook;       \
+        Hook::real() = mode == GL_TRACE_NULL ? &Hook::stub : glad_gl##name;            \
+        glad_gl##name = mode == GL_TRACE_TIME ? &Hook::timed : &Hook::count;           \
+    }
+    GL_TRACE_ENTRY_POINTS(GL_TRACE_INSTALL)
+#undef GL_TRACE_INSTALL
+
+    // Optional entry points: wrapped when loaded; the null backend has them all
+    GLExtensions& ext = glExtensions();
+#define GL_TRACE_INSTALL_EXTENSION(name, member)                                       \
+    if (ext.member || mode == GL_TRACE_NULL) {                                         \
+        typedef GLTraceHook<GL_TRACE_SLOT_##name, decltype(ext.member)> Hook;          \
+        Hook::real() = mode == GL_TRACE_NULL ? &Hook::stub : ext.member;               \
+        ext.member = mode == GL_TRACE_TIME ? &Hook::timed : &Hook::count;              \
+    }
+    GL_TRACE_EXTENSION_ENTRY_POINTS(GL_TRACE_INSTALL_EXTENSION)
+#undef GL_TRACE_INSTALL_EXTENSION
+    if (mode == GL_TRACE_NULL) {
+        ext.baseInstance = true;
+        ext.multiDrawIndirect = true;
+        ext.bufferStorage = true;
+    }
+
+    if (mode == GL_TRACE_NULL) {
+        GLTraceHook<GL_TRACE_SLOT_GenBuffers, PFNGLGENBUFFERSPROC>::real() = &GLTraceNull::genNames;
+        GLTraceHook<GL_TRACE_SLOT_GenTextures, PFNGLGENTEXTURESPROC>::real() = &GLTraceNull::genNames;
+        GLTraceHook<GL_TRACE_SLOT_GenVertexArrays, PFNGLGENVERTEXARRAYSPROC>::real() = &GLTraceNull::genNames;
+        GLTraceHook<GL_TRACE_SLOT_GenSamplers, PFNGLGENSAMPLERSPROC>::real() = &GLTraceNull::genNames;
+        GLTraceHook<GL_TRACE_SLOT_CreateShader, PFNGLCREATESHADERPROC>::real() = &GLTraceNull::createShader;
+        GLTraceHook<GL_TRACE_SLOT_CreateProgram, PFNGLCREATEPROGRAMPROC>::real() = &GLTraceNull::createProgram;
+        GLTraceHook<GL_TRACE_SLOT_GetShaderiv, PFNGLGETSHADERIVPROC>::real() = &GLTraceNull::getObjectiv;
+        GLTraceHook<GL_TRACE_SLOT_GetProgramiv, PFNGLGETPROGRAMIVPROC>::real() = &GLTraceNull::getObjectiv;
+        GLTraceHook<GL_TRACE_SLOT_GetUniformLocation, PFNGLGETUNIFORMLOCATIONPROC>::real() = &GLTraceNull::getUniformLocation;
+        GLTraceHook<GL_TRACE_SLOT_MapBufferRange, PFNGLMAPBUFFERRANGEPROC>::real() = &GLTraceNull::mapBufferRange;
+        GLTraceHook<GL_TRACE_SLOT_UnmapBuffer, PFNGLUNMAPBUFFERPROC>::real() = &GLTraceNull::unmapBuffer;
+        GLTraceHook<GL_TRACE_SLOT_GetString, PFNGLGETSTRINGPROC>::real() = &GLTraceNull::getString;
+    }
+
+    if (mode == GL_TRACE_TIME) {
+        // Calibrate ticks against steady_clock over a short busy wait
+        auto c0 = std::chrono::steady_clock::now();
+        uint64_t t0 = GLTrace::ticks();
+        while (std::chrono::steady_clock::now() - c0 < std::chrono::milliseconds(20)) {}
+        uint64_t t1 = GLTrace::ticks();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - c0).count();
+        t.nsPerTick = t1 > t0 ? ns / (double)(t1 - t0) : 1.0;
+    }
+    std::cout << "GL trace: " << t.modeName() << " mode, " << GL_TRACE_SLOT_COUNT
+              << " entry points hooked" << std::endl;
+}
+
+#endif
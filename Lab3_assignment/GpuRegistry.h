@@ -0,0 +1,298 @@
+#ifndef GPU_REGISTRY_H
+#define GPU_REGISTRY_H
+
+#include <glad/glad.h>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "GLState.h"
+
+// ============================================================================
+// GPU REGISTRY - every GL object the app creates, with owner and size
+// ============================================================================
+// Buffers, vertex arrays, textures, samplers, shaders and programs are
+// created and deleted through gpuRegistry() instead of calling glGen* /
+// glCreate* / glDelete* directly. Each live object is recorded with an
+// owner tag (a string literal, stored by pointer like profiler zone names),
+// its byte size once the owner reports it with setBytes(), and the frame it
+// was created on (beginFrame() is called at the top of the render loop).
+//
+// Deleting through the registry also drops the object from the GLState
+// shadow, so a recycled name is never mistaken for a bound one, and zeroes
+// the caller's handle.
+//
+// With keepBufferData set, owners that fill a buffer from CPU data report
+// it with setBufferData() and the registry keeps a copy, so a backend with
+// no GL (SoftRaster.h) can read the meshes back with bufferData().
+//
+// printReport() lists live counts and bytes per kind and per owner (TAB).
+// dumpLeaks() runs at shutdown after every owner has cleaned up: anything
+// still registered is reported with its owner tag and creation frame.
+// Objects created on frame 0 were made during startup.
+// ============================================================================
+
+enum GpuObjectKind {
+    GPU_BUFFER,
+    GPU_VERTEX_ARRAY,
+    GPU_TEXTURE,
+    GPU_SAMPLER,
+    GPU_SHADER,
+    GPU_PROGRAM,
+    GPU_KIND_COUNT
+};
+
+static const char* const gpuKindNames[GPU_KIND_COUNT] = {
+    "buffer", "vertex array", "texture", "sampler", "shader", "program"
+};
+
+struct GpuObject {
+    GpuObjectKind kind;
+    unsigned int id;
+    const char* owner;
+    size_t bytes;
+    int frame;
+};
+
+class GpuRegistry {
+public:
+    int frame = 0;
+    bool keepBufferData = false;    // copy setBufferData() contents
+
+    void beginFrame() { frame++; }
+
+    // ------------------------------------------------------------- creation
+    unsigned int genBuffer(const char* owner) {
+        unsigned int id = 0;
+        glGenBuffers(1, &id);
+        add(GPU_BUFFER, id, owner);
+        return id;
+    }
+    void genBuffers(int n, unsigned int* ids, const char* owner) {
+        glGenBuffers(n, ids);
+        for (int i = 0; i < n; i++) add(GPU_BUFFER, ids[i], owner);
+    }
+    unsigned int genVertexArray(const char* owner) {
+        unsigned int id = 0;
+        glGenVertexArrays(1, &id);
+        add(GPU_VERTEX_ARRAY, id, owner);
+        return id;
+    }
+    unsigned int genTexture(const char* owner) {
+        unsigned int id = 0;
+        glGenTextures(1, &id);
+        add(GPU_TEXTURE, id, owner);
+        return id;
+    }
+    unsigned int genSampler(const char* owner) {
+        unsigned int id = 0;
+        glGenSamplers(1, &id);
+        add(GPU_SAMPLER, id, owner);
+        return id;
+    }
+    unsigned int createShader(GLenum type, const char* owner) {
+        unsigned int id = glCreateShader(type);
+        add(GPU_SHADER, id, owner);
+        return id;
+    }
+    unsigned int createProgram(const char* owner) {
+        unsigned int id = glCreateProgram();
+        add(GPU_PROGRAM, id, owner);
+        return id;
+    }
+
+    // ------------------------------------------------------------- deletion
+    // Each takes the caller's handle, ignores 0 and resets it to 0
+    void deleteBuffer(unsigned int& id) {
+        if (!id) return;
+        glDeleteBuffers(1, &id);
+        remove(GPU_BUFFER, id);
+        bufferCopies.erase(id);
+        id = 0;
+    }
+    void deleteBuffers(int n, unsigned int* ids) {
+        for (int i = 0; i < n; i++) deleteBuffer(ids[i]);
+    }
+    void deleteVertexArray(unsigned int& id) {
+        if (!id) return;
+        glState().forgetVertexArray(id);
+        glDeleteVertexArrays(1, &id);
+        remove(GPU_VERTEX_ARRAY, id);
+        id = 0;
+    }
+    void deleteTexture(unsigned int& id) {
+        if (!id) return;
+        glState().forgetTexture(id);
+        glDeleteTextures(1, &id);
+        remove(GPU_TEXTURE, id);
+        id = 0;
+    }
+    void deleteSampler(unsigned int& id) {
+        if (!id) return;
+        glState().forgetSampler(id);
+        glDeleteSamplers(1, &id);
+        remove(GPU_SAMPLER, id);
+        id = 0;
+    }
+    void deleteShader(unsigned int& id) {
+        if (!id) return;
+        glDeleteShader(id);
+        remove(GPU_SHADER, id);
+        id = 0;
+    }
+    void deleteProgram(unsigned int& id) {
+        if (!id) return;
+        glState().forgetProgram(id);
+        glDeleteProgram(id);
+        remove(GPU_PROGRAM, id);
+        id = 0;
+    }
+
+    // Storage size of a live object (after glBufferData / glTexImage*)
+    void setBytes(GpuObjectKind kind, unsigned int id, size_t bytes) {
+        auto it = live.find(key(kind, id));
+        if (it == live.end()) return;
+        liveBytes[kind] -= it->second.bytes;
+        it->second.bytes = bytes;
+        liveBytes[kind] += bytes;
+    }
+
+    // setBytes() for a buffer just filled from data (glBufferData); the
+    // contents are kept when keepBufferData is set
+    void setBufferData(unsigned int id, const void* data, size_t bytes) {
+        setBytes(GPU_BUFFER, id, bytes);
+        if (!keepBufferData || !data) return;
+        const unsigned char* src = (const unsigned char*)data;
+        bufferCopies[id].assign(src, src + bytes);
+    }
+
+    // -------------------------------------------------------------- queries
+    // Contents kept by setBufferData(), or null
+    const std::vector<unsigned char>* bufferData(unsigned int id) const {
+        auto it = bufferCopies.find(id);
+        return it != bufferCopies.end() ? &it->second : nullptr;
+    }
+    int liveCount(GpuObjectKind kind) const { return liveCounts[kind]; }
+    size_t liveByteCount(GpuObjectKind kind) const { return liveBytes[kind]; }
+    int liveTotal() const { return (int)live.size(); }
+    size_t liveTotalBytes() const {
+        size_t total = 0;
+        for (int k = 0; k < GPU_KIND_COUNT; k++) total += liveBytes[k];
+        return total;
+    }
+
+    void printReport(std::ostream& out) const {
+        char line[160];
+        out << "  GPU objects: " << liveTotal() << " live, " << liveTotalBytes() / 1024 << " KB" << std::endl;
+        for (int k = 0; k < GPU_KIND_COUNT; k++) {
+            if (!liveCounts[k] && !created[k]) continue;
+            snprintf(line, sizeof(line), "    %-13s %5d live %9zu KB   (%d created, %d deleted)",
+                     gpuKindNames[k], liveCounts[k], liveBytes[k] / 1024, created[k], deleted[k]);
+            out << line << std::endl;
+        }
+        std::vector<OwnerTotal> owners = ownerTotals();
+        for (const auto& o : owners) {
+            snprintf(line, sizeof(line), "    %-28s %5d objects %9zu KB", o.owner, o.count, o.bytes / 1024);
+            out << line << std::endl;
+        }
+        if (unknownDeletes)
+            out << "    " << unknownDeletes << " deletes of objects the registry never saw" << std::endl;
+    }
+
+    // Lists every object still alive; returns how many
+    int dumpLeaks(std::ostream& out) const {
+        if (live.empty()) {
+            int total = 0;
+            for (int k = 0; k < GPU_KIND_COUNT; k++) total += created[k];
+            out << "  GPU objects: all " << total << " released" << std::endl;
+            return 0;
+        }
+        std::vector<GpuObject> leaks;
+        for (const auto& kv : live) leaks.push_back(kv.second);
+        std::sort(leaks.begin(), leaks.end(), [](const GpuObject& a, const GpuObject& b) {
+            int c = strcmp(a.owner, b.owner);
+            return c != 0 ? c < 0 : a.kind != b.kind ? a.kind < b.kind : a.id < b.id;
+        });
+        char line[160];
+        for (const auto& o : leaks) {
+            snprintf(line, sizeof(line), "  GPU LEAK: %-13s id %-5u %-28s %8zu bytes, created on frame %d",
+                     gpuKindNames[o.kind], o.id, o.owner, o.bytes, o.frame);
+            out << line << std::endl;
+        }
+        out << "  GPU objects: " << leaks.size() << " leaked (" << liveTotalBytes() / 1024 << " KB)" << std::endl;
+        return (int)leaks.size();
+    }
+
+private:
+    struct OwnerTotal {
+        const char* owner;
+        int count;
+        size_t bytes;
+    };
+
+    std::unordered_map<uint64_t, GpuObject> live;
+    std::unordered_map<unsigned int, std::vector<unsigned char> > bufferCopies;
+    int liveCounts[GPU_KIND_COUNT] = { 0 };
+    size_t liveBytes[GPU_KIND_COUNT] = { 0 };
+    int created[GPU_KIND_COUNT] = { 0 };
+    int deleted[GPU_KIND_COUNT] = { 0 };
+    int unknownDeletes = 0;
+
+    static uint64_t key(GpuObjectKind kind, unsigned int id) { return ((uint64_t)kind << 32) | id; }
+
+    void add(GpuObjectKind kind, unsigned int id, const char* owner) {
+        if (!id) return;
+        GpuObject o = { kind, id, owner ? owner : "?", 0, frame };
+        auto it = live.find(key(kind, id));
+        if (it != live.end()) {
+            // The name was freed behind the registry's back and reused
+            liveBytes[kind] -= it->second.bytes;
+            liveCounts[kind]--;
+            unknownDeletes++;
+        }
+        live[key(kind, id)] = o;
+        liveCounts[kind]++;
+        created[kind]++;
+    }
+
+    void remove(GpuObjectKind kind, unsigned int id) {
+        auto it = live.find(key(kind, id));
+        if (it == live.end()) {
+            unknownDeletes++;
+            return;
+        }
+        liveBytes[kind] -= it->second.bytes;
+        liveCounts[kind]--;
+        deleted[kind]++;
+        live.erase(it);
+    }
+
+    std::vector<OwnerTotal> ownerTotals() const {
+        std::vector<OwnerTotal> owners;
+        for (const auto& kv : live) {
+            const GpuObject& o = kv.second;
+            auto it = std::find_if(owners.begin(), owners.end(),
+                                   [&](const OwnerTotal& t) { return strcmp(t.owner, o.owner) == 0; });
+            if (it == owners.end()) {
+                OwnerTotal t = { o.owner, 0, 0 };
+                owners.push_back(t);
+                it = owners.end() - 1;
+            }
+            it->count++;
+            it->bytes += o.bytes;
+        }
+        std::sort(owners.begin(), owners.end(),
+                  [](const OwnerTotal& a, const OwnerTotal& b) { return a.bytes != b.bytes ? a.bytes > b.bytes : a.count > b.count; });
+        return owners;
+    }
+};
+
+inline GpuRegistry& gpuRegistry() {
+    static GpuRegistry registry;
+    return registry;
+}
+
+#endif
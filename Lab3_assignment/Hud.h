@@ -0,0 +1,229 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include "Shader.h"
+#include "GLState.h"
+#include "HudFont.h"
+#include "GpuRegistry.h"
+#include "StreamRing.h"
+#include "FrameArena.h"
+
+// ============================================================================
+// HUD - batched overlay text and graph quads
+// ============================================================================
+// Everything on the overlay is a screen-space quad in one dynamic vertex
+// buffer: glyphs sample the baked font atlas (HudFont.h, GL_R8), solid
+// rectangles and graph bars sample an all-white atlas cell, so text and
+// graphs share the same program, texture and draw call.
+//
+// Per frame: begin() resets the vertex array, text()/textf()/rect() append
+// quads, draw() uploads them (orphaning the buffer) and issues a single
+// glDrawArrays. The vertices live in the frame arena, reserved for the
+// last frame's quad count, so building the overlay does not allocate; quads
+// past HUD_MAX_QUADS are dropped.
+// Coordinates are framebuffer pixels with the origin at the top left.
+// With a stream ring the quads are copied into it and drawn from there
+// (the VAO reads the ring from offset 0, the draw's first vertex is the
+// allocation); VBO is the fallback when the ring is full.
+// ============================================================================
+
+const int HUD_MAX_QUADS = 4096;
+const int HUD_MIN_QUADS = 1024;    // reserved per frame before any frame was drawn
+const int HUD_ATLAS_COLS = 16;
+const int HUD_ATLAS_ROWS = 6;      // 95 glyphs + the solid cell (last slot)
+
+struct HudVertex {
+    float x, y;
+    float u, v;
+    unsigned int color;   // RGBA8, red in the low byte
+};
+
+// Packs 0..255 components into a HudVertex color
+inline unsigned int hudColor(int r, int g, int b, int a = 255) {
+    return (unsigned int)r | ((unsigned int)g << 8) | ((unsigned int)b << 16) | ((unsigned int)a << 24);
+}
+
+class Hud {
+public:
+    bool visible = false;
+    int scale = 1;                       // integer glyph scale (HiDPI)
+    unsigned int VAO = 0, VBO = 0, atlas = 0;
+    Shader* shader = nullptr;
+    StreamRing* ring = nullptr;
+
+    void init() {
+        shader = new Shader("hud.vert", "hud.frag");
+        shader->use();
+        shader->setInt("fontAtlas", 0);
+        buildAtlas();
+
+        VAO = gpuRegistry().genVertexArray("hud");
+        VBO = gpuRegistry().genBuffer("hud");
+        glState().bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, HUD_MAX_QUADS * 6 * sizeof(HudVertex), NULL, GL_STREAM_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, VBO, HUD_MAX_QUADS * 6 * sizeof(HudVertex));
+        pointVertices(VBO);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        glState().bindVertexArray(0);
+    }
+
+    void begin(int fbWidth, int fbHeight) {
+        width = fbWidth;
+        height = fbHeight;
+        frameReset(vertices, (size_t)std::max(lastQuads, HUD_MIN_QUADS) * 6);
+        dropped = 0;
+    }
+
+    void rect(float x, float y, float w, float h, unsigned int color) {
+        float u = (solidCell % HUD_ATLAS_COLS + 0.5f) / HUD_ATLAS_COLS;
+        float v = (solidCell / HUD_ATLAS_COLS + 0.5f) / HUD_ATLAS_ROWS;
+        quad(x, y, x + w, y + h, u, v, u, v, color);
+    }
+
+    // Returns the x just past the last glyph; '\n' starts a new line
+    float text(float x, float y, const char* s, unsigned int color) {
+        float gw = (float)(HUD_GLYPH_W * scale), gh = (float)(HUD_GLYPH_H * scale);
+        float startX = x;
+        for (; *s; s++) {
+            if (*s == '\n') { x = startX; y += gh; continue; }
+            int c = (unsigned char)*s - HUD_FIRST_CHAR;
+            if (c > 0 && c < HUD_CHAR_COUNT) {
+                float u0 = (float)(c % HUD_ATLAS_COLS) / HUD_ATLAS_COLS;
+                float v0 = (float)(c / HUD_ATLAS_COLS) / HUD_ATLAS_ROWS;
+                quad(x, y, x + gw, y + gh, u0, v0,
+                     u0 + 1.0f / HUD_ATLAS_COLS, v0 + 1.0f / HUD_ATLAS_ROWS, color);
+            }
+            x += gw;
+        }
+        return x;
+    }
+
+    // printf-style text through a fixed line buffer
+    float textf(float x, float y, unsigned int color, const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(line, sizeof(line), fmt, args);
+        va_end(args);
+        return text(x, y, line, color);
+    }
+
+    float lineHeight() const { return (float)(HUD_GLYPH_H * scale); }
+    float glyphWidth() const { return (float)(HUD_GLYPH_W * scale); }
+
+    // Uploads the frame's quads and draws them in one call. Leaves depth
+    // testing on and alpha blending selected, like the scene expects.
+    void draw() {
+        if (vertices.empty()) return;
+        size_t bytes = vertices.size() * sizeof(HudVertex);
+        size_t offset = 0;
+        void* dst = ring ? ring->alloc(bytes, sizeof(HudVertex), offset) : nullptr;
+        glState().bindVertexArray(VAO);
+        if (dst) {
+            memcpy(dst, vertices.data(), bytes);
+            ring->flush();
+            pointVertices(ring->buffer);
+        } else {
+            pointVertices(VBO);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferData(GL_ARRAY_BUFFER, HUD_MAX_QUADS * 6 * sizeof(HudVertex), NULL, GL_STREAM_DRAW);  // orphan
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+        }
+
+        glState().disable(GL_DEPTH_TEST);
+        glState().enable(GL_BLEND);
+        glState().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        shader->use();
+        shader->setVec2("screenSize", glm::vec2((float)width, (float)height));
+        glState().bindTexture(0, GL_TEXTURE_2D, atlas);
+        glState().drawArrays(GL_TRIANGLES, (GLint)(offset / sizeof(HudVertex)), (GLsizei)vertices.size());
+        glState().enable(GL_DEPTH_TEST);
+        lastQuads = (int)vertices.size() / 6;
+        frameReset(vertices);
+    }
+
+    int lastQuadCount() const { return lastQuads; }
+    int droppedQuadCount() const { return dropped; }
+
+    // Atlas texture size, for texture memory accounting
+    int atlasWidth() const { return HUD_ATLAS_COLS * HUD_GLYPH_W; }
+    int atlasHeight() const { return HUD_ATLAS_ROWS * HUD_GLYPH_H; }
+
+    void cleanup() {
+        gpuRegistry().deleteVertexArray(VAO);
+        gpuRegistry().deleteBuffer(VBO);
+        gpuRegistry().deleteTexture(atlas);
+        if (shader) {
+            shader->cleanup();
+            delete shader;
+            shader = nullptr;
+        }
+    }
+
+private:
+    FrameVector<HudVertex> vertices;
+    int width = 1, height = 1;
+    int lastQuads = 0, dropped = 0;
+    unsigned int pointedBuffer = 0;      // buffer the VAO's attributes read
+    char line[256];
+    static const int solidCell = HUD_ATLAS_COLS * HUD_ATLAS_ROWS - 1;
+
+    // Attributes 0-2 from buffer; the VAO must be bound
+    void pointVertices(unsigned int buffer) {
+        if (buffer == pointedBuffer) return;
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, x));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, u));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (void*)offsetof(HudVertex, color));
+        pointedBuffer = buffer;
+    }
+
+    void quad(float x0, float y0, float x1, float y1,
+              float u0, float v0, float u1, float v1, unsigned int color) {
+        if (vertices.size() + 6 > (size_t)HUD_MAX_QUADS * 6) { dropped++; return; }
+        HudVertex a = { x0, y0, u0, v0, color };
+        HudVertex b = { x1, y0, u1, v0, color };
+        HudVertex c = { x1, y1, u1, v1, color };
+        HudVertex d = { x0, y1, u0, v1, color };
+        vertices.push_back(a); vertices.push_back(b); vertices.push_back(c);
+        vertices.push_back(a); vertices.push_back(c); vertices.push_back(d);
+    }
+
+    // Expand the 1-bit glyph rows into an R8 atlas; the last cell is solid
+    void buildAtlas() {
+        int w = atlasWidth(), h = atlasHeight();
+        std::vector<unsigned char> pixels(w * h, 0);
+        for (int cell = 0; cell < HUD_ATLAS_COLS * HUD_ATLAS_ROWS; cell++) {
+            int ox = (cell % HUD_ATLAS_COLS) * HUD_GLYPH_W;
+            int oy = (cell / HUD_ATLAS_COLS) * HUD_GLYPH_H;
+            for (int y = 0; y < HUD_GLYPH_H; y++) {
+                unsigned char bits = cell == solidCell ? 0xFF
+                                   : cell < HUD_CHAR_COUNT ? HUD_FONT[cell][y] : 0;
+                for (int x = 0; x < HUD_GLYPH_W; x++)
+                    if (bits & (0x80 >> x)) pixels[(oy + y) * w + ox + x] = 255;
+            }
+        }
+        atlas = gpuRegistry().genTexture("hud font atlas");
+        glState().bindForEdit(0, GL_TEXTURE_2D, atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        gpuRegistry().setBytes(GPU_TEXTURE, atlas, pixels.size());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef HUD_FONT_H
+#define HUD_FONT_H
+
+// ============================================================================
+// HUD FONT - 8x14 bitmap glyphs for printable ASCII (32..126)
+// ============================================================================
+// One byte per row, most significant bit = leftmost pixel. Rasterized from
+// Source Code Pro Bold at 13 px (SIL Open Font License 1.1). Hud::init()
+// bakes these into a GL_R8 atlas texture at startup.
+// ============================================================================
+
+const int HUD_GLYPH_W = 8;
+const int HUD_GLYPH_H = 14;
+const int HUD_FIRST_CHAR = 32;
+const int HUD_CHAR_COUNT = 95;
+
+static const unsigned char HUD_FONT[HUD_CHAR_COUNT][HUD_GLYPH_H] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00 },   // '!'
+    { 0x00, 0x00, 0x6E, 0x6E, 0x66, 0x66, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '"'
+    { 0x00, 0x00, 0x00, 0x34, 0x34, 0x7E, 0x2C, 0x7E, 0x2C, 0x28, 0x28, 0x00, 0x00, 0x00 },   // '#'
+    { 0x00, 0x18, 0x18, 0x3C, 0x64, 0x70, 0x3C, 0x0E, 0x46, 0x7C, 0x18, 0x18, 0x00, 0x00 },   // '$'
+    { 0x00, 0x00, 0x00, 0x72, 0xD6, 0xD4, 0x70, 0x0E, 0x3A, 0x6A, 0x4E, 0x00, 0x00, 0x00 },   // '%'
+    { 0x00, 0x00, 0x00, 0x38, 0x68, 0x78, 0x72, 0x76, 0xFE, 0xCE, 0x7E, 0x00, 0x00, 0x00 },   // '&'
+    { 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '''
+    { 0x00, 0x04, 0x0C, 0x18, 0x18, 0x30, 0x30, 0x30, 0x30, 0x18, 0x18, 0x0C, 0x04, 0x00 },   // '('
+    { 0x00, 0x20, 0x30, 0x18, 0x18, 0x08, 0x0C, 0x0C, 0x08, 0x18, 0x18, 0x30, 0x20, 0x00 },   // ')'
+    { 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x7E, 0x38, 0x3C, 0x24, 0x00, 0x00, 0x00, 0x00 },   // '*'
+    { 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x7E, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x1C, 0x0C, 0x18, 0x10 },   // ','
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x38, 0x18, 0x00, 0x00, 0x00 },   // '.'
+    { 0x00, 0x00, 0x06, 0x04, 0x0C, 0x0C, 0x18, 0x18, 0x10, 0x30, 0x30, 0x60, 0x60, 0x00 },   // '/'
+    { 0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0x7E, 0x7E, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // '0'
+    { 0x00, 0x00, 0x00, 0x18, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7E, 0x00, 0x00, 0x00 },   // '1'
+    { 0x00, 0x00, 0x00, 0x78, 0x4C, 0x06, 0x0C, 0x0C, 0x18, 0x30, 0x7E, 0x00, 0x00, 0x00 },   // '2'
+    { 0x00, 0x00, 0x00, 0x7C, 0x4C, 0x06, 0x0C, 0x3C, 0x0E, 0x46, 0x7C, 0x00, 0x00, 0x00 },   // '3'
+    { 0x00, 0x00, 0x00, 0x1C, 0x1C, 0x3C, 0x6C, 0x6C, 0xFE, 0x0C, 0x0C, 0x00, 0x00, 0x00 },   // '4'
+    { 0x00, 0x00, 0x00, 0x7E, 0x60, 0x60, 0x7C, 0x0E, 0x06, 0x4E, 0x7C, 0x00, 0x00, 0x00 },   // '5'
+    { 0x00, 0x00, 0x00, 0x3E, 0x70, 0x60, 0x7C, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // '6'
+    { 0x00, 0x00, 0x00, 0x7E, 0x04, 0x0C, 0x18, 0x18, 0x18, 0x18, 0x38, 0x00, 0x00, 0x00 },   // '7'
+    { 0x00, 0x00, 0x00, 0x3C, 0x66, 0x3C, 0x3C, 0x6E, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // '8'
+    { 0x00, 0x00, 0x00, 0x3C, 0x6E, 0x66, 0x66, 0x7E, 0x06, 0x0C, 0x78, 0x00, 0x00, 0x00 },   // '9'
+    { 0x00, 0x00, 0x00, 0x00, 0x18, 0x38, 0x18, 0x00, 0x18, 0x38, 0x18, 0x00, 0x00, 0x00 },   // ':'
+    { 0x00, 0x00, 0x00, 0x00, 0x18, 0x38, 0x18, 0x00, 0x18, 0x3C, 0x1C, 0x0C, 0x18, 0x10 },   // ';'
+    { 0x00, 0x00, 0x00, 0x02, 0x0C, 0x38, 0x60, 0x38, 0x0C, 0x02, 0x00, 0x00, 0x00, 0x00 },   // '<'
+    { 0x00, 0x00, 0x00, 0x00, 0x7E, 0x00, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '='
+    { 0x00, 0x00, 0x00, 0x40, 0x30, 0x1C, 0x0C, 0x1C, 0x30, 0x40, 0x00, 0x00, 0x00, 0x00 },   // '>'
+    { 0x00, 0x00, 0x3C, 0x2C, 0x0C, 0x1C, 0x18, 0x00, 0x18, 0x38, 0x18, 0x00, 0x00, 0x00 },   // '?'
+    { 0x00, 0x00, 0x00, 0x3C, 0x66, 0x42, 0xCE, 0xDA, 0xD6, 0xDE, 0x40, 0x60, 0x3C, 0x00 },   // '@'
+    { 0x00, 0x00, 0x00, 0x38, 0x3C, 0x3C, 0x6C, 0x66, 0x7E, 0xE6, 0xC7, 0x00, 0x00, 0x00 },   // 'A'
+    { 0x00, 0x00, 0x00, 0x7C, 0x66, 0x66, 0x7C, 0x66, 0x66, 0x66, 0x7C, 0x00, 0x00, 0x00 },   // 'B'
+    { 0x00, 0x00, 0x00, 0x1E, 0x70, 0x60, 0x60, 0x60, 0x60, 0x72, 0x1E, 0x00, 0x00, 0x00 },   // 'C'
+    { 0x00, 0x00, 0x00, 0x78, 0x6E, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x78, 0x00, 0x00, 0x00 },   // 'D'
+    { 0x00, 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7C, 0x60, 0x60, 0x7E, 0x00, 0x00, 0x00 },   // 'E'
+    { 0x00, 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00 },   // 'F'
+    { 0x00, 0x00, 0x00, 0x3E, 0x70, 0x60, 0x60, 0x6E, 0x66, 0x76, 0x3E, 0x00, 0x00, 0x00 },   // 'G'
+    { 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x7E, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00 },   // 'H'
+    { 0x00, 0x00, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7E, 0x00, 0x00, 0x00 },   // 'I'
+    { 0x00, 0x00, 0x00, 0x7E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x6E, 0x7C, 0x00, 0x00, 0x00 },   // 'J'
+    { 0x00, 0x00, 0x00, 0x66, 0x6C, 0x7C, 0x78, 0x7C, 0x6C, 0x66, 0x67, 0x00, 0x00, 0x00 },   // 'K'
+    { 0x00, 0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x7E, 0x00, 0x00, 0x00 },   // 'L'
+    { 0x00, 0x00, 0x00, 0x66, 0x66, 0x6E, 0x7E, 0x5E, 0x5E, 0x46, 0x46, 0x00, 0x00, 0x00 },   // 'M'
+    { 0x00, 0x00, 0x00, 0x66, 0x76, 0x76, 0x76, 0x7E, 0x6E, 0x6E, 0x66, 0x00, 0x00, 0x00 },   // 'N'
+    { 0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0xE6, 0xE6, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // 'O'
+    { 0x00, 0x00, 0x00, 0x7C, 0x66, 0x66, 0x66, 0x7C, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00 },   // 'P'
+    { 0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0xE6, 0xE6, 0x66, 0x66, 0x3C, 0x1C, 0x0E, 0x00 },   // 'Q'
+    { 0x00, 0x00, 0x00, 0x7C, 0x66, 0x66, 0x66, 0x7C, 0x6C, 0x66, 0x66, 0x00, 0x00, 0x00 },   // 'R'
+    { 0x00, 0x00, 0x00, 0x3E, 0x64, 0x60, 0x7C, 0x1E, 0x06, 0x66, 0x7C, 0x00, 0x00, 0x00 },   // 'S'
+    { 0x00, 0x00, 0x00, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00 },   // 'T'
+    { 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // 'U'
+    { 0x00, 0x00, 0x00, 0xC7, 0x66, 0x66, 0x66, 0x2C, 0x3C, 0x3C, 0x38, 0x00, 0x00, 0x00 },   // 'V'
+    { 0x00, 0x00, 0x00, 0xC3, 0xC3, 0xC3, 0xDA, 0x5A, 0x7E, 0x7E, 0x6E, 0x00, 0x00, 0x00 },   // 'W'
+    { 0x00, 0x00, 0x00, 0x66, 0x66, 0x3C, 0x38, 0x3C, 0x3C, 0x6E, 0xE6, 0x00, 0x00, 0x00 },   // 'X'
+    { 0x00, 0x00, 0x00, 0xE6, 0x66, 0x6C, 0x3C, 0x38, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00 },   // 'Y'
+    { 0x00, 0x00, 0x00, 0x7E, 0x0E, 0x0C, 0x18, 0x38, 0x30, 0x70, 0x7E, 0x00, 0x00, 0x00 },   // 'Z'
+    { 0x00, 0x00, 0x3E, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3E, 0x00 },   // '['
+    { 0x00, 0x00, 0x60, 0x60, 0x30, 0x30, 0x10, 0x18, 0x18, 0x0C, 0x0C, 0x04, 0x06, 0x00 },   // '\\'
+    { 0x00, 0x00, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x78, 0x00 },   // ']'
+    { 0x00, 0x00, 0x00, 0x18, 0x38, 0x3C, 0x2C, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x00 },   // '_'
+    { 0x00, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '`'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x06, 0x3E, 0x66, 0x66, 0x7E, 0x00, 0x00, 0x00 },   // 'a'
+    { 0x00, 0x00, 0x60, 0x60, 0x60, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x7C, 0x00, 0x00, 0x00 },   // 'b'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x70, 0x60, 0x60, 0x70, 0x3E, 0x00, 0x00, 0x00 },   // 'c'
+    { 0x00, 0x00, 0x06, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x66, 0x66, 0x3E, 0x00, 0x00, 0x00 },   // 'd'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x7E, 0x60, 0x60, 0x3E, 0x00, 0x00, 0x00 },   // 'e'
+    { 0x00, 0x00, 0x0E, 0x18, 0x18, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00 },   // 'f'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x6C, 0x6C, 0x7C, 0x60, 0x7E, 0x66, 0x7E, 0x00 },   // 'g'
+    { 0x00, 0x00, 0x60, 0x60, 0x60, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00 },   // 'h'
+    { 0x00, 0x00, 0x1C, 0x1C, 0x00, 0x7C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x00, 0x00, 0x00 },   // 'i'
+    { 0x00, 0x00, 0x1C, 0x1C, 0x00, 0x7C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x18, 0x78, 0x00 },   // 'j'
+    { 0x00, 0x00, 0x60, 0x60, 0x60, 0x66, 0x6C, 0x78, 0x7C, 0x6E, 0x66, 0x00, 0x00, 0x00 },   // 'k'
+    { 0x00, 0x00, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00, 0x00, 0x00 },   // 'l'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xFF, 0xDB, 0xDB, 0xDB, 0xDB, 0x00, 0x00, 0x00 },   // 'm'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00 },   // 'n'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00 },   // 'o'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x7C, 0x60, 0x60, 0x00 },   // 'p'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x66, 0x66, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x00 },   // 'q'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x6E, 0x70, 0x70, 0x70, 0x70, 0x70, 0x00, 0x00, 0x00 },   // 'r'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x60, 0x78, 0x1E, 0x46, 0x7C, 0x00, 0x00, 0x00 },   // 's'
+    { 0x00, 0x00, 0x00, 0x30, 0x30, 0x7E, 0x30, 0x30, 0x30, 0x38, 0x1E, 0x00, 0x00, 0x00 },   // 't'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x7E, 0x00, 0x00, 0x00 },   // 'u'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0xE6, 0x66, 0x66, 0x3C, 0x3C, 0x18, 0x00, 0x00, 0x00 },   // 'v'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0xDB, 0xDB, 0xFE, 0x7E, 0x7E, 0x6E, 0x00, 0x00, 0x00 },   // 'w'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x3C, 0x3C, 0x3C, 0x7C, 0x66, 0x00, 0x00, 0x00 },   // 'x'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x66, 0x64, 0x3C, 0x3C, 0x18, 0x18, 0x70, 0x00 },   // 'y'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x0C, 0x1C, 0x38, 0x30, 0x7E, 0x00, 0x00, 0x00 },   // 'z'
+    { 0x00, 0x00, 0x1E, 0x18, 0x18, 0x18, 0x18, 0x70, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },   // '{'
+    { 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 },   // '|'
+    { 0x00, 0x00, 0x70, 0x18, 0x18, 0x18, 0x18, 0x0E, 0x18, 0x18, 0x18, 0x18, 0x70, 0x00 },   // '}'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x72, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '~'
+};
+
+#endif
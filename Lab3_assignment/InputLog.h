@@ -0,0 +1,278 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// ============================================================================
+// INPUT LOG - record a live session's input, replay it frame for frame
+// ============================================================================
+// Recording (--record file) writes, for every frame, the frame time step and
+// the state of the keys processInput() polls, plus every key / cursor /
+// scroll event the GLFW callbacks handle. Replaying (--replay file) feeds
+// the same time steps, polled keys and events back at the same points of
+// the same frames, so the simulation retraces the session exactly and a
+// hitch can be profiled offline.
+//
+// Events are delivered where they happened: GLFW reports them from
+// glfwPollEvents() at the end of a frame, and deliverEvents() is called in
+// the same place. While replaying, live events from the window are ignored.
+//
+// File layout (little endian):
+//   "BUSINPUT"  uint16 version  uint16 keyCount  int16 keys[keyCount]
+//   then records, each starting with a one-byte tag:
+//     FRAME   uint32 ms since start, float dt      (frame index = count)
+//     HELD    uint16 bitmask over keys[]           (only when it changes)
+//     KEY     uint32 us into frame, int16 key, uint8 action, uint8 mods
+//     CURSOR  uint32 us into frame, float x, float y
+//     SCROLL  uint32 us into frame, float dx, float dy
+// ============================================================================
+
+enum InputLogMode { INPUT_LOG_OFF, INPUT_LOG_RECORD, INPUT_LOG_REPLAY };
+
+enum InputLogTag : uint8_t {
+    INPUT_TAG_FRAME = 1,
+    INPUT_TAG_HELD = 2,
+    INPUT_TAG_KEY = 3,
+    INPUT_TAG_CURSOR = 4,
+    INPUT_TAG_SCROLL = 5
+};
+
+const uint16_t INPUT_LOG_VERSION = 1;
+const size_t INPUT_LOG_FLUSH_BYTES = 64 * 1024;
+
+// Keys polled by processInput(); bit i of a HELD mask is INPUT_LOG_KEYS[i]
+static const int16_t INPUT_LOG_KEYS[] = {
+    GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_SPACE,
+    GLFW_KEY_LEFT_CONTROL, GLFW_KEY_LEFT_SHIFT, GLFW_KEY_UP, GLFW_KEY_DOWN,
+    GLFW_KEY_LEFT, GLFW_KEY_RIGHT, GLFW_KEY_F
+};
+const int INPUT_LOG_KEY_COUNT = sizeof(INPUT_LOG_KEYS) / sizeof(INPUT_LOG_KEYS[0]);
+
+class InputLog {
+public:
+    InputLogMode mode = INPUT_LOG_OFF;
+
+    // Callbacks replayed events are sent to
+    GLFWkeyfun keyFn = nullptr;
+    GLFWcursorposfun cursorFn = nullptr;
+    GLFWscrollfun scrollFn = nullptr;
+
+    ~InputLog() { close(); }
+
+    bool recording() const { return mode == INPUT_LOG_RECORD; }
+    bool replaying() const { return mode == INPUT_LOG_REPLAY; }
+
+    bool startRecording(const std::string& file) {
+        out = fopen(file.c_str(), "wb");
+        if (!out) {
+            std::cout << "Input log: cannot write " << file << std::endl;
+            return false;
+        }
+        path = file;
+        mode = INPUT_LOG_RECORD;
+        start = frameStart = std::chrono::steady_clock::now();
+        buffer.reserve(INPUT_LOG_FLUSH_BYTES + 64);
+        buffer.insert(buffer.end(), "BUSINPUT", "BUSINPUT" + 8);
+        put(INPUT_LOG_VERSION);
+        put((uint16_t)INPUT_LOG_KEY_COUNT);
+        for (int i = 0; i < INPUT_LOG_KEY_COUNT; i++) put(INPUT_LOG_KEYS[i]);
+        std::cout << "Input log: recording to " << file << std::endl;
+        return true;
+    }
+
+    bool startReplay(const std::string& file) {
+        FILE* in = fopen(file.c_str(), "rb");
+        if (!in) {
+            std::cout << "Input log: cannot open " << file << std::endl;
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        long size = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        data.resize(size > 0 ? (size_t)size : 0);
+        size_t got = data.empty() ? 0 : fread(&data[0], 1, data.size(), in);
+        fclose(in);
+        data.resize(got);
+
+        pos = 0;
+        uint16_t version = 0, keyCount = 0;
+        if (data.size() < 12 || memcmp(&data[0], "BUSINPUT", 8) != 0) {
+            std::cout << "Input log: " << file << " is not an input log" << std::endl;
+            return false;
+        }
+        pos = 8;
+        get(version);
+        get(keyCount);
+        if (version != INPUT_LOG_VERSION) {
+            std::cout << "Input log: unsupported version " << version << std::endl;
+            return false;
+        }
+        replayKeys.assign(keyCount, 0);
+        for (uint16_t i = 0; i < keyCount; i++) get(replayKeys[i]);
+        path = file;
+        mode = INPUT_LOG_REPLAY;
+        std::cout << "Input log: replaying " << file << " (" << data.size() / 1024 << " KB)" << std::endl;
+        return true;
+    }
+
+    // Top of the frame. Recording: stores dt and the keys isHeld(key)
+    // reports. Replaying: overwrites dt with the recorded step; false once
+    // the log is exhausted.
+    template <typename HeldFn>
+    bool beginFrame(float& dt, HeldFn isHeld) {
+        if (recording()) {
+            frameStart = std::chrono::steady_clock::now();
+            put(INPUT_TAG_FRAME);
+            put((uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(frameStart - start).count());
+            put(dt);
+            uint16_t mask = 0;
+            for (int i = 0; i < INPUT_LOG_KEY_COUNT; i++)
+                if (isHeld(INPUT_LOG_KEYS[i])) mask |= (uint16_t)(1u << i);
+            if (frames == 0 || mask != heldMask) {
+                put(INPUT_TAG_HELD);
+                put(mask);
+            }
+            heldMask = mask;
+            frames++;
+            if (buffer.size() >= INPUT_LOG_FLUSH_BYTES) flush();
+            return true;
+        }
+        if (replaying()) {
+            if (pos >= data.size() || data[pos] != INPUT_TAG_FRAME) return false;
+            pos++;
+            uint32_t ms = 0;
+            get(ms);
+            get(dt);
+            if (pos < data.size() && data[pos] == INPUT_TAG_HELD) {
+                pos++;
+                get(heldMask);
+            }
+            frames++;
+            return true;
+        }
+        return true;
+    }
+
+    // Polled key state while replaying
+    bool held(int key) const {
+        for (size_t i = 0; i < replayKeys.size(); i++)
+            if (replayKeys[i] == key) return (heldMask >> i) & 1u;
+        return false;
+    }
+
+    // Call where glfwPollEvents() runs: sends this frame's logged events to
+    // the callbacks when replaying
+    void deliverEvents(GLFWwindow* window) {
+        if (!replaying()) return;
+        delivering = true;
+        while (pos < data.size() && data[pos] != INPUT_TAG_FRAME) {
+            uint8_t tag = data[pos++];
+            uint32_t us = 0;
+            if (tag == INPUT_TAG_HELD) { get(heldMask); continue; }
+            get(us);
+            if (tag == INPUT_TAG_KEY) {
+                int16_t key = 0;
+                uint8_t action = 0, mods = 0;
+                get(key); get(action); get(mods);
+                if (keyFn) keyFn(window, key, 0, action, mods);
+            } else if (tag == INPUT_TAG_CURSOR || tag == INPUT_TAG_SCROLL) {
+                float a = 0.0f, b = 0.0f;
+                get(a); get(b);
+                GLFWcursorposfun fn = tag == INPUT_TAG_CURSOR ? cursorFn : scrollFn;
+                if (fn) fn(window, a, b);
+            } else {
+                std::cout << "Input log: bad record at offset " << pos - 1 << std::endl;
+                pos = data.size();
+            }
+            events++;
+        }
+        delivering = false;
+    }
+
+    // Called first thing in each GLFW callback. Records the event; returns
+    // false for live events that a replay must ignore.
+    bool keyEvent(int key, int action, int mods) {
+        if (replaying()) return delivering;
+        if (recording()) {
+            put(INPUT_TAG_KEY);
+            put(sinceFrame());
+            put((int16_t)key);
+            put((uint8_t)action);
+            put((uint8_t)mods);
+            events++;
+        }
+        return true;
+    }
+    bool cursorEvent(double x, double y) { return pointerEvent(INPUT_TAG_CURSOR, x, y); }
+    bool scrollEvent(double dx, double dy) { return pointerEvent(INPUT_TAG_SCROLL, dx, dy); }
+
+    void close() {
+        if (recording()) {
+            flush();
+            fclose(out);
+            out = NULL;
+            std::cout << "Input log: wrote " << frames << " frames, " << events << " events ("
+                      << bytesWritten / 1024 << " KB) to " << path << std::endl;
+        } else if (replaying()) {
+            std::cout << "Input log: replayed " << frames << " frames, " << events << " events from "
+                      << path << (pos < data.size() ? " (stopped early)" : "") << std::endl;
+        }
+        mode = INPUT_LOG_OFF;
+    }
+
+private:
+    std::string path;
+    FILE* out = NULL;
+    std::vector<unsigned char> buffer;     // recording, flushed in blocks
+    std::vector<unsigned char> data;       // replay, whole file
+    size_t pos = 0;
+    size_t bytesWritten = 0;
+    std::vector<int16_t> replayKeys;
+    uint16_t heldMask = 0;
+    int frames = 0, events = 0;
+    bool delivering = false;
+    std::chrono::steady_clock::time_point start, frameStart;
+
+    bool pointerEvent(InputLogTag tag, double a, double b) {
+        if (replaying()) return delivering;
+        if (recording()) {
+            put(tag);
+            put(sinceFrame());
+            put((float)a);
+            put((float)b);
+            events++;
+        }
+        return true;
+    }
+
+    uint32_t sinceFrame() const {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - frameStart).count();
+    }
+
+    template <typename T> void put(T v) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        buffer.insert(buffer.end(), p, p + sizeof(T));
+    }
+
+    template <typename T> void get(T& v) {
+        if (pos + sizeof(T) > data.size()) { pos = data.size(); return; }
+        memcpy(&v, &data[pos], sizeof(T));
+        pos += sizeof(T);
+    }
+
+    void flush() {
+        if (!out || buffer.empty()) return;
+        bytesWritten += fwrite(buffer.data(), 1, buffer.size(), out);
+        buffer.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef INSTANCE_BATCH_H
+#define INSTANCE_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include "Shader.h"
+#include "GpuRegistry.h"
+#include "StreamRing.h"
+#include "FrameArena.h"
+
+// ============================================================================
+// INSTANCE BATCH - one instanced draw for many copies of a primitive
+// ============================================================================
+// Shares the primitive's VBO (pos3 + normal3 + texcoord2) and adds a
+// per-instance stream: model matrix (locations 3-6), color (7) and
+// material (8: x = texture-array layer or -1, y = textureMode).
+// Instances are collected with add() during the frame, in the frame arena,
+// and submitted with a single glDrawArraysInstanced in flush().
+//
+// With a stream ring the instances are copied into it instead of being
+// uploaded to instanceVBO. The instance attributes then point at the ring:
+// at offset 0 with the draw's base instance selecting the data when the
+// driver has base instance, otherwise re-pointed at each frame's offset.
+// ============================================================================
+
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec3 color;
+    glm::vec2 material;   // layer, textureMode
+};
+
+class InstanceBatch {
+public:
+    unsigned int VAO = 0, instanceVBO = 0;
+    unsigned int meshVBO = 0;       // the primitive's vertices
+    int vertexCount = 0;
+    FrameVector<InstanceData> instances;
+    StreamRing* ring = nullptr;
+
+    // meshVBO/meshVertexCount come from an initialized Cube/Cylinder/Cone
+    void init(unsigned int meshVBO, int meshVertexCount) {
+        this->meshVBO = meshVBO;
+        vertexCount = meshVertexCount;
+        VAO = gpuRegistry().genVertexArray("instance batch");
+        instanceVBO = gpuRegistry().genBuffer("instance batch");
+        glState().bindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        pointInstances(instanceVBO, 0);
+        for (int i = 3; i <= 8; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+
+        glState().bindVertexArray(0);
+    }
+
+    void add(const glm::mat4& model, const glm::vec3& color, float layer, int textureMode) {
+        InstanceData d;
+        d.model = model;
+        d.color = color;
+        // Untextured when the layer is not available yet
+        d.material = glm::vec2(layer, layer >= 0.0f ? (float)textureMode : 0.0f);
+        instances.push_back(d);
+    }
+
+    // Upload this frame's instances and draw them; the caller has the shader
+    // bound with the texture array on its unit
+    void flush(const Shader& shader) {
+        if (instances.empty()) return;
+        size_t bytes = instances.size() * sizeof(InstanceData);
+        size_t offset = 0;
+        void* dst = ring ? ring->alloc(bytes, sizeof(InstanceData), offset) : nullptr;
+        if (dst) {
+            memcpy(dst, instances.data(), bytes);
+            ring->flush();
+            bool baseInstance = glExtensions().baseInstance;
+            glState().bindVertexArray(VAO);
+            pointInstances(ring->buffer, baseInstance ? 0 : offset);
+            shader.setBool("instanced", true);
+            if (baseInstance)
+                glState().drawArraysInstancedBaseInstance(GL_TRIANGLES, 0, vertexCount, (GLsizei)instances.size(),
+                                                          (GLuint)(offset / sizeof(InstanceData)));
+            else
+                glState().drawArraysInstanced(GL_TRIANGLES, 0, vertexCount, (GLsizei)instances.size());
+            shader.setBool("instanced", false);
+            lastCount = (int)instances.size();
+            frameReset(instances);
+            return;
+        }
+        glState().bindVertexArray(VAO);
+        pointInstances(instanceVBO, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (bytes > capacityBytes) {
+            capacityBytes = bytes;
+            glBufferData(GL_ARRAY_BUFFER, capacityBytes, instances.data(), GL_STREAM_DRAW);
+            gpuRegistry().setBytes(GPU_BUFFER, instanceVBO, capacityBytes);
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, capacityBytes, NULL, GL_STREAM_DRAW);   // orphan
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        }
+        shader.setBool("instanced", true);
+        glState().drawArraysInstanced(GL_TRIANGLES, 0, vertexCount, (GLsizei)instances.size());
+        shader.setBool("instanced", false);
+        lastCount = (int)instances.size();
+        frameReset(instances);
+    }
+
+    int lastInstanceCount() const { return lastCount; }
+
+    void cleanup() {
+        gpuRegistry().deleteVertexArray(VAO);
+        gpuRegistry().deleteBuffer(instanceVBO);
+    }
+
+private:
+    size_t capacityBytes = 0;
+    int lastCount = 0;
+    unsigned int pointedBuffer = 0;     // where attributes 3-8 read, with the VAO bound
+    size_t pointedOffset = 0;
+
+    // Attributes 3-8 at buffer + offset; the VAO must be bound
+    void pointInstances(unsigned int buffer, size_t offset) {
+        if (buffer == pointedBuffer && offset == pointedOffset) return;
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        GLsizei stride = sizeof(InstanceData);
+        for (int i = 0; i < 4; i++) {
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, stride,
+                                  (void*)(offset + offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+        }
+        glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(InstanceData, color)));
+        glVertexAttribPointer(8, 2, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(InstanceData, material)));
+        pointedBuffer = buffer;
+        pointedOffset = offset;
+    }
+};
+
+#endif
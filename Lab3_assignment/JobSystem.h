@@ -0,0 +1,343 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include "Profiler.h"
+
+// ============================================================================
+// JOB SYSTEM - fixed worker pool with per-thread work-stealing deques
+// ============================================================================
+// init(threads) starts threads - 1 workers; the calling (main) thread is
+// worker 0 and runs jobs only while it waits. Every worker owns a deque: it
+// pushes and pops at the back (newest first, still in cache), idle workers
+// steal from the front of other workers' deques. The deques are fixed-size
+// rings behind a per-deque spin lock (an owner and the odd thief contend,
+// nothing else); a push to a full deque runs the job inline instead.
+//
+// A Job is a function pointer, a context pointer and an index range. run()
+// counts it on its JobCounter, which the job decrements when it finishes.
+// wait(counter) never sleeps while there is work: the waiting thread runs
+// queued jobs (its own first, then stolen ones) until the counter is zero.
+// A job may depend on another counter (after): run() parks it until that
+// counter reaches zero, and the thread finishing the counter's last job
+// queues it, so a dependent job is never taken early.
+//
+// parallelFor(count, grain, fn) queues [0, count) as grain-sized ranges,
+// calls fn(begin, end) for each and returns when all are done. Idle workers
+// spin briefly, then sleep until work is queued. Nothing allocates after
+// init().
+// ============================================================================
+
+const int JOB_DEQUE_SIZE = 4096;      // jobs per deque (power of two)
+const int JOB_SPIN_ROUNDS = 64;       // empty polls before an idle worker sleeps
+
+typedef void (*JobFn)(void* data, int begin, int end);
+
+struct JobCounter {
+    std::atomic<int> pending;
+    JobCounter() : pending(0) {}
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job {
+    JobFn fn;
+    void* data;
+    int begin, end;
+    JobCounter* counter;
+    const JobCounter* after;    // start only once this is zero (may be null)
+};
+
+class JobSystem {
+public:
+    // Per-worker totals since the last resetStats()
+    struct WorkerStats {
+        uint64_t jobs;
+        uint64_t steals;
+    };
+
+    ~JobSystem() { shutdown(); }
+
+    // threads <= 0: one per hardware thread
+    void init(int threads) {
+        shutdown();
+        if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        count = threads;
+        quit.store(false);
+        deques.clear();
+        for (int i = 0; i < count; i++) deques.emplace_back(new JobDeque());
+        while ((int)names.size() < count) names.push_back("job worker " + std::to_string(names.size()));
+        workerIndex() = 0;
+        for (int i = 1; i < count; i++) threads_.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    void shutdown() {
+        if (threads_.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            quit.store(true);
+        }
+        sleepCv.notify_all();
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+    }
+
+    int threadCount() const { return count; }
+
+    // Queue one job; its counters must outlive it
+    void run(Job job) {
+        job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+        if (job.after) {
+            {
+                std::lock_guard<std::mutex> lock(parkMutex);
+                if (!job.after->done() && parkedCount < JOB_DEQUE_SIZE) {
+                    parked[parkedCount++] = job;
+                    return;
+                }
+            }
+            wait(*job.after);       // parking space full: help until it is done
+        }
+        push(job);
+        wake();
+    }
+
+    // Runs queued jobs on this thread until counter is zero
+    void wait(const JobCounter& counter) {
+        int me = self();
+        while (!counter.done()) {
+            Job job;
+            if (take(me, job)) execute(me, job);
+            else std::this_thread::yield();
+        }
+    }
+
+    template <typename F>
+    void parallelFor(int n, int grain, const F& fn) {
+        if (n <= 0) return;
+        grain = std::max(grain, 1);
+        if (count == 1 || n <= grain) {
+            fn(0, n);
+            return;
+        }
+        JobCounter counter;
+        for (int b = 0; b < n; b += grain) {
+            Job job = { &invoke<F>, (void*)&fn, b, std::min(b + grain, n), &counter, nullptr };
+            counter.pending.fetch_add(1, std::memory_order_relaxed);
+            push(job);
+        }
+        wake();
+        wait(counter);
+    }
+
+    WorkerStats stats(int worker) const {
+        const JobDeque& d = *deques[worker];
+        WorkerStats s = { d.jobs.load(std::memory_order_relaxed), d.steals.load(std::memory_order_relaxed) };
+        return s;
+    }
+
+    WorkerStats totals() const {
+        WorkerStats t = { 0, 0 };
+        for (int i = 0; i < count; i++) {
+            t.jobs += stats(i).jobs;
+            t.steals += stats(i).steals;
+        }
+        return t;
+    }
+
+    void resetStats() {
+        for (auto& d : deques) {
+            d->jobs.store(0);
+            d->steals.store(0);
+        }
+    }
+
+private:
+    struct JobDeque {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        Job jobs_[JOB_DEQUE_SIZE];
+        uint32_t head = 0, tail = 0;        // steal at head, owner at tail
+        std::atomic<uint64_t> jobs{ 0 }, steals{ 0 };
+
+        void acquire() { while (lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield(); }
+        void release() { lock.clear(std::memory_order_release); }
+
+        bool pushBack(const Job& j) {
+            acquire();
+            bool ok = tail - head < (uint32_t)JOB_DEQUE_SIZE;
+            if (ok) jobs_[tail++ & (JOB_DEQUE_SIZE - 1)] = j;
+            release();
+            return ok;
+        }
+        bool popBack(Job& j) {
+            acquire();
+            bool ok = tail != head;
+            if (ok) j = jobs_[--tail & (JOB_DEQUE_SIZE - 1)];
+            release();
+            return ok;
+        }
+        bool popFront(Job& j) {
+            acquire();
+            bool ok = tail != head;
+            if (ok) j = jobs_[head++ & (JOB_DEQUE_SIZE - 1)];
+            release();
+            return ok;
+        }
+    };
+
+    int count = 1;
+    std::vector<std::unique_ptr<JobDeque> > deques;
+    std::vector<std::thread> threads_;
+    std::deque<std::string> names;              // profiler labels: stored by pointer, never moved
+    std::atomic<int> queued{ 0 };               // jobs in all deques
+    std::atomic<int> sleeping{ 0 };
+    std::atomic<bool> quit{ false };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    std::mutex parkMutex;                       // parked jobs, and counters reaching zero
+    Job parked[JOB_DEQUE_SIZE];
+    int parkedCount = 0;
+    std::atomic<int> parkedReady{ 0 };          // released but no deque had room
+
+    static int& workerIndex() {
+        static thread_local int index = 0;      // threads outside the pool use deque 0
+        return index;
+    }
+    int self() const { return std::min(workerIndex(), count - 1); }
+
+    template <typename F>
+    static void invoke(void* data, int begin, int end) { (*(const F*)data)(begin, end); }
+
+    // Into this thread's deque, else any other; false when all are full
+    bool pushAny(const Job& job) {
+        for (int k = 0; k < count; k++) {
+            if (deques[(self() + k) % count]->pushBack(job)) {
+                queued.fetch_add(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void push(const Job& job) {
+        if (!deques[self()]->pushBack(job)) {
+            // Deque full: run it here rather than grow
+            execute(self(), job);
+            return;
+        }
+        queued.fetch_add(1);
+    }
+
+    // Dekker-style handshake with workerLoop: a worker raises sleeping
+    // before re-checking queued, we raise queued before checking sleeping
+    void wake() {
+        if (sleeping.load() == 0) return;
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        sleepCv.notify_all();
+    }
+
+    bool take(int me, Job& job) {
+        if (queued.load(std::memory_order_relaxed) > 0) {
+            if (deques[me]->popBack(job)) {
+                queued.fetch_sub(1);
+                return true;
+            }
+            // Steal from the others, starting at a per-thread random victim
+            static thread_local uint32_t seed = 0x9E3779B9u;
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            for (int k = 0; k < count; k++) {
+                int victim = (int)((seed + (uint32_t)k) % (uint32_t)count);
+                if (victim == me) continue;
+                if (deques[victim]->popFront(job)) {
+                    queued.fetch_sub(1);
+                    deques[me]->steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        // Released jobs that found every deque full
+        if (parkedReady.load() > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            for (int i = 0; i < parkedCount; i++) {
+                if (parked[i].after) continue;
+                job = parked[i];
+                parked[i] = parked[--parkedCount];
+                parkedReady.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(int me, const Job& job) {
+        job.fn(job.data, job.begin, job.end);
+        deques[me]->jobs.fetch_add(1, std::memory_order_relaxed);
+        finish(job.counter);
+    }
+
+    // Decrements counter. The last decrement happens under parkMutex, with
+    // the jobs parked on the counter queued before anyone sees it at zero
+    // (and can reuse its address for a new counter).
+    void finish(JobCounter* counter) {
+        int v = counter->pending.load(std::memory_order_relaxed);
+        for (;;) {
+            if (v > 1) {
+                if (counter->pending.compare_exchange_weak(v, v - 1, std::memory_order_acq_rel)) return;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(parkMutex);
+            if (!counter->pending.compare_exchange_strong(v, 0, std::memory_order_acq_rel)) continue;
+            bool released = false;
+            for (int i = 0; i < parkedCount; i++) {
+                if (parked[i].after != counter) continue;
+                parked[i].after = nullptr;
+                if (pushAny(parked[i])) {
+                    parked[i--] = parked[--parkedCount];
+                } else {
+                    parkedReady.fetch_add(1);
+                }
+                released = true;
+            }
+            if (released) wake();
+            return;
+        }
+    }
+
+    void workerLoop(int index) {
+        workerIndex() = index;
+        profiler().setThreadName(names[index].c_str());
+        int idle = 0;
+        while (!quit.load(std::memory_order_relaxed)) {
+            Job job;
+            if (take(index, job)) {
+                execute(index, job);
+                idle = 0;
+                continue;
+            }
+            if (++idle < JOB_SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            sleepCv.wait(lock, [this] { return quit.load() || queued.load() > 0 || parkedReady.load() > 0; });
+            sleeping.fetch_sub(1);
+            idle = 0;
+        }
+    }
+};
+
+inline JobSystem& jobSystem() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+// ============================================================================
+// LIGHTING - the scene's lights as data, mirrored into shader.vert/.frag
+// ============================================================================
+// One directional light, NR_POINT_LIGHTS (4) point lights around the bus and
+// the camera's spot light, with the light-type and component toggles. The
+// app fills a SceneLighting each frame; apply() writes it into the uniforms
+// of the same names, and the software rasterizer (SoftRaster.h) shades with
+// it directly.
+// ============================================================================
+
+const int SCENE_POINT_LIGHTS = 4;   // NR_POINT_LIGHTS in the shaders
+
+struct DirLight {
+    glm::vec3 direction;
+    glm::vec3 ambient, diffuse, specular;
+};
+
+struct PointLight {
+    glm::vec3 position;
+    glm::vec3 ambient, diffuse, specular;
+    float constant, linear, quadratic;
+};
+
+struct SpotLight {
+    glm::vec3 position, direction;
+    glm::vec3 ambient, diffuse, specular;
+    float cutOff;               // cos(cutoff angle)
+    float constant, linear, quadratic;
+};
+
+struct SceneLighting {
+    DirLight dirLight;
+    PointLight pointLights[SCENE_POINT_LIGHTS];
+    SpotLight spotLight;
+    float shininess = 32.0f;
+    bool dirLightOn = true, pointLightsOn = true, spotLightOn = true;
+    bool ambientOn = true, diffuseOn = true, specularOn = true;
+
+    void apply(const Shader& shader) const {
+        shader.setVec3("dirLight.direction", dirLight.direction);
+        shader.setVec3("dirLight.ambient",   dirLight.ambient);
+        shader.setVec3("dirLight.diffuse",   dirLight.diffuse);
+        shader.setVec3("dirLight.specular",  dirLight.specular);
+
+        // Fixed strings: the shader caches locations by name pointer
+        static const char* const names[SCENE_POINT_LIGHTS][7] = {
+            { "pointLights[0].position", "pointLights[0].ambient", "pointLights[0].diffuse",
+              "pointLights[0].specular", "pointLights[0].constant", "pointLights[0].linear",
+              "pointLights[0].quadratic" },
+            { "pointLights[1].position", "pointLights[1].ambient", "pointLights[1].diffuse",
+              "pointLights[1].specular", "pointLights[1].constant", "pointLights[1].linear",
+              "pointLights[1].quadratic" },
+            { "pointLights[2].position", "pointLights[2].ambient", "pointLights[2].diffuse",
+              "pointLights[2].specular", "pointLights[2].constant", "pointLights[2].linear",
+              "pointLights[2].quadratic" },
+            { "pointLights[3].position", "pointLights[3].ambient", "pointLights[3].diffuse",
+              "pointLights[3].specular", "pointLights[3].constant", "pointLights[3].linear",
+              "pointLights[3].quadratic" }
+        };
+        for (int i = 0; i < SCENE_POINT_LIGHTS; i++) {
+            const PointLight& p = pointLights[i];
+            shader.setVec3(names[i][0], p.position);
+            shader.setVec3(names[i][1], p.ambient);
+            shader.setVec3(names[i][2], p.diffuse);
+            shader.setVec3(names[i][3], p.specular);
+            shader.setFloat(names[i][4], p.constant);
+            shader.setFloat(names[i][5], p.linear);
+            shader.setFloat(names[i][6], p.quadratic);
+        }
+
+        shader.setVec3("spotLight.position",  spotLight.position);
+        shader.setVec3("spotLight.direction", spotLight.direction);
+        shader.setVec3("spotLight.ambient",   spotLight.ambient);
+        shader.setVec3("spotLight.diffuse",   spotLight.diffuse);
+        shader.setVec3("spotLight.specular",  spotLight.specular);
+        shader.setFloat("spotLight.constant",  spotLight.constant);
+        shader.setFloat("spotLight.linear",    spotLight.linear);
+        shader.setFloat("spotLight.quadratic", spotLight.quadratic);
+        shader.setFloat("spotLight.cutOff",    spotLight.cutOff);
+
+        shader.setFloat("shininess", shininess);
+
+        shader.setBool("dirLightOn",    dirLightOn);
+        shader.setBool("pointLightsOn", pointLightsOn);
+        shader.setBool("spotLightOn",   spotLightOn);
+        shader.setBool("ambientOn",     ambientOn);
+        shader.setBool("diffuseOn",     diffuseOn);
+        shader.setBool("specularOn",    specularOn);
+    }
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <vector>
 #include <cmath>
 #include "Shader.h"
+#include "GpuRegistry.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -71,11 +72,12 @@ public:
         };
         vertexCount = 36;
 
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        VAO = gpuRegistry().genVertexArray("cube mesh");
+        VBO = gpuRegistry().genBuffer("cube mesh");
+        glState().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        gpuRegistry().setBufferData(VBO, vertices, sizeof(vertices));
         // position
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
@@ -86,21 +88,21 @@ public:
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
 
-        glBindVertexArray(0);
+        glState().bindVertexArray(0);
         initialized = true;
     }
 
     void draw(const Shader& shader, glm::mat4 model, glm::vec3 color) {
         shader.setVec3("objectColor", color);
         shader.setMat4("model", model);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glState().bindVertexArray(VAO);
+        glState().drawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void cleanup() {
         if (initialized) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
+            gpuRegistry().deleteVertexArray(VAO);
+            gpuRegistry().deleteBuffer(VBO);
             initialized = false;
         }
     }
@@ -164,32 +166,33 @@ public:
         }
 
         vertexCount = (int)vertices.size() / 8;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        VAO = gpuRegistry().genVertexArray("cylinder mesh");
+        VBO = gpuRegistry().genBuffer("cylinder mesh");
+        glState().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        gpuRegistry().setBufferData(VBO, vertices.data(), vertices.size() * sizeof(float));
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        glState().bindVertexArray(0);
         initialized = true;
     }
 
     void draw(const Shader& shader, glm::mat4 model, glm::vec3 color) {
         shader.setVec3("objectColor", color);
         shader.setMat4("model", model);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glState().bindVertexArray(VAO);
+        glState().drawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void cleanup() {
         if (initialized) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
+            gpuRegistry().deleteVertexArray(VAO);
+            gpuRegistry().deleteBuffer(VBO);
             initialized = false;
         }
     }
@@ -245,32 +248,33 @@ public:
         }
 
         vertexCount = (int)vertices.size() / 8;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        VAO = gpuRegistry().genVertexArray("torus mesh");
+        VBO = gpuRegistry().genBuffer("torus mesh");
+        glState().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        gpuRegistry().setBufferData(VBO, vertices.data(), vertices.size() * sizeof(float));
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        glState().bindVertexArray(0);
         initialized = true;
     }
 
     void draw(const Shader& shader, glm::mat4 model, glm::vec3 color) {
         shader.setVec3("objectColor", color);
         shader.setMat4("model", model);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glState().bindVertexArray(VAO);
+        glState().drawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void cleanup() {
         if (initialized) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
+            gpuRegistry().deleteVertexArray(VAO);
+            gpuRegistry().deleteBuffer(VBO);
             initialized = false;
         }
     }
@@ -324,32 +328,33 @@ public:
         }
 
         vertexCount = (int)vertices.size() / 8;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        VAO = gpuRegistry().genVertexArray("sphere mesh");
+        VBO = gpuRegistry().genBuffer("sphere mesh");
+        glState().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        gpuRegistry().setBufferData(VBO, vertices.data(), vertices.size() * sizeof(float));
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        glState().bindVertexArray(0);
         initialized = true;
     }
 
     void draw(const Shader& shader, glm::mat4 model, glm::vec3 color) {
         shader.setVec3("objectColor", color);
         shader.setMat4("model", model);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glState().bindVertexArray(VAO);
+        glState().drawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void cleanup() {
         if (initialized) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
+            gpuRegistry().deleteVertexArray(VAO);
+            gpuRegistry().deleteBuffer(VBO);
             initialized = false;
         }
     }
@@ -410,32 +415,33 @@ public:
         }
 
         vertexCount = (int)vertices.size() / 8;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        VAO = gpuRegistry().genVertexArray("cone mesh");
+        VBO = gpuRegistry().genBuffer("cone mesh");
+        glState().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        gpuRegistry().setBufferData(VBO, vertices.data(), vertices.size() * sizeof(float));
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
-        glBindVertexArray(0);
+        glState().bindVertexArray(0);
         initialized = true;
     }
 
     void draw(const Shader& shader, glm::mat4 model, glm::vec3 color) {
         shader.setVec3("objectColor", color);
         shader.setMat4("model", model);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glState().bindVertexArray(VAO);
+        glState().drawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void cleanup() {
         if (initialized) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
+            gpuRegistry().deleteVertexArray(VAO);
+            gpuRegistry().deleteBuffer(VBO);
             initialized = false;
         }
     }
@@ -0,0 +1,190 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+// ============================================================================
+// PROFILER - scoped CPU zones with Chrome trace export
+// ============================================================================
+// PROFILE_ZONE("name") opens a zone that closes at the end of the enclosing
+// scope. Each thread writes finished zones into its own fixed-size ring
+// buffer (no locks on the hot path); the oldest events are overwritten once
+// a ring is full. Timestamps are steady_clock nanoseconds since startup.
+//
+// Recording is off by default. A disabled zone costs an initialized-static
+// check, one relaxed atomic load and a branch. Define PROFILER_COMPILED_OUT
+// to remove zones entirely: PROFILE_ZONE expands to nothing, and ProfileZone
+// (for zones closed early with end()) becomes an empty class.
+//
+// writeChromeTrace() dumps every ring as trace-event JSON ("ph":"X"
+// complete events plus thread names), which loads in Perfetto or
+// chrome://tracing. Zone names must be string literals (the pointer is
+// stored, not the text).
+// ============================================================================
+
+const size_t PROFILER_RING_SIZE = 1 << 16;     // events per thread
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+struct ProfileThread {
+    std::string name;
+    int id = 0;
+    std::vector<ProfileEvent> ring;
+    std::atomic<uint64_t> written;     // total events ever written
+    ProfileThread() : ring(PROFILER_RING_SIZE), written(0) {}
+};
+
+class Profiler {
+public:
+    std::atomic<bool> enabled;
+
+    Profiler() : enabled(false), origin(std::chrono::steady_clock::now()) {}
+
+    uint64_t nowNs() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // This thread's ring, created on its first recorded zone. Rings are owned
+    // here so they outlive worker threads that exit before the dump.
+    ProfileThread& thisThread() {
+        ProfileThread*& mine = threadSlot();
+        if (!mine) {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.emplace_back(new ProfileThread());
+            mine = threads.back().get();
+            mine->id = (int)threads.size();
+            mine->name = threadLabel() ? threadLabel() : "thread " + std::to_string(mine->id);
+        }
+        return *mine;
+    }
+
+    // Label for the calling thread in the trace (cheap; no ring is created)
+    void setThreadName(const char* name) {
+        threadLabel() = name;
+        if (threadSlot()) threadSlot()->name = name;
+    }
+
+    void record(const char* name, uint64_t startNs, uint64_t endNs) {
+        ProfileThread& t = thisThread();
+        uint64_t n = t.written.load(std::memory_order_relaxed);
+        ProfileEvent& e = t.ring[n % PROFILER_RING_SIZE];
+        e.name = name;
+        e.startNs = startNs;
+        e.endNs = endNs;
+        t.written.store(n + 1, std::memory_order_release);
+    }
+
+    size_t eventCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = 0;
+        for (auto& t : threads) n += (size_t)std::min<uint64_t>(t->written.load(), PROFILER_RING_SIZE);
+        return n;
+    }
+
+    // Write all buffered zones as Chrome trace-event JSON. Best called
+    // with recording stopped; events written during the dump may be torn.
+    bool writeChromeTrace(const char* path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cout << "Profiler: cannot write " << path << std::endl;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        size_t count = 0;
+        char buf[256];
+        for (auto& t : threads) {
+            snprintf(buf, sizeof(buf),
+                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     t->id, t->name.c_str());
+            out << (first ? "" : ",\n") << buf;
+            first = false;
+            uint64_t end = t->written.load(std::memory_order_acquire);
+            uint64_t begin = end > PROFILER_RING_SIZE ? end - PROFILER_RING_SIZE : 0;
+            for (uint64_t i = begin; i < end; i++) {
+                const ProfileEvent& e = t->ring[i % PROFILER_RING_SIZE];
+                snprintf(buf, sizeof(buf),
+                         "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         e.name, t->id, e.startNs / 1000.0, (e.endNs - e.startNs) / 1000.0);
+                out << ",\n" << buf;
+                count++;
+            }
+        }
+        out << "\n]}\n";
+        std::cout << "Profiler: wrote " << count << " zones from " << threads.size()
+                  << " threads to " << path << std::endl;
+        return true;
+    }
+
+private:
+    std::chrono::steady_clock::time_point origin;
+
+    static ProfileThread*& threadSlot() {
+        thread_local ProfileThread* mine = nullptr;
+        return mine;
+    }
+    static const char*& threadLabel() {
+        thread_local const char* label = nullptr;
+        return label;
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ProfileThread> > threads;
+};
+
+inline Profiler& profiler() {
+    static Profiler p;
+    return p;
+}
+
+#ifdef PROFILER_COMPILED_OUT
+class ProfileZone {
+public:
+    explicit ProfileZone(const char*) {}
+    void end() {}
+};
+#else
+// RAII zone: timestamps on entry only if recording is on
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* zoneName) : name(zoneName), startNs(0) {
+        if (profiler().enabled.load(std::memory_order_relaxed)) startNs = profiler().nowNs() | 1;
+    }
+    ~ProfileZone() { end(); }
+
+    // Close the zone before the end of its scope
+    void end() {
+        if (startNs) profiler().record(name, startNs, profiler().nowNs());
+        startNs = 0;
+    }
+private:
+    const char* name;
+    uint64_t startNs;     // 0 = not recording (low bit forced on otherwise)
+};
+#endif
+
+#define PROFILER_CONCAT2(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT2(a, b)
+#ifdef PROFILER_COMPILED_OUT
+#define PROFILE_ZONE(name) ((void)0)
+#else
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(profileZone_, __LINE__)(name)
+#endif
+
+#endif
@@ -0,0 +1,640 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "Shader.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "GpuRegistry.h"
+#include "StreamRing.h"
+#include "TextureCache.h"
+#include "InstanceBatch.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+
+// ============================================================================
+// RENDER QUEUE - deferred draws, sorted by state before submission
+// ============================================================================
+// Scene code records draws with draw() / drawBatch() instead of issuing GL
+// calls. Each command is small (mesh, transform index, material, blend class,
+// color, alpha) and gets a 64-bit sort key; submit() radix-sorts the keys and
+// issues the whole frame in one pass:
+//
+//   opaque       [63:62] blend 0 | [61:50] material | [49:42] mesh | [41:18] depth (near first)
+//   translucent  [63:62] blend   | [61:38] ~depth (far first) | [37:26] material | [25:18] mesh
+//
+// so every opaque draw comes before every blended one, opaque draws are
+// grouped by material (texture + textureMode + emissive), then by mesh, and
+// go front-to-back inside each group; blended draws go back-to-front. Depth
+// is the view space distance of the transform's origin, quantized to 24
+// bits over [0, farPlane]. The sort is an LSD radix sort over 8-bit digits that skips
+// digits all keys share, so the unused low bits cost nothing; it is stable,
+// so draws with equal keys keep their recording order.
+//
+// Additive draws (flames, hover glow) blend with GL_SRC_ALPHA / GL_ONE and
+// test against but do not write depth, exactly as the immediate code did.
+//
+// Materials and meshes are interned into small tables the first time they
+// are seen. The per-frame arrays (commands, transforms, keys, records) are
+// FrameVectors: begin() reserves them in the frame arena at the largest
+// count a frame has recorded so far, so a frame never touches the heap.
+// Stats count material / mesh / blend changes in submission order next to
+// the count the same frame would have had unsorted.
+//
+// Submission modes (submitMode, clamped to what the driver offers):
+//
+//   uniforms       model / objectColor / alpha uniforms and one glDrawArrays
+//                  per command (GL 3.3 core, the original path)
+//   base instance  every transform, color and alpha goes into one texture
+//                  buffer (drawData, 5 RGBA32F texels per draw) and every
+//                  mesh into one pooled VBO; each command is a single
+//                  glDrawArraysInstancedBaseInstance whose base instance is
+//                  its record index (GL 4.2 / ARB_base_instance)
+//   indirect       as base instance, but the commands go into an indirect
+//                  buffer and each state bucket (run of sorted commands with
+//                  the same blend and material) is one glMultiDrawArraysIndirect
+//                  (GL 4.3 / ARB_multi_draw_indirect)
+//
+// shader.vert reads the record index from an instanced int attribute
+// (location 9, 0..N-1, divisor 1) rather than gl_DrawID, which needs GL 4.6;
+// with a divisor the fetch already includes the base instance. Instance
+// batches keep their own VAO and draw, and split buckets. submitMs is the
+// CPU time of submit() after the sort.
+//
+// With a stream ring (set ring before init()), the records and indirect
+// commands are written straight into the ring; drawDataBase tells the
+// shader where this frame's records start. The queue's own buffers are
+// the fallback when the ring is full or too big for a texture buffer.
+//
+// Other backends (SoftRaster.h) can read the recorded frame: sort(), then
+// sortedCommand(k) for k < size() with transform(), meshOf() and materialOf() of
+// each command. The data stays valid until submit().
+// ============================================================================
+
+enum RenderBlend {
+    RENDER_OPAQUE = 0,
+    RENDER_ADDITIVE = 1         // GL_SRC_ALPHA, GL_ONE, no depth write
+};
+
+struct RenderMaterial {
+    unsigned int texture;       // TextureCache handle, 0 = untextured
+    int textureMode;            // used when the texture resolves
+    bool emissive;
+};
+
+enum RenderSubmitMode {
+    RENDER_SUBMIT_UNIFORMS = 0,
+    RENDER_SUBMIT_BASE_INSTANCE,
+    RENDER_SUBMIT_INDIRECT,
+    RENDER_SUBMIT_MODE_COUNT
+};
+
+static const char* const renderSubmitModeNames[RENDER_SUBMIT_MODE_COUNT] = {
+    "uniforms", "base instance", "indirect"
+};
+
+struct RenderMesh {
+    unsigned int VAO;
+    unsigned int VBO;           // source of the pooled copy, 0 = not poolable
+    int first, count;
+    int poolFirst;              // first vertex in the pooled VBO, -1 = not copied yet
+};
+
+struct DrawCommand {
+    uint16_t mesh;
+    uint16_t material;
+    uint8_t blend;
+    uint32_t transform;         // index into the frame's transforms
+    glm::vec3 color;
+    float alpha;
+    InstanceBatch* batch;       // flushed instead of a mesh draw when set
+};
+
+struct RenderQueueStats {
+    int commands = 0, opaque = 0, blended = 0;
+    int materialChanges = 0, meshChanges = 0, blendChanges = 0;
+    int unsortedMaterialChanges = 0, unsortedMeshChanges = 0, unsortedBlendChanges = 0;
+    int sortPasses = 0;         // radix digits that needed a scatter
+    int drawCalls = 0;          // mesh draws + batch flushes issued by submit()
+    double submitMs = 0.0;
+};
+
+const int RENDER_QUEUE_MATERIAL_BITS = 12;
+const int RENDER_QUEUE_MESH_BITS = 8;
+const int RENDER_QUEUE_DEPTH_BITS = 24;
+const int RENDER_DRAW_DATA_TEXELS = 5;      // model columns 0-3, color + alpha
+const int RENDER_DRAW_DATA_UNIT = 2;        // texture unit of the drawData buffer
+const int RENDER_VERTEX_FLOATS = 8;         // pos3 + normal3 + texcoord2, as Primitives.h
+
+class RenderQueue {
+public:
+    TextureCache* textures = nullptr;
+    float farPlane = 500.0f;
+    RenderSubmitMode submitMode = RENDER_SUBMIT_UNIFORMS;
+    StreamRing* ring = nullptr;     // per-frame records and commands, when set
+    RenderQueueStats stats, lastFrameStats;
+
+    void init(size_t reserveCommands = 1024) {
+        commandHint = reserveCommands;
+        materials.reserve(64);
+        meshes.reserve(16);
+        material(0, 0, false);      // id 0: untextured, lit
+
+        poolVAO = gpuRegistry().genVertexArray("render queue");
+        poolVBO = gpuRegistry().genBuffer("render queue");
+        drawIndexVBO = gpuRegistry().genBuffer("render queue");
+        drawDataBuffer = gpuRegistry().genBuffer("render queue");
+        indirectBuffer = gpuRegistry().genBuffer("render queue");
+        drawDataTexture = gpuRegistry().genTexture("render queue");
+
+        glState().bindVertexArray(poolVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, poolVBO);
+        GLsizei stride = RENDER_VERTEX_FLOATS * sizeof(float);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        growDrawIndices(reserveCommands);
+        glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void*)0);
+        glEnableVertexAttribArray(9);
+        glVertexAttribDivisor(9, 1);
+        glState().bindVertexArray(0);
+
+        glBindBuffer(GL_TEXTURE_BUFFER, drawDataBuffer);
+        drawDataBytes = reserveCommands * RENDER_DRAW_DATA_TEXELS * sizeof(glm::vec4);
+        glBufferData(GL_TEXTURE_BUFFER, drawDataBytes, NULL, GL_STREAM_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, drawDataBuffer, drawDataBytes);
+        glState().bindTexture(RENDER_DRAW_DATA_UNIT, GL_TEXTURE_BUFFER, drawDataTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, drawDataBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        // The whole ring as one texture buffer, if it has few enough texels
+        GLint maxTexels = 65536;    // the GL 3.3 minimum, kept if the query fails
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if (ring && ring->totalBytes() / sizeof(glm::vec4) <= (size_t)maxTexels) {
+            ringTexture = gpuRegistry().genTexture("render queue");
+            glState().bindTexture(RENDER_DRAW_DATA_UNIT, GL_TEXTURE_BUFFER, ringTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, ring->buffer);
+        }
+    }
+
+    // Picks mode, or the best one below it the driver supports; returns it
+    RenderSubmitMode setSubmitMode(RenderSubmitMode mode) {
+        if (mode == RENDER_SUBMIT_INDIRECT && !glExtensions().multiDrawIndirect) mode = RENDER_SUBMIT_BASE_INSTANCE;
+        if (mode == RENDER_SUBMIT_BASE_INSTANCE && !glExtensions().baseInstance) mode = RENDER_SUBMIT_UNIFORMS;
+        submitMode = mode;
+        return mode;
+    }
+
+    void cleanup() {
+        gpuRegistry().deleteVertexArray(poolVAO);
+        gpuRegistry().deleteBuffer(poolVBO);
+        gpuRegistry().deleteBuffer(drawIndexVBO);
+        gpuRegistry().deleteBuffer(drawDataBuffer);
+        gpuRegistry().deleteBuffer(indirectBuffer);
+        gpuRegistry().deleteTexture(drawDataTexture);
+        gpuRegistry().deleteTexture(ringTexture);
+    }
+
+    // Start recording; view is the camera used for depth keys
+    void begin(const glm::mat4& viewMatrix) {
+        view = viewMatrix;
+        sorted = false;
+        frameReset(commands, commandHint);
+        frameReset(transforms, commandHint);
+        frameReset(keys, commandHint);
+    }
+
+    // Material id for a texture handle / mode / emissive flag
+    int material(unsigned int texture, int textureMode, bool emissive = false) {
+        for (size_t i = 0; i < materials.size(); i++) {
+            const RenderMaterial& m = materials[i];
+            if (m.texture == texture && m.textureMode == textureMode && m.emissive == emissive) return (int)i;
+        }
+        RenderMaterial m = { texture, textureMode, emissive };
+        materials.push_back(m);
+        return (int)materials.size() - 1;
+    }
+
+    // Any primitive with VAO / vertexCount (Cube, Cylinder, Torus, ...)
+    template <typename Primitive>
+    void draw(const Primitive& shape, const glm::mat4& model, const glm::vec3& color,
+              int materialId = 0, RenderBlend blend = RENDER_OPAQUE, float alpha = 1.0f) {
+        drawRange(shape.VAO, shape.VBO, 0, shape.vertexCount, model, color, materialId, blend, alpha);
+    }
+
+    // count vertices from first of a VAO (vbo: their source, 0 = not poolable)
+    void drawRange(unsigned int vao, unsigned int vbo, int first, int count, const glm::mat4& model,
+                   const glm::vec3& color, int materialId = 0, RenderBlend blend = RENDER_OPAQUE,
+                   float alpha = 1.0f) {
+        DrawCommand c;
+        c.mesh = (uint16_t)mesh(vao, vbo, first, count);
+        c.material = (uint16_t)materialId;
+        c.blend = (uint8_t)blend;
+        c.transform = (uint32_t)transforms.size();
+        c.color = color;
+        c.alpha = alpha;
+        c.batch = nullptr;
+        transforms.push_back(model);
+        push(c, viewDepth(model));
+    }
+
+    // An instance batch (the city) as one opaque command. Batches span the
+    // scene, so they key at the far plane: after nearer draws of the material.
+    void drawBatch(InstanceBatch& batch, int materialId = 0) {
+        if (batch.instances.empty()) return;
+        DrawCommand c;
+        c.mesh = (uint16_t)mesh(batch.VAO, 0, 0, batch.vertexCount);
+        c.material = (uint16_t)materialId;
+        c.blend = RENDER_OPAQUE;
+        c.transform = 0;
+        c.color = glm::vec3(1.0f);
+        c.alpha = 1.0f;
+        c.batch = &batch;
+        push(c, farPlane);
+    }
+
+    // Sort and issue everything recorded since begin(); leaves the shader in
+    // its defaults (untextured, not emissive, alpha 1, opaque state)
+    void submit(const Shader& shader) {
+        sort();
+        PROFILE_ZONE("queue.submit");
+        auto t0 = std::chrono::steady_clock::now();
+        countUnsorted();
+
+        SubmitState state;
+        shader.setBool("isEmissive", false);
+        if (submitMode == RENDER_SUBMIT_UNIFORMS) submitUniforms(shader, state);
+        else submitBuffered(shader, state);
+
+        if (state.textureMode != 0) shader.setInt("textureMode", 0);
+        if (state.emissive) shader.setBool("isEmissive", false);
+        shader.setFloat("alpha", 1.0f);
+        if (state.blend != RENDER_OPAQUE) setBlend(RENDER_OPAQUE);
+        stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        lastFrameStats = stats;
+        stats = RenderQueueStats();
+        if (commands.size() > commandHint) commandHint = commands.size();
+        frameReset(commands);
+        frameReset(transforms);
+        frameReset(keys);
+        frameReset(scratch);
+        sorted = false;
+    }
+
+    // Sort the recorded commands once; submit() calls it if nobody has
+    void sort() {
+        if (sorted) return;
+        PROFILE_ZONE("queue.sort");
+        sortKeys();
+        sorted = true;
+    }
+
+    // The frame in submission order, after sort()
+    size_t size() const { return keys.size(); }
+    const DrawCommand& sortedCommand(size_t k) const { return commands[keys[k].index]; }
+    const glm::mat4& transform(const DrawCommand& c) const { return transforms[c.transform]; }
+    const RenderMesh& meshOf(const DrawCommand& c) const { return meshes[c.mesh]; }
+    const RenderMaterial& materialOf(const DrawCommand& c) const { return materials[c.material]; }
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    glm::mat4 view = glm::mat4(1.0f);
+    size_t commandHint = 0;         // most commands a frame has recorded
+    bool sorted = false;            // keys are in submission order
+    FrameVector<DrawCommand> commands;
+    FrameVector<glm::mat4> transforms;
+    FrameVector<SortEntry> keys, scratch;
+    std::vector<RenderMaterial> materials;
+    std::vector<RenderMesh> meshes;
+
+    // Bound state while submitting, to skip redundant changes
+    struct SubmitState {
+        int material = -1, mesh = -1, blend = -1;
+        int textureMode = -1;
+        bool emissive = false;
+    };
+
+    // A run of sorted commands issued as one draw call (indirect) or one
+    // call per command (base instance); batch is set for an instance batch
+    struct Bucket {
+        uint32_t firstKey, keyCount;
+        uint32_t firstCommand;      // index into indirect
+        int vertexTotal;
+        InstanceBatch* batch;
+    };
+
+    // Buffered submission: per-draw records, indirect commands, buckets
+    FrameVector<glm::vec4> drawData;
+    FrameVector<DrawArraysIndirectCommand> indirect;
+    FrameVector<Bucket> buckets;
+    unsigned int poolVAO = 0, poolVBO = 0, drawIndexVBO = 0;
+    unsigned int drawDataBuffer = 0, drawDataTexture = 0, indirectBuffer = 0;
+    unsigned int ringTexture = 0;   // texture buffer over ring->buffer
+    unsigned int drawDataSource = 0;    // texture the frame's records are in
+    int drawDataBase = 0;           // first record texel in drawDataSource
+    size_t drawDataBytes = 0, indirectBytes = 0;
+    size_t indirectBase = 0;        // byte offset of the frame's commands
+    size_t drawIndexCount = 0;      // records the draw index stream covers
+    size_t pooledMeshes = 0;        // meshes[0, pooledMeshes) are in poolVBO
+
+    int mesh(unsigned int vao, unsigned int vbo, int first, int count) {
+        for (size_t i = 0; i < meshes.size(); i++)
+            if (meshes[i].VAO == vao && meshes[i].first == first && meshes[i].count == count) return (int)i;
+        RenderMesh m = { vao, vbo, first, count, -1 };
+        meshes.push_back(m);
+        return (int)meshes.size() - 1;
+    }
+
+    // Blend and material for command c, counting the changes
+    void applyState(const DrawCommand& c, const Shader& shader, SubmitState& state) {
+        if (c.blend != state.blend) {
+            if (state.blend >= 0) stats.blendChanges++;
+            state.blend = c.blend;
+            setBlend((RenderBlend)c.blend);
+        }
+        if (c.material != state.material) {
+            if (state.material >= 0) stats.materialChanges++;
+            state.material = c.material;
+            const RenderMaterial& m = materials[c.material];
+            unsigned int glTex = m.texture && textures ? textures->use(m.texture) : 0;
+            int mode = glTex ? m.textureMode : 0;
+            if (glTex) glState().bindTexture(0, GL_TEXTURE_2D, glTex);
+            if (mode != state.textureMode) {
+                shader.setInt("textureMode", mode);
+                state.textureMode = mode;
+            }
+            if (m.emissive != state.emissive) {
+                shader.setBool("isEmissive", m.emissive);
+                state.emissive = m.emissive;
+            }
+        }
+        if (c.mesh != state.mesh) {
+            if (state.mesh >= 0) stats.meshChanges++;
+            state.mesh = c.mesh;
+        }
+    }
+
+    void submitUniforms(const Shader& shader, SubmitState& state) {
+        for (size_t k = 0; k < keys.size(); k++) {
+            const DrawCommand& c = commands[keys[k].index];
+            applyState(c, shader, state);
+            stats.drawCalls++;
+            if (c.batch) {
+                c.batch->flush(shader);
+                continue;
+            }
+            const RenderMesh& m = meshes[c.mesh];
+            shader.setFloat("alpha", c.alpha);
+            shader.setVec3("objectColor", c.color);
+            shader.setMat4("model", transforms[c.transform]);
+            glState().bindVertexArray(m.VAO);
+            glState().drawArrays(GL_TRIANGLES, m.first, m.count);
+        }
+    }
+
+    void submitBuffered(const Shader& shader, SubmitState& state) {
+        poolMeshes();
+
+        // Pass 1: records, commands and buckets in sorted order
+        frameReset(drawData, keys.size() * RENDER_DRAW_DATA_TEXELS);
+        frameReset(indirect, keys.size());
+        frameReset(buckets, keys.size());
+        const DrawCommand* prev = nullptr;
+        for (size_t k = 0; k < keys.size(); k++) {
+            const DrawCommand& c = commands[keys[k].index];
+            if (c.batch) {
+                Bucket b = { (uint32_t)k, 1, (uint32_t)indirect.size(), 0, c.batch };
+                buckets.push_back(b);
+                prev = nullptr;
+                continue;
+            }
+            if (!prev || prev->blend != c.blend || prev->material != c.material) {
+                Bucket b = { (uint32_t)k, 0, (uint32_t)indirect.size(), 0, nullptr };
+                buckets.push_back(b);
+            }
+            prev = &c;
+            const RenderMesh& m = meshes[c.mesh];
+            const glm::mat4& model = transforms[c.transform];
+            DrawArraysIndirectCommand cmd = { (GLuint)m.count, 1, (GLuint)m.poolFirst, (GLuint)indirect.size() };
+            indirect.push_back(cmd);
+            for (int col = 0; col < 4; col++) drawData.push_back(model[col]);
+            drawData.push_back(glm::vec4(c.color, c.alpha));
+            Bucket& b = buckets.back();
+            b.keyCount++;
+            b.vertexTotal += m.count;
+        }
+        if (!indirect.empty()) upload();
+
+        // Pass 2: one state change per bucket, then its draw call(s)
+        for (size_t i = 0; i < buckets.size(); i++) {
+            const Bucket& b = buckets[i];
+            if (b.batch) {
+                applyState(commands[keys[b.firstKey].index], shader, state);
+                shader.setBool("perDrawData", false);
+                b.batch->flush(shader);
+                stats.drawCalls++;
+                continue;
+            }
+            for (uint32_t k = b.firstKey; k < b.firstKey + b.keyCount; k++)
+                applyState(commands[keys[k].index], shader, state);
+            shader.setBool("perDrawData", true);
+            shader.setInt("drawDataBase", drawDataBase);
+            glState().bindVertexArray(poolVAO);
+            glState().bindTexture(RENDER_DRAW_DATA_UNIT, GL_TEXTURE_BUFFER, drawDataSource);
+            if (submitMode == RENDER_SUBMIT_INDIRECT) {
+                glState().multiDrawArraysIndirect(GL_TRIANGLES,
+                                                  indirectBase + b.firstCommand * sizeof(DrawArraysIndirectCommand),
+                                                  (GLsizei)b.keyCount, b.vertexTotal);
+                stats.drawCalls++;
+            } else {
+                for (uint32_t j = b.firstCommand; j < b.firstCommand + b.keyCount; j++) {
+                    const DrawArraysIndirectCommand& cmd = indirect[j];
+                    glState().drawArraysInstancedBaseInstance(GL_TRIANGLES, cmd.first, cmd.count, 1, cmd.baseInstance);
+                }
+                stats.drawCalls += b.keyCount;
+            }
+        }
+        shader.setBool("perDrawData", false);
+        frameReset(drawData);
+        frameReset(indirect);
+        frameReset(buckets);
+    }
+
+    // Records (and indirect commands) into the ring, or orphan-and-refill
+    // the queue's own buffers when the ring has no room
+    void upload() {
+        size_t bytes = drawData.size() * sizeof(glm::vec4);
+        size_t offset = 0;
+        void* dst = ring && ringTexture ? ring->alloc(bytes, sizeof(glm::vec4), offset) : nullptr;
+        if (dst) {
+            memcpy(dst, drawData.data(), bytes);
+            drawDataSource = ringTexture;
+            drawDataBase = (int)(offset / sizeof(glm::vec4));
+        } else {
+            glBindBuffer(GL_TEXTURE_BUFFER, drawDataBuffer);
+            if (bytes > drawDataBytes) {
+                drawDataBytes = bytes;
+                glBufferData(GL_TEXTURE_BUFFER, drawDataBytes, drawData.data(), GL_STREAM_DRAW);
+                gpuRegistry().setBytes(GPU_BUFFER, drawDataBuffer, drawDataBytes);
+            } else {
+                glBufferData(GL_TEXTURE_BUFFER, drawDataBytes, NULL, GL_STREAM_DRAW);
+                glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, drawData.data());
+            }
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            drawDataSource = drawDataTexture;
+            drawDataBase = 0;
+        }
+        if (indirect.size() > drawIndexCount) growDrawIndices(indirect.size() * 2);
+
+        if (submitMode == RENDER_SUBMIT_INDIRECT) {
+            bytes = indirect.size() * sizeof(DrawArraysIndirectCommand);
+            dst = ring ? ring->alloc(bytes, sizeof(DrawArraysIndirectCommand), offset) : nullptr;
+            if (dst) {
+                memcpy(dst, indirect.data(), bytes);
+                glBindBuffer(GL_EXT_DRAW_INDIRECT_BUFFER, ring->buffer);
+                indirectBase = offset;
+            } else {
+                glBindBuffer(GL_EXT_DRAW_INDIRECT_BUFFER, indirectBuffer);
+                if (bytes > indirectBytes) {
+                    indirectBytes = bytes;
+                    glBufferData(GL_EXT_DRAW_INDIRECT_BUFFER, indirectBytes, indirect.data(), GL_STREAM_DRAW);
+                    gpuRegistry().setBytes(GPU_BUFFER, indirectBuffer, indirectBytes);
+                } else {
+                    glBufferData(GL_EXT_DRAW_INDIRECT_BUFFER, indirectBytes, NULL, GL_STREAM_DRAW);
+                    glBufferSubData(GL_EXT_DRAW_INDIRECT_BUFFER, 0, bytes, indirect.data());
+                }
+                indirectBase = 0;
+            }
+        }
+        if (ring) ring->flush();
+    }
+
+    // The draw index stream is static: 0..count-1, regrown when a frame
+    // records more draws than it covers
+    void growDrawIndices(size_t count) {
+        std::vector<int> indices(count);
+        for (size_t i = 0; i < count; i++) indices[i] = (int)i;
+        glBindBuffer(GL_ARRAY_BUFFER, drawIndexVBO);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(int), indices.data(), GL_STATIC_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, drawIndexVBO, count * sizeof(int));
+        drawIndexCount = count;
+    }
+
+    // Copies every poolable mesh into poolVBO, GPU side; runs again only
+    // when a frame interned a new mesh
+    void poolMeshes() {
+        if (pooledMeshes == meshes.size()) return;
+        const size_t vertexBytes = RENDER_VERTEX_FLOATS * sizeof(float);
+        size_t total = 0;
+        for (size_t i = 0; i < meshes.size(); i++)
+            if (meshes[i].VBO) total += meshes[i].count;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, poolVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, total * vertexBytes, NULL, GL_STATIC_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, poolVBO, total * vertexBytes);
+        size_t offset = 0;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            RenderMesh& m = meshes[i];
+            if (!m.VBO) continue;
+            glBindBuffer(GL_COPY_READ_BUFFER, m.VBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, m.first * vertexBytes,
+                                offset * vertexBytes, m.count * vertexBytes);
+            m.poolFirst = (int)offset;
+            offset += m.count;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        pooledMeshes = meshes.size();
+    }
+
+    float viewDepth(const glm::mat4& model) const {
+        glm::vec4 p = view * model[3];
+        return -p.z;
+    }
+
+    void push(const DrawCommand& c, float depth) {
+        const uint64_t materialMask = (1u << RENDER_QUEUE_MATERIAL_BITS) - 1;
+        const uint64_t meshMask = (1u << RENDER_QUEUE_MESH_BITS) - 1;
+        const uint64_t depthMax = (1u << RENDER_QUEUE_DEPTH_BITS) - 1;
+        float t = depth <= 0.0f ? 0.0f : depth >= farPlane ? 1.0f : depth / farPlane;
+        uint64_t d = (uint64_t)(t * (float)depthMax);
+        uint64_t key = (uint64_t)c.blend << 62;
+        if (c.blend == RENDER_OPAQUE)
+            key |= ((c.material & materialMask) << 50) | ((c.mesh & meshMask) << 42) | (d << 18);
+        else
+            key |= ((depthMax - d) << 38) | ((c.material & materialMask) << 26) | ((c.mesh & meshMask) << 18);
+
+        SortEntry e = { key, (uint32_t)commands.size() };
+        keys.push_back(e);
+        commands.push_back(c);
+        stats.commands++;
+        if (c.blend == RENDER_OPAQUE) stats.opaque++;
+        else stats.blended++;
+    }
+
+    // LSD radix sort, 8 bits per pass; digits every key shares are skipped
+    void sortKeys() {
+        size_t n = keys.size();
+        if (n < 2) return;
+        uint32_t counts[8][256];
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) {
+            uint64_t k = keys[i].key;
+            for (int d = 0; d < 8; d++) counts[d][(k >> (d * 8)) & 0xFF]++;
+        }
+        frameReset(scratch, n);
+        scratch.resize(n);
+        SortEntry* src = keys.data();
+        SortEntry* dst = scratch.data();
+        for (int d = 0; d < 8; d++) {
+            uint32_t* c = counts[d];
+            if (c[(src[0].key >> (d * 8)) & 0xFF] == n) continue;
+            uint32_t offset = 0;
+            for (int b = 0; b < 256; b++) {
+                uint32_t count = c[b];
+                c[b] = offset;
+                offset += count;
+            }
+            for (size_t i = 0; i < n; i++) dst[c[(src[i].key >> (d * 8)) & 0xFF]++] = src[i];
+            SortEntry* t = src; src = dst; dst = t;
+            stats.sortPasses++;
+        }
+        if (src != keys.data()) keys.swap(scratch);
+    }
+
+    // What the same frame costs in recording order, for comparison
+    void countUnsorted() {
+        for (size_t i = 1; i < commands.size(); i++) {
+            const DrawCommand& a = commands[i - 1];
+            const DrawCommand& b = commands[i];
+            if (a.material != b.material) stats.unsortedMaterialChanges++;
+            if (a.mesh != b.mesh) stats.unsortedMeshChanges++;
+            if (a.blend != b.blend) stats.unsortedBlendChanges++;
+        }
+    }
+
+    static void setBlend(RenderBlend blend) {
+        if (blend == RENDER_ADDITIVE) {
+            glState().enable(GL_BLEND);
+            glState().blendFunc(GL_SRC_ALPHA, GL_ONE);
+            glState().depthMask(false);
+        } else {
+            glState().depthMask(true);
+            glState().disable(GL_BLEND);
+        }
+    }
+};
+
+#endif
@@ -8,16 +8,22 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include "GLState.h"
+#include "GpuRegistry.h"
+#include "Profiler.h"
 
 class Shader
 {
 public:
     unsigned int ID;
 
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly; the program is registered
+    // with vertexPath as its owner tag, so pass a string literal
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
     {
+        PROFILE_ZONE("shader compile");
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
@@ -51,91 +57,149 @@ public:
         // 2. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
+        vertex = gpuRegistry().createShader(GL_VERTEX_SHADER, vertexPath);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
         checkCompileErrors(vertex, "VERTEX");
         // fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        fragment = gpuRegistry().createShader(GL_FRAGMENT_SHADER, vertexPath);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
-        ID = glCreateProgram();
+        ID = gpuRegistry().createProgram(vertexPath);
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        gpuRegistry().deleteShader(vertex);
+        gpuRegistry().deleteShader(fragment);
     }
-    // activate the shader
+    // delete the program; uniform writes shadowed for it are forgotten
     // ------------------------------------------------------------------------
-    void use()
+    void cleanup()
     {
-        glUseProgram(ID);
+        gpuRegistry().deleteProgram(ID);
+        locations.clear();
+        pointerLocations.clear();
     }
-    // utility uniform functions
+    // activate the shader (skipped if it is already current)
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    void use()
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glState().useProgram(ID);
     }
+    // utility uniform functions
+    // Locations are looked up once per name; writes that repeat the last
+    // value for a location are dropped by the state tracker. The const char*
+    // overloads (string literals) find the location through the pointer
+    // without building a std::string, so setting uniforms does not allocate.
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
-    {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-    }
+    void setBool(const char* name, bool value) const { writeInt(location(name), (int)value); }
+    void setBool(const std::string& name, bool value) const { writeInt(location(name), (int)value); }
+    // ------------------------------------------------------------------------
+    void setInt(const char* name, int value) const { writeInt(location(name), value); }
+    void setInt(const std::string& name, int value) const { writeInt(location(name), value); }
+    // ------------------------------------------------------------------------
+    void setFloat(const char* name, float value) const { writeFloat(location(name), value); }
+    void setFloat(const std::string& name, float value) const { writeFloat(location(name), value); }
+    // ------------------------------------------------------------------------
+    void setVec2(const char* name, const glm::vec2& value) const { writeVec2(location(name), value); }
+    void setVec2(const std::string& name, const glm::vec2& value) const { writeVec2(location(name), value); }
+    void setVec2(const char* name, float x, float y) const { writeVec2(location(name), glm::vec2(x, y)); }
+    void setVec2(const std::string& name, float x, float y) const { writeVec2(location(name), glm::vec2(x, y)); }
+    // ------------------------------------------------------------------------
+    void setVec3(const char* name, const glm::vec3& value) const { writeVec3(location(name), value); }
+    void setVec3(const std::string& name, const glm::vec3& value) const { writeVec3(location(name), value); }
+    void setVec3(const char* name, float x, float y, float z) const { writeVec3(location(name), glm::vec3(x, y, z)); }
+    void setVec3(const std::string& name, float x, float y, float z) const { writeVec3(location(name), glm::vec3(x, y, z)); }
+    // ------------------------------------------------------------------------
+    void setVec4(const char* name, const glm::vec4& value) const { writeVec4(location(name), value); }
+    void setVec4(const std::string& name, const glm::vec4& value) const { writeVec4(location(name), value); }
+    void setVec4(const char* name, float x, float y, float z, float w) const { writeVec4(location(name), glm::vec4(x, y, z, w)); }
+    void setVec4(const std::string& name, float x, float y, float z, float w) const { writeVec4(location(name), glm::vec4(x, y, z, w)); }
+    // ------------------------------------------------------------------------
+    void setMat2(const char* name, const glm::mat2& mat) const { writeMat2(location(name), mat); }
+    void setMat2(const std::string& name, const glm::mat2& mat) const { writeMat2(location(name), mat); }
+    // ------------------------------------------------------------------------
+    void setMat3(const char* name, const glm::mat3& mat) const { writeMat3(location(name), mat); }
+    void setMat3(const std::string& name, const glm::mat3& mat) const { writeMat3(location(name), mat); }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setMat4(const char* name, const glm::mat4& mat) const { writeMat4(location(name), mat); }
+    void setMat4(const std::string& name, const glm::mat4& mat) const { writeMat4(location(name), mat); }
+
+private:
+    struct NameLocation {
+        std::string name;        // text the pointer held when cached
+        int loc;
+    };
+    mutable std::unordered_map<std::string, int> locations;
+    mutable std::unordered_map<const char*, NameLocation> pointerLocations;
+
+    int location(const std::string& name) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        auto it = locations.find(name);
+        if (it != locations.end()) return it->second;
+        int loc = glGetUniformLocation(ID, name.c_str());
+        locations[name] = loc;
+        return loc;
     }
-    // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+
+    // Cached by address; the stored text is compared too, so a reused
+    // buffer holding a different name falls back to the lookup above
+    int location(const char* name) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        auto it = pointerLocations.find(name);
+        if (it != pointerLocations.end() && it->second.name == name) return it->second.loc;
+        NameLocation entry;
+        entry.name = name;
+        entry.loc = location(entry.name);
+        pointerLocations[name] = entry;
+        return entry.loc;
     }
-    void setVec2(const std::string& name, float x, float y) const
+
+    void writeInt(int loc, int value) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        if (glState().uniformChanged(ID, loc, &value, sizeof(value)))
+            glUniform1i(loc, value);
     }
-    // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void writeFloat(int loc, float value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        if (glState().uniformChanged(ID, loc, &value, sizeof(value)))
+            glUniform1f(loc, value);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void writeVec2(int loc, const glm::vec2& value) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        if (glState().uniformChanged(ID, loc, &value[0], sizeof(value)))
+            glUniform2fv(loc, 1, &value[0]);
     }
-    // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void writeVec3(int loc, const glm::vec3& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        if (glState().uniformChanged(ID, loc, &value[0], sizeof(value)))
+            glUniform3fv(loc, 1, &value[0]);
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w) const
+    void writeVec4(int loc, const glm::vec4& value) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        if (glState().uniformChanged(ID, loc, &value[0], sizeof(value)))
+            glUniform4fv(loc, 1, &value[0]);
     }
-    // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void writeMat2(int loc, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        if (glState().uniformChanged(ID, loc, &mat[0][0], sizeof(mat)))
+            glUniformMatrix2fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
-    // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void writeMat3(int loc, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        if (glState().uniformChanged(ID, loc, &mat[0][0], sizeof(mat)))
+            glUniformMatrix3fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
-    // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void writeMat4(int loc, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        if (glState().uniformChanged(ID, loc, &mat[0][0], sizeof(mat)))
+            glUniformMatrix4fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
 
-private:
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(unsigned int shader, std::string type)
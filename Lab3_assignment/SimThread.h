@@ -0,0 +1,281 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Profiler.h"
+
+// ============================================================================
+// SIM THREAD - simulation on its own thread, handed to the renderer in snapshots
+// ============================================================================
+// The main thread keeps GLFW (event polling must stay there) and the GL
+// context. Each frame it samples the input into a SimInput: the held-key
+// mask, the key presses and mouse-look deltas its callbacks saw, and when it
+// was sampled. post() queues it for the simulation thread on a fixed-size
+// single-producer / single-consumer ring. The simulation thread applies the
+// queued inputs in order, steps the world and publishes an immutable
+// snapshot of everything the renderer reads into a TripleBuffer, which the
+// renderer picks up without ever waiting for the simulation.
+//
+//   free       the elapsed wall time is handed to the step whenever an
+//              input arrives or the next fixed step is due. A slow frame no
+//              longer holds the simulation back, nor a slow step the frame.
+//   lockstep   one call per input with the input's dt, and the renderer
+//              waits for that call's snapshot: the results match a serial
+//              loop exactly (--fixed-dt, --record, --replay).
+//
+// Either way the world itself only moves in FixedStep increments, so the
+// trajectory does not depend on the frame rate.
+//
+// The ring and the snapshots are preallocated; nothing allocates per frame.
+// ============================================================================
+
+const int SIM_INPUT_QUEUE = 64;           // inputs in flight (power of two)
+const int SIM_INPUT_MAX_EVENTS = 64;      // presses and looks per input
+const double SIM_STEP_HZ = 120.0;         // fixed simulation rate (--sim-hz)
+const int SIM_MAX_CATCHUP_STEPS = 8;      // steps per advance before time is dropped
+
+// ----------------------------------------------------------------------------
+// FixedStep: turns variable elapsed time into whole steps of one length.
+// advance(dt) adds dt to the accumulator and returns how many steps are due.
+// After a long stall (texture load, window drag) at most maxSteps are run
+// and the rest of the backlog is dropped, so a slow step can never snowball
+// into ever more steps per frame. alpha() is how far the leftover time is
+// into the next step: the renderer blends the last two states by it.
+// ----------------------------------------------------------------------------
+struct FixedStep {
+    double step = 1.0 / SIM_STEP_HZ;
+    int maxSteps = SIM_MAX_CATCHUP_STEPS;
+    double accumulator = 0.0;
+    uint64_t droppedSteps = 0;          // steps skipped by the catch-up cap
+
+    void setRate(double hz) { step = 1.0 / hz; }
+
+    int advance(double dt) {
+        accumulator += dt;
+        int n = (int)(accumulator / step);
+        if (n > maxSteps) {
+            droppedSteps += (uint64_t)(n - maxSteps);
+            n = maxSteps;
+            accumulator = std::fmod(accumulator, step) + n * step;
+        }
+        accumulator -= n * step;
+        if (accumulator < 0.0) accumulator = 0.0;
+        return n;
+    }
+
+    float alpha() const { return (float)(accumulator / step); }
+    double untilNext() const { return step - accumulator; }
+};
+
+// ----------------------------------------------------------------------------
+// TripleBuffer: one writer and one reader swap slots through an atomic index,
+// so neither ever blocks. The writer fills write() and publish()es it; the
+// reader's update() takes the newest published slot (true if there was one
+// it has not seen) and read() returns it until the next update(). Snapshots
+// published in between are skipped, never torn.
+// ----------------------------------------------------------------------------
+template <typename T>
+class TripleBuffer {
+public:
+    T& write() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& read() const { return slots[front]; }
+
+private:
+    static const int INDEX = 3, FRESH = 4;
+    T slots[3];
+    int back = 0;                       // writer only
+    int front = 2;                      // reader only
+    std::atomic<int> middle{ 1 };       // the slot in between, FRESH once published
+};
+
+enum SimEventType : uint8_t { SIM_EVENT_KEY, SIM_EVENT_LOOK };
+
+struct SimEvent {
+    SimEventType type;
+    int key;                // SIM_EVENT_KEY
+    float dx, dy;           // SIM_EVENT_LOOK, degrees
+};
+
+// Everything the simulation needs from one main-thread frame
+struct SimInput {
+    int frame = 0;          // main loop frame that sampled it
+    double time = 0.0;      // when, in the app's clock (seconds)
+    float dt = 0.0f;        // lockstep: that frame's time step
+    uint16_t held = 0;      // polled keys, one bit per key (the app's order)
+    int eventCount = 0;
+    int dropped = 0;        // presses lost to a full event list
+    SimEvent events[SIM_INPUT_MAX_EVENTS];
+
+    void key(int k) {
+        if (eventCount == SIM_INPUT_MAX_EVENTS) { dropped++; return; }
+        SimEvent& e = events[eventCount++];
+        e.type = SIM_EVENT_KEY;
+        e.key = k;
+        e.dx = e.dy = 0.0f;
+    }
+
+    // A full list folds further motion into its last look
+    void look(float dx, float dy) {
+        if (eventCount == SIM_INPUT_MAX_EVENTS) {
+            SimEvent& last = events[eventCount - 1];
+            if (last.type != SIM_EVENT_LOOK) { dropped++; return; }
+            last.dx += dx;
+            last.dy += dy;
+            return;
+        }
+        SimEvent& e = events[eventCount++];
+        e.type = SIM_EVENT_LOOK;
+        e.key = 0;
+        e.dx = dx;
+        e.dy = dy;
+    }
+
+    // The look events summed in order (what applying them turns the camera by)
+    void lookTotal(float& dx, float& dy) const {
+        dx = dy = 0.0f;
+        for (int i = 0; i < eventCount; i++) {
+            if (events[i].type != SIM_EVENT_LOOK) continue;
+            dx += events[i].dx;
+            dy += events[i].dy;
+        }
+    }
+
+    void clearEvents() { eventCount = 0; }
+};
+
+// Applies one input's events (in order) and remembers its held keys
+typedef void (*SimApplyFn)(const SimInput& input);
+// Advances the world by dt of elapsed time and publishes a snapshot;
+// returns the seconds until the next fixed step is due
+typedef double (*SimStepFn)(float dt);
+
+class SimThread {
+public:
+    bool lockstep = false;
+    int queueFull = 0;              // post()s refused (main thread)
+
+    ~SimThread() { stop(); }
+
+    bool running() const { return thread.joinable(); }
+
+    void start(SimApplyFn applyFn, SimStepFn stepFn, bool lockstepMode) {
+        stop();
+        apply = applyFn;
+        step = stepFn;
+        lockstep = lockstepMode;
+        quit.store(false);
+        thread = std::thread(&SimThread::loop, this);
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            quit.store(true);
+        }
+        wakeCv.notify_one();
+        thread.join();
+    }
+
+    // Main thread. False when the ring is full; keep the input and post it
+    // (with whatever came in since) next frame.
+    bool post(const SimInput& input) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == (uint32_t)SIM_INPUT_QUEUE) {
+            queueFull++;
+            return false;
+        }
+        queue[t & (SIM_INPUT_QUEUE - 1)] = input;
+        tail.store(t + 1);
+        // Same handshake as JobSystem::wake(): the thread raises sleeping
+        // before its last look at the ring
+        if (sleeping.load() != 0) {
+            { std::lock_guard<std::mutex> lock(wakeMutex); }
+            wakeCv.notify_one();
+        }
+        return true;
+    }
+
+    uint64_t stepCount() const { return steps.load(std::memory_order_relaxed); }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::thread thread;
+    SimApplyFn apply = nullptr;
+    SimStepFn step = nullptr;
+    SimInput queue[SIM_INPUT_QUEUE];
+    std::atomic<uint32_t> head{ 0 }, tail{ 0 };
+    std::atomic<bool> quit{ false };
+    std::atomic<int> sleeping{ 0 };
+    std::atomic<uint64_t> steps{ 0 };
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+
+    bool pending() const { return head.load(std::memory_order_relaxed) != tail.load(); }
+
+    void pop(SimInput& out) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        out = queue[h & (SIM_INPUT_QUEUE - 1)];
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Until an input is queued, quit, or (free mode) the next fixed step
+    void sleepUntil(const Clock::time_point* deadline) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        sleeping.fetch_add(1);
+        auto ready = [this] { return quit.load() || pending(); };
+        if (deadline) wakeCv.wait_until(lock, *deadline, ready);
+        else wakeCv.wait(lock, ready);
+        sleeping.fetch_sub(1);
+    }
+
+    void loop() {
+        profiler().setThreadName("sim");
+        Clock::time_point last = Clock::now(), next = last;
+        SimInput input;
+        while (!quit.load()) {
+            if (lockstep) {
+                if (!pending()) {
+                    sleepUntil(nullptr);
+                    continue;
+                }
+                pop(input);
+                apply(input);
+                step(input.dt);
+                steps.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (!pending() && Clock::now() < next) sleepUntil(&next);
+            if (quit.load()) break;
+            while (pending()) {
+                pop(input);
+                apply(input);
+            }
+            Clock::time_point now = Clock::now();
+            double wait = step(std::chrono::duration<float>(now - last).count());
+            last = now;
+            next = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait));
+            steps.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,1219 @@
+#ifndef SOFT_RASTER_H
+#define SOFT_RASTER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include "CameraMath.h"
+#include "Lighting.h"
+#include "RenderQueue.h"
+#include "InstanceBatch.h"
+#include "TextureCache.h"
+#include "TextureArray.h"
+#include "GpuRegistry.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE 1
+#endif
+
+#if defined(_MSC_VER)
+#define SOFT_RASTER_INLINE __forceinline
+#else
+#define SOFT_RASTER_INLINE inline __attribute__((always_inline))
+#endif
+
+// ============================================================================
+// SOFT RASTER - tile-binned CPU rasterizer for machines without a GPU
+// ============================================================================
+// Renders the render queue's frame the way shader.vert / shader.frag would:
+// same pos3 + normal3 + texcoord2 vertices, same lights (Lighting.h), same
+// texture modes (0 Phong, 1 lit texture, 2 texture x Gouraud, 3 texture x
+// Phong) and emissive draws, opaque draws with a LESS depth test and
+// additive ones blended GL_SRC_ALPHA / GL_ONE without depth writes. It reads
+// the sorted commands just before submit(), so the order is the GL order.
+//
+//   geometry  draws are grouped into runs of ~SOFT_RUN_VERTICES vertices,
+//             one job each. Vertices are transformed four at a time (SSE2,
+//             scalar otherwise), Gouraud lighting is done per vertex for
+//             mode 2, triangles are clipped against the near and far planes
+//             and a 2x guard band only when they cross one, snapped to 1/16
+//             pixel and set up as integer edge functions plus attribute
+//             planes (z, 1/w and varyings / w). Each run bins its triangles
+//             into SOFT_TILE_SIZE tiles.
+//   raster    one job per tile walks every run's bin in run order, so the
+//             image does not depend on the thread count. Triangles are
+//             tested in 8x8 blocks against the tile's and each block's
+//             farthest depth (Hi-Z), then per edge: blocks outside one edge
+//             are skipped, blocks inside all three need no per-pixel edge
+//             test, the rest are evaluated four pixels at a time in 32-bit
+//             integers. Depth is tested four at a time before shading;
+//             shading interpolates perspective-correctly and lights four
+//             fragments at once, sampling textures per fragment.
+//
+// Edge functions are exact (fixed point, top-left style tie rule), so
+// triangles that share an edge cover each of its pixels exactly once.
+// Textures come from the CPU copies the cache and the array keep when asked
+// (keepPixels): bilinear at the triangle's mip level when minified, the
+// texture's mag filter otherwise, with its wrap mode; a texture still
+// loading samples white, as the GL fallback does. The HUD is not drawn.
+// Frame buffers are RGBA8 color and float depth, written as PNG by
+// writePng().
+// ============================================================================
+
+const int SOFT_TILE_SIZE = 64;          // pixels per tile side (multiple of 8)
+const int SOFT_BLOCK_SIZE = 8;          // Hi-Z and edge-test block side
+const int SOFT_SUBPIXEL_BITS = 4;       // vertices snap to 1/16 pixel
+const float SOFT_GUARD_BAND = 2.0f;     // x, y clipped at +-2w only
+const int SOFT_RUN_VERTICES = 8192;     // vertices per geometry job
+const int SOFT_VARYINGS = 11;           // world pos 3, normal 3, uv 2, vertex light 3
+const int SOFT_PLANES = 2 + SOFT_VARYINGS;     // z, 1/w, varyings / w
+const int SOFT_MAX_LIGHTS = 2 + SCENE_POINT_LIGHTS;
+
+// ============================================================================
+// SIMD - four floats / ints, SSE2 or plain arrays
+// ============================================================================
+struct SoftFloat4 {
+#ifdef SOFT_RASTER_SSE
+    __m128 v;
+    SoftFloat4() {}
+    SoftFloat4(__m128 x) : v(x) {}
+    explicit SoftFloat4(float a) : v(_mm_set1_ps(a)) {}
+    SoftFloat4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+    static SoftFloat4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+#else
+    float v[4];
+    SoftFloat4() {}
+    explicit SoftFloat4(float a) { v[0] = v[1] = v[2] = v[3] = a; }
+    SoftFloat4(float a, float b, float c, float d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+    static SoftFloat4 load(const float* p) { return SoftFloat4(p[0], p[1], p[2], p[3]); }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+#endif
+};
+
+#ifdef SOFT_RASTER_SSE
+SOFT_RASTER_INLINE SoftFloat4 operator+(SoftFloat4 a, SoftFloat4 b) { return _mm_add_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 operator-(SoftFloat4 a, SoftFloat4 b) { return _mm_sub_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 operator*(SoftFloat4 a, SoftFloat4 b) { return _mm_mul_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 operator/(SoftFloat4 a, SoftFloat4 b) { return _mm_div_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 sfMin(SoftFloat4 a, SoftFloat4 b) { return _mm_min_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 sfMax(SoftFloat4 a, SoftFloat4 b) { return _mm_max_ps(a.v, b.v); }
+SOFT_RASTER_INLINE SoftFloat4 sfSqrt(SoftFloat4 a) { return _mm_sqrt_ps(a.v); }
+// 1/sqrt(a) and 1/a: the 12-bit estimates plus one Newton step (~22 bits)
+SOFT_RASTER_INLINE SoftFloat4 sfRsqrt(SoftFloat4 a) {
+    __m128 r = _mm_rsqrt_ps(a.v);
+    __m128 ar2 = _mm_mul_ps(_mm_mul_ps(a.v, r), r);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), ar2));
+}
+SOFT_RASTER_INLINE SoftFloat4 sfRcp(SoftFloat4 a) {
+    __m128 r = _mm_rcp_ps(a.v);
+    return _mm_sub_ps(_mm_add_ps(r, r), _mm_mul_ps(_mm_mul_ps(a.v, r), r));
+}
+// 1.0 where a > b, else 0.0
+SOFT_RASTER_INLINE SoftFloat4 sfGreater(SoftFloat4 a, SoftFloat4 b) {
+    return _mm_and_ps(_mm_cmpgt_ps(a.v, b.v), _mm_set1_ps(1.0f));
+}
+// Bit i set where a[i] < b[i]
+SOFT_RASTER_INLINE int sfLessMask(SoftFloat4 a, SoftFloat4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+#else
+#define SOFT_FLOAT4_OP(name, expr) \
+    SOFT_RASTER_INLINE SoftFloat4 name(SoftFloat4 a, SoftFloat4 b) { \
+        SoftFloat4 r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r; }
+SOFT_FLOAT4_OP(operator+, a.v[i] + b.v[i])
+SOFT_FLOAT4_OP(operator-, a.v[i] - b.v[i])
+SOFT_FLOAT4_OP(operator*, a.v[i] * b.v[i])
+SOFT_FLOAT4_OP(operator/, a.v[i] / b.v[i])
+SOFT_FLOAT4_OP(sfMin, std::min(a.v[i], b.v[i]))
+SOFT_FLOAT4_OP(sfMax, std::max(a.v[i], b.v[i]))
+SOFT_FLOAT4_OP(sfGreater, a.v[i] > b.v[i] ? 1.0f : 0.0f)
+#undef SOFT_FLOAT4_OP
+SOFT_RASTER_INLINE SoftFloat4 sfSqrt(SoftFloat4 a) {
+    return SoftFloat4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]));
+}
+SOFT_RASTER_INLINE SoftFloat4 sfRsqrt(SoftFloat4 a) { return SoftFloat4(1.0f) / sfSqrt(a); }
+SOFT_RASTER_INLINE SoftFloat4 sfRcp(SoftFloat4 a) { return SoftFloat4(1.0f) / a; }
+SOFT_RASTER_INLINE int sfLessMask(SoftFloat4 a, SoftFloat4 b) {
+    int m = 0;
+    for (int i = 0; i < 4; i++) m |= (a.v[i] < b.v[i]) << i;
+    return m;
+}
+#endif
+
+SOFT_RASTER_INLINE SoftFloat4 sfClamp01(SoftFloat4 a) { return sfMin(sfMax(a, SoftFloat4(0.0f)), SoftFloat4(1.0f)); }
+
+struct SoftInt4 {
+#ifdef SOFT_RASTER_SSE
+    __m128i v;
+    SoftInt4() {}
+    SoftInt4(__m128i x) : v(x) {}
+    explicit SoftInt4(int32_t a) : v(_mm_set1_epi32(a)) {}
+    SoftInt4(int32_t a, int32_t b, int32_t c, int32_t d) : v(_mm_setr_epi32(a, b, c, d)) {}
+#else
+    int32_t v[4];
+    SoftInt4() {}
+    explicit SoftInt4(int32_t a) { v[0] = v[1] = v[2] = v[3] = a; }
+    SoftInt4(int32_t a, int32_t b, int32_t c, int32_t d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+#endif
+};
+
+#ifdef SOFT_RASTER_SSE
+SOFT_RASTER_INLINE SoftInt4 operator+(SoftInt4 a, SoftInt4 b) { return _mm_add_epi32(a.v, b.v); }
+SOFT_RASTER_INLINE SoftInt4 operator|(SoftInt4 a, SoftInt4 b) { return _mm_or_si128(a.v, b.v); }
+// Bit i set where a[i] < 0
+SOFT_RASTER_INLINE int siNegativeMask(SoftInt4 a) { return _mm_movemask_ps(_mm_castsi128_ps(a.v)); }
+#else
+SOFT_RASTER_INLINE SoftInt4 operator+(SoftInt4 a, SoftInt4 b) {
+    return SoftInt4(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);
+}
+SOFT_RASTER_INLINE SoftInt4 operator|(SoftInt4 a, SoftInt4 b) {
+    return SoftInt4(a.v[0] | b.v[0], a.v[1] | b.v[1], a.v[2] | b.v[2], a.v[3] | b.v[3]);
+}
+SOFT_RASTER_INLINE int siNegativeMask(SoftInt4 a) {
+    return (a.v[0] < 0) | (a.v[1] < 0) << 1 | (a.v[2] < 0) << 2 | (a.v[3] < 0) << 3;
+}
+#endif
+
+struct SoftVec4x3 {
+    SoftFloat4 x, y, z;
+};
+
+SOFT_RASTER_INLINE SoftFloat4 sfDot(const SoftVec4x3& a, const SoftVec4x3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+SOFT_RASTER_INLINE SoftVec4x3 sfNormalize(const SoftVec4x3& a) {
+    SoftFloat4 inv = sfRsqrt(sfDot(a, a));
+    SoftVec4x3 r = { a.x * inv, a.y * inv, a.z * inv };
+    return r;
+}
+
+// ============================================================================
+// DATA
+// ============================================================================
+
+// A texture as the sampler sees it: levels[firstLevel..levelCount) usable
+struct SoftTexture {
+    const MipLevel* levels = nullptr;   // null: sample white (still loading)
+    int levelCount = 0;
+    int firstLevel = 0;
+    GLenum wrap = GL_REPEAT;
+    GLenum filter = GL_LINEAR;          // mag filter; minification is bilinear
+};
+
+enum SoftNeeds {
+    SOFT_NEED_SURFACE = 1,      // world position and normal (per-fragment lighting)
+    SOFT_NEED_UV = 2,
+    SOFT_NEED_VERTEX_LIGHT = 4
+};
+
+// One mesh instance to draw
+struct SoftDraw {
+    const float* vertices;      // pos3 + normal3 + texcoord2 per vertex
+    int count;
+    glm::mat4 model;
+    glm::vec3 color;
+    float alpha;
+    SoftTexture texture;
+    int textureMode;            // after resolution, as the shader sees it
+    int needs;                  // SoftNeeds
+    bool additive, emissive;
+};
+
+struct SoftClipVertex {
+    float clip[4];
+    float var[SOFT_VARYINGS];
+};
+
+// A set-up screen triangle. Edge i (opposite vertex i) is
+// E(X, Y) = a*X + b*Y + c over 1/16-pixel coordinates, with the tie rule
+// folded into c so a pixel center is inside when all three are >= 0.
+// Planes are f(x, y) = p[0] + p[1]*(x - x0) + p[2]*(y - y0) in pixels.
+struct SoftTriangle {
+    int32_t edgeA[3], edgeB[3];
+    int64_t edgeC[3];
+    float x0, y0;
+    float plane[SOFT_PLANES][3];
+    float minZ;
+    float lod;                  // log2 of texels per pixel, for minification
+    int16_t minX, minY, maxX, maxY;    // covered pixel bounds, inclusive
+    uint32_t draw;
+};
+
+// A batch of draws transformed and set up by one job
+struct SoftRun {
+    int firstDraw = 0, drawCount = 0;
+    int clipped = 0, culled = 0;
+    std::vector<SoftTriangle> triangles;
+    std::vector<uint32_t> binOffsets;       // per tile, into binTriangles (tiles + 1)
+    std::vector<uint32_t> binCursor;
+    std::vector<uint32_t> binTriangles;
+    std::vector<SoftClipVertex> vertices;   // one draw's vertices, scratch
+};
+
+// The lights with the toggles applied
+struct SoftLight {
+    int type;                   // 0 directional, 1 point, 2 spot
+    glm::vec3 position;
+    glm::vec3 direction;        // directional: toward the light; spot: normalized axis
+    glm::vec3 ambient, diffuse, specular;
+    float constant, linear, quadratic, cutOff;
+};
+
+struct SoftRasterStats {
+    int draws = 0, triangles = 0, clipped = 0, culled = 0, binned = 0;
+    long long pixels = 0;       // fragments shaded
+    double geometryMs = 0.0, rasterMs = 0.0, totalMs = 0.0;
+};
+
+class SoftRaster {
+public:
+    int width = 0, height = 0;
+    int stride = 0, paddedHeight = 0;   // buffers are padded to whole blocks
+    int tilesX = 0, tilesY = 0;
+    std::vector<uint32_t> color;        // RGBA8, top row first
+    std::vector<float> depth;
+    TextureCache* textures = nullptr;
+    TextureArray* array = nullptr;
+    GLenum arrayWrap = GL_REPEAT, arrayFilter = GL_LINEAR;   // the city sampler's state
+    glm::vec3 clearColor = glm::vec3(0.53f, 0.72f, 0.92f);
+    SoftRasterStats stats;              // last frame
+    SoftRasterStats total;              // summed over frames
+    double bestMs = 0.0;
+    int frames = 0;
+
+    void init(int w, int h, TextureCache* cache, TextureArray* textureArray) {
+        width = w;
+        height = h;
+        stride = (w + SOFT_BLOCK_SIZE - 1) / SOFT_BLOCK_SIZE * SOFT_BLOCK_SIZE;
+        paddedHeight = (h + SOFT_BLOCK_SIZE - 1) / SOFT_BLOCK_SIZE * SOFT_BLOCK_SIZE;
+        tilesX = (stride + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+        tilesY = (paddedHeight + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+        color.assign((size_t)stride * paddedHeight, 0);
+        depth.assign((size_t)stride * paddedHeight, 1.0f);
+        hiZ.assign((size_t)(stride / SOFT_BLOCK_SIZE) * (paddedHeight / SOFT_BLOCK_SIZE), 1.0f);
+        tilePixels.assign(tilesX * tilesY, 0);
+        textures = cache;
+        array = textureArray;
+        draws.reserve(4096);
+    }
+
+    // Draw the queue's recorded frame (sorting it if submit() has not yet)
+    void render(RenderQueue& queue, const SceneLighting& lighting, const glm::mat4& view,
+                const glm::mat4& projection, const glm::vec3& eye, JobSystem& jobs) {
+        auto t0 = std::chrono::steady_clock::now();
+        stats = SoftRasterStats();
+        mulMat4(projection, view, viewProj);
+        setLights(lighting, eye);
+        if (array && array->ready() && arrayLevels.empty()) buildArrayLevels(jobs);
+        queue.sort();
+        collect(queue);
+
+        // Runs of whole draws, about SOFT_RUN_VERTICES vertices each
+        runCount = 0;
+        for (int d = 0; d < (int)draws.size();) {
+            if (runCount == (int)runs.size()) runs.emplace_back();
+            SoftRun& run = runs[runCount++];
+            run.firstDraw = d;
+            int vertices = 0;
+            while (d < (int)draws.size() && vertices < SOFT_RUN_VERTICES) vertices += draws[d++].count;
+            run.drawCount = d - run.firstDraw;
+        }
+        {
+            PROFILE_ZONE("raster geometry");
+            jobs.parallelFor(runCount, 1, [this](int begin, int end) {
+                for (int r = begin; r < end; r++) geometry(runs[r]);
+            });
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        {
+            PROFILE_ZONE("raster tiles");
+            jobs.parallelFor(tilesX * tilesY, 1, [this](int begin, int end) {
+                for (int t = begin; t < end; t++) rasterTile(t);
+            });
+        }
+        auto t2 = std::chrono::steady_clock::now();
+
+        stats.draws = (int)draws.size();
+        for (int r = 0; r < runCount; r++) {
+            stats.triangles += (int)runs[r].triangles.size();
+            stats.clipped += runs[r].clipped;
+            stats.culled += runs[r].culled;
+            stats.binned += (int)runs[r].binTriangles.size();
+        }
+        for (long long p : tilePixels) stats.pixels += p;
+        stats.geometryMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        stats.rasterMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        stats.totalMs = std::chrono::duration<double, std::milli>(t2 - t0).count();
+        total.draws += stats.draws;
+        total.triangles += stats.triangles;
+        total.clipped += stats.clipped;
+        total.culled += stats.culled;
+        total.binned += stats.binned;
+        total.pixels += stats.pixels;
+        total.geometryMs += stats.geometryMs;
+        total.rasterMs += stats.rasterMs;
+        total.totalMs += stats.totalMs;
+        if (frames == 0 || stats.totalMs < bestMs) bestMs = stats.totalMs;
+        frames++;
+    }
+
+    void printSummary(std::ostream& os) const {
+        int n = std::max(frames, 1);
+        char line[256];
+        snprintf(line, sizeof(line), "Raster: %d frames at %dx%d on %d threads, %.2f ms/frame (geometry %.2f, "
+                 "tiles %.2f), best %.2f ms", frames, width, height, jobSystem().threadCount(), total.totalMs / n,
+                 total.geometryMs / n, total.rasterMs / n, bestMs);
+        os << line << std::endl;
+        snprintf(line, sizeof(line), "  last frame: %d draws, %d triangles (%d clipped, %d culled), %d tile bins, "
+                 "%lld fragments shaded", stats.draws, stats.triangles, stats.clipped, stats.culled, stats.binned,
+                 stats.pixels);
+        os << line << std::endl;
+    }
+
+    // The color buffer as an 8-bit RGB PNG (stored, uncompressed deflate)
+    bool writePng(const std::string& path) const {
+        std::vector<unsigned char> raw;
+        raw.reserve((size_t)(width * 3 + 1) * height);
+        for (int y = 0; y < height; y++) {
+            raw.push_back(0);       // filter: none
+            const uint32_t* row = &color[(size_t)y * stride];
+            for (int x = 0; x < width; x++) {
+                raw.push_back((unsigned char)(row[x] & 0xFF));
+                raw.push_back((unsigned char)((row[x] >> 8) & 0xFF));
+                raw.push_back((unsigned char)((row[x] >> 16) & 0xFF));
+            }
+        }
+        std::vector<unsigned char> z;
+        z.push_back(0x78);
+        z.push_back(0x01);
+        size_t at = 0;
+        do {                        // stored blocks of up to 64 KB
+            size_t n = std::min<size_t>(raw.size() - at, 65535);
+            bool last = at + n >= raw.size();
+            z.push_back(last ? 1 : 0);
+            z.push_back((unsigned char)(n & 0xFF));
+            z.push_back((unsigned char)(n >> 8));
+            z.push_back((unsigned char)(~n & 0xFF));
+            z.push_back((unsigned char)((~n >> 8) & 0xFF));
+            z.insert(z.end(), raw.begin() + at, raw.begin() + at + n);
+            at += n;
+        } while (at < raw.size());
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : raw) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        putBig(z, (b << 16) | a);
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) {
+            std::cout << "Raster: cannot write " << path << std::endl;
+            return false;
+        }
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        fwrite(signature, 1, 8, f);
+        std::vector<unsigned char> header;
+        putBig(header, (uint32_t)width);
+        putBig(header, (uint32_t)height);
+        header.push_back(8);        // bit depth
+        header.push_back(2);        // RGB
+        header.push_back(0);
+        header.push_back(0);
+        header.push_back(0);
+        writeChunk(f, "IHDR", header);
+        writeChunk(f, "IDAT", z);
+        writeChunk(f, "IEND", std::vector<unsigned char>());
+        bool ok = fclose(f) == 0;
+        std::cout << "Raster: wrote " << path << " (" << width << "x" << height << ")" << std::endl;
+        return ok;
+    }
+
+private:
+    glm::mat4 viewProj;
+    SoftLight lights[SOFT_MAX_LIGHTS];
+    int lightCount = 0;
+    glm::vec3 eyePos;
+    float shininess = 32.0f;
+    int shininessSquarings = 5;         // shininess = 2^n, or -1 for pow()
+    bool specularOn = true;
+    std::vector<SoftDraw> draws;
+    std::vector<SoftRun> runs;
+    int runCount = 0;
+    std::vector<float> hiZ;             // farthest depth of each block
+    std::vector<long long> tilePixels;
+    std::vector<std::vector<MipLevel> > arrayLevels;     // per layer
+
+    static void putBig(std::vector<unsigned char>& out, uint32_t v) {
+        out.push_back((unsigned char)(v >> 24));
+        out.push_back((unsigned char)(v >> 16));
+        out.push_back((unsigned char)(v >> 8));
+        out.push_back((unsigned char)v);
+    }
+
+    static void writeChunk(FILE* f, const char* type, const std::vector<unsigned char>& data) {
+        static uint32_t table[256];
+        static bool tableReady = false;
+        if (!tableReady) {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+            tableReady = true;
+        }
+        std::vector<unsigned char> head;
+        putBig(head, (uint32_t)data.size());
+        fwrite(head.data(), 1, 4, f);
+        fwrite(type, 1, 4, f);
+        if (!data.empty()) fwrite(data.data(), 1, data.size(), f);
+        uint32_t crc = 0xFFFFFFFFu;
+        for (int i = 0; i < 4; i++) crc = table[(crc ^ (unsigned char)type[i]) & 0xFF] ^ (crc >> 8);
+        for (unsigned char c : data) crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+        std::vector<unsigned char> tail;
+        putBig(tail, crc ^ 0xFFFFFFFFu);
+        fwrite(tail.data(), 1, 4, f);
+    }
+
+    // ---------------------------------------------------------------- setup
+
+    void setLights(const SceneLighting& L, const glm::vec3& eye) {
+        eyePos = eye;
+        shininess = L.shininess;
+        specularOn = L.specularOn;
+        shininessSquarings = -1;
+        for (int n = 0; n <= 8; n++)
+            if (L.shininess == (float)(1 << n)) shininessSquarings = n;
+        glm::vec3 zero(0.0f);
+        lightCount = 0;
+        auto add = [&](int type, const glm::vec3& ambient, const glm::vec3& diffuse, const glm::vec3& specular) {
+            SoftLight& s = lights[lightCount++];
+            s.type = type;
+            s.ambient = L.ambientOn ? ambient : zero;
+            s.diffuse = L.diffuseOn ? diffuse : zero;
+            s.specular = L.specularOn ? specular : zero;
+            s.constant = 1.0f;
+            s.linear = s.quadratic = 0.0f;
+            s.cutOff = -2.0f;
+            return &s;
+        };
+        if (L.dirLightOn) {
+            SoftLight* s = add(0, L.dirLight.ambient, L.dirLight.diffuse, L.dirLight.specular);
+            s->direction = glm::normalize(-L.dirLight.direction);
+        }
+        if (L.pointLightsOn) {
+            for (int i = 0; i < SCENE_POINT_LIGHTS; i++) {
+                const PointLight& p = L.pointLights[i];
+                SoftLight* s = add(1, p.ambient, p.diffuse, p.specular);
+                s->position = p.position;
+                s->constant = p.constant;
+                s->linear = p.linear;
+                s->quadratic = p.quadratic;
+            }
+        }
+        if (L.spotLightOn) {
+            const SpotLight& p = L.spotLight;
+            SoftLight* s = add(2, p.ambient, p.diffuse, p.specular);
+            s->position = p.position;
+            s->direction = glm::normalize(-p.direction);
+            s->constant = p.constant;
+            s->linear = p.linear;
+            s->quadratic = p.quadratic;
+            s->cutOff = p.cutOff;
+        }
+    }
+
+    // The array layers' mip chains, once the array has been decoded
+    void buildArrayLevels(JobSystem& jobs) {
+        int layers = array->layerCount();
+        if (!array->pixels(0)) return;
+        PROFILE_ZONE("raster array mips");
+        arrayLevels.resize(layers);
+        jobs.parallelFor(layers, 1, [this](int begin, int end) {
+            for (int l = begin; l < end; l++) {
+                std::vector<MipLevel>& chain = arrayLevels[l];
+                MipLevel base;
+                base.width = base.height = array->layerSize;
+                const unsigned char* src = array->pixels(l);
+                base.pixels.assign(src, src + (size_t)array->layerSize * array->layerSize * 3);
+                chain.push_back(std::move(base));
+                while (chain.back().width > 1 || chain.back().height > 1)
+                    chain.push_back(TextureCache::downsample(chain.back()));
+            }
+        });
+    }
+
+    SoftTexture cacheTexture(const RenderMaterial& m, int& mode) const {
+        SoftTexture t;
+        mode = 0;
+        const TextureEntry* e = textures ? textures->entry(m.texture) : nullptr;
+        if (!e || e->state == TEX_MISSING) return t;
+        mode = m.textureMode;
+        if (e->state != TEX_RESIDENT || e->pixels.empty()) return t;     // the white fallback
+        t.levels = e->pixels.data();
+        t.levelCount = (int)e->pixels.size();
+        t.firstLevel = std::min(e->baseLevel, t.levelCount - 1);
+        t.wrap = e->wrapMode;
+        t.filter = e->filterMode;
+        return t;
+    }
+
+    static int needsOf(int mode, bool emissive) {
+        if (emissive) return 0;
+        switch (mode) {
+        case 1: case 3: return SOFT_NEED_SURFACE | SOFT_NEED_UV;
+        case 2: return SOFT_NEED_UV | SOFT_NEED_VERTEX_LIGHT;
+        default: return SOFT_NEED_SURFACE;
+        }
+    }
+
+    // The queue's commands as draws, in submission order
+    void collect(RenderQueue& queue) {
+        draws.clear();
+        for (size_t k = 0; k < queue.size(); k++) {
+            const DrawCommand& c = queue.sortedCommand(k);
+            const RenderMaterial& m = queue.materialOf(c);
+            SoftDraw d;
+            d.additive = c.blend == RENDER_ADDITIVE;
+            d.emissive = m.emissive;
+            if (c.batch) {
+                const std::vector<unsigned char>* data = gpuRegistry().bufferData(c.batch->meshVBO);
+                if (!data) continue;
+                d.vertices = (const float*)data->data();
+                d.count = c.batch->vertexCount;
+                d.alpha = 1.0f;
+                for (const InstanceData& inst : c.batch->instances) {
+                    d.model = inst.model;
+                    d.color = inst.color;
+                    int layer = (int)inst.material.x;
+                    d.texture = SoftTexture();
+                    d.textureMode = 0;
+                    if (inst.material.x >= 0.0f && layer < (int)arrayLevels.size()) {
+                        const std::vector<MipLevel>& chain = arrayLevels[layer];
+                        d.texture.levels = chain.data();
+                        d.texture.levelCount = (int)chain.size();
+                        d.texture.wrap = arrayWrap;
+                        d.texture.filter = arrayFilter;
+                        d.textureMode = (int)inst.material.y;
+                    } else if (inst.material.x >= 0.0f) {
+                        d.textureMode = (int)inst.material.y;      // array not decoded yet: white
+                    }
+                    d.needs = needsOf(d.textureMode, d.emissive);
+                    draws.push_back(d);
+                }
+                continue;
+            }
+            const RenderMesh& mesh = queue.meshOf(c);
+            const std::vector<unsigned char>* data = gpuRegistry().bufferData(mesh.VBO);
+            if (!data) continue;
+            d.vertices = (const float*)data->data() + (size_t)mesh.first * RENDER_VERTEX_FLOATS;
+            d.count = mesh.count;
+            d.model = queue.transform(c);
+            d.color = c.color;
+            d.alpha = c.alpha;
+            d.texture = cacheTexture(m, d.textureMode);
+            d.needs = needsOf(d.textureMode, d.emissive);
+            draws.push_back(d);
+        }
+    }
+
+    // ------------------------------------------------------------- lighting
+
+    // Lighting of four surface points as mat * A + S (see shader.frag)
+    SOFT_RASTER_INLINE void lightFactors(const SoftVec4x3& position, const SoftVec4x3& normal,
+                                         SoftVec4x3& A, SoftVec4x3& S) const {
+        SoftFloat4 zero(0.0f), one(1.0f);
+        SoftVec4x3 n = sfNormalize(normal);
+        SoftVec4x3 toEye = { SoftFloat4(eyePos.x) - position.x, SoftFloat4(eyePos.y) - position.y,
+                             SoftFloat4(eyePos.z) - position.z };
+        SoftVec4x3 v = sfNormalize(toEye);
+        A.x = A.y = A.z = zero;
+        S.x = S.y = S.z = zero;
+        for (int i = 0; i < lightCount; i++) {
+            const SoftLight& light = lights[i];
+            SoftVec4x3 l;
+            SoftFloat4 att = one, lit = one;
+            if (light.type == 0) {
+                l.x = SoftFloat4(light.direction.x);
+                l.y = SoftFloat4(light.direction.y);
+                l.z = SoftFloat4(light.direction.z);
+            } else {
+                SoftVec4x3 d = { SoftFloat4(light.position.x) - position.x, SoftFloat4(light.position.y) - position.y,
+                                 SoftFloat4(light.position.z) - position.z };
+                SoftFloat4 d2 = sfDot(d, d);
+                SoftFloat4 inv = sfRsqrt(d2);
+                SoftFloat4 dist = d2 * inv;
+                l.x = d.x * inv;
+                l.y = d.y * inv;
+                l.z = d.z * inv;
+                att = sfRcp(SoftFloat4(light.constant) + SoftFloat4(light.linear) * dist
+                            + SoftFloat4(light.quadratic) * d2);
+                lit = att;
+                if (light.type == 2) {
+                    SoftFloat4 theta = l.x * SoftFloat4(light.direction.x) + l.y * SoftFloat4(light.direction.y)
+                                     + l.z * SoftFloat4(light.direction.z);
+                    lit = att * sfGreater(theta, SoftFloat4(light.cutOff));
+                }
+            }
+            SoftFloat4 nl = sfDot(n, l);
+            SoftFloat4 diff = sfMax(nl, zero) * lit;
+            A.x = A.x + SoftFloat4(light.ambient.x) * att + SoftFloat4(light.diffuse.x) * diff;
+            A.y = A.y + SoftFloat4(light.ambient.y) * att + SoftFloat4(light.diffuse.y) * diff;
+            A.z = A.z + SoftFloat4(light.ambient.z) * att + SoftFloat4(light.diffuse.z) * diff;
+            if (!specularOn) continue;
+            // reflect(-l, n) = 2 (n.l) n - l
+            SoftFloat4 twoNl = nl + nl;
+            SoftVec4x3 r = { twoNl * n.x - l.x, twoNl * n.y - l.y, twoNl * n.z - l.z };
+            SoftFloat4 spec = specPow(sfMax(sfDot(v, r), zero)) * lit;
+            S.x = S.x + SoftFloat4(light.specular.x) * spec;
+            S.y = S.y + SoftFloat4(light.specular.y) * spec;
+            S.z = S.z + SoftFloat4(light.specular.z) * spec;
+        }
+    }
+
+    SOFT_RASTER_INLINE SoftFloat4 specPow(SoftFloat4 x) const {
+        if (shininessSquarings >= 0) {
+            for (int k = 0; k < shininessSquarings; k++) x = x * x;
+            return x;
+        }
+        float f[4];
+        x.store(f);
+        for (int i = 0; i < 4; i++) f[i] = std::pow(f[i], shininess);
+        return SoftFloat4::load(f);
+    }
+
+    // ------------------------------------------------------------- geometry
+
+    void geometry(SoftRun& run) {
+        run.triangles.clear();
+        run.clipped = run.culled = 0;
+        for (int d = run.firstDraw; d < run.firstDraw + run.drawCount; d++) {
+            const SoftDraw& draw = draws[d];
+            transformVertices(draw, run.vertices);
+            const SoftClipVertex* v = run.vertices.data();
+            for (int i = 0; i + 2 < draw.count; i += 3) clipTriangle(run, v[i], v[i + 1], v[i + 2], draw, (uint32_t)d);
+        }
+        bin(run);
+    }
+
+    // Clip space, world position, normal, uv and Gouraud light of every
+    // vertex, four at a time
+    void transformVertices(const SoftDraw& draw, std::vector<SoftClipVertex>& out) const {
+        if ((int)out.size() < draw.count + 3) out.resize(draw.count + 3);
+        glm::mat4 mvp;
+        mulMat4(viewProj, draw.model, mvp);
+        const float* M = &draw.model[0][0];
+        const float* P = &mvp[0][0];
+        // Normal matrix: transpose(inverse(mat3(model))) = cofactors / det
+        glm::vec3 c0(M[0], M[1], M[2]), c1(M[4], M[5], M[6]), c2(M[8], M[9], M[10]);
+        glm::vec3 n0 = glm::cross(c1, c2), n1 = glm::cross(c2, c0), n2 = glm::cross(c0, c1);
+        float det = glm::dot(c0, n0);
+        float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+        float N[9] = { n0.x * invDet, n0.y * invDet, n0.z * invDet, n1.x * invDet, n1.y * invDet,
+                       n1.z * invDet, n2.x * invDet, n2.y * invDet, n2.z * invDet };
+        bool gouraud = (draw.needs & SOFT_NEED_VERTEX_LIGHT) != 0;
+
+        for (int i = 0; i < draw.count; i += 4) {
+            float px[4], py[4], pz[4], nx[4], ny[4], nz[4];
+            for (int j = 0; j < 4; j++) {
+                const float* src = draw.vertices + (size_t)std::min(i + j, draw.count - 1) * RENDER_VERTEX_FLOATS;
+                px[j] = src[0]; py[j] = src[1]; pz[j] = src[2];
+                nx[j] = src[3]; ny[j] = src[4]; nz[j] = src[5];
+            }
+            SoftFloat4 x = SoftFloat4::load(px), y = SoftFloat4::load(py), z = SoftFloat4::load(pz);
+            SoftFloat4 a = SoftFloat4::load(nx), b = SoftFloat4::load(ny), c = SoftFloat4::load(nz);
+            SoftFloat4 clip[4];
+            for (int r = 0; r < 4; r++)
+                clip[r] = SoftFloat4(P[r]) * x + SoftFloat4(P[4 + r]) * y + SoftFloat4(P[8 + r]) * z + SoftFloat4(P[12 + r]);
+            SoftVec4x3 world, normal;
+            world.x = SoftFloat4(M[0]) * x + SoftFloat4(M[4]) * y + SoftFloat4(M[8]) * z + SoftFloat4(M[12]);
+            world.y = SoftFloat4(M[1]) * x + SoftFloat4(M[5]) * y + SoftFloat4(M[9]) * z + SoftFloat4(M[13]);
+            world.z = SoftFloat4(M[2]) * x + SoftFloat4(M[6]) * y + SoftFloat4(M[10]) * z + SoftFloat4(M[14]);
+            normal.x = SoftFloat4(N[0]) * a + SoftFloat4(N[3]) * b + SoftFloat4(N[6]) * c;
+            normal.y = SoftFloat4(N[1]) * a + SoftFloat4(N[4]) * b + SoftFloat4(N[7]) * c;
+            normal.z = SoftFloat4(N[2]) * a + SoftFloat4(N[5]) * b + SoftFloat4(N[8]) * c;
+            SoftVec4x3 light = { SoftFloat4(1.0f), SoftFloat4(1.0f), SoftFloat4(1.0f) };
+            if (gouraud) {
+                SoftVec4x3 A, S;
+                lightFactors(world, normal, A, S);
+                light.x = sfClamp01(SoftFloat4(draw.color.x) * A.x + S.x);
+                light.y = sfClamp01(SoftFloat4(draw.color.y) * A.y + S.y);
+                light.z = sfClamp01(SoftFloat4(draw.color.z) * A.z + S.z);
+            }
+            float lanes[13][4];
+            for (int r = 0; r < 4; r++) clip[r].store(lanes[r]);
+            world.x.store(lanes[4]); world.y.store(lanes[5]); world.z.store(lanes[6]);
+            normal.x.store(lanes[7]); normal.y.store(lanes[8]); normal.z.store(lanes[9]);
+            light.x.store(lanes[10]); light.y.store(lanes[11]); light.z.store(lanes[12]);
+            for (int j = 0; j < 4 && i + j < draw.count; j++) {
+                SoftClipVertex& o = out[i + j];
+                const float* src = draw.vertices + (size_t)(i + j) * RENDER_VERTEX_FLOATS;
+                for (int r = 0; r < 4; r++) o.clip[r] = lanes[r][j];
+                for (int k = 0; k < 6; k++) o.var[k] = lanes[4 + k][j];
+                o.var[6] = src[6];
+                o.var[7] = src[7];
+                for (int k = 0; k < 3; k++) o.var[8 + k] = lanes[10 + k][j];
+            }
+        }
+    }
+
+    // Signed distance of a clip-space point to clip plane p (inside >= 0):
+    // near, far, left, right, bottom, top (guard band)
+    static float planeDistance(const float* c, int p) {
+        switch (p) {
+        case 0: return c[2] + c[3];
+        case 1: return c[3] - c[2];
+        case 2: return c[0] + SOFT_GUARD_BAND * c[3];
+        case 3: return SOFT_GUARD_BAND * c[3] - c[0];
+        case 4: return c[1] + SOFT_GUARD_BAND * c[3];
+        default: return SOFT_GUARD_BAND * c[3] - c[1];
+        }
+    }
+
+    static int outcode(const SoftClipVertex& v) {
+        int code = 0;
+        for (int p = 0; p < 6; p++)
+            if (planeDistance(v.clip, p) < 0.0f) code |= 1 << p;
+        return code;
+    }
+
+    void clipTriangle(SoftRun& run, const SoftClipVertex& a, const SoftClipVertex& b, const SoftClipVertex& c,
+                      const SoftDraw& draw, uint32_t drawIndex) {
+        int ca = outcode(a), cb = outcode(b), cc = outcode(c);
+        if (ca & cb & cc) {
+            run.culled++;
+            return;
+        }
+        int crossed = ca | cb | cc;
+        if (!crossed) {
+            setup(run, a, b, c, draw, drawIndex);
+            return;
+        }
+        // Sutherland-Hodgman against the planes the triangle crosses
+        run.clipped++;
+        SoftClipVertex poly[2][9];
+        int count = 3;
+        poly[0][0] = a;
+        poly[0][1] = b;
+        poly[0][2] = c;
+        int cur = 0;
+        for (int p = 0; p < 6 && count >= 3; p++) {
+            if (!(crossed & (1 << p))) continue;
+            const SoftClipVertex* in = poly[cur];
+            SoftClipVertex* out = poly[cur ^ 1];
+            int n = 0;
+            for (int i = 0; i < count; i++) {
+                const SoftClipVertex& s = in[i];
+                const SoftClipVertex& e = in[(i + 1) % count];
+                float ds = planeDistance(s.clip, p), de = planeDistance(e.clip, p);
+                if (ds >= 0.0f) out[n++] = s;
+                if ((ds >= 0.0f) != (de >= 0.0f)) {
+                    float t = ds / (ds - de);
+                    SoftClipVertex& o = out[n++];
+                    for (int k = 0; k < 4; k++) o.clip[k] = s.clip[k] + (e.clip[k] - s.clip[k]) * t;
+                    for (int k = 0; k < SOFT_VARYINGS; k++) o.var[k] = s.var[k] + (e.var[k] - s.var[k]) * t;
+                }
+            }
+            count = n;
+            cur ^= 1;
+        }
+        for (int i = 1; i + 1 < count; i++) setup(run, poly[cur][0], poly[cur][i], poly[cur][i + 1], draw, drawIndex);
+    }
+
+    void setup(SoftRun& run, const SoftClipVertex& va, const SoftClipVertex& vb, const SoftClipVertex& vc,
+               const SoftDraw& draw, uint32_t drawIndex) {
+        const SoftClipVertex* v[3] = { &va, &vb, &vc };
+        float sz[3], iw[3];
+        int32_t X[3], Y[3];
+        const float sub = (float)(1 << SOFT_SUBPIXEL_BITS);
+        for (int i = 0; i < 3; i++) {
+            iw[i] = 1.0f / v[i]->clip[3];
+            X[i] = (int32_t)std::floor(((v[i]->clip[0] * iw[i]) * 0.5f + 0.5f) * width * sub + 0.5f);
+            Y[i] = (int32_t)std::floor((0.5f - (v[i]->clip[1] * iw[i]) * 0.5f) * height * sub + 0.5f);
+            sz[i] = (v[i]->clip[2] * iw[i]) * 0.5f + 0.5f;
+        }
+        int64_t area = (int64_t)(X[1] - X[0]) * (Y[2] - Y[0]) - (int64_t)(X[2] - X[0]) * (Y[1] - Y[0]);
+        if (area == 0) return;
+        int order[3] = { 0, 1, 2 };
+        if (area < 0) {             // both windings are drawn (no face culling)
+            order[1] = 2;
+            order[2] = 1;
+        }
+        int32_t x[3], y[3];
+        for (int i = 0; i < 3; i++) {
+            x[i] = X[order[i]];
+            y[i] = Y[order[i]];
+        }
+        int minX = std::min(x[0], std::min(x[1], x[2])), maxX = std::max(x[0], std::max(x[1], x[2]));
+        int minY = std::min(y[0], std::min(y[1], y[2])), maxY = std::max(y[0], std::max(y[1], y[2]));
+        // Pixels whose centers (p * 16 + 8) fall inside the bounds
+        int half = 1 << (SOFT_SUBPIXEL_BITS - 1);
+        int px0 = std::max(0, (minX - half + (1 << SOFT_SUBPIXEL_BITS) - 1) >> SOFT_SUBPIXEL_BITS);
+        int py0 = std::max(0, (minY - half + (1 << SOFT_SUBPIXEL_BITS) - 1) >> SOFT_SUBPIXEL_BITS);
+        int px1 = std::min(width - 1, (maxX - half) >> SOFT_SUBPIXEL_BITS);
+        int py1 = std::min(height - 1, (maxY - half) >> SOFT_SUBPIXEL_BITS);
+        if (px0 > px1 || py0 > py1) return;
+
+        run.triangles.emplace_back();
+        SoftTriangle& t = run.triangles.back();
+        for (int i = 0; i < 3; i++) {
+            int a = (i + 1) % 3, b = (i + 2) % 3;
+            t.edgeA[i] = y[a] - y[b];
+            t.edgeB[i] = x[b] - x[a];
+            t.edgeC[i] = (int64_t)x[a] * y[b] - (int64_t)x[b] * y[a];
+            bool owned = t.edgeA[i] > 0 || (t.edgeA[i] == 0 && t.edgeB[i] > 0);
+            if (!owned) t.edgeC[i] -= 1;
+        }
+        t.minX = (int16_t)px0;
+        t.minY = (int16_t)py0;
+        t.maxX = (int16_t)px1;
+        t.maxY = (int16_t)py1;
+        t.draw = drawIndex;
+
+        // Attribute planes from the snapped positions, relative to vertex 0
+        const SoftClipVertex* o[3] = { v[order[0]], v[order[1]], v[order[2]] };
+        float fw[3], fz[3];
+        for (int i = 0; i < 3; i++) {
+            fw[i] = iw[order[i]];
+            fz[i] = sz[order[i]];
+        }
+        t.x0 = x[0] / sub;
+        t.y0 = y[0] / sub;
+        float dx1 = (x[1] - x[0]) / sub, dy1 = (y[1] - y[0]) / sub;
+        float dx2 = (x[2] - x[0]) / sub, dy2 = (y[2] - y[0]) / sub;
+        float invDet = 1.0f / (dx1 * dy2 - dx2 * dy1);
+        auto plane = [&](float* p, float f0, float f1, float f2) {
+            p[0] = f0;
+            p[1] = ((f1 - f0) * dy2 - (f2 - f0) * dy1) * invDet;
+            p[2] = ((f2 - f0) * dx1 - (f1 - f0) * dx2) * invDet;
+        };
+        plane(t.plane[0], fz[0], fz[1], fz[2]);
+        plane(t.plane[1], fw[0], fw[1], fw[2]);
+        for (int k = 0; k < SOFT_VARYINGS; k++)
+            plane(t.plane[2 + k], o[0]->var[k] * fw[0], o[1]->var[k] * fw[1], o[2]->var[k] * fw[2]);
+        t.minZ = std::min(fz[0], std::min(fz[1], fz[2]));
+
+        // Texels per pixel over the triangle's area, for the mip level
+        t.lod = 0.0f;
+        if (draw.texture.levels && (draw.needs & SOFT_NEED_UV)) {
+            const MipLevel& base = draw.texture.levels[0];
+            float du1 = o[1]->var[6] - o[0]->var[6], dv1 = o[1]->var[7] - o[0]->var[7];
+            float du2 = o[2]->var[6] - o[0]->var[6], dv2 = o[2]->var[7] - o[0]->var[7];
+            float texels = std::fabs(du1 * dv2 - du2 * dv1) * base.width * base.height;
+            float pixels = std::fabs(dx1 * dy2 - dx2 * dy1);
+            if (texels > 0.0f && pixels > 0.0f) t.lod = 0.5f * std::log2(texels / pixels);
+        }
+    }
+
+    // Every tile a triangle's bounds touch lists it, in order
+    void bin(SoftRun& run) {
+        int tiles = tilesX * tilesY;
+        run.binOffsets.assign(tiles + 1, 0);
+        for (const SoftTriangle& t : run.triangles)
+            for (int ty = t.minY / SOFT_TILE_SIZE; ty <= t.maxY / SOFT_TILE_SIZE; ty++)
+                for (int tx = t.minX / SOFT_TILE_SIZE; tx <= t.maxX / SOFT_TILE_SIZE; tx++)
+                    run.binOffsets[ty * tilesX + tx + 1]++;
+        for (int i = 0; i < tiles; i++) run.binOffsets[i + 1] += run.binOffsets[i];
+        run.binCursor.assign(run.binOffsets.begin(), run.binOffsets.end() - 1);
+        run.binTriangles.resize(run.binOffsets[tiles]);
+        for (size_t k = 0; k < run.triangles.size(); k++) {
+            const SoftTriangle& t = run.triangles[k];
+            for (int ty = t.minY / SOFT_TILE_SIZE; ty <= t.maxY / SOFT_TILE_SIZE; ty++)
+                for (int tx = t.minX / SOFT_TILE_SIZE; tx <= t.maxX / SOFT_TILE_SIZE; tx++)
+                    run.binTriangles[run.binCursor[ty * tilesX + tx]++] = (uint32_t)k;
+        }
+    }
+
+    // --------------------------------------------------------------- raster
+
+    struct TileState {
+        int x0, y0, x1, y1;         // pixel rect, exclusive end
+        float maxZ;                 // farthest depth in the tile
+        bool maxZStale;
+        long long pixels;
+    };
+
+    void rasterTile(int tile) {
+        TileState ts;
+        ts.x0 = (tile % tilesX) * SOFT_TILE_SIZE;
+        ts.y0 = (tile / tilesX) * SOFT_TILE_SIZE;
+        ts.x1 = std::min(ts.x0 + SOFT_TILE_SIZE, stride);
+        ts.y1 = std::min(ts.y0 + SOFT_TILE_SIZE, paddedHeight);
+        ts.maxZ = 1.0f;
+        ts.maxZStale = false;
+        ts.pixels = 0;
+
+        uint32_t clear = packColor(clearColor.x, clearColor.y, clearColor.z);
+        for (int y = ts.y0; y < ts.y1; y++) {
+            std::fill(&color[(size_t)y * stride + ts.x0], &color[(size_t)y * stride + ts.x1], clear);
+            std::fill(&depth[(size_t)y * stride + ts.x0], &depth[(size_t)y * stride + ts.x1], 1.0f);
+        }
+        int blocksX = stride / SOFT_BLOCK_SIZE;
+        for (int by = ts.y0; by < ts.y1; by += SOFT_BLOCK_SIZE)
+            for (int bx = ts.x0; bx < ts.x1; bx += SOFT_BLOCK_SIZE)
+                hiZ[(by / SOFT_BLOCK_SIZE) * blocksX + bx / SOFT_BLOCK_SIZE] = 1.0f;
+
+        for (int r = 0; r < runCount; r++) {
+            const SoftRun& run = runs[r];
+            for (uint32_t k = run.binOffsets[tile]; k < run.binOffsets[tile + 1]; k++) {
+                const SoftTriangle& t = run.triangles[run.binTriangles[k]];
+                if (ts.maxZStale) {
+                    ts.maxZ = 0.0f;
+                    for (int by = ts.y0; by < ts.y1; by += SOFT_BLOCK_SIZE)
+                        for (int bx = ts.x0; bx < ts.x1; bx += SOFT_BLOCK_SIZE)
+                            ts.maxZ = std::max(ts.maxZ, hiZ[(by / SOFT_BLOCK_SIZE) * blocksX + bx / SOFT_BLOCK_SIZE]);
+                    ts.maxZStale = false;
+                }
+                if (t.minZ >= ts.maxZ) continue;
+                rasterTriangle(t, draws[t.draw], ts);
+            }
+        }
+        tilePixels[tile] = ts.pixels;
+    }
+
+    SOFT_RASTER_INLINE float planeAt(const float* p, float fx, float fy) const {
+        return p[0] + p[1] * fx + p[2] * fy;
+    }
+
+    void rasterTriangle(const SoftTriangle& t, const SoftDraw& draw, TileState& ts) {
+        int x0 = std::max((int)t.minX, ts.x0) & ~(SOFT_BLOCK_SIZE - 1);
+        int y0 = std::max((int)t.minY, ts.y0) & ~(SOFT_BLOCK_SIZE - 1);
+        int x1 = std::min((int)t.maxX, ts.x1 - 1);
+        int y1 = std::min((int)t.maxY, ts.y1 - 1);
+        int blocksX = stride / SOFT_BLOCK_SIZE;
+        const int sub = 1 << SOFT_SUBPIXEL_BITS;
+        const int span = (SOFT_BLOCK_SIZE - 1) * sub;
+
+        for (int by = y0; by <= y1; by += SOFT_BLOCK_SIZE) {
+            for (int bx = x0; bx <= x1; bx += SOFT_BLOCK_SIZE) {
+                float& blockZ = hiZ[(by / SOFT_BLOCK_SIZE) * blocksX + bx / SOFT_BLOCK_SIZE];
+                // Nearest depth of the triangle's plane over the block
+                float fx = bx + 0.5f - t.x0, fy = by + 0.5f - t.y0;
+                const float* zp = t.plane[0];
+                float zc = planeAt(zp, fx, fy);
+                float zMin = zc + std::min(0.0f, zp[1] * (SOFT_BLOCK_SIZE - 1)) + std::min(0.0f, zp[2] * (SOFT_BLOCK_SIZE - 1));
+                if (std::max(zMin, t.minZ) >= blockZ) continue;
+
+                // Edges at the block's first pixel center
+                int64_t X = (int64_t)bx * sub + sub / 2, Y = (int64_t)by * sub + sub / 2;
+                int partial = 0;
+                int32_t e0[3], stepX[3], stepY[3];
+                bool outside = false;
+                for (int i = 0; i < 3; i++) {
+                    int64_t e = (int64_t)t.edgeA[i] * X + (int64_t)t.edgeB[i] * Y + t.edgeC[i];
+                    int64_t dx = (int64_t)t.edgeA[i] * span, dy = (int64_t)t.edgeB[i] * span;
+                    int64_t hi = e + std::max<int64_t>(dx, 0) + std::max<int64_t>(dy, 0);
+                    int64_t lo = e + std::min<int64_t>(dx, 0) + std::min<int64_t>(dy, 0);
+                    if (hi < 0) {
+                        outside = true;
+                        break;
+                    }
+                    if (lo >= 0) continue;
+                    e0[partial] = (int32_t)e;
+                    stepX[partial] = t.edgeA[i] * sub;
+                    stepY[partial] = t.edgeB[i] * sub;
+                    partial++;
+                }
+                if (outside) continue;
+
+                SoftInt4 row[3], half[3], down[3];
+                for (int i = 0; i < partial; i++) {
+                    row[i] = SoftInt4(e0[i], e0[i] + stepX[i], e0[i] + 2 * stepX[i], e0[i] + 3 * stepX[i]);
+                    half[i] = SoftInt4(4 * stepX[i]);
+                    down[i] = SoftInt4(stepY[i]);
+                }
+                bool wrote = false;
+                for (int r = 0; r < SOFT_BLOCK_SIZE; r++) {
+                    int py = by + r;
+                    for (int h = 0; h < 2; h++) {
+                        int mask = 0xF;
+                        if (partial) {
+                            SoftInt4 e = h ? row[0] + half[0] : row[0];
+                            for (int i = 1; i < partial; i++) e = e | (h ? row[i] + half[i] : row[i]);
+                            mask = ~siNegativeMask(e) & 0xF;
+                        }
+                        if (!mask) continue;
+                        int px = bx + h * 4;
+                        float* d = &depth[(size_t)py * stride + px];
+                        SoftFloat4 lx = SoftFloat4(px + 0.5f - t.x0) + SoftFloat4(0.0f, 1.0f, 2.0f, 3.0f);
+                        float ly = py + 0.5f - t.y0;
+                        SoftFloat4 z = SoftFloat4(zp[0] + zp[2] * ly) + SoftFloat4(zp[1]) * lx;
+                        mask &= sfLessMask(z, SoftFloat4::load(d));
+                        if (!mask) continue;
+                        shadeQuad(t, draw, lx, ly, mask, &color[(size_t)py * stride + px]);
+                        if (!draw.additive) {
+                            float zs[4];
+                            z.store(zs);
+                            for (int j = 0; j < 4; j++)
+                                if (mask & (1 << j)) d[j] = zs[j];
+                            wrote = true;
+                        }
+                        for (int j = 0; j < 4; j++) ts.pixels += (mask >> j) & 1;
+                    }
+                    for (int i = 0; i < partial; i++) row[i] = row[i] + down[i];
+                }
+                if (wrote) {
+                    SoftFloat4 m(0.0f);
+                    for (int r = 0; r < SOFT_BLOCK_SIZE; r++) {
+                        const float* d = &depth[(size_t)(by + r) * stride + bx];
+                        m = sfMax(m, sfMax(SoftFloat4::load(d), SoftFloat4::load(d + 4)));
+                    }
+                    float z4[4];
+                    m.store(z4);
+                    float newZ = std::max(std::max(z4[0], z4[1]), std::max(z4[2], z4[3]));
+                    if (newZ < blockZ) ts.maxZStale = true;
+                    blockZ = newZ;
+                }
+            }
+        }
+    }
+
+    static SOFT_RASTER_INLINE uint32_t packColor(float r, float g, float b) {
+        auto unorm = [](float c) { return (uint32_t)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return unorm(r) | unorm(g) << 8 | unorm(b) << 16 | 0xFF000000u;
+    }
+
+    // Shade the covered, depth-passing lanes of four pixels and write them
+    void shadeQuad(const SoftTriangle& t, const SoftDraw& draw, SoftFloat4 lx, float ly, int mask, uint32_t* out) {
+        SoftFloat4 r, g, b;
+        if (draw.emissive) {
+            r = SoftFloat4(draw.color.x);
+            g = SoftFloat4(draw.color.y);
+            b = SoftFloat4(draw.color.z);
+        } else {
+            SoftFloat4 fy(ly);
+            auto plane = [&](int k) {
+                const float* p = t.plane[k];
+                return SoftFloat4(p[0]) + SoftFloat4(p[1]) * lx + SoftFloat4(p[2]) * fy;
+            };
+            SoftFloat4 w = sfRcp(plane(1));
+            SoftVec4x3 tex = { SoftFloat4(1.0f), SoftFloat4(1.0f), SoftFloat4(1.0f) };
+            int mode = draw.textureMode;
+            if (mode != 0 && draw.texture.levels) {
+                float u[4], v[4], rgb[3][4];
+                (plane(2 + 6) * w).store(u);
+                (plane(2 + 7) * w).store(v);
+                for (int j = 0; j < 4; j++) {
+                    if (!(mask & (1 << j))) {
+                        rgb[0][j] = rgb[1][j] = rgb[2][j] = 0.0f;
+                        continue;
+                    }
+                    float c[3];
+                    sample(draw.texture, t.lod, u[j], v[j], c);
+                    rgb[0][j] = c[0];
+                    rgb[1][j] = c[1];
+                    rgb[2][j] = c[2];
+                }
+                tex.x = SoftFloat4::load(rgb[0]);
+                tex.y = SoftFloat4::load(rgb[1]);
+                tex.z = SoftFloat4::load(rgb[2]);
+            }
+            if (mode == 2) {
+                r = tex.x * (plane(2 + 8) * w);
+                g = tex.y * (plane(2 + 9) * w);
+                b = tex.z * (plane(2 + 10) * w);
+            } else {
+                SoftVec4x3 position = { plane(2) * w, plane(3) * w, plane(4) * w };
+                SoftVec4x3 normal = { plane(5) * w, plane(6) * w, plane(7) * w };
+                SoftVec4x3 A, S;
+                lightFactors(position, normal, A, S);
+                if (mode == 1) {
+                    r = tex.x * A.x + S.x;
+                    g = tex.y * A.y + S.y;
+                    b = tex.z * A.z + S.z;
+                } else {
+                    r = sfClamp01(SoftFloat4(draw.color.x) * A.x + S.x);
+                    g = sfClamp01(SoftFloat4(draw.color.y) * A.y + S.y);
+                    b = sfClamp01(SoftFloat4(draw.color.z) * A.z + S.z);
+                    if (mode == 3) {
+                        r = r * tex.x;
+                        g = g * tex.y;
+                        b = b * tex.z;
+                    }
+                }
+            }
+        }
+        float rs[4], gs[4], bs[4];
+        sfClamp01(r).store(rs);
+        sfClamp01(g).store(gs);
+        sfClamp01(b).store(bs);
+        for (int j = 0; j < 4; j++) {
+            if (!(mask & (1 << j))) continue;
+            if (!draw.additive) {
+                out[j] = packColor(rs[j], gs[j], bs[j]);
+                continue;
+            }
+            // GL_SRC_ALPHA, GL_ONE
+            uint32_t dst = out[j];
+            out[j] = packColor((dst & 0xFF) / 255.0f + rs[j] * draw.alpha,
+                               ((dst >> 8) & 0xFF) / 255.0f + gs[j] * draw.alpha,
+                               ((dst >> 16) & 0xFF) / 255.0f + bs[j] * draw.alpha);
+        }
+    }
+
+    // ------------------------------------------------------------- textures
+
+    static SOFT_RASTER_INLINE int wrapTexel(int i, int n, GLenum wrap) {
+        if (wrap == GL_CLAMP_TO_EDGE) return std::min(std::max(i, 0), n - 1);
+        if (wrap == GL_MIRRORED_REPEAT) {
+            int m = i % (2 * n);
+            if (m < 0) m += 2 * n;
+            return m < n ? m : 2 * n - 1 - m;
+        }
+        int m = i % n;
+        return m < 0 ? m + n : m;
+    }
+
+    // Wrap a coordinate before scaling so large repeats keep their precision
+    static SOFT_RASTER_INLINE float wrapCoord(float s, GLenum wrap) {
+        if (wrap == GL_REPEAT) return s - std::floor(s);
+        if (wrap == GL_MIRRORED_REPEAT) return s - 2.0f * std::floor(s * 0.5f);
+        return s;
+    }
+
+    static void sample(const SoftTexture& tex, float lod, float u, float v, float rgb[3]) {
+        int level = tex.firstLevel;
+        bool linear = tex.filter != GL_NEAREST;
+        if (lod > 0.0f) {
+            level = std::min(std::max((int)(lod + 0.5f), tex.firstLevel), tex.levelCount - 1);
+            linear = true;
+        }
+        const MipLevel& L = tex.levels[level];
+        const unsigned char* px = L.pixels.data();
+        float fu = wrapCoord(u, tex.wrap) * L.width, fv = wrapCoord(v, tex.wrap) * L.height;
+        if (!linear) {
+            int i = wrapTexel((int)std::floor(fu), L.width, tex.wrap);
+            int j = wrapTexel((int)std::floor(fv), L.height, tex.wrap);
+            const unsigned char* p = px + ((size_t)j * L.width + i) * 3;
+            for (int c = 0; c < 3; c++) rgb[c] = p[c] * (1.0f / 255.0f);
+            return;
+        }
+        fu -= 0.5f;
+        fv -= 0.5f;
+        float iu = std::floor(fu), iv = std::floor(fv);
+        float tu = fu - iu, tv = fv - iv;
+        int i0 = wrapTexel((int)iu, L.width, tex.wrap), i1 = wrapTexel((int)iu + 1, L.width, tex.wrap);
+        int j0 = wrapTexel((int)iv, L.height, tex.wrap), j1 = wrapTexel((int)iv + 1, L.height, tex.wrap);
+        const unsigned char* p00 = px + ((size_t)j0 * L.width + i0) * 3;
+        const unsigned char* p10 = px + ((size_t)j0 * L.width + i1) * 3;
+        const unsigned char* p01 = px + ((size_t)j1 * L.width + i0) * 3;
+        const unsigned char* p11 = px + ((size_t)j1 * L.width + i1) * 3;
+        for (int c = 0; c < 3; c++) {
+            float top = p00[c] + (p10[c] - p00[c]) * tu;
+            float bottom = p01[c] + (p11[c] - p01[c]) * tu;
+            rgb[c] = (top + (bottom - top) * tv) * (1.0f / 255.0f);
+        }
+    }
+};
+
+#endif
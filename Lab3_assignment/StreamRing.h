@@ -0,0 +1,187 @@
+#ifndef STREAM_RING_H
+#define STREAM_RING_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include "GLExtensions.h"
+#include "GpuRegistry.h"
+
+// ============================================================================
+// STREAM RING - per-frame dynamic data through one mapped buffer
+// ============================================================================
+// One buffer object split into STREAM_RING_REGIONS equal regions: frame N
+// writes region N % 3 while the GPU may still be reading the two before it.
+// Producers (render queue draw records and indirect commands, instance
+// batches, HUD vertices) ask alloc() for space, memcpy into the returned
+// pointer and draw from the returned offset, with no glBufferData /
+// glBufferSubData per frame:
+//
+//   persistent      GL 4.4 / ARB_buffer_storage: immutable storage, mapped
+//                   once PERSISTENT | COHERENT for the life of the ring
+//   unsynchronized  otherwise: the rest of the region is mapped
+//                   UNSYNCHRONIZED | FLUSH_EXPLICIT on the first alloc()
+//                   after a flush, and flush() unmaps it. flush() must run
+//                   before a draw reads the data; it is a no-op when
+//                   persistent.
+//
+// endFrame() puts a fence after the frame's last draw; beginFrame() waits
+// on the fence of the region it is about to overwrite. A wait that had to
+// block is a stall, counted and timed. alloc() returns a null pointer when
+// the request does not fit in what is left of the region (an overflow);
+// callers then fall back to their own buffer, so a region that is too
+// small costs speed, not correctness.
+// ============================================================================
+
+const int STREAM_RING_REGIONS = 3;
+const GLuint64 STREAM_RING_WAIT_NS = 100000000;   // per ClientWaitSync call while stalled
+
+struct StreamRingStats {
+    size_t bytes = 0;           // used in this frame's region, padding included
+    int allocs = 0;
+    int overflows = 0;          // allocs that did not fit
+    int stalls = 0;             // fence waits that blocked
+    double stallMs = 0.0;
+};
+
+class StreamRing {
+public:
+    unsigned int buffer = 0;
+    bool allowPersistent = true;    // false forces the unsynchronized path
+    bool persistent = false;
+    StreamRingStats stats, lastFrameStats;
+    int totalStalls = 0, totalOverflows = 0;
+    double totalStallMs = 0.0;
+    size_t highWater = 0;       // most bytes one frame used
+
+    void init(size_t bytesPerRegion) {
+        regionBytes = (bytesPerRegion + 255) / 256 * 256;
+        size_t total = regionBytes * STREAM_RING_REGIONS;
+        buffer = gpuRegistry().genBuffer("stream ring");
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (allowPersistent && glExtensions().bufferStorage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_EXT_MAP_PERSISTENT_BIT | GL_EXT_MAP_COHERENT_BIT;
+            glExtensions().bufferStorageFn(GL_COPY_WRITE_BUFFER, total, NULL, flags);
+            base = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags);
+            persistent = base != nullptr;
+            if (!persistent) {
+                // Immutable storage cannot be respecified: start over
+                gpuRegistry().deleteBuffer(buffer);
+                buffer = gpuRegistry().genBuffer("stream ring");
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            }
+        }
+        if (!persistent) glBufferData(GL_COPY_WRITE_BUFFER, total, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        gpuRegistry().setBytes(GPU_BUFFER, buffer, total);
+        std::cout << "Stream ring: " << STREAM_RING_REGIONS << " x " << regionBytes / 1024 << " KB, "
+                  << (persistent ? "persistent coherent mapping" : "unsynchronized mapping per frame") << std::endl;
+    }
+
+    // Waits until the GPU is done with this frame's region
+    void beginFrame() {
+        head = region * regionBytes;
+        GLsync& fence = fences[region];
+        if (!fence) return;
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            auto t0 = std::chrono::steady_clock::now();
+            GLenum r;
+            do {
+                r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_RING_WAIT_NS);
+            } while (r == GL_TIMEOUT_EXPIRED);
+            stats.stalls++;
+            stats.stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    // bytes at an offset (from the start of buffer) that is a multiple of
+    // align, which may be any stride (a vertex size), not only a power of 2
+    void* alloc(size_t bytes, size_t align, size_t& offset) {
+        size_t at = (head + align - 1) / align * align;
+        if (at + bytes > (region + 1) * regionBytes) {
+            stats.overflows++;
+            return nullptr;
+        }
+        unsigned char* dst;
+        if (persistent) {
+            dst = base + at;
+        } else {
+            if (!mapped && !map()) {
+                stats.overflows++;
+                return nullptr;
+            }
+            dst = mapped + (at - mapStart);
+        }
+        offset = at;
+        head = at + bytes;
+        stats.allocs++;
+        stats.bytes = head - region * regionBytes;
+        return dst;
+    }
+
+    // Makes this frame's writes so far visible to the GL
+    void flush() {
+        if (!mapped) return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, head - mapStart);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mapped = nullptr;
+    }
+
+    // After the frame's last draw that reads the ring
+    void endFrame() {
+        flush();
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        if (stats.bytes > highWater) highWater = stats.bytes;
+        totalStalls += stats.stalls;
+        totalOverflows += stats.overflows;
+        totalStallMs += stats.stallMs;
+        lastFrameStats = stats;
+        stats = StreamRingStats();
+        region = (region + 1) % STREAM_RING_REGIONS;
+    }
+
+    size_t bytesPerRegion() const { return regionBytes; }
+    size_t totalBytes() const { return regionBytes * STREAM_RING_REGIONS; }
+
+    void cleanup() {
+        for (int i = 0; i < STREAM_RING_REGIONS; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        if (buffer && (persistent || mapped)) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        base = mapped = nullptr;
+        gpuRegistry().deleteBuffer(buffer);
+    }
+
+private:
+    size_t regionBytes = 0;
+    int region = 0;
+    size_t head = 0;                    // next free byte of the buffer
+    GLsync fences[STREAM_RING_REGIONS] = { 0, 0, 0 };
+    unsigned char* base = nullptr;      // whole buffer, persistent mode
+    unsigned char* mapped = nullptr;    // [mapStart, region end), unsynchronized mode
+    size_t mapStart = 0;
+
+    bool map() {
+        mapStart = head;
+        size_t length = (region + 1) * regionBytes - head;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, mapStart, length,
+                                                  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                                  GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return mapped != nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include "stb_image.h"
+#include "GLState.h"
+#include "GpuRegistry.h"
+#include "Profiler.h"
+
+// ============================================================================
+// TEXTURE ARRAY - same-class textures packed into one GL_TEXTURE_2D_ARRAY
+// ============================================================================
+// Every layer is resampled to a common size so materials that share a shader
+// path (road, grass, wall, container...) can be sampled with
+// texture(arr, vec3(uv, layer)) and drawn together in one instanced call.
+// Decoding and resampling run on a background task; poll() uploads the
+// finished array on the GL thread. Until then layer lookups return -1 and
+// callers draw untextured, the same as a missing 2D texture.
+//
+// keepPixels keeps the decoded layers (bottom row first, as uploaded) for
+// the software rasterizer (SoftRaster.h).
+// ============================================================================
+
+class TextureArray {
+public:
+    unsigned int ID = 0;
+    int layerSize = 512;
+    bool keepPixels = false;
+
+    // Add a layer source; returns its layer index
+    int addLayer(const char* path) {
+        paths.push_back(path);
+        return (int)paths.size() - 1;
+    }
+
+    int layerCount() const { return (int)paths.size(); }
+
+    // Start decoding all layers in the background
+    void build(int size) {
+        layerSize = size;
+        std::vector<std::string> files = paths;
+        pendingPixels = std::async(std::launch::async, [files, size]() {
+            return decodeLayers(files, size);
+        });
+        building = true;
+    }
+
+    // Upload on the GL thread once the background decode has finished.
+    // Returns true on the frame the array becomes ready.
+    bool poll() {
+        if (!building) return false;
+        if (pendingPixels.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        PROFILE_ZONE("texture array upload");
+        std::vector<unsigned char> pixels = pendingPixels.get();
+        building = false;
+
+        ID = gpuRegistry().genTexture("city texture array");
+        glState().bindForEdit(0, GL_TEXTURE_2D_ARRAY, ID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, layerSize, layerSize, layerCount(), 0,
+                     GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        gpuRegistry().setBytes(GPU_TEXTURE, ID, bytes());
+        if (keepPixels) layerPixels.swap(pixels);
+        glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+        std::cout << "  Texture array: " << layerCount() << " layers @ "
+                  << layerSize << "x" << layerSize << " [OK]" << std::endl;
+        return true;
+    }
+
+    bool ready() const { return ID != 0; }
+
+    // RGB8 level 0 of a layer (keepPixels), or null
+    const unsigned char* pixels(int index) const {
+        if (layerPixels.empty() || index < 0 || index >= layerCount()) return nullptr;
+        return layerPixels.data() + (size_t)layerSize * layerSize * 3 * index;
+    }
+
+    // Layer to sample, or -1 while the array is not uploaded yet
+    float layer(int index) const { return ready() ? (float)index : -1.0f; }
+
+    size_t bytes() const {
+        // RGB8 (stored padded to 4 bytes) level 0 plus ~1/3 for the mip chain
+        return ready() ? (size_t)layerSize * layerSize * 4 * layerCount() * 4 / 3 : 0;
+    }
+
+    void cleanup() {
+        if (building) {
+            pendingPixels.wait();
+            building = false;
+        }
+        gpuRegistry().deleteTexture(ID);
+        std::vector<unsigned char>().swap(layerPixels);
+    }
+
+private:
+    std::vector<std::string> paths;
+    std::vector<unsigned char> layerPixels;
+    std::future<std::vector<unsigned char> > pendingPixels;
+    bool building = false;
+
+    // Decode every file and bilinearly resample it to size x size RGB.
+    // Missing files become a mid-grey layer so indices stay stable.
+    static std::vector<unsigned char> decodeLayers(const std::vector<std::string>& files, int size) {
+        profiler().setThreadName("texture array builder");
+        PROFILE_ZONE("texture array decode");
+        stbi_set_flip_vertically_on_load_thread(true);
+        size_t layerBytes = (size_t)size * size * 3;
+        std::vector<unsigned char> out(layerBytes * files.size(), 128);
+        for (size_t l = 0; l < files.size(); l++) {
+            int w = 0, h = 0, n = 0;
+            unsigned char* data = stbi_load(files[l].c_str(), &w, &h, &n, 3);
+            if (!data) {
+                std::cout << "  Texture array: " << files[l] << " [--] "
+                          << stbi_failure_reason() << std::endl;
+                continue;
+            }
+            resample(data, w, h, out.data() + layerBytes * l, size);
+            stbi_image_free(data);
+        }
+        return out;
+    }
+
+    static void resample(const unsigned char* src, int w, int h, unsigned char* dst, int size) {
+        for (int y = 0; y < size; y++) {
+            float fy = std::max(0.0f, (y + 0.5f) * h / size - 0.5f);
+            int y0 = std::min((int)fy, h - 1);
+            int y1 = std::min(y0 + 1, h - 1);
+            float ty = fy - y0;
+            for (int x = 0; x < size; x++) {
+                float fx = std::max(0.0f, (x + 0.5f) * w / size - 0.5f);
+                int x0 = std::min((int)fx, w - 1);
+                int x1 = std::min(x0 + 1, w - 1);
+                float tx = fx - x0;
+                for (int c = 0; c < 3; c++) {
+                    float a = src[(y0 * w + x0) * 3 + c] * (1.0f - tx) + src[(y0 * w + x1) * 3 + c] * tx;
+                    float b = src[(y1 * w + x0) * 3 + c] * (1.0f - tx) + src[(y1 * w + x1) * 3 + c] * tx;
+                    dst[(y * size + x) * 3 + c] = (unsigned char)(a * (1.0f - ty) + b * ty + 0.5f);
+                }
+            }
+        }
+    }
+};
+
+// ============================================================================
+// SAMPLER - wrap/filter state kept outside the texture objects
+// ============================================================================
+class Sampler {
+public:
+    unsigned int ID = 0;
+
+    void init(GLenum wrapMode, GLenum magFilter) {
+        ID = gpuRegistry().genSampler("sampler");
+        glSamplerParameteri(ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        set(wrapMode, magFilter);
+    }
+
+    void set(GLenum wrapMode, GLenum magFilter) {
+        glSamplerParameteri(ID, GL_TEXTURE_WRAP_S, wrapMode);
+        glSamplerParameteri(ID, GL_TEXTURE_WRAP_T, wrapMode);
+        glSamplerParameteri(ID, GL_TEXTURE_MAG_FILTER, magFilter);
+    }
+
+    void bind(unsigned int unit) const { glState().bindSampler(unit, ID); }
+
+    void cleanup() {
+        gpuRegistry().deleteSampler(ID);
+    }
+};
+
+#endif
@@ -0,0 +1,741 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <utility>
+#include <cstdlib>
+#include "stb_image.h"
+#include "GLState.h"
+#include "GpuRegistry.h"
+#include "Profiler.h"
+
+// ============================================================================
+// TEXTURE CACHE - lazy, budgeted texture residency
+// ============================================================================
+// Textures are registered by path and handed out as small integer handles
+// (0 = no texture). Nothing is decoded until a draw asks for the handle with
+// use(): the first request queues the file on a background decode thread and
+// returns a 1x1 white fallback until the pixels are ready. GL uploads happen
+// on the render thread in update(), which also evicts least-recently-drawn
+// textures once the resident total exceeds budgetBytes.
+//
+// Mip streaming: the worker builds the whole mip chain on the CPU. The first
+// upload only sends the small tail (<= STREAM_TAIL_DIM) so the texture is
+// sampleable immediately; finer levels then trickle in through one pixel
+// buffer object (orphaned per chunk), at most uploadBudgetBytes per frame, and
+// GL_TEXTURE_BASE_LEVEL is lowered as each level completes.
+//
+// Residency: every GL texture in the app is either owned here or registered
+// with track(), so the totals cover all texture memory. Sizes are accounted
+// per level and per internal format. Over budget, the least-recently-drawn
+// texture first loses its finest mip levels (the storage is reallocated
+// without them); only once it is down to the streaming tail is it evicted
+// outright. Drawing a trimmed texture again reloads the full chain if it
+// fits. shutdown() reports anything still alive as a leak.
+//
+// keepPixels keeps each decoded chain in its entry until the texture is
+// evicted, for the software rasterizer (SoftRaster.h).
+// ============================================================================
+
+const int MAX_TEXTURE_DIM = 2048;
+const int STREAM_TAIL_DIM = 64;     // levels at or below this size upload at once
+
+enum TextureState {
+    TEX_UNLOADED,   // registered, never requested (or evicted)
+    TEX_LOADING,    // queued / decoding on the worker thread
+    TEX_RESIDENT,   // uploaded, glID is valid
+    TEX_MISSING     // file not found or failed to decode; draws go untextured
+};
+
+struct MipLevel {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;   // RGB8, tightly packed
+};
+
+struct TextureEntry {
+    std::string path;
+    GLenum wrapMode = GL_REPEAT;
+    GLenum filterMode = GL_LINEAR;
+    TextureState state = TEX_UNLOADED;
+    unsigned int glID = 0;
+    int width = 0, height = 0;
+    size_t bytes = 0;                 // level 0 + mip chain
+    unsigned long lastUsedFrame = 0;
+    int baseLevel = 0;                // finest level currently sampleable
+    int topLevel = 0;                 // finest level with storage (> 0 once trimmed)
+    GLenum internalFormat = GL_RGB8;
+    std::vector<size_t> levelBytes;   // GPU bytes of each level, allocated or not
+    bool reloading = false;           // full chain requested again after a trim
+    std::vector<MipLevel> pixels;     // CPU copy of the chain (keepPixels)
+};
+
+// A texture created outside the cache (e.g. a texture array), registered so
+// it shows up in the totals and in the shutdown leak check
+struct TrackedTexture {
+    unsigned int glID = 0;
+    std::string label;
+    GLenum internalFormat = GL_RGB8;
+    size_t bytes = 0;
+};
+
+// Result handed back from the decode thread
+struct DecodedTexture {
+    unsigned int handle = 0;
+    std::vector<MipLevel> levels;     // [0] = full size ... last = 1x1
+    int srcWidth = 0, srcHeight = 0;
+    const char* error = nullptr;
+};
+
+// A texture whose finer levels are still being streamed in
+struct StreamJob {
+    unsigned int handle = 0;
+    std::vector<MipLevel> levels;
+    int level = 0;                    // level currently uploading
+    int nextRow = 0;                  // first row of `level` not yet sent
+};
+
+class TextureCache {
+public:
+    size_t budgetBytes = 32u * 1024u * 1024u;
+    size_t uploadBudgetBytes = 1u * 1024u * 1024u;   // streamed bytes per frame
+    bool streamMips = true;                          // false = upload all levels at once
+    bool keepPixels = false;                         // CPU copies of resident textures
+
+    ~TextureCache() { shutdown(); }
+
+    void init() {
+        if (running) return;
+        // 1x1 white: textured modes degrade to plain lit objectColor
+        unsigned char white[3] = { 255, 255, 255 };
+        fallbackID = genTexture();
+        glState().bindForEdit(0, GL_TEXTURE_2D, fallbackID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, white);
+        gpuRegistry().setBytes(GPU_TEXTURE, fallbackID, formatBytes(GL_RGB8));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // Orphaned each chunk: the driver hands back fresh storage while
+        // the GPU still reads the last chunk's, so one buffer never stalls
+        // the next write
+        gpuRegistry().genBuffers(1, &pbo, "texture upload pbo");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBudgetBytes, NULL, GL_STREAM_DRAW);
+        gpuRegistry().setBytes(GPU_BUFFER, pbo, uploadBudgetBytes);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        running = true;
+        glReady = true;
+        worker = std::thread(&TextureCache::workerLoop, this);
+    }
+
+    // Register a texture file. Returns a non-zero handle; no I/O happens here.
+    unsigned int add(const char* path, GLenum wrapMode, GLenum filterMode) {
+        TextureEntry e;
+        e.path = path;
+        e.wrapMode = wrapMode;
+        e.filterMode = filterMode;
+        entries.push_back(e);
+        return (unsigned int)entries.size();
+    }
+
+    // Resolve a handle for drawing this frame. Returns the GL texture to bind,
+    // the fallback while the file is still loading, or 0 if there is nothing
+    // to sample (no handle, or the file is missing).
+    unsigned int use(unsigned int handle) {
+        if (handle == 0 || handle > entries.size()) return 0;
+        TextureEntry& e = entries[handle - 1];
+        e.lastUsedFrame = frame;
+        switch (e.state) {
+            case TEX_RESIDENT:
+                if (e.topLevel > 0 && !e.reloading) requestReload(handle);
+                return e.glID;
+            case TEX_MISSING:  return 0;
+            case TEX_UNLOADED: request(handle); return fallbackID;
+            default:           return fallbackID;
+        }
+    }
+
+    // Registration and residency of a handle, or null
+    const TextureEntry* entry(unsigned int handle) const {
+        if (handle == 0 || handle > entries.size()) return nullptr;
+        return &entries[handle - 1];
+    }
+
+    // GL name of a resident texture without touching LRU state (0 otherwise)
+    unsigned int residentID(unsigned int handle) const {
+        if (handle == 0 || handle > entries.size()) return 0;
+        const TextureEntry& e = entries[handle - 1];
+        return e.state == TEX_RESIDENT ? e.glID : 0;
+    }
+
+    // Once per frame on the GL thread: upload finished decodes, enforce budget
+    void update() {
+        PROFILE_ZONE("texture update");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(done);
+        }
+        for (auto& d : ready) upload(d);
+        ready.clear();
+        streamLevels();
+        evict();
+        frame++;
+    }
+
+    // Register a texture this cache did not create. Bytes are computed from
+    // the format and size: a full mip chain per layer if mipmapped.
+    void track(unsigned int glID, const char* label, GLenum internalFormat,
+               int width, int height, int layers, bool mipmapped) {
+        if (glID == 0) return;
+        TrackedTexture t;
+        t.glID = glID;
+        t.label = label;
+        t.internalFormat = internalFormat;
+        size_t perLayer = mipmapped ? mipChainBytes(width, height, (int)formatBytes(internalFormat))
+                                    : (size_t)width * height * formatBytes(internalFormat);
+        t.bytes = perLayer * layers;
+        tracked.push_back(t);
+    }
+
+    // Call before the owner deletes a tracked texture
+    void untrack(unsigned int glID) {
+        for (size_t i = 0; i < tracked.size(); i++) {
+            if (tracked[i].glID == glID) {
+                tracked.erase(tracked.begin() + i);
+                return;
+            }
+        }
+    }
+
+    size_t residentBytes() const { return totalBytes; }
+
+    size_t trackedBytes() const {
+        size_t n = 0;
+        for (const auto& t : tracked) n += t.bytes;
+        return n;
+    }
+
+    // Everything texture-shaped on the GPU: cache, tracked, fallback
+    size_t totalTextureBytes() const {
+        return totalBytes + trackedBytes() + (fallbackID ? formatBytes(GL_RGB8) : 0);
+    }
+
+    int liveTextureCount() const { return texturesCreated - texturesDeleted + (int)tracked.size(); }
+
+    int residentCount() const {
+        int n = 0;
+        for (const auto& e : entries) if (e.state == TEX_RESIDENT) n++;
+        return n;
+    }
+
+    int pendingCount() const {
+        int n = 0;
+        for (const auto& e : entries) if (e.state == TEX_LOADING) n++;
+        return n;
+    }
+
+    int evictionCount() const { return evictions; }
+    int droppedLevelCount() const { return droppedLevels; }
+    int streamingCount() const { return (int)streams.size(); }
+    size_t streamedBytesLastFrame() const { return lastFrameStreamed; }
+
+    // Per-texture breakdown for the status print
+    void printReport() const {
+        for (const auto& e : entries) {
+            if (e.state != TEX_RESIDENT) continue;
+            int w = std::max(1, e.width >> e.topLevel), h = std::max(1, e.height >> e.topLevel);
+            std::cout << "    " << e.path << "  " << formatName(e.internalFormat) << " "
+                      << w << "x" << h << "  levels " << e.topLevel << "-" << e.levelBytes.size() - 1
+                      << " (sampling from " << e.baseLevel << ")  " << e.bytes / 1024 << " KB"
+                      << (e.reloading ? "  reloading" : "") << std::endl;
+        }
+        for (const auto& t : tracked) {
+            std::cout << "    " << t.label << "  " << formatName(t.internalFormat) << "  "
+                      << t.bytes / 1024 << " KB (tracked)" << std::endl;
+        }
+    }
+
+    // 2x2 box filter; odd edges clamp to the last row/column. Public for
+    // other CPU-side mip chains (SoftRaster.h).
+    static MipLevel downsample(const MipLevel& src) {
+        MipLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.pixels.resize((size_t)dst.width * dst.height * 3);
+        for (int y = 0; y < dst.height; y++) {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; x++) {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                for (int c = 0; c < 3; c++) {
+                    int sum = src.pixels[(y0 * src.width + x0) * 3 + c]
+                            + src.pixels[(y0 * src.width + x1) * 3 + c]
+                            + src.pixels[(y1 * src.width + x0) * 3 + c]
+                            + src.pixels[(y1 * src.width + x1) * 3 + c];
+                    dst.pixels[(y * dst.width + x) * 3 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+
+    void shutdown() {
+        if (running) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+            }
+            cv.notify_all();
+            if (worker.joinable()) worker.join();
+            done.clear();
+            pending.clear();
+        }
+        streams.clear();
+        if (!glReady) return;
+        gpuRegistry().deleteBuffers(1, &pbo);
+        for (auto& e : entries) {
+            if (e.glID) deleteTexture(e.glID);
+            e.glID = 0;
+            e.state = TEX_UNLOADED;
+        }
+        totalBytes = 0;
+        if (fallbackID) deleteTexture(fallbackID);
+        fallbackID = 0;
+
+        // Leak check: tracked textures should have been untracked by their
+        // owners, and every texture created here should be gone
+        for (auto& t : tracked) {
+            std::cout << "  Texture LEAK: " << t.label << " (id " << t.glID << ", "
+                      << t.bytes / 1024 << " KB) still alive at shutdown" << std::endl;
+            gpuRegistry().deleteTexture(t.glID);
+        }
+        if (texturesCreated != texturesDeleted) {
+            std::cout << "  Texture LEAK: " << texturesCreated - texturesDeleted
+                      << " cache-owned textures not deleted" << std::endl;
+        }
+        if (tracked.empty() && texturesCreated == texturesDeleted)
+            std::cout << "  Textures: all " << texturesCreated << " released" << std::endl;
+        tracked.clear();
+        glReady = false;
+    }
+
+private:
+    std::vector<TextureEntry> entries;
+    unsigned int fallbackID = 0;
+    unsigned long frame = 1;
+    size_t totalBytes = 0;
+    int evictions = 0;
+    int droppedLevels = 0;
+    std::vector<TrackedTexture> tracked;
+    int texturesCreated = 0, texturesDeleted = 0;
+    bool glReady = false;
+
+    // Streaming state (GL thread only)
+    std::vector<StreamJob> streams;
+    unsigned int pbo = 0;
+    size_t lastFrameStreamed = 0;
+
+    // Worker thread state (guarded by mutex)
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<unsigned int, std::string> > pending;
+    std::deque<DecodedTexture> done;
+    bool running = false;
+    std::deque<DecodedTexture> ready;      // update()'s side of the swap, kept so polling does not allocate
+
+    void request(unsigned int handle) {
+        TextureEntry& e = entries[handle - 1];
+        e.state = TEX_LOADING;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::make_pair(handle, e.path));
+        }
+        cv.notify_one();
+    }
+
+    // Queue the full chain again for a trimmed texture, if it would fit once
+    // textures not drawn last frame are trimmed in its place. The trimmed
+    // texture stays bound until the new one is uploaded.
+    void requestReload(unsigned int handle) {
+        TextureEntry& e = entries[handle - 1];
+        size_t full = 0;
+        for (size_t b : e.levelBytes) full += b;
+        size_t reclaimable = 0;
+        for (const auto& o : entries) {
+            if (&o == &e || o.state != TEX_RESIDENT || o.lastUsedFrame + 1 >= frame) continue;
+            reclaimable += o.bytes;
+        }
+        if (totalBytes - e.bytes + full > budgetBytes + reclaimable) return;
+        e.reloading = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::make_pair(handle, e.path));
+        }
+        cv.notify_one();
+    }
+
+    void workerLoop() {
+        profiler().setThreadName("texture worker");
+        stbi_set_flip_vertically_on_load_thread(true);
+        for (;;) {
+            std::pair<unsigned int, std::string> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return !running || !pending.empty(); });
+                if (!running) return;
+                job = pending.front();
+                pending.pop_front();
+            }
+            DecodedTexture d = decode(job.second.c_str());
+            d.handle = job.first;
+            std::lock_guard<std::mutex> lock(mutex);
+            done.push_back(std::move(d));
+        }
+    }
+
+    // Runs on the worker thread: file check, stb decode, downscale
+    static DecodedTexture decode(const char* path) {
+        PROFILE_ZONE("texture decode");
+        DecodedTexture d;
+        {
+            std::ifstream testFile(path, std::ios::binary);
+            if (!testFile.good()) { d.error = "not found"; return d; }
+        }
+
+        int width = 0, height = 0, nrChannels = 0;
+        if (!stbi_info(path, &width, &height, &nrChannels) || width <= 0 || height <= 0) {
+            d.error = "invalid/corrupt image";
+            return d;
+        }
+
+        // Force 3 channels (RGB)
+        unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 3);
+        if (!data) { d.error = stbi_failure_reason(); return d; }
+        d.srcWidth = width;
+        d.srcHeight = height;
+
+        // Downscale if too large (nearest sample)
+        int outW = width, outH = height;
+        if (outW > MAX_TEXTURE_DIM || outH > MAX_TEXTURE_DIM) {
+            float scale = std::min((float)MAX_TEXTURE_DIM / outW, (float)MAX_TEXTURE_DIM / outH);
+            outW = std::max(1, (int)(width * scale));
+            outH = std::max(1, (int)(height * scale));
+        }
+        MipLevel base;
+        base.width = outW;
+        base.height = outH;
+        base.pixels.resize((size_t)outW * outH * 3);
+        unsigned char* out = base.pixels.data();
+        if (outW == width && outH == height) {
+            std::copy(data, data + (size_t)width * height * 3, out);
+        } else {
+            float scale = (float)outW / width;
+            for (int y = 0; y < outH; y++) {
+                for (int x = 0; x < outW; x++) {
+                    int srcX = std::min((int)(x / scale), width - 1);
+                    int srcY = std::min((int)(y / scale), height - 1);
+                    int si = (srcY * width + srcX) * 3;
+                    int di = (y * outW + x) * 3;
+                    out[di] = data[si];
+                    out[di + 1] = data[si + 1];
+                    out[di + 2] = data[si + 2];
+                }
+            }
+        }
+        stbi_image_free(data);
+        d.levels.push_back(std::move(base));
+
+        // Build the rest of the chain here so the GL thread never has to
+        // call glGenerateMipmap
+        while (d.levels.back().width > 1 || d.levels.back().height > 1) {
+            d.levels.push_back(downsample(d.levels.back()));
+        }
+        return d;
+    }
+
+    void upload(DecodedTexture& d) {
+        PROFILE_ZONE("texture upload");
+        TextureEntry& e = entries[d.handle - 1];
+        bool reload = e.state == TEX_RESIDENT && e.reloading;
+        if (e.state != TEX_LOADING && !reload) return;     // evicted/reset while decoding
+        e.reloading = false;
+        if (reload && d.levels.empty()) return;            // keep the trimmed copy
+        if (d.levels.empty()) {
+            std::cout << "  Texture " << e.path << " [--] " << d.error << std::endl;
+            e.state = TEX_MISSING;
+            return;
+        }
+
+        if (keepPixels) e.pixels = d.levels;
+        int numLevels = (int)d.levels.size();
+        const MipLevel& top = d.levels[0];
+
+        // Find the finest level of the small tail that goes up immediately
+        int firstLevel = 0;
+        if (streamMips) {
+            while (firstLevel < numLevels - 1 &&
+                   std::max(d.levels[firstLevel].width, d.levels[firstLevel].height) > STREAM_TAIL_DIM)
+                firstLevel++;
+        }
+
+        if (reload) {
+            // Levels that were resident before the trim go up at once
+            firstLevel = std::min(firstLevel, e.topLevel);
+            cancelStream(d.handle);
+            deleteTexture(e.glID);
+            totalBytes -= e.bytes;
+        }
+
+        e.glID = genTexture();
+        e.internalFormat = GL_RGB8;
+        e.levelBytes.clear();
+        glState().bindForEdit(0, GL_TEXTURE_2D, e.glID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // Allocate every level; streamed ones are filled in later
+        for (int i = 0; i < numLevels; i++) {
+            const MipLevel& L = d.levels[i];
+            glTexImage2D(GL_TEXTURE_2D, i, e.internalFormat, L.width, L.height, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                         i >= firstLevel ? L.pixels.data() : NULL);
+            e.levelBytes.push_back((size_t)L.width * L.height * formatBytes(e.internalFormat));
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, e.wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, e.wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, e.filterMode);
+
+        e.width = top.width;
+        e.height = top.height;
+        e.bytes = 0;
+        for (size_t b : e.levelBytes) e.bytes += b;
+        gpuRegistry().setBytes(GPU_TEXTURE, e.glID, e.bytes);
+        e.baseLevel = firstLevel;
+        e.topLevel = 0;
+        e.state = TEX_RESIDENT;
+        totalBytes += e.bytes;
+
+        std::cout << "  Texture " << e.path << " " << d.srcWidth << "x" << d.srcHeight;
+        if (top.width != d.srcWidth || top.height != d.srcHeight)
+            std::cout << " resized->" << top.width << "x" << top.height;
+        if (reload)
+            std::cout << " [reloaded]";
+        else if (firstLevel > 0)
+            std::cout << " [OK, streaming " << firstLevel << " levels]";
+        else
+            std::cout << " [OK]";
+        std::cout << " (" << totalBytes / 1024 << " KB resident)" << std::endl;
+
+        if (firstLevel > 0) {
+            StreamJob job;
+            job.handle = d.handle;
+            job.levels.swap(d.levels);
+            job.levels.resize(firstLevel);      // the tail is already on the GPU
+            job.level = firstLevel - 1;
+            job.nextRow = 0;
+            streams.push_back(std::move(job));
+        }
+    }
+
+    // Push up to uploadBudgetBytes of pending mip rows through the PBO,
+    // coarse levels first so each texture sharpens one level at a time
+    void streamLevels() {
+        lastFrameStreamed = 0;
+        if (streams.empty()) return;
+        PROFILE_ZONE("texture mip streaming");
+
+        size_t budget = uploadBudgetBytes;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        while (budget > 0 && !streams.empty()) {
+            StreamJob& job = streams.front();
+            TextureEntry& e = entries[job.handle - 1];
+            const MipLevel& L = job.levels[job.level];
+            size_t rowBytes = (size_t)L.width * 3;
+
+            int rows = std::min(L.height - job.nextRow, (int)std::max<size_t>(1, budget / rowBytes));
+            rows = std::min(rows, (int)std::max<size_t>(1, uploadBudgetBytes / rowBytes));
+            size_t chunk = rowBytes * rows;
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, std::max(chunk, uploadBudgetBytes), NULL, GL_STREAM_DRAW);
+            gpuRegistry().setBytes(GPU_BUFFER, pbo, std::max(chunk, uploadBudgetBytes));
+            void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, chunk,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (dst) {
+                std::copy(L.pixels.data() + rowBytes * job.nextRow,
+                          L.pixels.data() + rowBytes * (job.nextRow + rows),
+                          (unsigned char*)dst);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glState().bindForEdit(0, GL_TEXTURE_2D, e.glID);
+                glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.nextRow, L.width, rows,
+                                GL_RGB, GL_UNSIGNED_BYTE, (void*)0);
+            } else {
+                // Mapping failed: fall back to a direct client-memory upload
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                glState().bindForEdit(0, GL_TEXTURE_2D, e.glID);
+                glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.nextRow, L.width, rows,
+                                GL_RGB, GL_UNSIGNED_BYTE, L.pixels.data() + rowBytes * job.nextRow);
+            }
+
+            job.nextRow += rows;
+            lastFrameStreamed += chunk;
+            budget = chunk >= budget ? 0 : budget - chunk;
+
+            if (job.nextRow >= L.height) {
+                // Level complete: make it the finest sampleable level
+                e.baseLevel = job.level;
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, job.level);
+                job.levels.pop_back();
+                job.level--;
+                job.nextRow = 0;
+                if (job.level < 0) streams.erase(streams.begin());
+            }
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void cancelStream(unsigned int handle) {
+        for (size_t i = 0; i < streams.size(); i++) {
+            if (streams[i].handle == handle) {
+                streams.erase(streams.begin() + i);
+                return;
+            }
+        }
+    }
+
+    // Trim least-recently-drawn textures until we are back under budget:
+    // finest levels go first, whole textures only once they are down to the
+    // streaming tail. Anything drawn this frame is pinned.
+    void evict() {
+        while (totalBytes > budgetBytes) {
+            TextureEntry* victim = nullptr;
+            for (auto& e : entries) {
+                if (e.state != TEX_RESIDENT || e.lastUsedFrame >= frame) continue;
+                if (!victim || e.lastUsedFrame < victim->lastUsedFrame) victim = &e;
+            }
+            if (!victim) break;
+            unsigned int handle = (unsigned int)(victim - &entries[0]) + 1;
+            if (std::max(victim->width >> victim->topLevel, victim->height >> victim->topLevel) > STREAM_TAIL_DIM) {
+                dropTopLevels(handle);
+                continue;
+            }
+            cancelStream(handle);
+            deleteTexture(victim->glID);
+            victim->glID = 0;
+            victim->state = TEX_UNLOADED;
+            victim->reloading = false;
+            std::vector<MipLevel>().swap(victim->pixels);
+            totalBytes -= victim->bytes;
+            evictions++;
+            std::cout << "  Texture " << victim->path << " evicted (" << totalBytes / 1024 << " KB resident)" << std::endl;
+        }
+    }
+
+    // Reallocate a texture without its finest level (or without levels that
+    // never finished streaming). Kept levels are read back and re-specified.
+    // glGetTexImage into client memory is synchronous: it waits for all GL
+    // work issued so far, this frame's PBO uploads included. GL 3.3 has no
+    // glCopyImageSubData and RGB8 need not be renderable for an FBO blit,
+    // so this stays a readback; trims only happen over budget.
+    void dropTopLevels(unsigned int handle) {
+        PROFILE_ZONE("texture trim");
+        TextureEntry& e = entries[handle - 1];
+        int numLevels = (int)e.levelBytes.size();
+        int newTop = std::max(e.topLevel + 1, e.baseLevel);
+        cancelStream(handle);
+
+        unsigned int newID = genTexture();
+        std::vector<unsigned char> pixels;
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int i = newTop; i < numLevels; i++) {
+            int w = std::max(1, e.width >> i), h = std::max(1, e.height >> i);
+            pixels.resize((size_t)w * h * 3);
+            glState().bindForEdit(0, GL_TEXTURE_2D, e.glID);
+            glGetTexImage(GL_TEXTURE_2D, i, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+            glState().bindForEdit(0, GL_TEXTURE_2D, newID);
+            glTexImage2D(GL_TEXTURE_2D, i, e.internalFormat, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, newTop);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, e.wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, e.wrapMode);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, e.filterMode);
+        deleteTexture(e.glID);
+        e.glID = newID;
+
+        totalBytes -= e.bytes;
+        e.bytes = 0;
+        for (int i = newTop; i < numLevels; i++) e.bytes += e.levelBytes[i];
+        gpuRegistry().setBytes(GPU_TEXTURE, e.glID, e.bytes);
+        totalBytes += e.bytes;
+        droppedLevels += newTop - e.topLevel;
+        e.topLevel = newTop;
+        e.baseLevel = newTop;
+        std::cout << "  Texture " << e.path << " trimmed to "
+                  << std::max(1, e.width >> newTop) << "x" << std::max(1, e.height >> newTop)
+                  << " (" << totalBytes / 1024 << " KB resident)" << std::endl;
+    }
+
+    unsigned int genTexture() {
+        texturesCreated++;
+        return gpuRegistry().genTexture("texture cache");
+    }
+
+    void deleteTexture(unsigned int id) {
+        gpuRegistry().deleteTexture(id);
+        texturesDeleted++;
+    }
+
+    // Bytes per texel as stored by the driver. RGB8 is counted as 4: drivers
+    // pad it to RGBA8 internally.
+    static size_t formatBytes(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_R8:    return 1;
+            case GL_RG8:   return 2;
+            case GL_RGB8:  return 4;
+            case GL_RGBA8: return 4;
+            case GL_RGBA16F: return 8;
+            case GL_RGBA32F: return 16;
+            default:       return 4;
+        }
+    }
+
+    static const char* formatName(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_R8:    return "R8";
+            case GL_RG8:   return "RG8";
+            case GL_RGB8:  return "RGB8";
+            case GL_RGBA8: return "RGBA8";
+            case GL_RGBA16F: return "RGBA16F";
+            case GL_RGBA32F: return "RGBA32F";
+            default:       return "?";
+        }
+    }
+
+    static size_t mipChainBytes(int w, int h, int bytesPerPixel) {
+        size_t total = 0;
+        for (;;) {
+            total += (size_t)w * h * bytesPerPixel;
+            if (w == 1 && h == 1) break;
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+        return total;
+    }
+};
+
+#endif
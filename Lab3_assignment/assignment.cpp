@@ -7,8 +7,31 @@
 #include <cmath>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <thread>
 #include "Shader.h"
+#include "CameraMath.h"
 #include "Bus.h"
+#include "TextureArray.h"
+#include "InstanceBatch.h"
+#include "RenderQueue.h"
+#include "StreamRing.h"
+#include "JobSystem.h"
+#include "City.h"
+#include "GLTrace.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "Hud.h"
+#include "Bench.h"
+#include "InputLog.h"
+#include "SimThread.h"
+#include "CameraBlock.h"
+#include "FrameArena.h"
+#include "Ecs.h"
+#include "Lighting.h"
+#include "SoftRaster.h"
 
 // ============================================================================
 // STB_IMAGE for texture loading
@@ -16,10 +39,110 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+// ============================================================================
+// ALLOC TRACKER global operator new / delete (see AllocTracker.h)
+// ============================================================================
+#define ALLOC_TRACKER_IMPLEMENTATION
+#include "AllocTracker.h"
+
 // Settings
 const unsigned int SCR_WIDTH = 1200;
 const unsigned int SCR_HEIGHT = 800;
 
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+//   --gl-trace count|time|null   hook the glad table (see GLTrace.h); null
+//                                runs headless with no window or GL context
+//   --frames N                   exit after N frames and print the GL histogram
+//   --profile                    record CPU zones from startup (P toggles)
+//   --stats file.csv|file.jsonl  write per-frame timings and counters
+//   --hud                        start with the performance overlay on (H)
+//   --bench script.json          run a scripted benchmark (see Bench.h) on the
+//                                null backend and write per-phase results
+//   --bench-gl                   run the bench on the real driver (hidden window)
+//   --bench-out file.json        bench results path (default bench_results.json)
+//   --fixed-dt                   step the simulation by the script's dt (1/60 s
+//                                without a script) instead of the wall clock
+//   --record file.bin            log every input event and frame step
+//   --replay file.bin            feed a recorded session back frame for frame
+//   --alloc-track                sample heap allocation call sites in the loop
+//                                and print the busiest ones at exit (TAB too)
+//   --assert-no-alloc            fail (exit 3) if the render thread allocates
+//                                after ALLOC_WARMUP_FRAMES frames
+//   --submit uniforms|base-instance|indirect
+//                                render queue submission (see RenderQueue.h);
+//                                default: the best the driver supports
+//   --stream-ring persistent|unsynchronized|off
+//                                how per-frame data reaches the GPU (see
+//                                StreamRing.h); default: persistent if supported
+//   --jobs N                     job system threads, main included (see
+//                                JobSystem.h); default: one per hardware thread
+//   --city-blocks N              add N generated city blocks (see City.h)
+//   --no-cull                    draw the whole city, no frustum culling
+//   --job-bench [blocks]         time the city update on 1..N threads over a
+//                                generated city (default 20000 blocks), no
+//                                window, then exit
+//   --ecs-bench [entities]       time transform and culling passes over city
+//                                part entities (default 1000000) stored as
+//                                objects and as ECS columns, serial and on
+//                                1..N threads, no window, then exit
+//   --no-sim-thread              simulate in the loop, in series with rendering;
+//                                otherwise the simulation thread runs free, or
+//                                in lockstep under --fixed-dt, --record and
+//                                --replay (see SimThread.h)
+//   --sim-hz N                   fixed simulation step rate (default 120); the
+//                                renderer interpolates between steps
+//   --no-late-latch              draw with the snapshot's view instead of one
+//                                rebuilt from the freshest mouse look just
+//                                before submission (see CameraBlock.h)
+//   --raster [file.png]          also draw every frame with the CPU rasterizer
+//                                (see SoftRaster.h) and save the last one
+//                                (default raster.png); runs on the null
+//                                backend unless --gl-trace picks another
+GLTraceMode glTraceMode = GL_TRACE_OFF;
+int maxFrames = 0;                 // 0 = run until the window closes
+bool headless = false;             // no GLFW window (null GL backend)
+Bench bench;                       // scripted inputs when active()
+bool benchOnGL = false;
+std::string benchOut = "bench_results.json";
+bool fixedDt = false;
+InputLog inputLog;                 // --record / --replay
+const char* PROFILE_TRACE_PATH = "profile_trace.json";
+FrameStats frameStats;             // rolling frame/sim/render times (TAB prints)
+Hud hud;                           // H toggles the in-window performance overlay
+bool assertNoAlloc = false;
+const int ALLOC_WARMUP_FRAMES = 120;   // frames before the loop must stop allocating
+int allocFailFrames = 0;           // frames past warmup that allocated
+int jobThreads = 0;                // --jobs; 0 = hardware threads
+int cityBlocks = 0;                // --city-blocks
+int jobBenchBlocks = -1;           // --job-bench; -1 = off
+const int JOB_BENCH_DEFAULT_BLOCKS = 20000;
+const int JOB_BENCH_ROUNDS = 31;   // timed updates per thread count (median)
+int ecsBenchEntities = -1;         // --ecs-bench; -1 = off
+const int ECS_BENCH_DEFAULT_ENTITIES = 1000000;
+const int ECS_BENCH_ROUNDS = 11;   // timed passes per configuration (median)
+bool simThreadOn = true;           // --no-sim-thread runs the simulation in the loop
+bool lateLatch = true;             // --no-late-latch
+RenderSubmitMode submitRequest = RENDER_SUBMIT_INDIRECT;   // --submit, clamped to the driver
+const int HUD_GRAPH_FRAMES = 120;
+const float HUD_GRAPH_MS = 33.3f;  // graph full scale
+std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+// Seconds since startup; GLFW's timer when there is a window
+double appTime() {
+    if (!headless) return glfwGetTime();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Continuous key state; scripted during a bench run, always released when
+// running headless
+bool keyPressed(GLFWwindow* window, int key) {
+    if (bench.active()) return bench.held(key);
+    if (inputLog.replaying()) return inputLog.held(key);
+    return window && glfwGetKey(window, key) == GLFW_PRESS;
+}
+
 // ============================================================================
 // CAMERA SYSTEM
 // ============================================================================
@@ -50,7 +173,8 @@ float orbitHeight = 10.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-Bus bus;
+Bus bus;                           // drawn; animation copied from each snapshot
+Bus simBus;                        // the simulation's animation state, never init()'d
 bool fanSpinning = false;
 
 // ============================================================================
@@ -84,58 +208,114 @@ bool ambientOn = true;
 bool diffuseOn = true;
 bool specularOn = true;
 
+// ============================================================================
+// SIMULATION SNAPSHOTS
+// ============================================================================
+// The camera, driving, bus animation and lighting state above belong to the
+// simulation: after startup only stepSimulation() and the input it applies
+// touch them, on the simulation thread (or in the loop with
+// --no-sim-thread). The GLFW callbacks add events to simInput, and the
+// renderer draws from the SimSnapshot each step publishes.
+//
+// The world moves in fixed steps (SIM_STEP_HZ). A snapshot carries the
+// poses after the last two steps; the renderer blends them by how far its
+// clock is into the next step, so motion stays smooth at any frame rate
+// for one step of added latency.
+struct SimPose {
+    int cameraMode = -1;            // not blended: a camera switch cuts
+    glm::vec3 busPosition = glm::vec3(0.0f);
+    float busYaw = 0.0f, busAltitude = 0.0f;
+    float fanRotation = 0.0f, steeringAngle = 0.0f;
+    float jetFlameFlicker = 0.0f, hoverBobOffset = 0.0f, hoverTime = 0.0f;
+    glm::vec3 cameraPos = glm::vec3(0.0f), cameraTarget = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f), cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    float cameraYaw = 0.0f, cameraPitch = 0.0f;    // not blended: the latest, for the late latch
+};
+
+struct SimSnapshot {
+    int inputFrame = -1;            // newest input applied (-1: none yet)
+    double inputTime = 0.0;         // when that input was polled (appTime)
+    uint64_t step = 0;              // fixed steps so far
+    int stepsRun = 0;               // fixed steps behind this snapshot
+    uint64_t droppedSteps = 0;      // skipped by the catch-up cap, so far
+    float stepMs = 0.0f;            // CPU time of the advance that published it
+    double lookYaw = 0.0, lookPitch = 0.0;         // all mouse look applied so far
+    float alpha = 0.0f;             // leftover time / step when published
+    double stepTime = 0.0;          // appTime that pose stands for (free thread)
+    SimPose prev, pose;             // after the last two fixed steps
+    float frontDoorAngle = 0.0f, middleDoorAngle = 0.0f, windowOpenAmount[12] = { 0 };
+    bool lightOn = true, jetEngineOn = false;
+    bool drivingMode = true;
+    bool dirLightOn = true, pointLightsOn = true, spotLightOn = true, emissiveLightOn = true;
+    bool ambientOn = true, diffuseOn = true, specularOn = true;
+};
+
+SimThread simThread;
+TripleBuffer<SimSnapshot> snapshots;
+SimInput simInput;                 // main thread: this frame's input so far
+uint16_t simHeld = 0;              // simulation: keys held in the last input applied
+int simInputFrame = -1;            // simulation: the last input applied
+double simInputTime = 0.0;
+uint64_t simSteps = 0;
+FixedStep simClock;                // simulation: elapsed time -> fixed steps
+SimPose simPrevPose, simPose;      // simulation: after the last two steps
+double simLookYaw = 0.0, simLookPitch = 0.0;   // simulation: mouse look applied
+double postedLookYaw = 0.0, postedLookPitch = 0.0;     // main thread: mouse look handed over
+double lastPollTime = 0.0;         // main thread: when input was last polled
+int lastShownInput = -1;           // main thread: newest input already presented
+
 // ============================================================================
 // TEXTURE STATE
 // ============================================================================
+// All tex* values are TextureCache handles (loaded lazily on first draw)
+TextureCache textures;
+const size_t TEXTURE_BUDGET_BYTES = 32u * 1024u * 1024u;
+const size_t TEXTURE_UPLOAD_BYTES_PER_FRAME = 1u * 1024u * 1024u;  // mip streaming budget
+double firstFrameTime = -1.0;  // seconds from startup to first presented frame
+
 unsigned int texFloor = 0, texCarpet = 0, texFabric = 0;
 unsigned int texWall = 0, texDashboard = 0, texBusBody = 0;
 unsigned int texSphere = 0, texCone = 0;
 
-// City environment textures
-unsigned int texRoad = 0, texGrass = 0;
-unsigned int texContainer = 0, texEmoji = 0;
+unsigned int texEmoji = 0;
+
+// City environment materials: layers of one texture array, drawn instanced
+TextureArray cityArray;
+Sampler citySampler;            // wrap/filter for the city array (keys 8/9)
+int layerRoad = 0, layerGrass = 0, layerContainer = 0, layerWall = 0;
+InstanceBatch cityCubes, cityCylinders, cityCones;
+City city;                      // parts, culled and listed into the batches on the job system
+JobSystem::WorkerStats cityJobStats = { 0, 0 };   // last frame's jobs and steals
+
+// City and bus parts are entities of one world; the schedule runs the
+// city's systems and the bus pose each frame (Ecs.h)
+EcsWorld scene;
+EcsSchedule sceneSchedule;
+const int CITY_LAYER_SIZE = 512;
 
 Sphere sceneSphere;
 Cone sceneCone;
 
-int sceneTextureMode = 1;
+// Bus and city draws are recorded here and submitted sorted once per frame
+RenderQueue renderQueue;
 
-// ============================================================================
-// CITY ENVIRONMENT CONSTANTS
-// ============================================================================
-const float ROAD_WIDTH = 8.0f;
-const float ROAD_SEGMENT_LEN = 20.0f;
-const int   VISIBLE_SEGMENTS = 30;        // segments ahead + behind
-const float GRASS_WIDTH = 50.0f;
-const float BUILDING_ZONE_START = 6.0f;   // distance from road center
-const float BUILDING_ZONE_END = 40.0f;
-const int   BUILDINGS_PER_SEGMENT = 6;    // buildings per side per segment
-
-// Simple deterministic hash for building placement
-unsigned int cityHash(int x, int y) {
-    unsigned int h = (unsigned int)(x * 374761393 + y * 668265263);
-    h = (h ^ (h >> 13)) * 1274126177;
-    return h ^ (h >> 16);
-}
+// Per-frame dynamic data (queue records, city instances, HUD quads)
+StreamRing streamRing;
+const size_t STREAM_RING_REGION_BYTES = 256 * 1024;
+bool streamRingOn = true;          // --stream-ring off uses each owner's own buffer
 
-float cityRand(int seed, int id) {
-    return (float)(cityHash(seed, id) % 10000) / 10000.0f;
-}
+// View / projection uniform block, written just before the queue submits
+CameraBlock cameraBlock;
 
-// Pre-defined bright color palette for buildings
-glm::vec3 buildingPalette[] = {
-    glm::vec3(0.85f, 0.2f, 0.2f),   // Red
-    glm::vec3(0.2f, 0.65f, 0.9f),   // Blue
-    glm::vec3(0.2f, 0.8f, 0.3f),    // Green
-    glm::vec3(0.9f, 0.85f, 0.1f),   // Yellow
-    glm::vec3(0.7f, 0.3f, 0.85f),   // Purple
-    glm::vec3(0.95f, 0.55f, 0.1f),  // Orange
-    glm::vec3(0.1f, 0.85f, 0.75f),  // Cyan
-    glm::vec3(0.85f, 0.15f, 0.55f), // Pink
-    glm::vec3(0.5f, 0.5f, 0.85f),   // Periwinkle
-    glm::vec3(0.3f, 0.75f, 0.5f),   // Teal
-};
-const int NUM_PALETTE_COLORS = 10;
+// This frame's lights (LIGHT SETUP), for the shader and the software rasterizer
+SceneLighting sceneLighting;
+
+// --raster: the CPU rasterizer draws the queue's frame before GL submits it
+bool rasterOn = false;
+std::string rasterOut = "raster.png";
+SoftRaster softRaster;
+
+int sceneTextureMode = 1;
 
 int currentWrapIndex = 0;
 GLenum wrapModes[] = { GL_REPEAT, GL_CLAMP_TO_EDGE, GL_MIRRORED_REPEAT };
@@ -149,41 +329,41 @@ const int NUM_FILTER_MODES = 2;
 
 const char* textureModeNames[] = { "OFF", "PURE TEXTURE", "VERTEX-BLENDED (Gouraud)", "FRAGMENT-BLENDED (Phong)" };
 
-// ============================================================================
-// CUSTOM lookAt
-// ============================================================================
-glm::mat4 myLookAt(glm::vec3 eye, glm::vec3 center, glm::vec3 up) {
-    glm::vec3 f = glm::normalize(center - eye);
-    glm::vec3 s = glm::normalize(glm::cross(f, up));
-    glm::vec3 u = glm::cross(s, f);
-    glm::mat4 result(1.0f);
-    result[0][0] = s.x;   result[1][0] = s.y;   result[2][0] = s.z;
-    result[0][1] = u.x;   result[1][1] = u.y;   result[2][1] = u.z;
-    result[0][2] = -f.x;  result[1][2] = -f.y;  result[2][2] = -f.z;
-    result[3][0] = -glm::dot(s, eye);
-    result[3][1] = -glm::dot(u, eye);
-    result[3][2] =  glm::dot(f, eye);
-    return result;
-}
-
 // Function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window);
+void processInput(float dt);
+void simKey(int key);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 // ============================================================================
 // CAMERA HELPERS
 // ============================================================================
-glm::vec3 getCameraFront() {
+// Look direction for a yaw and pitch in degrees
+glm::vec3 frontFromAngles(float yaw, float pitch) {
     glm::vec3 front;
-    front.x = cos(glm::radians(cameraYaw)) * cos(glm::radians(cameraPitch));
-    front.y = sin(glm::radians(cameraPitch));
-    front.z = sin(glm::radians(cameraYaw)) * cos(glm::radians(cameraPitch));
+    front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    front.y = sin(glm::radians(pitch));
+    front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
     return glm::normalize(front);
 }
 
+glm::vec3 getCameraFront() {
+    return frontFromAngles(cameraYaw, cameraPitch);
+}
+
+// Up vector of the free camera looking along front (with its roll)
+glm::vec3 freeCameraUp(const glm::vec3& front) {
+    glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::normalize(glm::cross(right, front));
+    if (cameraRoll != 0.0f) {
+        glm::mat4 rollMat = glm::rotate(glm::mat4(1.0f), glm::radians(cameraRoll), front);
+        up = glm::vec3(rollMat * glm::vec4(up, 0.0f));
+    }
+    return up;
+}
+
 glm::vec3 getCameraRight() {
     return glm::normalize(glm::cross(getCameraFront(), glm::vec3(0.0f, 1.0f, 0.0f)));
 }
@@ -203,9 +383,10 @@ glm::vec3 getBusRight() {
     return glm::vec3(-cos(rad), 0.0f, sin(rad));
 }
 
-glm::mat4 getViewMatrix() {
+// Where the camera is and looks; places the chase / interior camera
+void getCameraLook(glm::vec3& eye, glm::vec3& target, glm::vec3& up) {
     glm::vec3 busRenderPos = busPosition;
-    busRenderPos.y += HOVER_HEIGHT + bus.hoverBobOffset + busAltitude;
+    busRenderPos.y += HOVER_HEIGHT + simBus.hoverBobOffset + busAltitude;
 
     if (cameraMode == 1) {
         // === CHASE CAMERA (3rd person behind bus, jet engine visible) ===
@@ -215,7 +396,10 @@ glm::mat4 getViewMatrix() {
         cameraPos = busRenderPos + chaseOffset;
         // Look at the rear of the bus (where the jet engine is) + slight upward bias
         glm::vec3 lookTarget = busRenderPos + glm::vec3(0.0f, 1.5f, 0.0f) - forward * 2.0f;
-        return myLookAt(cameraPos, lookTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+        eye = cameraPos;
+        target = lookTarget;
+        up = glm::vec3(0.0f, 1.0f, 0.0f);
+        return;
     }
 
     if (cameraMode == 2) {
@@ -225,208 +409,930 @@ glm::mat4 getViewMatrix() {
         // Driver position inside bus
         cameraPos = busRenderPos + forward * (-3.0f) + glm::vec3(0.0f, 1.0f, 0.0f) + right * (-0.6f);
         // Look forward through windshield, with mouse-look adjustment
-        glm::vec3 lookDir;
-        lookDir.x = cos(glm::radians(cameraYaw)) * cos(glm::radians(cameraPitch));
-        lookDir.y = sin(glm::radians(cameraPitch));
-        lookDir.z = sin(glm::radians(cameraYaw)) * cos(glm::radians(cameraPitch));
-        lookDir = glm::normalize(lookDir);
-        return myLookAt(cameraPos, cameraPos + lookDir, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::vec3 lookDir = frontFromAngles(cameraYaw, cameraPitch);
+        eye = cameraPos;
+        target = cameraPos + lookDir;
+        up = glm::vec3(0.0f, 1.0f, 0.0f);
+        return;
     }
 
     // === FREE CAMERA ===
     glm::vec3 front = getCameraFront();
-    glm::vec3 up = getCameraUp();
-    if (cameraRoll != 0.0f) {
-        glm::mat4 rollMat = glm::rotate(glm::mat4(1.0f), glm::radians(cameraRoll), front);
-        up = glm::vec3(rollMat * glm::vec4(up, 0.0f));
-    }
-    return myLookAt(cameraPos, cameraPos + front, up);
+    up = freeCameraUp(front);
+    eye = cameraPos;
+    target = cameraPos + front;
+}
+
+glm::mat4 getViewMatrix() {
+    glm::vec3 eye, target, up;
+    getCameraLook(eye, target, up);
+    return myLookAt(eye, target, up);
 }
 
 // ============================================================================
-// TEXTURE LOADING
+// SIMULATION STEP
 // ============================================================================
-const int MAX_TEXTURE_DIM = 2048;
+// Held-key mask over INPUT_LOG_KEYS, the keys processInput() polls
+uint16_t sampleHeldKeys(GLFWwindow* window) {
+    uint16_t mask = 0;
+    for (int i = 0; i < INPUT_LOG_KEY_COUNT; i++)
+        if (keyPressed(window, INPUT_LOG_KEYS[i])) mask |= (uint16_t)(1u << i);
+    return mask;
+}
 
-unsigned int loadTexture(const char* path, GLenum wrapMode, GLenum filterMode) {
-    std::cout << "  Loading: " << path << "..." << std::flush;
+bool simKeyHeld(int key) {
+    for (int i = 0; i < INPUT_LOG_KEY_COUNT; i++)
+        if (INPUT_LOG_KEYS[i] == key) return (simHeld >> i) & 1u;
+    return false;
+}
 
-    // Pre-check: can we open the file?
-    {
-        std::ifstream testFile(path, std::ios::binary);
-        if (!testFile.good()) {
-            std::cout << " [--] not found" << std::endl;
-            std::cout.flush();
-            return 0;
+// Key presses and mouse look in the order the callbacks saw them
+void applySimInput(const SimInput& input) {
+    for (int i = 0; i < input.eventCount; i++) {
+        const SimEvent& e = input.events[i];
+        if (e.type == SIM_EVENT_KEY) {
+            simKey(e.key);
+            continue;
         }
+        cameraYaw += e.dx;
+        cameraPitch += e.dy;
+        // Clamp pitch to prevent flipping
+        if (cameraPitch > 89.0f) cameraPitch = 89.0f;
+        if (cameraPitch < -89.0f) cameraPitch = -89.0f;
     }
+    float dx, dy;
+    input.lookTotal(dx, dy);
+    simLookYaw += dx;
+    simLookPitch += dy;
+    simHeld = input.held;
+    simInputFrame = input.frame;
+    simInputTime = input.time;
+}
 
-    int width = 0, height = 0, nrChannels = 0;
-    stbi_set_flip_vertically_on_load(true);
+void capturePose(SimPose& p) {
+    p.cameraMode = cameraMode;
+    p.busPosition = busPosition;
+    p.busYaw = busYaw;
+    p.busAltitude = busAltitude;
+    p.fanRotation = simBus.fanRotation;
+    p.steeringAngle = simBus.steeringAngle;
+    p.jetFlameFlicker = simBus.jetFlameFlicker;
+    p.hoverBobOffset = simBus.hoverBobOffset;
+    p.hoverTime = simBus.hoverTime;
+    getCameraLook(p.cameraPos, p.cameraTarget, p.cameraUp);
+    p.cameraFront = getCameraFront();
+    p.cameraYaw = cameraYaw;
+    p.cameraPitch = cameraPitch;
+}
 
-    // Query info without loading pixel data
-    int infoOk = stbi_info(path, &width, &height, &nrChannels);
-    if (!infoOk || width <= 0 || height <= 0) {
-        std::cout << " [SKIP] invalid/corrupt image" << std::endl;
-        std::cout.flush();
-        return 0;
-    }
-    std::cout << " " << width << "x" << height << "..." << std::flush;
-
-    // Force 3 channels (RGB)
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 3);
-    if (!data) {
-        std::cout << " [FAIL] " << stbi_failure_reason() << std::endl;
-        std::cout.flush();
-        return 0;
-    }
+// a + (b - a) * t: exactly a when nothing moved, so a still bus keeps
+// sending the same uniforms (glm::mix can be an ulp off)
+template <typename T>
+T blend(const T& a, const T& b, float t) { return a + (b - a) * t; }
+
+// Shortest way round for values that wrap at period
+float lerpWrapped(float a, float b, float t, float period) {
+    float d = b - a;
+    if (d > 0.5f * period) d -= period;
+    if (d < -0.5f * period) d += period;
+    return a + d * t;
+}
 
-    // Downscale if too large (simple box filter)
-    int outW = width, outH = height;
-    unsigned char* finalData = data;
-    bool didResize = false;
-    if (outW > MAX_TEXTURE_DIM || outH > MAX_TEXTURE_DIM) {
-        float scale = std::min((float)MAX_TEXTURE_DIM / outW, (float)MAX_TEXTURE_DIM / outH);
-        int newW = (int)(outW * scale);
-        int newH = (int)(outH * scale);
-        if (newW < 1) newW = 1;
-        if (newH < 1) newH = 1;
-        unsigned char* resized = (unsigned char*)malloc(newW * newH * 3);
-        if (resized) {
-            for (int y = 0; y < newH; y++) {
-                for (int x = 0; x < newW; x++) {
-                    int srcX = (int)(x / scale);
-                    int srcY = (int)(y / scale);
-                    if (srcX >= outW) srcX = outW - 1;
-                    if (srcY >= outH) srcY = outH - 1;
-                    int si = (srcY * outW + srcX) * 3;
-                    int di = (y * newW + x) * 3;
-                    resized[di] = data[si];
-                    resized[di+1] = data[si+1];
-                    resized[di+2] = data[si+2];
-                }
-            }
-            stbi_image_free(data);
-            finalData = resized;
-            outW = newW;
-            outH = newH;
-            didResize = true;
-            std::cout << " resized->" << outW << "x" << outH << "..." << std::flush;
-        }
+SimPose lerpPose(const SimPose& a, const SimPose& b, float t) {
+    SimPose p;
+    p.cameraMode = b.cameraMode;
+    p.busPosition = blend(a.busPosition, b.busPosition, t);
+    p.busYaw = blend(a.busYaw, b.busYaw, t);
+    p.busAltitude = blend(a.busAltitude, b.busAltitude, t);
+    p.fanRotation = lerpWrapped(a.fanRotation, b.fanRotation, t, 360.0f);
+    p.steeringAngle = blend(a.steeringAngle, b.steeringAngle, t);
+    p.jetFlameFlicker = lerpWrapped(a.jetFlameFlicker, b.jetFlameFlicker, t, 100.0f);
+    p.hoverBobOffset = blend(a.hoverBobOffset, b.hoverBobOffset, t);
+    p.hoverTime = blend(a.hoverTime, b.hoverTime, t);
+    p.cameraPos = blend(a.cameraPos, b.cameraPos, t);
+    p.cameraTarget = blend(a.cameraTarget, b.cameraTarget, t);
+    p.cameraUp = glm::normalize(blend(a.cameraUp, b.cameraUp, t));
+    p.cameraFront = glm::normalize(blend(a.cameraFront, b.cameraFront, t));
+    p.cameraYaw = b.cameraYaw;
+    p.cameraPitch = b.cameraPitch;
+    return p;
+}
+
+void publishSnapshot(float stepMs, int stepsRun) {
+    SimSnapshot& s = snapshots.write();
+    s.inputFrame = simInputFrame;
+    s.inputTime = simInputTime;
+    s.step = simSteps;
+    s.stepsRun = stepsRun;
+    s.droppedSteps = simClock.droppedSteps;
+    s.stepMs = stepMs;
+    s.lookYaw = simLookYaw;
+    s.lookPitch = simLookPitch;
+    s.alpha = simClock.alpha();
+    s.stepTime = appTime() - simClock.accumulator;
+    // Also when no step was due: inputs applied since (mouse look, a
+    // camera switch) show at once
+    capturePose(simPose);
+    s.prev = simPrevPose.cameraMode == simPose.cameraMode ? simPrevPose : simPose;
+    s.pose = simPose;
+    s.frontDoorAngle = simBus.frontDoorAngle;
+    s.middleDoorAngle = simBus.middleDoorAngle;
+    memcpy(s.windowOpenAmount, simBus.windowOpenAmount, sizeof(s.windowOpenAmount));
+    s.lightOn = simBus.lightOn;
+    s.jetEngineOn = simBus.jetEngineOn;
+    s.drivingMode = isDrivingMode;
+    s.dirLightOn = dirLightOn;
+    s.pointLightsOn = pointLightsOn;
+    s.spotLightOn = spotLightOn;
+    s.emissiveLightOn = emissiveLightOn;
+    s.ambientOn = ambientOn;
+    s.diffuseOn = diffuseOn;
+    s.specularOn = specularOn;
+    snapshots.publish();
+}
+
+// Advances by dt of elapsed time in fixed steps (none, if dt does not
+// complete one); returns the seconds until the next step is due
+double stepSimulation(float dt) {
+    auto t0 = std::chrono::steady_clock::now();
+    int n = simClock.advance(dt);
+    float h = (float)simClock.step;
+    for (int i = 0; i < n; i++) {
+        if (i == n - 1) capturePose(simPrevPose);
+        processInput(h);
+        simBus.updateFan(h, fanSpinning);
+        simBus.updateJetFlame(h);
+        simSteps++;
     }
+    publishSnapshot(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count(), n);
+    return simClock.untilNext();
+}
+
+// The renderer's copy of the bus animation, blended between the last two
+// steps
+void applySnapshot(const SimSnapshot& s, const SimPose& p, Bus& b) {
+    b.fanRotation = p.fanRotation;
+    b.steeringAngle = p.steeringAngle;
+    b.jetFlameFlicker = p.jetFlameFlicker;
+    b.hoverBobOffset = p.hoverBobOffset;
+    b.hoverTime = p.hoverTime;
+    b.frontDoorAngle = s.frontDoorAngle;
+    b.middleDoorAngle = s.middleDoorAngle;
+    memcpy(b.windowOpenAmount, s.windowOpenAmount, sizeof(b.windowOpenAmount));
+    b.lightOn = s.lightOn;
+    b.jetEngineOn = s.jetEngineOn && s.emissiveLightOn;
+}
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, outW, outH, 0, GL_RGB, GL_UNSIGNED_BYTE, finalData);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMode);
-    std::cout << " [OK]" << std::endl;
-    std::cout.flush();
-
-    if (didResize)
-        free(finalData);
-    else
-        stbi_image_free(finalData);
-
-    return textureID;
+// Main thread: the newest snapshot, or in lockstep the one stepped from
+// this frame's input. The first frame always waits for a step with input.
+const SimSnapshot& acquireSnapshot(int frame) {
+    PROFILE_ZONE("acquire snapshot");
+    int need = simThread.lockstep ? frame : 0;
+    snapshots.update();
+    while (snapshots.read().inputFrame < need)
+        if (!snapshots.update()) std::this_thread::yield();
+    return snapshots.read();
 }
 
+// How far into the next step to draw: the free-running thread's clock has
+// moved on since it published, elsewhere the snapshot is this frame's own
+float renderAlpha(const SimSnapshot& s) {
+    if (!simThread.running() || simThread.lockstep) return s.alpha;
+    float a = (float)((appTime() - s.stepTime) / simClock.step);
+    return glm::clamp(a, 0.0f, 1.0f);
+}
 
+// ============================================================================
+// LATE LATCH
+// ============================================================================
+// The free and interior cameras turn with the mouse. By the time the queue
+// submits, the snapshot's view is a frame old: the look it was built from
+// was polled before the frame started. latchedView() turns it by the look
+// the snapshot has not applied yet: inputs still on their way to the
+// simulation, events not posted yet, and the cursor's motion since the
+// last poll (read live from GLFW), or a bench phase's scripted look. The
+// eye stays where the snapshot put it. Returns false for the chase camera,
+// which the mouse does not move.
+bool latchedView(GLFWwindow* window, const SimSnapshot& s, const SimPose& shown, double now, glm::mat4& view) {
+    if (shown.cameraMode != 0 && shown.cameraMode != 2) return false;
+    float dYaw = (float)(postedLookYaw - s.lookYaw);
+    float dPitch = (float)(postedLookPitch - s.lookPitch);
+    float ux, uy;
+    simInput.lookTotal(ux, uy);         // held back by a full queue
+    dYaw += ux;
+    dPitch += uy;
+    if (bench.active()) {
+        const float* rate = bench.lookRate();
+        dYaw += rate[0] * (float)(now - simInput.time);
+        dPitch += rate[1] * (float)(now - simInput.time);
+    } else if (window && mouseCaptured && !firstMouse && !inputLog.replaying()) {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        dYaw += ((float)x - lastMouseX) * mouseSensitivity;
+        dPitch += (lastMouseY - (float)y) * mouseSensitivity;
+    }
+    float yaw = shown.cameraYaw + dYaw;
+    float pitch = glm::clamp(shown.cameraPitch + dPitch, -89.0f, 89.0f);
+    glm::vec3 front = frontFromAngles(yaw, pitch);
+    glm::vec3 up = shown.cameraMode == 0 ? freeCameraUp(front) : glm::vec3(0.0f, 1.0f, 0.0f);
+    view = myLookAt(shown.cameraPos, shown.cameraPos + front, up);
+    return true;
+}
+
+// Mouse look is live: the mouse is captured, or a bench phase scripts it
+bool lookLive() {
+    if (bench.active()) {
+        const float* rate = bench.lookRate();
+        return rate[0] != 0.0f || rate[1] != 0.0f;
+    }
+    return mouseCaptured;
+}
+
+const char* simModeName() {
+    if (!simThread.running()) return "serial";
+    return simThread.lockstep ? "lockstep" : "thread";
+}
 
 void updateSceneTextureParams() {
     GLenum wrap = wrapModes[currentWrapIndex];
     GLenum filter = filterModes[currentFilterIndex];
-    unsigned int ids[] = { texSphere, texCone };
+    unsigned int ids[] = { textures.residentID(texSphere), textures.residentID(texCone) };
     for (auto id : ids) {
         if (id != 0) {
-            glBindTexture(GL_TEXTURE_2D, id);
+            glState().bindForEdit(0, GL_TEXTURE_2D, id);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
         }
     }
+    // The city array is sampled through citySampler, so no re-specification
+    citySampler.set(wrap, filter);
+}
+
+// P: start a capture, or stop it and write the Chrome trace
+void toggleProfiler() {
+    bool on = !profiler().enabled.load();
+    profiler().enabled.store(on);
+    if (on) std::cout << "Profiler: recording (press P again to write " << PROFILE_TRACE_PATH << ")" << std::endl;
+    else profiler().writeChromeTrace(PROFILE_TRACE_PATH);
+}
+
+// Overlay: counters from the last finished frame plus a frame-time graph.
+// Built into the HUD's vertex buffer and drawn in one call.
+void drawHud(int fbWidth, int fbHeight) {
+    PROFILE_ZONE("hud");
+    hud.scale = fbWidth > 2000 ? 2 : 1;
+    hud.begin(fbWidth, fbHeight);
+    const GLState& gs = glState();
+    float lh = hud.lineHeight(), gw = hud.glyphWidth();
+    float x = 8.0f * hud.scale, y = 8.0f * hud.scale;
+    float panelW = 52 * gw, graphH = 60.0f * hud.scale;
+    hud.rect(x - 4, y - 4, panelW + 8, 12 * lh + graphH + 12, hudColor(0, 0, 0, 160));
+
+    int n = std::min(frameStats.sampleCount(), HUD_GRAPH_FRAMES);
+    double sum = 0.0, worst = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += frameStats.recent(i).frameMs;
+        worst = std::max(worst, frameStats.recent(i).frameMs);
+    }
+    double avg = n ? sum / n : 0.0;
+    unsigned int white = hudColor(255, 255, 255), grey = hudColor(190, 190, 190);
+    hud.textf(x, y, white, "FPS %6.1f  %6.2f ms avg  %6.2f ms max", avg > 0.0 ? 1000.0 / avg : 0.0, avg, worst);
+    y += lh;
+    hud.textf(x, y, white, "Draws %d  Triangles %d", gs.lastFrameDraws, gs.lastFrameTriangles);
+    y += lh;
+    const FrameRecord* last = frameStats.sampleCount() ? &frameStats.recent(0) : nullptr;
+    const SimSnapshot& sim = snapshots.read();
+    hud.textf(x, y, white, "Sim %s %.0f Hz  %d steps %.3f ms  latency %.1f ms", simModeName(),
+              1.0 / simClock.step, sim.stepsRun, sim.stepMs, last && last->latencyMs >= 0.0 ? last->latencyMs : 0.0);
+    y += lh;
+    hud.textf(x, y, allocTracker().lastFrameAllocs ? white : grey, "Heap %llu allocs  %llu bytes",
+              (unsigned long long)allocTracker().lastFrameAllocs,
+              (unsigned long long)allocTracker().lastFrameBytes);
+    y += lh;
+    hud.textf(x, y, white, "Uniforms %d uploaded, %d skipped",
+              gs.lastFrameUniforms.issued, gs.lastFrameUniforms.skipped);
+    y += lh;
+    hud.textf(x, y, grey, "Binds %d/%d  Toggles %d/%d (issued/skipped)",
+              gs.lastFrameBinds.issued, gs.lastFrameBinds.skipped,
+              gs.lastFrameToggles.issued, gs.lastFrameToggles.skipped);
+    y += lh;
+    hud.textf(x, y, white, "Tex mem %d KB in %d textures (%d / %d KB cache)",
+              (int)(textures.totalTextureBytes() / 1024), textures.liveTextureCount(),
+              (int)(textures.residentBytes() / 1024), (int)(textures.budgetBytes / 1024));
+    y += lh;
+    const CityStats& cs = city.lastStats;
+    hud.textf(x, y, white, "City %d/%d %s  %.2f ms, %d jobs %d steals", cs.visible, cs.parts,
+              city.culling ? "culled" : "no cull", cs.updateMs,
+              (int)cityJobStats.jobs, (int)cityJobStats.steals);
+    y += lh;
+    const RenderQueueStats& qs = renderQueue.lastFrameStats;
+    hud.textf(x, y, grey, "Queue %d  mat %d mesh %d blend %d (unsorted %d/%d/%d)", qs.commands,
+              qs.materialChanges, qs.meshChanges, qs.blendChanges,
+              qs.unsortedMaterialChanges, qs.unsortedMeshChanges, qs.unsortedBlendChanges);
+    y += lh;
+    hud.textf(x, y, grey, "Submit %s: %d calls, %.1f us", renderSubmitModeNames[renderQueue.submitMode],
+              qs.drawCalls, qs.submitMs * 1000.0);
+    y += lh;
+    if (streamRingOn) {
+        const StreamRingStats& rs = streamRing.lastFrameStats;
+        hud.textf(x, y, grey, "Ring %d/%d KB (peak %d), stalls %d, overflows %d", (int)(rs.bytes / 1024),
+                  (int)(streamRing.bytesPerRegion() / 1024), (int)(streamRing.highWater / 1024),
+                  streamRing.totalStalls, streamRing.totalOverflows);
+    } else {
+        hud.textf(x, y, grey, "Ring off");
+    }
+    y += lh;
+    const FrameArena& fa = frameArena();
+    hud.textf(x, y, fa.lastFrameStats.overflows ? white : grey, "Arena %d/%d KB (peak %d), overflows %d",
+              (int)(fa.lastFrameStats.bytes / 1024), (int)(fa.bytesPerBlock() / 1024), (int)(fa.highWater / 1024),
+              fa.totalOverflows);
+    y += lh + 4;
+
+    // Frame-time graph, newest on the right; line at 16.7 ms
+    float barW = panelW / HUD_GRAPH_FRAMES;
+    float base = y + graphH;
+    hud.rect(x, base - graphH * (16.7f / HUD_GRAPH_MS), panelW, 1.0f * hud.scale, hudColor(255, 255, 255, 90));
+    for (int i = 0; i < n; i++) {
+        const FrameRecord& r = frameStats.recent(i);
+        float h = std::min((float)r.frameMs / HUD_GRAPH_MS, 1.0f) * graphH;
+        unsigned int c = r.stutter ? hudColor(255, 60, 60)
+                       : r.frameMs > 16.7 ? hudColor(255, 200, 40) : hudColor(80, 220, 80);
+        hud.rect(x + panelW - (i + 1) * barW, base - h, std::max(barW - 1.0f, 1.0f), h, c);
+    }
+    y = base + 2;
+    hud.textf(x, y, grey, "%.0f ms", HUD_GRAPH_MS);
+    hud.draw();
+}
+
+void printStreamRing(std::ostream& out) {
+    const StreamRingStats& rs = streamRing.lastFrameStats;
+    out << "  Ring:     " << (streamRing.persistent ? "persistent" : "unsynchronized") << ", "
+        << rs.bytes / 1024 << " KB in " << rs.allocs << " allocs last frame, peak "
+        << streamRing.highWater / 1024 << " of " << streamRing.bytesPerRegion() / 1024 << " KB; "
+        << streamRing.totalStalls << " stalls (" << streamRing.totalStallMs << " ms), "
+        << streamRing.totalOverflows << " overflows" << std::endl;
+}
+
+void printFrameArena(std::ostream& out) {
+    const FrameArena& fa = frameArena();
+    out << "  Arena:    " << fa.lastFrameStats.bytes / 1024 << " KB in " << fa.lastFrameStats.allocs
+        << " allocs last frame, peak " << fa.highWater / 1024 << " of " << fa.bytesPerBlock() / 1024
+        << " KB per block; " << fa.totalOverflows << " overflows to the heap, " << fa.regrows
+        << " block regrows" << std::endl;
 }
 
 void printStatus() {
+    const SimSnapshot& sim = snapshots.read();
     std::cout << "\n========== STATUS ==========" << std::endl;
-    std::cout << "  Camera:   " << cameraModeNames[cameraMode] << std::endl;
+    std::cout << "  Camera:   " << cameraModeNames[std::max(sim.pose.cameraMode, 0)] << std::endl;
     std::cout << "  FOV:      " << cameraFOV << " deg" << std::endl;
     std::cout << "  Mouse:    " << (mouseCaptured ? "CAPTURED (press M to release)" : "FREE (press M to capture)") << std::endl;
-    std::cout << "  Driving:  " << (isDrivingMode ? "ON" : "OFF") << std::endl;
+    std::cout << "  Driving:  " << (sim.drivingMode ? "ON" : "OFF") << std::endl;
     std::cout << "  Texture:  " << textureModeNames[sceneTextureMode] << std::endl;
     std::cout << "  Wrap:     " << wrapNames[currentWrapIndex] << std::endl;
     std::cout << "  Filter:   " << filterNames[currentFilterIndex] << std::endl;
-    std::cout << "  Lights:   Dir=" << (dirLightOn ? "ON" : "OFF")
-              << " Pt=" << (pointLightsOn ? "ON" : "OFF")
-              << " Spot=" << (spotLightOn ? "ON" : "OFF")
-              << " Emis=" << (emissiveLightOn ? "ON" : "OFF") << std::endl;
-    std::cout << "  Shading:  A=" << (ambientOn ? "ON" : "OFF")
-              << " D=" << (diffuseOn ? "ON" : "OFF")
-              << " S=" << (specularOn ? "ON" : "OFF") << std::endl;
+    std::cout << "  Lights:   Dir=" << (sim.dirLightOn ? "ON" : "OFF")
+              << " Pt=" << (sim.pointLightsOn ? "ON" : "OFF")
+              << " Spot=" << (sim.spotLightOn ? "ON" : "OFF")
+              << " Emis=" << (sim.emissiveLightOn ? "ON" : "OFF") << std::endl;
+    std::cout << "  Shading:  A=" << (sim.ambientOn ? "ON" : "OFF")
+              << " D=" << (sim.diffuseOn ? "ON" : "OFF")
+              << " S=" << (sim.specularOn ? "ON" : "OFF") << std::endl;
+    std::cout << "  Sim:      " << simModeName() << ", " << 1.0 / simClock.step << " Hz fixed step, step "
+              << sim.step << " (" << sim.stepsRun << " in the last advance, " << sim.stepMs << " ms), "
+              << sim.droppedSteps << " dropped by the catch-up cap; " << simThread.queueFull
+              << " inputs held back by a full queue, " << simInput.dropped << " presses dropped" << std::endl;
+    std::cout << "  View:     " << (lateLatch ? "late-latched before submit" : "from the snapshot") << ", "
+              << cameraBlock.latches << " latches, " << cameraBlock.uploads << " camera block uploads" << std::endl;
+    std::cout << "  Textures: " << textures.residentCount() << " resident, "
+              << textures.pendingCount() << " loading, "
+              << textures.residentBytes() / 1024 << " / " << textures.budgetBytes / 1024 << " KB, "
+              << textures.evictionCount() << " evictions, "
+              << textures.droppedLevelCount() << " mips dropped, "
+              << textures.streamingCount() << " streaming mips" << std::endl;
+    std::cout << "  GPU tex:  " << textures.totalTextureBytes() / 1024 << " KB in "
+              << textures.liveTextureCount() << " textures" << std::endl;
+    textures.printReport();
+    gpuRegistry().printReport(std::cout);
+    if (glTraceMode != GL_TRACE_OFF) glTrace().printHistogram(std::cout);
+    const GLState& gs = glState();
+    std::cout << "  GL state: " << gs.lastFrameIssued() << " issued, "
+              << gs.lastFrameSkipped() << " skipped last frame (binds "
+              << gs.lastFrameBinds.issued << "/" << gs.lastFrameBinds.skipped << ", toggles "
+              << gs.lastFrameToggles.issued << "/" << gs.lastFrameToggles.skipped << ", uniforms "
+              << gs.lastFrameUniforms.issued << "/" << gs.lastFrameUniforms.skipped << ")" << std::endl;
+    std::cout << "  Draws:    " << gs.lastFrameDraws << " calls, "
+              << gs.lastFrameTriangles << " triangles last frame" << std::endl;
+    frameStats.printSummary(std::cout);
+    std::cout << "  City:     " << cityCubes.lastInstanceCount() << " cubes, "
+              << cityCylinders.lastInstanceCount() << " cylinders, "
+              << cityCones.lastInstanceCount() << " cones in 3 draws, array "
+              << (cityArray.ready() ? "ready" : "loading") << " ("
+              << cityArray.bytes() / 1024 << " KB)" << std::endl;
+    std::cout << "  Jobs:     " << city.lastStats.visible << "/" << city.lastStats.parts << " parts visible"
+              << (city.culling ? "" : " (culling off)") << ", update " << city.lastStats.updateMs << " ms in "
+              << cityJobStats.jobs << " jobs on " << jobSystem().threadCount() << " threads, "
+              << cityJobStats.steals << " steals" << std::endl;
+    std::cout << "  ECS:      " << scene.size() << " entities in " << scene.archetypes.size() << " archetypes ("
+              << scene.bytes() / 1024 << " KB), " << sceneSchedule.systemCount() << " systems in "
+              << sceneSchedule.stageCount << " stages:";
+    for (int i = 0; i < sceneSchedule.systemCount(); i++)
+        std::cout << (i ? ", " : " ") << sceneSchedule.system(i).name << " " << sceneSchedule.system(i).ms << " ms";
+    std::cout << std::endl;
+    const RenderQueueStats& qs = renderQueue.lastFrameStats;
+    std::cout << "  Queue:    " << qs.commands << " commands (" << qs.opaque << " opaque, "
+              << qs.blended << " additive), " << qs.sortPasses << " radix passes; changes: material "
+              << qs.materialChanges << ", mesh " << qs.meshChanges << ", blend " << qs.blendChanges
+              << " (unsorted " << qs.unsortedMaterialChanges << " / " << qs.unsortedMeshChanges
+              << " / " << qs.unsortedBlendChanges << ")" << std::endl;
+    std::cout << "  Submit:   " << renderSubmitModeNames[renderQueue.submitMode] << ", " << qs.drawCalls
+              << " draw calls, " << qs.submitMs * 1000.0 << " us" << std::endl;
+    if (streamRingOn) printStreamRing(std::cout);
+    printFrameArena(std::cout);
+    std::cout << "  Profiler: " << (profiler().enabled.load() ? "RECORDING" : "OFF")
+              << " (" << profiler().eventCount() << " zones buffered)" << std::endl;
+    std::cout << "  Heap:     " << allocTracker().lastFrameAllocs << " allocations ("
+              << allocTracker().lastFrameBytes << " bytes) last frame, "
+              << allocTracker().liveAllocs() << " live blocks" << std::endl;
+    if (allocTracker().sampling.load()) allocTracker().printTopSites(std::cout, 5);
+    if (firstFrameTime >= 0.0)
+        std::cout << "  Startup:  first frame after " << firstFrameTime * 1000.0 << " ms" << std::endl;
     std::cout << "============================" << std::endl;
 }
 
+// --job-bench: City::update over the road, landmarks and a generated city
+// on 1, 2, 4, ... up to --jobs (default: all hardware) threads. Runs before
+// any window or GL exists; every thread count must list the same instances.
+int runJobBench(int blocks) {
+    EcsWorld stressWorld;
+    City stress;
+    stress.init(stressWorld);
+    stress.culling = city.culling;
+    stress.addRoad();
+    stress.addLandmarks();
+    stress.generateBlocks(blocks);
+    int maxThreads = jobThreads > 0 ? jobThreads : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    // Looking down the road from above the start: most blocks are behind
+    // the far plane or off to the sides, as when driving
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, 1000.0f);
+    glm::mat4 view = myLookAt(glm::vec3(20.0f, 40.0f, 0.0f), glm::vec3(-300.0f, 0.0f, 0.0f), glm::vec3(0, 1, 0));
+    float layers[CITY_MATERIAL_COUNT] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    FrameVector<InstanceData> lists[CITY_MESH_COUNT];
+    FrameVector<InstanceData>* out[CITY_MESH_COUNT] = { &lists[0], &lists[1], &lists[2] };
+
+    std::cout << "Job bench: " << stress.partCount() << " parts in " << blocks << " generated blocks, "
+              << JOB_BENCH_ROUNDS << " rounds, culling " << (stress.culling ? "on" : "off") << std::endl;
+    char line[160];
+    snprintf(line, sizeof(line), "  %7s %10s %9s %11s %12s %14s", "threads", "median ms", "speed-up",
+             "efficiency", "jobs/update", "steals/update");
+    std::cout << line << std::endl;
+    double baseMs = 0.0, baseSum = 0.0;
+    bool mismatch = false;
+    std::vector<double> samples(JOB_BENCH_ROUNDS);
+    for (int threads = 1; threads <= maxThreads; threads = (threads * 2 > maxThreads && threads < maxThreads)
+                                                         ? maxThreads : threads * 2) {
+        jobSystem().init(threads);
+        for (int i = 0; i < 3; i++) {
+            frameArena().beginFrame();      // each update is a frame's worth of arena use
+            stress.update(jobSystem(), 0.0f, projection * view, layers, out);
+        }
+        jobSystem().resetStats();
+        for (int i = 0; i < JOB_BENCH_ROUNDS; i++) {
+            frameArena().beginFrame();
+            stress.update(jobSystem(), 0.0f, projection * view, layers, out);
+            samples[i] = stress.lastStats.updateMs;
+        }
+        std::sort(samples.begin(), samples.end());
+        double ms = samples[JOB_BENCH_ROUNDS / 2];
+        JobSystem::WorkerStats js = jobSystem().totals();
+
+        // Same visible parts in the same order: compare a position checksum
+        double sum = 0.0;
+        for (auto& list : lists) {
+            for (size_t i = 0; i < list.size(); i++) sum += list[i].model[3].x * (double)(i + 1) + list[i].model[3].z;
+        }
+        if (threads == 1) {
+            baseMs = ms;
+            baseSum = sum;
+        } else if (sum != baseSum) {
+            mismatch = true;
+        }
+        snprintf(line, sizeof(line), "  %7d %10.3f %8.2fx %10.0f%% %12.1f %14.1f%s", threads, ms, baseMs / ms,
+                 100.0 * baseMs / ms / threads, (double)js.jobs / JOB_BENCH_ROUNDS,
+                 (double)js.steals / JOB_BENCH_ROUNDS, sum != baseSum ? "  MISMATCH" : "");
+        std::cout << line << std::endl;
+        if (threads == maxThreads) break;
+    }
+    std::cout << stress.lastStats.visible << " of " << stress.partCount() << " parts visible in "
+              << stress.lastStats.chunks << " chunks" << std::endl;
+    jobSystem().shutdown();
+    if (mismatch) {
+        std::cout << "Job bench FAILED: instance lists differ between thread counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --ecs-bench: the city's transform and culling passes over entities city
+// parts are made of, spread over four archetypes, against the same data as
+// one struct per object. Serial, then EcsQuery chunks on 1, 2, 4, ... up to
+// --jobs threads. Runs before any window or GL exists; every layout must
+// find the same visible set.
+struct EcsBenchObject {
+    glm::mat4 local;
+    glm::vec3 origin;
+    glm::mat4 world;
+    glm::vec4 bounds;
+    int mesh;
+    EcsMaterial material;
+    EcsAnimation animation;         // half of the entities animate
+    unsigned char visible;
+};
+
+struct EcsBenchResult {
+    double transformMs, cullMs;
+    int visible;
+    double checksum;
+};
+
+int runEcsBench(int entities) {
+    int maxThreads = jobThreads > 0 ? jobThreads : (int)std::max(1u, std::thread::hardware_concurrency());
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, 1000.0f);
+    glm::mat4 view = myLookAt(glm::vec3(20.0f, 40.0f, 0.0f), glm::vec3(-300.0f, 0.0f, 0.0f), glm::vec3(0, 1, 0));
+    Frustum frustum;
+    frustum.extract(projection * view);
+
+    // Parts scattered over a 2 km square down the road, 1-10 m across
+    std::vector<EcsBenchObject> objects(entities);
+    EcsWorld world;
+    EcsMask masks[4] = {
+        CITY_PART_COMPONENTS,
+        CITY_PART_COMPONENTS | EcsMaskOf<EcsRoadSegment>::value,
+        CITY_PART_COMPONENTS | EcsMaskOf<EcsAnimation>::value,
+        CITY_PART_COMPONENTS | EcsMaskOf<EcsRoadSegment, EcsAnimation>::value
+    };
+    for (int k = 0; k < 4; k++) world.reserve(masks[k], (entities + 3) / 4);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < entities; i++) {
+        EcsBenchObject& o = objects[i];
+        glm::vec3 at(-2000.0f * cityRand(i, 0), 0.0f, 2000.0f * cityRand(i, 1) - 1000.0f);
+        float size = 1.0f + 9.0f * cityRand(i, 2);
+        o.local = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, size * 0.5f, 0.0f)), glm::vec3(size));
+        o.origin = at;
+        o.mesh = i % CITY_MESH_COUNT;
+        o.material = EcsMaterial();
+        o.material.color = buildingPalette[i % NUM_PALETTE_COLORS];
+        o.animation = EcsAnimation();
+
+        EcsEntity e = world.create(masks[i & 3]);
+        world.get<EcsTransform>(e).local = o.local;
+        world.get<EcsOrigin>(e).position = o.origin;
+        world.get<EcsMeshRange>(e).mesh = o.mesh;
+        world.get<EcsMaterial>(e) = o.material;
+    }
+    double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "ECS bench: " << entities << " entities in " << world.archetypes.size() << " archetypes ("
+              << world.bytes() / (1024 * 1024) << " MB of columns, " << entities * sizeof(EcsBenchObject) / (1024 * 1024)
+              << " MB as objects), created in " << createMs << " ms; " << ECS_BENCH_ROUNDS << " rounds" << std::endl;
+    char line[160];
+    snprintf(line, sizeof(line), "  %-14s %7s %14s %14s %10s %9s", "layout", "threads", "transform ns", "cull ns",
+             "visible", "speed-up");
+    std::cout << line << std::endl;
+
+    // Medians of the two passes; fn(pass) runs pass 0 (transform) or 1 (cull)
+    std::vector<double> samples[2] = { std::vector<double>(ECS_BENCH_ROUNDS), std::vector<double>(ECS_BENCH_ROUNDS) };
+    auto measure = [&](const auto& fn, EcsBenchResult& r) {
+        for (int pass = 0; pass < 2; pass++) {
+            fn(pass);                       // warm
+            for (int k = 0; k < ECS_BENCH_ROUNDS; k++) {
+                auto s = std::chrono::steady_clock::now();
+                fn(pass);
+                samples[pass][k] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s).count();
+            }
+            std::sort(samples[pass].begin(), samples[pass].end());
+        }
+        r.transformMs = samples[0][ECS_BENCH_ROUNDS / 2];
+        r.cullMs = samples[1][ECS_BENCH_ROUNDS / 2];
+    };
+
+    // Objects: every pass strides over whole structs
+    EcsBenchResult base;
+    measure([&](int pass) {
+        if (pass == 0) {
+            for (auto& o : objects) cityPartTransform(o.local, o.origin, o.mesh, o.world, o.bounds);
+            return;
+        }
+        int visible = 0;
+        for (auto& o : objects) {
+            o.visible = frustum.sphereVisible(glm::vec3(o.bounds), o.bounds.w);
+            visible += o.visible;
+        }
+        base.visible = visible;
+    }, base);
+    base.checksum = 0.0;
+    for (auto& o : objects) base.checksum += o.visible ? o.bounds.x + o.bounds.w : 0.0;
+
+    bool mismatch = false;
+    auto report = [&](const char* layout, int threads, const EcsBenchResult& r) {
+        double ns = 1e6 / std::max(entities, 1);
+        snprintf(line, sizeof(line), "  %-14s %7d %14.2f %14.2f %10d %8.2fx%s", layout, threads, r.transformMs * ns,
+                 r.cullMs * ns, r.visible, (base.transformMs + base.cullMs) / (r.transformMs + r.cullMs),
+                 r.visible != base.visible || r.checksum != base.checksum ? "  MISMATCH" : "");
+        std::cout << line << std::endl;
+        if (r.visible != base.visible || r.checksum != base.checksum) mismatch = true;
+    };
+    // Same sum over the ECS columns, in the objects' order of creation
+    auto ecsChecksum = [&](EcsBenchResult& r) {
+        std::vector<double> byRow(entities, 0.0);
+        for (auto& a : world.archetypes) {
+            const EcsBounds* b = a->column<EcsBounds>();
+            const EcsCityPart* p = a->column<EcsCityPart>();
+            for (int i = 0; i < a->count; i++)
+                byRow[a->entities[i] & 0xFFFFFF] = p[i].visible ? b[i].sphere.x + b[i].sphere.w : 0.0;
+        }
+        r.checksum = 0.0;
+        for (double v : byRow) r.checksum += v;
+    };
+    report("objects", 1, base);
+
+    // ECS columns, one archetype after the other on this thread
+    EcsBenchResult serial;
+    measure([&](int pass) {
+        if (pass == 0) {
+            world.each<EcsTransform, EcsOrigin, EcsMeshRange, EcsWorldTransform, EcsBounds>(
+                [](int n, const EcsTransform* local, const EcsOrigin* origin, const EcsMeshRange* mesh,
+                   EcsWorldTransform* xform, EcsBounds* bounds) {
+                    for (int i = 0; i < n; i++)
+                        cityPartTransform(local[i].local, origin[i].position, mesh[i].mesh, xform[i].world, bounds[i].sphere);
+                });
+            return;
+        }
+        int visible = 0;
+        world.each<EcsBounds, EcsCityPart>([&](int n, const EcsBounds* bounds, EcsCityPart* part) {
+            for (int i = 0; i < n; i++) {
+                part[i].visible = frustum.sphereVisible(glm::vec3(bounds[i].sphere), bounds[i].sphere.w);
+                visible += part[i].visible;
+            }
+        });
+        serial.visible = visible;
+    }, serial);
+    ecsChecksum(serial);
+    report("ECS each", 1, serial);
+
+    // EcsQuery chunks on the job system
+    EcsQuery query;
+    query.include = EcsMaskOf<EcsCityPart>::value;
+    int chunkSize = std::max(CITY_MIN_CHUNK, (entities + CITY_MAX_CHUNKS - 1) / CITY_MAX_CHUNKS);
+    query.split(world, chunkSize);
+    std::vector<int> chunkVisible(query.chunks.size());
+    for (int threads = 1; threads <= maxThreads; threads = (threads * 2 > maxThreads && threads < maxThreads)
+                                                         ? maxThreads : threads * 2) {
+        jobSystem().init(threads);
+        EcsBenchResult parallel;
+        measure([&](int pass) {
+            if (pass == 0) {
+                query.run<EcsTransform, EcsOrigin, EcsMeshRange, EcsWorldTransform, EcsBounds>(jobSystem(),
+                    [](int, int n, const EcsTransform* local, const EcsOrigin* origin, const EcsMeshRange* mesh,
+                       EcsWorldTransform* xform, EcsBounds* bounds) {
+                        for (int i = 0; i < n; i++)
+                            cityPartTransform(local[i].local, origin[i].position, mesh[i].mesh, xform[i].world, bounds[i].sphere);
+                    });
+                return;
+            }
+            query.run<EcsBounds, EcsCityPart>(jobSystem(), [&](int c, int n, const EcsBounds* bounds, EcsCityPart* part) {
+                int visible = 0;
+                for (int i = 0; i < n; i++) {
+                    part[i].visible = frustum.sphereVisible(glm::vec3(bounds[i].sphere), bounds[i].sphere.w);
+                    visible += part[i].visible;
+                }
+                chunkVisible[c] = visible;
+            });
+            parallel.visible = 0;
+            for (int v : chunkVisible) parallel.visible += v;
+        }, parallel);
+        ecsChecksum(parallel);
+        report("ECS query", threads, parallel);
+        if (threads == maxThreads) break;
+    }
+    jobSystem().shutdown();
+    if (mismatch) {
+        std::cout << "ECS bench FAILED: layouts disagree on the visible set" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
 // ============================================================================
 // MAIN
 // ============================================================================
-int main()
+int main(int argc, char** argv)
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT,
-        "Hover Bus - Texture Mapped", NULL, NULL);
-    if (!window) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--gl-trace") && i + 1 < argc) {
+            const char* m = argv[++i];
+            glTraceMode = !strcmp(m, "time") ? GL_TRACE_TIME
+                        : !strcmp(m, "null") ? GL_TRACE_NULL : GL_TRACE_COUNT;
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            maxFrames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--profile")) {
+            profiler().enabled.store(true);
+        } else if (!strcmp(argv[i], "--hud")) {
+            hud.visible = true;
+        } else if (!strcmp(argv[i], "--bench") && i + 1 < argc) {
+            if (!bench.load(argv[++i])) return -1;
+        } else if (!strcmp(argv[i], "--bench-gl")) {
+            benchOnGL = true;
+        } else if (!strcmp(argv[i], "--bench-out") && i + 1 < argc) {
+            benchOut = argv[++i];
+        } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            if (!inputLog.startRecording(argv[++i])) return -1;
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            if (!inputLog.startReplay(argv[++i])) return -1;
+        } else if (!strcmp(argv[i], "--fixed-dt")) {
+            fixedDt = true;
+        } else if (!strcmp(argv[i], "--stats") && i + 1 < argc) {
+            frameStats.openLog(argv[++i]);
+        } else if (!strcmp(argv[i], "--alloc-track")) {
+            allocTracker().sampling.store(true);
+        } else if (!strcmp(argv[i], "--assert-no-alloc")) {
+            assertNoAlloc = true;
+            allocTracker().sampling.store(true);     // to name the offenders
+        } else if (!strcmp(argv[i], "--stream-ring") && i + 1 < argc) {
+            const char* m = argv[++i];
+            streamRingOn = strcmp(m, "off") != 0;
+            streamRing.allowPersistent = strcmp(m, "unsynchronized") != 0;
+        } else if (!strcmp(argv[i], "--submit") && i + 1 < argc) {
+            const char* m = argv[++i];
+            submitRequest = !strcmp(m, "uniforms") ? RENDER_SUBMIT_UNIFORMS
+                          : !strcmp(m, "base-instance") ? RENDER_SUBMIT_BASE_INSTANCE : RENDER_SUBMIT_INDIRECT;
+        } else if (!strcmp(argv[i], "--jobs") && i + 1 < argc) {
+            jobThreads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--city-blocks") && i + 1 < argc) {
+            cityBlocks = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--no-cull")) {
+            city.culling = false;
+        } else if (!strcmp(argv[i], "--sim-hz") && i + 1 < argc) {
+            double hz = atof(argv[++i]);
+            if (hz > 0.0) simClock.setRate(hz);
+        } else if (!strcmp(argv[i], "--no-sim-thread")) {
+            simThreadOn = false;
+        } else if (!strcmp(argv[i], "--no-late-latch")) {
+            lateLatch = false;
+        } else if (!strcmp(argv[i], "--raster")) {
+            rasterOn = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') rasterOut = argv[++i];
+        } else if (!strcmp(argv[i], "--job-bench")) {
+            jobBenchBlocks = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : JOB_BENCH_DEFAULT_BLOCKS;
+        } else if (!strcmp(argv[i], "--ecs-bench")) {
+            ecsBenchEntities = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : ECS_BENCH_DEFAULT_ENTITIES;
+        }
     }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    glfwSetKeyCallback(window, key_callback);
-
-    // Mouse starts free â€” press M to capture for look-around
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
+    allocTracker().markRenderThread();
+    profiler().setThreadName("main");
+    frameArena().init(FRAME_ARENA_BYTES);
+    if (jobBenchBlocks >= 0) return runJobBench(jobBenchBlocks);
+    if (ecsBenchEntities >= 0) return runEcsBench(ecsBenchEntities);
+    jobSystem().init(jobThreads);
+    if (bench.active() && inputLog.replaying()) {
+        std::cout << "--bench and --replay cannot be combined" << std::endl;
         return -1;
     }
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    inputLog.keyFn = key_callback;
+    inputLog.cursorFn = mouse_callback;
+    inputLog.scrollFn = scroll_callback;
+    if (bench.active()) {
+        // Null backend unless the real driver is asked for; the trace hooks
+        // stay on in count mode so GL calls per frame are reported
+        if (!benchOnGL) glTraceMode = GL_TRACE_NULL;
+        else if (glTraceMode == GL_TRACE_OFF) glTraceMode = GL_TRACE_COUNT;
+        if (maxFrames <= 0) maxFrames = bench.totalFrames();
+        bench.reserveRun(maxFrames);
+    }
+    if (rasterOn && glTraceMode == GL_TRACE_OFF) glTraceMode = GL_TRACE_NULL;
+    headless = (glTraceMode == GL_TRACE_NULL);
+
+    GLFWwindow* window = NULL;
+    if (headless) {
+        // No window, no context: the null backend answers every GL call
+        installGLTrace(GL_TRACE_NULL);
+        if (maxFrames <= 0 && !inputLog.replaying()) maxFrames = 1;
+    } else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (bench.active()) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT,
+            "Hover Bus - Texture Mapped", NULL, NULL);
+        if (!window) {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        if (bench.active()) glfwSwapInterval(0);   // measure the frame, not vsync
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+        glfwSetKeyCallback(window, key_callback);
+
+        // Mouse starts free â€” press M to capture for look-around
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        glExtensions().load((GLExtensionLoader)glfwGetProcAddress);
+        installGLTrace(glTraceMode);
+    }
+    glState().enable(GL_DEPTH_TEST);
+    glState().enable(GL_BLEND);
+    glState().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     Shader ourShader("shader.vert", "shader.frag");
+    hud.init();
+    textures.track(hud.atlas, "hud font atlas", GL_R8, hud.atlasWidth(), hud.atlasHeight(), 1, false);
+    if (rasterOn) {
+        // CPU copies of vertices and texels for the software rasterizer
+        gpuRegistry().keepBufferData = true;
+        textures.keepPixels = true;
+        cityArray.keepPixels = true;
+    }
     bus.init();
-    bus.jetEngineOn = true;  // Flame always visible
+    bus.build(scene);
+    simBus.jetEngineOn = true;  // Flame always visible
     sceneSphere.init(30, 36);
     sceneCone.init(36);
 
-    // ==================== LOAD TEXTURES ====================
-    std::cout << "\n=== Loading Textures ===" << std::endl;
-    texFloor     = loadTexture("textures/floor.jpg",     GL_REPEAT,          GL_LINEAR);
-    texCarpet    = loadTexture("textures/carpet.jpg",    GL_REPEAT,          GL_NEAREST);
-    texFabric    = loadTexture("textures/fabric.jpg",    GL_CLAMP_TO_EDGE,   GL_LINEAR);
-    texWall      = loadTexture("textures/wall.jpg",      GL_MIRRORED_REPEAT, GL_LINEAR);
-    texDashboard = loadTexture("textures/dashboard.jpg", GL_REPEAT,          GL_NEAREST);
-    texBusBody   = loadTexture("textures/busbody.jpg",   GL_CLAMP_TO_EDGE,   GL_NEAREST);
-    texSphere    = loadTexture("textures/sphere.jpg",    GL_REPEAT,          GL_LINEAR);
-    texCone      = loadTexture("textures/cone.jpg",      GL_MIRRORED_REPEAT, GL_NEAREST);
-
-    // City environment textures
-    texRoad      = loadTexture("textures/road.jpg",      GL_REPEAT,          GL_LINEAR);
-    texGrass     = loadTexture("textures/grass.jpg",     GL_REPEAT,          GL_LINEAR);
-    texContainer = loadTexture("textures/container2.png", GL_REPEAT,         GL_LINEAR);
-    texEmoji     = loadTexture("textures/emoji.png",     GL_CLAMP_TO_EDGE,   GL_LINEAR);
-    std::cout << "========================" << std::endl;
+    // ==================== REGISTER TEXTURES ====================
+    // Nothing is read from disk here; each file is decoded in the background
+    // the first time a visible draw references it.
+    textures.budgetBytes = TEXTURE_BUDGET_BYTES;
+    textures.uploadBudgetBytes = TEXTURE_UPLOAD_BYTES_PER_FRAME;
+    textures.init();
+    texFloor     = textures.add("textures/floor.jpg",     GL_REPEAT,          GL_LINEAR);
+    texCarpet    = textures.add("textures/carpet.jpg",    GL_REPEAT,          GL_NEAREST);
+    texFabric    = textures.add("textures/fabric.jpg",    GL_CLAMP_TO_EDGE,   GL_LINEAR);
+    texWall      = textures.add("textures/wall.jpg",      GL_MIRRORED_REPEAT, GL_LINEAR);
+    texDashboard = textures.add("textures/dashboard.jpg", GL_REPEAT,          GL_NEAREST);
+    texBusBody   = textures.add("textures/busbody.jpg",   GL_CLAMP_TO_EDGE,   GL_NEAREST);
+    texSphere    = textures.add("textures/sphere.jpg",    GL_REPEAT,          GL_LINEAR);
+    texCone      = textures.add("textures/cone.jpg",      GL_MIRRORED_REPEAT, GL_NEAREST);
+
+    texEmoji     = textures.add("textures/emoji.png",     GL_CLAMP_TO_EDGE,   GL_LINEAR);
+
+    // City environment textures, resampled into one array
+    layerRoad      = cityArray.addLayer("textures/road.jpg");
+    layerGrass     = cityArray.addLayer("textures/grass.jpg");
+    layerContainer = cityArray.addLayer("textures/container2.png");
+    layerWall      = cityArray.addLayer("textures/wall.jpg");
+    cityArray.build(CITY_LAYER_SIZE);
+    citySampler.init(wrapModes[currentWrapIndex], filterModes[currentFilterIndex]);
+    if (rasterOn) softRaster.init(SCR_WIDTH, SCR_HEIGHT, &textures, &cityArray);
+
+    cityCubes.init(bus.cube.VBO, bus.cube.vertexCount);
+    cityCylinders.init(bus.cylinder.VBO, bus.cylinder.vertexCount);
+    cityCones.init(sceneCone.VBO, sceneCone.vertexCount);
+    city.init(scene);
+    city.addRoad();
+    city.addLandmarks();
+    city.generateBlocks(cityBlocks);
+    std::cout << "City: " << city.partCount() << " parts in " << city.nodes.size() << " nodes, "
+              << jobSystem().threadCount() << " job threads" << std::endl;
+    bus.addSystems(sceneSchedule);
+    city.addSystems(sceneSchedule);
+    std::cout << "Scene: " << scene.size() << " entities in " << scene.archetypes.size() << " archetypes, "
+              << sceneSchedule.systemCount() << " systems" << std::endl;
+
+    // Fixed sampler units: 2D textures on 0, the city array on 1, the
+    // render queue's per-draw data on 2
+    ourShader.use();
+    ourShader.setInt("textureSampler", 0);
+    ourShader.setInt("textureArray", 1);
+    ourShader.setInt("drawData", RENDER_DRAW_DATA_UNIT);
+    ourShader.setBool("instanced", false);
+    ourShader.setBool("perDrawData", false);
+
+    if (streamRingOn) {
+        streamRing.init(STREAM_RING_REGION_BYTES);
+        renderQueue.ring = &streamRing;
+        cityCubes.ring = cityCylinders.ring = cityCones.ring = &streamRing;
+        hud.ring = &streamRing;
+    }
+    renderQueue.init();
+    renderQueue.textures = &textures;
+    cameraBlock.init();
+    cameraBlock.attach(ourShader.ID);
+    renderQueue.farPlane = 500.0f;
+    if (renderQueue.setSubmitMode(submitRequest) != submitRequest)
+        std::cout << "Render queue: " << renderSubmitModeNames[submitRequest] << " not supported, using "
+                  << renderSubmitModeNames[renderQueue.submitMode] << std::endl;
+    bench.submitMode = renderSubmitModeNames[renderQueue.submitMode];
 
     // Assign to bus
     bus.texFloor = texFloor;
@@ -481,25 +1387,81 @@ int main()
     std::cout << "  5/6/7       Ambient / Diffuse / Specular" << std::endl;
     std::cout << "" << std::endl;
     std::cout << "  TAB         Print Status" << std::endl;
+    std::cout << "  H           Toggle Performance HUD" << std::endl;
+    std::cout << "  P           Start/Stop CPU Profile (writes " << PROFILE_TRACE_PATH << ")" << std::endl;
     std::cout << "  ESC         Exit" << std::endl;
     std::cout << "=====================================================" << std::endl;
     std::cout << "\nTIP: Press V to switch to Interior Camera to see" << std::endl;
     std::cout << "     the textured seats, floor, and walls inside!" << std::endl;
     std::cout << "     Press K to start driving.\n" << std::endl;
 
+    // ==================== SIMULATION THREAD ====================
+    // Lockstep wherever a run must be repeatable: a fixed dt, or an input
+    // log whose frames the simulation has to retrace exactly
+    if (simThreadOn)
+        simThread.start(applySimInput, stepSimulation, fixedDt || inputLog.recording() || inputLog.replaying());
+    bench.simMode = simModeName();
+    bench.lateLatch = lateLatch;
+    std::cout << "Simulation: " << simModeName() << ", " << 1.0 / simClock.step << " Hz fixed step, at most "
+              << simClock.maxSteps << " steps per advance" << std::endl;
+
     // ==================== RENDER LOOP ====================
-    while (!glfwWindowShouldClose(window))
+    int frameCount = 0;
+    inputLog.deliverEvents(window);     // events logged before the first frame
+    lastPollTime = appTime();
+    allocTracker().endFrame();          // startup allocations are not frame 0's
+    allocTracker().resetSites();
+    while (headless || !glfwWindowShouldClose(window))
     {
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        if (maxFrames > 0 && frameCount >= maxFrames) break;
+        PROFILE_ZONE("frame");
+        frameStats.beginFrame();
+        float currentFrame = static_cast<float>(appTime());
+        deltaTime = fixedDt ? bench.dt : currentFrame - lastFrame;
         lastFrame = currentFrame;
+        if (bench.active()) {
+            for (int key : bench.beginFrame(frameCount))
+                key_callback(window, key, 0, GLFW_PRESS, 0);
+        }
+        if (!inputLog.beginFrame(deltaTime, [window](int key) { return keyPressed(window, key); }))
+            break;      // replay finished
+        if (keyPressed(window, GLFW_KEY_ESCAPE))
+            glfwSetWindowShouldClose(window, true);
+        glState().beginFrame();
+        gpuRegistry().beginFrame();
+        frameArena().beginFrame();
+        if (streamRingOn) streamRing.beginFrame();
+
+        // ==================== SIMULATION ====================
+        // This frame's input goes to the simulation thread (kept for the
+        // next frame if its queue is full), or is stepped right here
+        if (bench.active()) {
+            const float* rate = bench.lookRate();
+            if (rate[0] != 0.0f || rate[1] != 0.0f) simInput.look(rate[0] * deltaTime, rate[1] * deltaTime);
+        }
+        simInput.frame = frameCount;
+        simInput.time = lastPollTime;
+        simInput.dt = deltaTime;
+        simInput.held = sampleHeldKeys(window);
+        float lookX, lookY;
+        simInput.lookTotal(lookX, lookY);
+        bool handedOver = true;
+        if (!simThread.running()) {
+            applySimInput(simInput);
+            stepSimulation(deltaTime);
+        } else {
+            handedOver = simThread.post(simInput);
+        }
+        if (handedOver) {
+            postedLookYaw += lookX;
+            postedLookPitch += lookY;
+            simInput.clearEvents();
+        }
+        frameStats.endSim();
+        textures.update();
 
-        processInput(window);
-        bus.updateFan(deltaTime, fanSpinning);
-        bus.updateJetFlame(deltaTime);
-
-        int fbWidth, fbHeight;
-        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        int fbWidth = SCR_WIDTH, fbHeight = SCR_HEIGHT;
+        if (window) glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
 
         glViewport(0, 0, fbWidth, fbHeight);
         glClearColor(0.53f, 0.72f, 0.92f, 1.0f);  // Light blue sky
@@ -508,322 +1470,262 @@ int main()
         ourShader.use();
         ourShader.setInt("textureMode", 0);
 
+        // As late as possible, so the simulation thread has had this
+        // frame's input for as long as possible
+        const SimSnapshot& sim = acquireSnapshot(frameCount);
+        SimPose shown = lerpPose(sim.prev, sim.pose, renderAlpha(sim));
+
         // ==================== LIGHT SETUP ====================
-        ourShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
-        ourShader.setVec3("dirLight.ambient",  0.15f, 0.15f, 0.15f);
-        ourShader.setVec3("dirLight.diffuse",  0.7f, 0.7f, 0.6f);
-        ourShader.setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
-
-        // Point Lights
-        glm::vec3 bp = busPosition;
-        ourShader.setVec3("pointLights[0].position", bp + glm::vec3(5, 5, 5));
-        ourShader.setVec3("pointLights[0].ambient",  0.05f, 0.0f, 0.0f);
-        ourShader.setVec3("pointLights[0].diffuse",  0.8f, 0.1f, 0.1f);
-        ourShader.setVec3("pointLights[0].specular", 1.0f, 0.2f, 0.2f);
-        ourShader.setFloat("pointLights[0].constant",  1.0f);
-        ourShader.setFloat("pointLights[0].linear",    0.09f);
-        ourShader.setFloat("pointLights[0].quadratic", 0.032f);
-
-        ourShader.setVec3("pointLights[1].position", bp + glm::vec3(-5, 5, 5));
-        ourShader.setVec3("pointLights[1].ambient",  0.0f, 0.05f, 0.0f);
-        ourShader.setVec3("pointLights[1].diffuse",  0.1f, 0.8f, 0.1f);
-        ourShader.setVec3("pointLights[1].specular", 0.2f, 1.0f, 0.2f);
-        ourShader.setFloat("pointLights[1].constant",  1.0f);
-        ourShader.setFloat("pointLights[1].linear",    0.09f);
-        ourShader.setFloat("pointLights[1].quadratic", 0.032f);
-
-        ourShader.setVec3("pointLights[2].position", bp + glm::vec3(5, 5, -5));
-        ourShader.setVec3("pointLights[2].ambient",  0.0f, 0.0f, 0.05f);
-        ourShader.setVec3("pointLights[2].diffuse",  0.1f, 0.1f, 0.8f);
-        ourShader.setVec3("pointLights[2].specular", 0.2f, 0.2f, 1.0f);
-        ourShader.setFloat("pointLights[2].constant",  1.0f);
-        ourShader.setFloat("pointLights[2].linear",    0.09f);
-        ourShader.setFloat("pointLights[2].quadratic", 0.032f);
-
-        ourShader.setVec3("pointLights[3].position", bp + glm::vec3(-5, 5, -5));
-        ourShader.setVec3("pointLights[3].ambient",  0.05f, 0.05f, 0.05f);
-        ourShader.setVec3("pointLights[3].diffuse",  0.6f, 0.6f, 0.6f);
-        ourShader.setVec3("pointLights[3].specular", 0.6f, 0.6f, 0.6f);
-        ourShader.setFloat("pointLights[3].constant",  1.0f);
-        ourShader.setFloat("pointLights[3].linear",    0.09f);
-        ourShader.setFloat("pointLights[3].quadratic", 0.032f);
-
-        ourShader.setVec3("spotLight.position", cameraPos);
-        ourShader.setVec3("spotLight.direction", getCameraFront());
-        ourShader.setVec3("spotLight.ambient",  0.0f, 0.0f, 0.0f);
-        ourShader.setVec3("spotLight.diffuse",  1.0f, 1.0f, 1.0f);
-        ourShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        ourShader.setFloat("spotLight.constant",  1.0f);
-        ourShader.setFloat("spotLight.linear",    0.09f);
-        ourShader.setFloat("spotLight.quadratic", 0.032f);
-        ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-
-        ourShader.setFloat("shininess", 32.0f);
-        ourShader.setVec3("viewPos", cameraPos);
-
-        ourShader.setBool("dirLightOn",    dirLightOn);
-        ourShader.setBool("pointLightsOn", pointLightsOn);
-        ourShader.setBool("spotLightOn",   spotLightOn);
-        ourShader.setBool("ambientOn",     ambientOn);
-        ourShader.setBool("diffuseOn",     diffuseOn);
-        ourShader.setBool("specularOn",    specularOn);
+        ProfileZone lightZone("light setup");
+        SceneLighting& L = sceneLighting;
+        L.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+        L.dirLight.ambient   = glm::vec3(0.15f, 0.15f, 0.15f);
+        L.dirLight.diffuse   = glm::vec3(0.7f, 0.7f, 0.6f);
+        L.dirLight.specular  = glm::vec3(0.5f, 0.5f, 0.5f);
+
+        // Point Lights: colored corners around the bus, white at the back left
+        const glm::vec3 corners[SCENE_POINT_LIGHTS] = {
+            glm::vec3(5, 5, 5), glm::vec3(-5, 5, 5), glm::vec3(5, 5, -5), glm::vec3(-5, 5, -5)
+        };
+        const glm::vec3 pointColors[SCENE_POINT_LIGHTS][3] = {     // ambient, diffuse, specular
+            { glm::vec3(0.05f, 0.0f, 0.0f),   glm::vec3(0.8f, 0.1f, 0.1f), glm::vec3(1.0f, 0.2f, 0.2f) },
+            { glm::vec3(0.0f, 0.05f, 0.0f),   glm::vec3(0.1f, 0.8f, 0.1f), glm::vec3(0.2f, 1.0f, 0.2f) },
+            { glm::vec3(0.0f, 0.0f, 0.05f),   glm::vec3(0.1f, 0.1f, 0.8f), glm::vec3(0.2f, 0.2f, 1.0f) },
+            { glm::vec3(0.05f, 0.05f, 0.05f), glm::vec3(0.6f, 0.6f, 0.6f), glm::vec3(0.6f, 0.6f, 0.6f) }
+        };
+        glm::vec3 bp = shown.busPosition;
+        for (int i = 0; i < SCENE_POINT_LIGHTS; i++) {
+            PointLight& p = L.pointLights[i];
+            p.position = bp + corners[i];
+            p.ambient  = pointColors[i][0];
+            p.diffuse  = pointColors[i][1];
+            p.specular = pointColors[i][2];
+            p.constant  = 1.0f;
+            p.linear    = 0.09f;
+            p.quadratic = 0.032f;
+        }
+
+        L.spotLight.position  = shown.cameraPos;
+        L.spotLight.direction = shown.cameraFront;
+        L.spotLight.ambient   = glm::vec3(0.0f, 0.0f, 0.0f);
+        L.spotLight.diffuse   = glm::vec3(1.0f, 1.0f, 1.0f);
+        L.spotLight.specular  = glm::vec3(1.0f, 1.0f, 1.0f);
+        L.spotLight.constant  = 1.0f;
+        L.spotLight.linear    = 0.09f;
+        L.spotLight.quadratic = 0.032f;
+        L.spotLight.cutOff    = glm::cos(glm::radians(12.5f));
+
+        L.shininess = 32.0f;
+
+        L.dirLightOn    = sim.dirLightOn;
+        L.pointLightsOn = sim.pointLightsOn;
+        L.spotLightOn   = sim.spotLightOn;
+        L.ambientOn     = sim.ambientOn;
+        L.diffuseOn     = sim.diffuseOn;
+        L.specularOn    = sim.specularOn;
+        L.apply(ourShader);
         ourShader.setBool("isEmissive", false);
         ourShader.setFloat("alpha", 1.0f);
+        lightZone.end();
 
         // View & Projection
         float aspect = (float)fbWidth / (float)fbHeight;
-        glm::mat4 projection = glm::perspective(glm::radians(cameraFOV), aspect, 0.1f, 500.0f);
-        glm::mat4 view = getViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
+        glm::mat4 projection = glm::perspective(glm::radians(cameraFOV), aspect, 0.1f, renderQueue.farPlane);
+        glm::mat4 view = myLookAt(shown.cameraPos, shown.cameraTarget, shown.cameraUp);
+        renderQueue.begin(view);
 
-        // ==================== DRAW BUS ====================
+        // ==================== BUS ====================
         glm::mat4 busTransform = glm::mat4(1.0f);
-        glm::vec3 renderPos = busPosition;
-        renderPos.y += HOVER_HEIGHT + bus.hoverBobOffset + busAltitude;
+        glm::vec3 renderPos = shown.busPosition;
+        renderPos.y += HOVER_HEIGHT + shown.hoverBobOffset + shown.busAltitude;
         busTransform = glm::translate(busTransform, renderPos);
-        busTransform = glm::rotate(busTransform, glm::radians(busYaw), glm::vec3(0, 1, 0));
+        busTransform = glm::rotate(busTransform, glm::radians(shown.busYaw), glm::vec3(0, 1, 0));
 
-        bool savedJetOn = bus.jetEngineOn;
-        if (!emissiveLightOn) bus.jetEngineOn = false;
-        bus.draw(ourShader, busTransform);
-        bus.jetEngineOn = savedJetOn;
+        // Closed windows are opaque: the interior is only visible from the
+        // driver seat, from a free camera inside the body, or through an
+        // open door or window
+        applySnapshot(sim, shown, bus);
+        bus.parent = busTransform;
+        bus.interiorVisible = (shown.cameraMode == 2) || bus.interiorSeenFrom(shown.cameraPos);
 
         // ==================== CITY ENVIRONMENT ====================
-        // The road runs along the X-axis. Bus starts at (0,0,0) facing -X.
-        // We generate road segments and buildings relative to the bus X position.
-
-        float busX = busPosition.x;
-        // Snap to nearest segment boundary
-        float segStart = floor(busX / ROAD_SEGMENT_LEN) * ROAD_SEGMENT_LEN;
-
-        for (int seg = -VISIBLE_SEGMENTS / 2; seg <= VISIBLE_SEGMENTS / 2; seg++) {
-            float segX = segStart + seg * ROAD_SEGMENT_LEN;
-
-            // --- ROAD SEGMENT ---
-            {
-                ourShader.setInt("textureMode", 0);
-                if (texRoad != 0) {
-                    ourShader.setInt("textureMode", 1);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texRoad);
-                    ourShader.setInt("textureSampler", 0);
-                }
-                glm::mat4 model = glm::translate(glm::mat4(1.0f),
-                    glm::vec3(segX + ROAD_SEGMENT_LEN * 0.5f, -0.05f, 0.0f));
-                model = glm::scale(model, glm::vec3(ROAD_SEGMENT_LEN, 0.1f, ROAD_WIDTH));
-                bus.cube.draw(ourShader, model, glm::vec3(0.08f, 0.08f, 0.08f));
-                ourShader.setInt("textureMode", 0);
-            }
-
-            // --- WHITE DASHED CENTER DIVIDER ---
-            {
-                int numDashes = 4;
-                float dashLen = ROAD_SEGMENT_LEN / (numDashes * 2.0f);
-                for (int d = 0; d < numDashes; d++) {
-                    float dx = segX + d * (dashLen * 2.0f) + dashLen * 0.5f;
-                    glm::mat4 model = glm::translate(glm::mat4(1.0f),
-                        glm::vec3(dx, 0.01f, 0.0f));
-                    model = glm::scale(model, glm::vec3(dashLen * 0.8f, 0.02f, 0.15f));
-                    bus.cube.draw(ourShader, model, glm::vec3(1.0f, 1.0f, 1.0f));
-                }
-            }
-
-            // --- GRASS STRIPS (both sides) ---
-            for (int side = -1; side <= 1; side += 2) {
-                float grassZ = side * (ROAD_WIDTH * 0.5f + GRASS_WIDTH * 0.5f);
-                if (texGrass != 0) {
-                    ourShader.setInt("textureMode", 3);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texGrass);
-                    ourShader.setInt("textureSampler", 0);
-                }
-                glm::mat4 model = glm::translate(glm::mat4(1.0f),
-                    glm::vec3(segX + ROAD_SEGMENT_LEN * 0.5f, -0.1f, grassZ));
-                model = glm::scale(model, glm::vec3(ROAD_SEGMENT_LEN, 0.1f, GRASS_WIDTH));
-                bus.cube.draw(ourShader, model, glm::vec3(0.15f, 0.45f, 0.1f));
-                ourShader.setInt("textureMode", 0);
-            }
-        } // end segment loop
-
-        // ==================== BUILDINGS ====================
-        // Each building type appears twice (one on each side or at different positions)
-
-        // Helper lambda: draws a stacked-cubes building at (posX, posZ)
-        // --- STACKED CUBES #1 (left side, near start) ---
+        // The road runs along the X-axis and follows the bus; buildings are
+        // fixed. City materials live in one texture array, so the parts that
+        // survive culling are listed into one instance batch per primitive
+        // type, on the job system (City.h).
+        ProfileZone cityZone("city");
+        if (cityArray.poll())
+            textures.track(cityArray.ID, "city texture array", GL_RGB8,
+                           cityArray.layerSize, cityArray.layerSize, cityArray.layerCount(), true);
+        float cityLayers[CITY_MATERIAL_COUNT];
+        cityLayers[CITY_ROAD] = cityArray.layer(layerRoad);
+        cityLayers[CITY_GRASS] = cityArray.layer(layerGrass);
+        cityLayers[CITY_CONTAINER] = cityArray.layer(layerContainer);
+        cityLayers[CITY_WALL] = cityArray.layer(layerWall);
+        FrameVector<InstanceData>* cityLists[CITY_MESH_COUNT] = {
+            &cityCubes.instances, &cityCylinders.instances, &cityCones.instances
+        };
+
+        // ==================== SCENE SYSTEMS ====================
+        // Bus pose beside the city's road follow, then the city transforms
+        // and culling (the schedule stages them, Ecs.h)
+        jobSystem().resetStats();
+        city.beginUpdate(jobSystem(), shown.busPosition.x, projection * view, cityLayers);
         {
-            float bx = -15.0f, bz = -10.0f;
-            glm::vec3 colors[] = {
-                glm::vec3(0.85f, 0.2f, 0.2f),
-                glm::vec3(0.2f, 0.65f, 0.9f),
-                glm::vec3(0.9f, 0.85f, 0.1f)
-            };
-            float yOff = 0.0f;
-            float sizes[][3] = { {3.0f, 3.0f, 3.0f}, {2.5f, 2.5f, 2.5f}, {2.0f, 2.0f, 2.0f} };
-            for (int c = 0; c < 3; c++) {
-                if (texContainer != 0) {
-                    ourShader.setInt("textureMode", 1);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texContainer);
-                    ourShader.setInt("textureSampler", 0);
-                }
-                glm::mat4 model = glm::translate(glm::mat4(1.0f),
-                    glm::vec3(bx, yOff + sizes[c][1] * 0.5f, bz));
-                model = glm::scale(model, glm::vec3(sizes[c][0], sizes[c][1], sizes[c][2]));
-                bus.cube.draw(ourShader, model, colors[c]);
-                ourShader.setInt("textureMode", 0);
-                yOff += sizes[c][1];
-            }
+            PROFILE_ZONE("scene systems");
+            sceneSchedule.run(scene, jobSystem());
         }
-
-        // --- STACKED CUBES #2 (right side, further along) ---
+        city.endUpdate(cityLists);
+        cityJobStats = jobSystem().totals();
         {
-            float bx = -50.0f, bz = 12.0f;
-            glm::vec3 colors[] = {
-                glm::vec3(0.95f, 0.55f, 0.1f),
-                glm::vec3(0.7f, 0.3f, 0.85f)
-            };
-            float yOff = 0.0f;
-            float sizes[][3] = { {3.5f, 4.0f, 3.5f}, {2.5f, 3.0f, 2.5f} };
-            for (int c = 0; c < 2; c++) {
-                if (texContainer != 0) {
-                    ourShader.setInt("textureMode", 1);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texContainer);
-                    ourShader.setInt("textureSampler", 0);
-                }
-                glm::mat4 model = glm::translate(glm::mat4(1.0f),
-                    glm::vec3(bx, yOff + sizes[c][1] * 0.5f, bz));
-                model = glm::scale(model, glm::vec3(sizes[c][0], sizes[c][1], sizes[c][2]));
-                bus.cube.draw(ourShader, model, colors[c]);
-                ourShader.setInt("textureMode", 0);
-                yOff += sizes[c][1];
-            }
+            PROFILE_ZONE("bus.draw");
+            bus.draw(renderQueue);
         }
 
-        // --- TALL BUILDING #1 WITH WINDOWS (right side) ---
+        // The whole city: one instanced command per primitive type
+        renderQueue.drawBatch(cityCubes);
+        renderQueue.drawBatch(cityCylinders);
+        renderQueue.drawBatch(cityCones);
+        cityZone.end();
+
+        // ==================== SUBMIT ====================
+        // Bus and city sorted by state: opaque by material near to far, then
+        // the additive flame and hover glow far to near
+        glState().bindTexture(1, GL_TEXTURE_2D_ARRAY, cityArray.ID);
+        citySampler.bind(1);
+        // Late latch: the camera the draws go out with, as fresh as it gets
+        double viewSampleTime = sim.inputTime;
         {
-            float bx = -25.0f, bz = 10.0f;
-            float bw = 4.0f, bh = 12.0f, bd = 4.0f;
-
-            if (texWall != 0) {
-                ourShader.setInt("textureMode", 3);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, texWall);
-                ourShader.setInt("textureSampler", 0);
-            }
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, bh * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(bw, bh, bd));
-            bus.cube.draw(ourShader, model, glm::vec3(0.7f, 0.3f, 0.85f));
-            ourShader.setInt("textureMode", 0);
-
-            // Windows on road-facing side
-            for (int wr = 0; wr < 5; wr++) {
-                for (int wc = 0; wc < 2; wc++) {
-                    float wx = bx - 1.0f + wc * 2.0f;
-                    float wy = 1.8f + wr * 2.0f;
-                    float wz = bz - bd * 0.52f;
-                    glm::mat4 wModel = glm::translate(glm::mat4(1.0f), glm::vec3(wx, wy, wz));
-                    wModel = glm::scale(wModel, glm::vec3(0.8f, 1.0f, 0.05f));
-                    bus.cube.draw(ourShader, wModel, glm::vec3(0.05f, 0.08f, 0.15f));
-                }
+            PROFILE_ZONE("latch camera");
+            glm::mat4 latched;
+            double now = appTime();
+            if (lateLatch && latchedView(window, sim, shown, now, latched)) {
+                view = latched;
+                viewSampleTime = now;
             }
+            cameraBlock.latch(view, projection, shown.cameraPos);
         }
-
-        // --- TALL BUILDING #2 WITH WINDOWS (left side, further along) ---
-        {
-            float bx = -60.0f, bz = -11.0f;
-            float bw = 5.0f, bh = 15.0f, bd = 5.0f;
-
-            if (texWall != 0) {
-                ourShader.setInt("textureMode", 3);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, texWall);
-                ourShader.setInt("textureSampler", 0);
-            }
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, bh * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(bw, bh, bd));
-            bus.cube.draw(ourShader, model, glm::vec3(0.2f, 0.65f, 0.9f));
-            ourShader.setInt("textureMode", 0);
-
-            // Windows on road-facing side
-            for (int wr = 0; wr < 6; wr++) {
-                for (int wc = 0; wc < 2; wc++) {
-                    float wx = bx - 1.2f + wc * 2.4f;
-                    float wy = 2.0f + wr * 2.0f;
-                    float wz = bz + bd * 0.52f;
-                    glm::mat4 wModel = glm::translate(glm::mat4(1.0f), glm::vec3(wx, wy, wz));
-                    wModel = glm::scale(wModel, glm::vec3(0.9f, 1.1f, 0.05f));
-                    bus.cube.draw(ourShader, wModel, glm::vec3(0.05f, 0.08f, 0.15f));
-                }
-            }
+        if (rasterOn) {
+            PROFILE_ZONE("raster");
+            softRaster.arrayWrap = wrapModes[currentWrapIndex];
+            softRaster.arrayFilter = filterModes[currentFilterIndex];
+            softRaster.render(renderQueue, sceneLighting, view, projection, shown.cameraPos, jobSystem());
         }
+        renderQueue.submit(ourShader);
 
-        // --- CONE-TOPPED TOWER #1 (left side) ---
-        // Cylinder: height goes from 0 to towerH (center at towerH/2)
-        // Cone: sits on top, center at towerH + coneH/2
-        {
-            float bx = -40.0f, bz = -12.0f;
-            float radius = 2.0f, towerH = 8.0f, coneH = 3.0f;
-
-            // Cylinder body — use container2.png (512x512, square, clean UV)
-            if (texContainer != 0) {
-                ourShader.setInt("textureMode", 3);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, texContainer);
-                ourShader.setInt("textureSampler", 0);
-            }
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, towerH * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(radius * 2.0f, towerH, radius * 2.0f));
-            bus.cylinder.draw(ourShader, model, glm::vec3(0.1f, 0.85f, 0.75f));
-            ourShader.setInt("textureMode", 0);
-
-            // Cone roof — sits ON TOP of cylinder (no overlap)
-            model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, towerH + coneH * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(radius * 2.8f, coneH, radius * 2.8f));
-            sceneCone.draw(ourShader, model, glm::vec3(0.95f, 0.55f, 0.1f));
+        ourShader.setInt("textureMode", 0);
+        if (hud.visible) drawHud(fbWidth, fbHeight);
+        if (streamRingOn) streamRing.endFrame();
+        if (window) {
+            PROFILE_ZONE("swap");
+            glfwSwapBuffers(window);
         }
-
-        // --- CONE-TOPPED TOWER #2 (right side, further along) ---
-        {
-            float bx = -75.0f, bz = 13.0f;
-            float radius = 1.5f, towerH = 6.0f, coneH = 2.5f;
-
-            if (texContainer != 0) {
-                ourShader.setInt("textureMode", 3);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, texContainer);
-                ourShader.setInt("textureSampler", 0);
-            }
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, towerH * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(radius * 2.0f, towerH, radius * 2.0f));
-            bus.cylinder.draw(ourShader, model, glm::vec3(0.85f, 0.15f, 0.55f));
-            ourShader.setInt("textureMode", 0);
-
-            // Cone roof — ON TOP
-            model = glm::translate(glm::mat4(1.0f), glm::vec3(bx, towerH + coneH * 0.5f, bz));
-            model = glm::scale(model, glm::vec3(radius * 2.8f, coneH, radius * 2.8f));
-            sceneCone.draw(ourShader, model, glm::vec3(0.2f, 0.8f, 0.3f));
+        // Input-to-photon: from the poll of the newest input on screen to
+        // the end of the swap, for frames that show input no earlier frame
+        // did; and the age of the mouse look in the view, while it is live
+        double presentTime = appTime();
+        double latencyMs = -1.0;
+        if (sim.inputFrame > lastShownInput) {
+            latencyMs = (presentTime - sim.inputTime) * 1000.0;
+            lastShownInput = sim.inputFrame;
         }
-
-        ourShader.setInt("textureMode", 0);
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        double viewAgeMs = -1.0;
+        if (lookLive() && (shown.cameraMode == 0 || shown.cameraMode == 2))
+            viewAgeMs = (presentTime - viewSampleTime) * 1000.0;
+        const FrameRecord& frameRecord = frameStats.endFrame(glState().draws, glState().triangles,
+                                                             glState().uniforms.issued, latencyMs, viewAgeMs);
+        glTrace().endFrame();
+        if (bench.active()) bench.record(frameRecord, glTrace().lastFrameCalls(), renderQueue.lastFrameStats.submitMs);
+        frameCount++;
+        if (firstFrameTime < 0.0) {
+            firstFrameTime = appTime();
+            std::cout << "First frame presented after " << firstFrameTime * 1000.0 << " ms" << std::endl;
+        }
+        if (window) glfwPollEvents();
+        inputLog.deliverEvents(window);
+        lastPollTime = appTime();
+
+        allocTracker().endFrame();
+        if (assertNoAlloc && frameCount > ALLOC_WARMUP_FRAMES && allocTracker().lastFrameAllocs > 0) {
+            if (allocFailFrames++ == 0)
+                std::cout << "Alloc check: frame " << frameCount - 1 << " made " << allocTracker().lastFrameAllocs
+                          << " heap allocations (" << allocTracker().lastFrameBytes << " bytes)" << std::endl;
+        }
+    }
+    bool allocSampled = allocTracker().sampling.exchange(false);    // report the loop only
+    simThread.stop();                   // the simulation state is the main thread's again
+    if (inputLog.replaying()) {
+        std::cout << "Replay end: bus at (" << busPosition.x << ", " << busAltitude << ", " << busPosition.z
+                  << ") yaw " << busYaw << ", camera " << cameraModeNames[cameraMode] << std::endl;
+    }
+    inputLog.close();
+
+    if (glTraceMode != GL_TRACE_OFF) glTrace().printHistogram(std::cout);
+    if (streamRingOn && bench.active()) printStreamRing(std::cout);
+    if (bench.active()) printFrameArena(std::cout);
+    if (profiler().enabled.load()) toggleProfiler();
+    if (bench.active()) {
+        bench.finalState.push_back(std::make_pair("bus_x", (double)busPosition.x));
+        bench.finalState.push_back(std::make_pair("bus_z", (double)busPosition.z));
+        bench.finalState.push_back(std::make_pair("bus_yaw", (double)busYaw));
+        bench.finalState.push_back(std::make_pair("bus_altitude", (double)busAltitude));
+        bench.finalState.push_back(std::make_pair("camera_mode", (double)cameraMode));
+        bench.startupMs = firstFrameTime * 1000.0;
+        bench.printTable(std::cout);
+        bench.writeResults(benchOut, headless ? "null" : "gl", fixedDt);
+    }
+    if (rasterOn && softRaster.frames > 0) {
+        softRaster.printSummary(std::cout);
+        softRaster.writePng(rasterOut);
+    }
+    if (frameStats.logging()) {
+        frameStats.printSummary(std::cout);
+        frameStats.closeLog();
+    }
+    int exitCode = 0;
+    if (assertNoAlloc) {
+        int checked = frameCount > ALLOC_WARMUP_FRAMES ? frameCount - ALLOC_WARMUP_FRAMES : 0;
+        if (allocFailFrames > 0) {
+            std::cout << "Alloc check FAILED: " << allocFailFrames << " of " << checked
+                      << " steady-state frames allocated" << std::endl;
+            allocTracker().printTopSites(std::cout, 10, true);
+            exitCode = 3;
+        } else {
+            std::cout << "Alloc check passed: no heap allocations in " << checked
+                      << " steady-state frames" << std::endl;
+        }
+    } else if (allocSampled) {
+        allocTracker().printTopSites(std::cout);
     }
 
     bus.cleanup();
     sceneSphere.cleanup();
     sceneCone.cleanup();
-    unsigned int allTex[] = { texFloor, texCarpet, texFabric, texWall, texDashboard, texBusBody, texSphere, texCone };
-    for (auto t : allTex) { if (t) glDeleteTextures(1, &t); }
-    glfwTerminate();
-    return 0;
+    cityCubes.cleanup();
+    cityCylinders.cleanup();
+    cityCones.cleanup();
+    textures.untrack(cityArray.ID);
+    textures.untrack(hud.atlas);
+    hud.cleanup();
+    cityArray.cleanup();
+    citySampler.cleanup();
+    renderQueue.cleanup();
+    streamRing.cleanup();
+    cameraBlock.cleanup();
+    frameArena().cleanup();
+    textures.shutdown();
+    ourShader.cleanup();
+    gpuRegistry().dumpLeaks(std::cout);
+    jobSystem().shutdown();
+    if (window) glfwTerminate();
+    return exitCode;
 }
 
 // ============================================================================
 // MOUSE CALLBACK â€” look around (FPS-style)
 // ============================================================================
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
+    if (!inputLog.cursorEvent(xposIn, yposIn)) return;
     if (!mouseCaptured) return;
 
     float xpos = static_cast<float>(xposIn);
@@ -840,76 +1742,72 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     lastMouseX = xpos;
     lastMouseY = ypos;
 
-    cameraYaw += xoffset;
-    cameraPitch += yoffset;
-
-    // Clamp pitch to prevent flipping
-    if (cameraPitch > 89.0f) cameraPitch = 89.0f;
-    if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+    // The camera angles are the simulation's (applySimInput)
+    simInput.look(xoffset, yoffset);
 }
 
 // ============================================================================
 // SCROLL CALLBACK â€” zoom in/out (change FOV)
 // ============================================================================
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    if (!inputLog.scrollEvent(xoffset, yoffset)) return;
     cameraFOV -= (float)yoffset * 2.0f;
     if (cameraFOV < 15.0f) cameraFOV = 15.0f;
     if (cameraFOV > 90.0f) cameraFOV = 90.0f;
 }
 
 // ============================================================================
-// PROCESS INPUT â€” continuous key handling
+// PROCESS INPUT â€” continuous key handling (one simulation step)
 // ============================================================================
-void processInput(GLFWwindow* window) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+void processInput(float dt) {
+    PROFILE_ZONE("processInput");
 
     // ================================================================
     // WASD always drives the bus
     // ================================================================
     {
         float appliedAcc = 0.0f;
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) appliedAcc = ACCELERATION;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) appliedAcc = -ACCELERATION;
+        if (simKeyHeld(GLFW_KEY_W)) appliedAcc = ACCELERATION;
+        if (simKeyHeld(GLFW_KEY_S)) appliedAcc = -ACCELERATION;
 
         glm::vec3 forwardDir = getBusForward();
         if (appliedAcc != 0.0f)
-            busSpeed += appliedAcc * deltaTime;
+            busSpeed += appliedAcc * dt;
         else {
             // Natural deceleration
-            if (busSpeed > 0) busSpeed = std::max(0.0f, busSpeed - DECELERATION * deltaTime);
-            if (busSpeed < 0) busSpeed = std::min(0.0f, busSpeed + DECELERATION * deltaTime);
+            if (busSpeed > 0) busSpeed = std::max(0.0f, busSpeed - DECELERATION * dt);
+            if (busSpeed < 0) busSpeed = std::min(0.0f, busSpeed + DECELERATION * dt);
         }
         busSpeed = glm::clamp(busSpeed, -MAX_SPEED, MAX_SPEED);
 
         float turnInput = 0.0f;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) turnInput = 1.0f;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) turnInput = -1.0f;
+        if (simKeyHeld(GLFW_KEY_A)) turnInput = 1.0f;
+        if (simKeyHeld(GLFW_KEY_D)) turnInput = -1.0f;
         if (turnInput != 0.0f)
-            busSteerAngle += turnInput * STEER_SPEED * deltaTime;
+            busSteerAngle += turnInput * STEER_SPEED * dt;
         else {
-            if (busSteerAngle > 0) busSteerAngle = std::max(0.0f, busSteerAngle - STEER_SPEED * deltaTime);
-            if (busSteerAngle < 0) busSteerAngle = std::min(0.0f, busSteerAngle + STEER_SPEED * deltaTime);
+            if (busSteerAngle > 0) busSteerAngle = std::max(0.0f, busSteerAngle - STEER_SPEED * dt);
+            if (busSteerAngle < 0) busSteerAngle = std::min(0.0f, busSteerAngle + STEER_SPEED * dt);
         }
         busSteerAngle = glm::clamp(busSteerAngle, -MAX_STEER, MAX_STEER);
-        if (busSpeed != 0.0f) busYaw += busSteerAngle * busSpeed * deltaTime * 0.1f;
-        busPosition += forwardDir * busSpeed * deltaTime;
-        bus.steeringAngle = busSteerAngle;
-        bus.jetEngineOn = true;
+        if (busSpeed != 0.0f) busYaw += busSteerAngle * busSpeed * dt * 0.1f;
+        busPosition += forwardDir * busSpeed * dt;
+        simBus.steeringAngle = busSteerAngle;
+        simBus.jetEngineOn = true;
 
         // Up/Down hover control
         float vertInput = 0.0f;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) vertInput = 1.0f;
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) vertInput = -1.0f;
+        if (simKeyHeld(GLFW_KEY_SPACE)) vertInput = 1.0f;
+        if (simKeyHeld(GLFW_KEY_LEFT_CONTROL)) vertInput = -1.0f;
         if (vertInput != 0.0f)
-            busVerticalSpeed += vertInput * VERTICAL_ACCEL * deltaTime;
+            busVerticalSpeed += vertInput * VERTICAL_ACCEL * dt;
         else {
             // Dampen vertical speed
-            if (busVerticalSpeed > 0) busVerticalSpeed = std::max(0.0f, busVerticalSpeed - VERTICAL_ACCEL * 0.7f * deltaTime);
-            if (busVerticalSpeed < 0) busVerticalSpeed = std::min(0.0f, busVerticalSpeed + VERTICAL_ACCEL * 0.7f * deltaTime);
+            if (busVerticalSpeed > 0) busVerticalSpeed = std::max(0.0f, busVerticalSpeed - VERTICAL_ACCEL * 0.7f * dt);
+            if (busVerticalSpeed < 0) busVerticalSpeed = std::min(0.0f, busVerticalSpeed + VERTICAL_ACCEL * 0.7f * dt);
         }
         busVerticalSpeed = glm::clamp(busVerticalSpeed, -15.0f, 15.0f);
-        busAltitude += busVerticalSpeed * deltaTime;
+        busAltitude += busVerticalSpeed * dt;
         busAltitude = glm::clamp(busAltitude, 0.0f, MAX_ALTITUDE);
     }
 
@@ -917,19 +1815,19 @@ void processInput(GLFWwindow* window) {
     // FREE CAMERA movement with Arrow Keys (only in free cam mode)
     // ================================================================
     if (!isDrivingMode && cameraMode == 0) {
-        float camSpeed = 15.0f * deltaTime;
-        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) camSpeed *= 2.5f;
+        float camSpeed = 15.0f * dt;
+        if (simKeyHeld(GLFW_KEY_LEFT_SHIFT)) camSpeed *= 2.5f;
 
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)    cameraPos += camSpeed * getCameraFront();
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)  cameraPos -= camSpeed * getCameraFront();
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)  cameraPos -= getCameraRight() * camSpeed;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) cameraPos += getCameraRight() * camSpeed;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) cameraPos += glm::vec3(0, 1, 0) * camSpeed;
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) cameraPos -= glm::vec3(0, 1, 0) * camSpeed;
+        if (simKeyHeld(GLFW_KEY_UP))    cameraPos += camSpeed * getCameraFront();
+        if (simKeyHeld(GLFW_KEY_DOWN))  cameraPos -= camSpeed * getCameraFront();
+        if (simKeyHeld(GLFW_KEY_LEFT))  cameraPos -= getCameraRight() * camSpeed;
+        if (simKeyHeld(GLFW_KEY_RIGHT)) cameraPos += getCameraRight() * camSpeed;
+        if (simKeyHeld(GLFW_KEY_SPACE)) cameraPos += glm::vec3(0, 1, 0) * camSpeed;
+        if (simKeyHeld(GLFW_KEY_LEFT_CONTROL)) cameraPos -= glm::vec3(0, 1, 0) * camSpeed;
 
         // Orbit (hold F)
-        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
-            orbitAngle += 50.0f * deltaTime;
+        if (simKeyHeld(GLFW_KEY_F)) {
+            orbitAngle += 50.0f * dt;
             if (orbitAngle > 360.0f) orbitAngle -= 360.0f;
             cameraPos.x = busPosition.x + orbitRadius * sin(glm::radians(orbitAngle));
             cameraPos.z = busPosition.z + orbitRadius * cos(glm::radians(orbitAngle));
@@ -945,22 +1843,14 @@ void processInput(GLFWwindow* window) {
 // KEY CALLBACK â€” discrete key presses
 // ============================================================================
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (!inputLog.keyEvent(key, action, mods)) return;
     if (action != GLFW_PRESS) return;
 
     switch (key) {
         // --- CAMERA ---
-        case GLFW_KEY_V:
-            cameraMode = (cameraMode + 1) % NUM_CAMERA_MODES;
-            std::cout << "Camera: " << cameraModeNames[cameraMode] << std::endl;
-            // When switching to interior, point forward
-            if (cameraMode == 2) {
-                cameraYaw = busYaw + 180.0f; // look forward from driver seat
-                cameraPitch = 0.0f;
-            }
-            break;
         case GLFW_KEY_M:
             mouseCaptured = !mouseCaptured;
-            glfwSetInputMode(window, GLFW_CURSOR,
+            if (window) glfwSetInputMode(window, GLFW_CURSOR,
                 mouseCaptured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
             firstMouse = true;
             std::cout << "Mouse: " << (mouseCaptured ? "CAPTURED" : "FREE") << std::endl;
@@ -996,6 +1886,34 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             }
             break;
 
+        // --- STATUS ---
+        case GLFW_KEY_TAB: printStatus(); break;
+        case GLFW_KEY_P: toggleProfiler(); break;
+        case GLFW_KEY_H: hud.visible = !hud.visible;
+            std::cout << "HUD: " << (hud.visible ? "ON" : "OFF") << std::endl; break;
+
+        // Camera, lighting and bus keys change the simulation (simKey)
+        default: simInput.key(key); break;
+    }
+}
+
+// ============================================================================
+// SIM KEY - discrete presses that change the simulated scene, applied by
+// the simulation in the order they were pressed
+// ============================================================================
+void simKey(int key) {
+    switch (key) {
+        // --- CAMERA ---
+        case GLFW_KEY_V:
+            cameraMode = (cameraMode + 1) % NUM_CAMERA_MODES;
+            std::cout << "Camera: " << cameraModeNames[cameraMode] << std::endl;
+            // When switching to interior, point forward
+            if (cameraMode == 2) {
+                cameraYaw = busYaw + 180.0f; // look forward from driver seat
+                cameraPitch = 0.0f;
+            }
+            break;
+
         // --- LIGHTING ---
         case GLFW_KEY_1: dirLightOn = !dirLightOn;
             std::cout << "Directional: " << (dirLightOn ? "ON" : "OFF") << std::endl; break;
@@ -1013,9 +1931,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             std::cout << "Specular: " << (specularOn ? "ON" : "OFF") << std::endl; break;
 
         // --- BUS ---
-        case GLFW_KEY_B: bus.toggleFrontDoor(); break;
+        case GLFW_KEY_B: simBus.toggleFrontDoor(); break;
         case GLFW_KEY_G: fanSpinning = !fanSpinning; break;
-        case GLFW_KEY_L: bus.toggleLight(); break;
+        case GLFW_KEY_L: simBus.toggleLight(); break;
         case GLFW_KEY_K:
             isDrivingMode = !isDrivingMode;
             if (!isDrivingMode) {
@@ -1026,9 +1944,6 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 std::cout << "CHASE CAM | WASD=Drive | V=cycle camera" << std::endl;
             }
             break;
-
-        // --- STATUS ---
-        case GLFW_KEY_TAB: printStatus(); break;
     }
 }
 
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+// Glyph coverage in the red channel; solid quads sample an all-white cell
+uniform sampler2D fontAtlas;
+
+void main() {
+    float coverage = texture(fontAtlas, TexCoord).r;
+    FragColor = vec4(Color.rgb, Color.a * coverage);
+}
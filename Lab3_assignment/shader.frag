@@ -5,6 +5,10 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 in vec3 VertexLightColor;
+in vec3 ObjectColor;        // objectColor, or the per-instance color
+flat in int TexMode;        // textureMode, or the per-instance mode
+flat in float TexLayer;     // >= 0: sample textureArray at this layer
+in float Alpha;             // alpha, or the per-draw alpha
 
 // ==================== LIGHT STRUCTS ====================
 struct DirLight {
@@ -40,7 +44,12 @@ struct SpotLight {
 #define NR_POINT_LIGHTS 4
 
 uniform vec3 objectColor;
-uniform vec3 viewPos;
+// Camera (CameraBlock.h): latched just before the frame's draws are issued
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 eyePos;            // camera position, xyz
+};
 
 // Material
 uniform float shininess;     // Specular exponent (e.g. 32.0)
@@ -62,13 +71,19 @@ uniform bool specularOn;
 
 // Emissive mode (for flames, glows)
 uniform bool isEmissive;
-uniform float alpha;
 
 // ==================== TEXTURE UNIFORMS ====================
 uniform sampler2D textureSampler;
+uniform sampler2DArray textureArray;   // city materials, one layer each
 // textureMode: 0=none, 1=pure texture, 2=vertex-blended (Gouraud), 3=fragment-blended (Phong)
 uniform int textureMode;
 
+vec3 sampleTexture() {
+    if (TexLayer >= 0.0)
+        return texture(textureArray, vec3(TexCoord, TexLayer)).rgb;
+    return texture(textureSampler, TexCoord).rgb;
+}
+
 // ==================== LIGHT CALCULATION FUNCTIONS ====================
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 matColor) {
@@ -122,20 +137,20 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec
 void main() {
     if (isEmissive) {
         // Emissive objects bypass all lighting (flames, glows)
-        FragColor = vec4(objectColor, alpha);
+        FragColor = vec4(ObjectColor, Alpha);
         return;
     }
     
     vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(eyePos.xyz - FragPos);
     
     // Determine material color based on texture mode
-    vec3 matColor = objectColor;
+    vec3 matColor = ObjectColor;
     vec3 texColor = vec3(1.0);
     
-    if (textureMode == 1) {
+    if (TexMode == 1) {
         // Mode 1: Pure texture — texture replaces object color entirely
-        texColor = texture(textureSampler, TexCoord).rgb;
+        texColor = sampleTexture();
         // Compute lighting with texture as material
         vec3 result = vec3(0.0);
         if (dirLightOn)
@@ -147,48 +162,48 @@ void main() {
         if (spotLightOn)
             result += CalcSpotLight(spotLight, norm, FragPos, viewDir, texColor);
         result = clamp(result, 0.0, 1.0);
-        FragColor = vec4(result, alpha);
+        FragColor = vec4(result, Alpha);
         return;
     }
     
-    if (textureMode == 2) {
+    if (TexMode == 2) {
         // Mode 2: Texture × vertex-computed (Gouraud) lighting
-        texColor = texture(textureSampler, TexCoord).rgb;
+        texColor = sampleTexture();
         vec3 result = texColor * VertexLightColor;
         result = clamp(result, 0.0, 1.0);
-        FragColor = vec4(result, alpha);
+        FragColor = vec4(result, Alpha);
         return;
     }
     
-    if (textureMode == 3) {
+    if (TexMode == 3) {
         // Mode 3: Texture × fragment-computed (Phong) lighting
-        texColor = texture(textureSampler, TexCoord).rgb;
-        // Compute per-fragment Phong with objectColor
+        texColor = sampleTexture();
+        // Compute per-fragment Phong with ObjectColor
         vec3 phongResult = vec3(0.0);
         if (dirLightOn)
-            phongResult += CalcDirLight(dirLight, norm, viewDir, objectColor);
+            phongResult += CalcDirLight(dirLight, norm, viewDir, ObjectColor);
         if (pointLightsOn) {
             for (int i = 0; i < NR_POINT_LIGHTS; i++)
-                phongResult += CalcPointLight(pointLights[i], norm, FragPos, viewDir, objectColor);
+                phongResult += CalcPointLight(pointLights[i], norm, FragPos, viewDir, ObjectColor);
         }
         if (spotLightOn)
-            phongResult += CalcSpotLight(spotLight, norm, FragPos, viewDir, objectColor);
+            phongResult += CalcSpotLight(spotLight, norm, FragPos, viewDir, ObjectColor);
         vec3 result = texColor * clamp(phongResult, 0.0, 1.0);
         result = clamp(result, 0.0, 1.0);
-        FragColor = vec4(result, alpha);
+        FragColor = vec4(result, Alpha);
         return;
     }
     
     // Mode 0: No texture — original Phong lighting
     vec3 result = vec3(0.0);
     if (dirLightOn)
-        result += CalcDirLight(dirLight, norm, viewDir, objectColor);
+        result += CalcDirLight(dirLight, norm, viewDir, ObjectColor);
     if (pointLightsOn) {
         for (int i = 0; i < NR_POINT_LIGHTS; i++)
-            result += CalcPointLight(pointLights[i], norm, FragPos, viewDir, objectColor);
+            result += CalcPointLight(pointLights[i], norm, FragPos, viewDir, ObjectColor);
     }
     if (spotLightOn)
-        result += CalcSpotLight(spotLight, norm, FragPos, viewDir, objectColor);
+        result += CalcSpotLight(spotLight, norm, FragPos, viewDir, ObjectColor);
     result = clamp(result, 0.0, 1.0);
-    FragColor = vec4(result, alpha);
+    FragColor = vec4(result, Alpha);
 }
@@ -2,22 +2,41 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+// Per-instance stream (InstanceBatch): model matrix, color, (layer, textureMode)
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 7) in vec3 aInstanceColor;
+layout (location = 8) in vec2 aInstanceMaterial;
+// Per-draw index (RenderQueue buffered submission): 0..N-1 with divisor 1,
+// so the draw's base instance selects its record in drawData
+layout (location = 9) in int aDrawIndex;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 out vec3 VertexLightColor;
+out vec3 ObjectColor;
+flat out int TexMode;
+flat out float TexLayer;    // texture-array layer, -1 = use textureSampler
+out float Alpha;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Camera (CameraBlock.h): latched just before the frame's draws are issued
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 eyePos;            // camera position, xyz
+};
+uniform bool instanced;     // take model/color/material from the instance stream
+uniform bool perDrawData;   // take model/color/alpha from drawData[aDrawIndex]
+uniform samplerBuffer drawData;   // 5 texels per draw: model columns, color + alpha
+uniform int drawDataBase;   // texel of this frame's first record (stream ring offset)
+uniform float alpha;
 
 // Texture mode: 0=none, 1=pure texture, 2=vertex-blended, 3=fragment-blended
 uniform int textureMode;
 
 // --- Light uniforms duplicated for vertex (Gouraud) lighting ---
 uniform vec3 objectColor;
-uniform vec3 viewPos;
 uniform float shininess;
 
 // Directional light
@@ -65,39 +84,39 @@ uniform bool diffuseOn;
 uniform bool specularOn;
 
 // === Vertex-shader Phong (Gouraud) functions ===
-vec3 CalcDirLightV(DirLight light, vec3 normal, vec3 viewDir) {
+vec3 CalcDirLightV(DirLight light, vec3 normal, vec3 viewDir, vec3 matColor) {
     vec3 lightDir = normalize(-light.direction);
-    vec3 ambient = ambientOn ? light.ambient * objectColor : vec3(0.0);
+    vec3 ambient = ambientOn ? light.ambient * matColor : vec3(0.0);
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = diffuseOn ? light.diffuse * diff * objectColor : vec3(0.0);
+    vec3 diffuse = diffuseOn ? light.diffuse * diff * matColor : vec3(0.0);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     vec3 specular = specularOn ? light.specular * spec : vec3(0.0);
     return ambient + diffuse + specular;
 }
 
-vec3 CalcPointLightV(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+vec3 CalcPointLightV(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 matColor) {
     vec3 lightDir = normalize(light.position - fragPos);
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    vec3 ambient = ambientOn ? light.ambient * objectColor : vec3(0.0);
+    vec3 ambient = ambientOn ? light.ambient * matColor : vec3(0.0);
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = diffuseOn ? light.diffuse * diff * objectColor : vec3(0.0);
+    vec3 diffuse = diffuseOn ? light.diffuse * diff * matColor : vec3(0.0);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     vec3 specular = specularOn ? light.specular * spec : vec3(0.0);
     return (ambient + diffuse + specular) * attenuation;
 }
 
-vec3 CalcSpotLightV(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+vec3 CalcSpotLightV(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 matColor) {
     vec3 lightDir = normalize(light.position - fragPos);
     float theta = dot(lightDir, normalize(-light.direction));
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    vec3 ambient = ambientOn ? light.ambient * objectColor * attenuation : vec3(0.0);
+    vec3 ambient = ambientOn ? light.ambient * matColor * attenuation : vec3(0.0);
     if (theta > light.cutOff) {
         float diff = max(dot(normal, lightDir), 0.0);
-        vec3 diffuse = diffuseOn ? light.diffuse * diff * objectColor : vec3(0.0);
+        vec3 diffuse = diffuseOn ? light.diffuse * diff * matColor : vec3(0.0);
         vec3 reflectDir = reflect(-lightDir, normal);
         float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
         vec3 specular = specularOn ? light.specular * spec : vec3(0.0);
@@ -107,25 +126,39 @@ vec3 CalcSpotLightV(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
 }
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    mat4 M = instanced ? aInstanceModel : model;
+    ObjectColor = instanced ? aInstanceColor : objectColor;
+    Alpha = alpha;
+    if (perDrawData) {
+        int base = drawDataBase + aDrawIndex * 5;
+        M = mat4(texelFetch(drawData, base), texelFetch(drawData, base + 1),
+                 texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+        vec4 colorAlpha = texelFetch(drawData, base + 4);
+        ObjectColor = colorAlpha.rgb;
+        Alpha = colorAlpha.a;
+    }
+    TexMode = instanced ? int(aInstanceMaterial.y) : textureMode;
+    TexLayer = instanced ? aInstanceMaterial.x : -1.0;
+
+    FragPos = vec3(M * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(M))) * aNormal;
     TexCoord = aTexCoord;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 
     // Compute Gouraud lighting only when textureMode == 2
     VertexLightColor = vec3(1.0);
-    if (textureMode == 2) {
+    if (TexMode == 2) {
         vec3 norm = normalize(Normal);
-        vec3 viewDir = normalize(viewPos - FragPos);
+        vec3 viewDir = normalize(eyePos.xyz - FragPos);
         vec3 result = vec3(0.0);
         if (dirLightOn)
-            result += CalcDirLightV(dirLight, norm, viewDir);
+            result += CalcDirLightV(dirLight, norm, viewDir, ObjectColor);
         if (pointLightsOn) {
             for (int i = 0; i < NR_POINT_LIGHTS; i++)
-                result += CalcPointLightV(pointLights[i], norm, FragPos, viewDir);
+                result += CalcPointLightV(pointLights[i], norm, FragPos, viewDir, ObjectColor);
         }
         if (spotLightOn)
-            result += CalcSpotLightV(spotLight, norm, FragPos, viewDir);
+            result += CalcSpotLightV(spotLight, norm, FragPos, viewDir, ObjectColor);
         VertexLightColor = clamp(result, 0.0, 1.0);
     }
 }
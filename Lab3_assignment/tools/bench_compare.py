@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""Compare hover-bus benchmark results and fail on regressions.
+
+Usage:
+    python tools/bench_compare.py --base a1.json a2.json --new b1.json b2.json
+    python tools/bench_compare.py base.json new.json
+    options: --thresholds limits.json  --alpha 0.01  --method mwu|bootstrap
+
+Each file is one `--bench ... --bench-out` result. Repeated runs of the same
+build are pooled. Phases are matched by name, and each metric is compared
+against its threshold (relative change, see DEFAULT_THRESHOLDS):
+
+  frame_ms    per-frame CPU time; the samples are the per-run medians.
+              Frames of one process are not independent (they share its
+              caches, clocks and neighbours), so a single run is one
+              sample, however many frames it has. Gated only with at
+              least MIN_GATE_RUNS runs on each side: a regression needs
+              the median to rise by more than the limit AND the rise to
+              be significant, by a one-sided Mann-Whitney U test
+              (p < alpha) or, with --method bootstrap, the lower bound of
+              a bootstrap CI of the relative median change above the
+              limit. The limit is raised to the run-to-run spread of the
+              base medians. With fewer runs the change is reported only.
+              Three runs a side can reach p < 0.05, five reach p < 0.01.
+  draws, uniforms, gl_calls, triangles
+              per-frame counters, compared by mean. Deterministic only
+              with --fixed-dt (wall-clock steps move the bus and camera
+              differently each run), so gated only when both sides ran
+              with it, and reported otherwise.
+  startup_ms  launch to first frame, one value per run, compared by median.
+              Gated like frame_ms (Mann-Whitney, >= MIN_GATE_RUNS runs a
+              side), reported otherwise.
+  submit_ms   render queue CPU submit time, median of the per-run p50s.
+              Reported only ("slower" never fails the run): it is what
+              switching the submission mode (--submit) changes.
+  latency_ms, frame_ms sd
+              input-to-photon latency (median of the per-run p50s) and
+              the per-run frame-time standard deviation. Reported only,
+              like submit_ms: they are what the simulation threading
+              ("sim", --no-sim-thread) changes.
+  view_age_ms age of the mouse look in the drawn view at the swap, in
+              phases that script "look" (median of the per-run p50s).
+              Reported only: it is what the late latch ("late_latch",
+              --no-late-latch) changes.
+
+Exit status: 0 = no regression, 1 = regression, 2 = bad input.
+"""
+
+import argparse
+import json
+import math
+import random
+import sys
+
+DEFAULT_THRESHOLDS = {
+    "frame_ms": 0.05,
+    "draws": 0.0,
+    "uniforms": 0.02,
+    "gl_calls": 0.02,
+    "triangles": 0.0,
+    "startup_ms": 0.10,
+    "submit_ms": 0.10,
+    "latency_ms": 0.10,
+    "frame_ms_sd": 0.10,
+    "view_age_ms": 0.10,
+}
+COUNTERS = ["draws", "uniforms", "gl_calls", "triangles"]
+MIN_GATE_RUNS = 3       # runs a side before a timing change can fail the gate
+
+
+def load_runs(paths):
+    runs = []
+    for p in paths:
+        try:
+            with open(p) as f:
+                runs.append(json.load(f))
+        except (OSError, ValueError) as e:
+            print("error: cannot read %s: %s" % (p, e))
+            sys.exit(2)
+    return runs
+
+
+def median(v):
+    s = sorted(v)
+    n = len(s)
+    if n == 0:
+        return float("nan")
+    return s[n // 2] if n % 2 else 0.5 * (s[n // 2 - 1] + s[n // 2])
+
+
+def mean(v):
+    return sum(v) / len(v) if v else float("nan")
+
+
+def mann_whitney_greater(base, new):
+    """One-sided p-value that `new` tends to be larger than `base`
+    (normal approximation with tie correction)."""
+    n1, n2 = len(base), len(new)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    combined = sorted([(x, 0) for x in base] + [(x, 1) for x in new])
+    ranks = [0.0] * len(combined)
+    ties = 0.0
+    i = 0
+    while i < len(combined):
+        j = i
+        while j + 1 < len(combined) and combined[j + 1][0] == combined[i][0]:
+            j += 1
+        r = 0.5 * (i + j) + 1.0
+        for k in range(i, j + 1):
+            ranks[k] = r
+        t = j - i + 1
+        ties += t ** 3 - t
+        i = j + 1
+    r_new = sum(r for r, (_, g) in zip(ranks, combined) if g == 1)
+    u = r_new - n2 * (n2 + 1) / 2.0
+    n = n1 + n2
+    mu = n1 * n2 / 2.0
+    var = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1))) if n > 1 else 0.0
+    if var <= 0:
+        return 1.0
+    z = (u - mu - 0.5) / math.sqrt(var)      # continuity correction
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def bootstrap_change_ci(base, new, iters=2000, seed=1234, level=0.95):
+    """CI of the relative change of the median, (new - base) / base."""
+    rng = random.Random(seed)
+    changes = []
+    for _ in range(iters):
+        b = median([rng.choice(base) for _ in base])
+        n = median([rng.choice(new) for _ in new])
+        if b > 0:
+            changes.append((n - b) / b)
+    changes.sort()
+    lo = changes[int((1.0 - level) / 2.0 * (len(changes) - 1))]
+    hi = changes[int((1.0 + level) / 2.0 * (len(changes) - 1))]
+    return lo, hi
+
+
+def rel_change(b, n):
+    if b == 0:
+        return 0.0 if n == 0 else float("inf")
+    return (n - b) / b
+
+
+def phase_map(run):
+    return {p["name"]: p for p in run.get("phases", [])}
+
+
+def collect(runs, phase, key):
+    out = []
+    for r in runs:
+        p = phase_map(r).get(phase)
+        if p is not None and key in p:
+            out.append(p[key])
+    return out
+
+
+def compare(base_runs, new_runs, thresholds, alpha, method):
+    rows = []
+    regressions = 0
+
+    def add(phase, metric, b, n, stat, verdict):
+        nonlocal regressions
+        if verdict == "REGRESSION":
+            regressions += 1
+        rows.append((phase, metric, b, n, rel_change(b, n), stat, verdict))
+
+    gate_timing = len(base_runs) >= MIN_GATE_RUNS and len(new_runs) >= MIN_GATE_RUNS
+    gate_counters = all(r.get("fixed_dt") is True for r in base_runs + new_runs)
+    runs_stat = "%d vs %d runs" % (len(base_runs), len(new_runs))
+
+    base_phases = [p["name"] for p in base_runs[0].get("phases", [])]
+    new_names = set(phase_map(new_runs[0]))
+    for phase in base_phases:
+        if phase not in new_names:
+            add(phase, "(phase)", 0, 0, "", "missing")
+            continue
+
+        # CPU frame time: one sample (the median frame) per run
+        b = [median(s) for s in collect(base_runs, phase, "frame_ms_samples") if s]
+        n = [median(s) for s in collect(new_runs, phase, "frame_ms_samples") if s]
+        if b and n:
+            spread = (max(b) - min(b)) / median(b) if len(b) > 1 and median(b) > 0 else 0.0
+            t = max(thresholds["frame_ms"], spread)
+            change = rel_change(median(b), median(n))
+            if not gate_timing:
+                add(phase, "frame_ms p50", median(b), median(n), runs_stat,
+                    "slower" if change > t else "improved" if change < -t else "ok")
+            elif method == "bootstrap":
+                lo, hi = bootstrap_change_ci(b, n)
+                stat = "CI [%+.1f%%, %+.1f%%] lim %.0f%%" % (100 * lo, 100 * hi, 100 * t)
+                add(phase, "frame_ms p50", median(b), median(n), stat,
+                    "REGRESSION" if lo > t else "improved" if hi < -t else "ok")
+            else:
+                p_worse = mann_whitney_greater(b, n)
+                p_better = mann_whitney_greater(n, b)
+                stat = "p=%.2g lim %.0f%%" % (min(p_worse, p_better), 100 * t)
+                worse = change > t and p_worse < alpha
+                better = change < -t and p_better < alpha
+                add(phase, "frame_ms p50", median(b), median(n), stat,
+                    "REGRESSION" if worse else "improved" if better else "ok")
+
+        # Per-frame counters: compared by mean, gated only under --fixed-dt
+        for c in COUNTERS:
+            bv, nv = collect(base_runs, phase, c), collect(new_runs, phase, c)
+            if not bv or not nv:
+                continue
+            bm, nm = mean(bv), mean(nv)
+            change = rel_change(bm, nm)
+            t = thresholds[c]
+            higher = "REGRESSION" if gate_counters else "higher"
+            verdict = higher if change > t + 1e-9 else "improved" if change < -t - 1e-9 else "ok"
+            add(phase, c, bm, nm, "" if gate_counters else "no fixed_dt", verdict)
+
+        # Submit time: informational
+        for key, metric in (("submit_ms", "submit_ms p50"), ("latency_ms", "latency_ms p50"),
+                            ("view_age_ms", "view_age_ms p50")):
+            bv = [t["p50"] for t in collect(base_runs, phase, key)]
+            nv = [t["p50"] for t in collect(new_runs, phase, key)]
+            if key == "view_age_ms" and not any(bv + nv):
+                continue        # no scripted look in this phase
+            if bv and nv:
+                change = rel_change(median(bv), median(nv))
+                t = thresholds[key]
+                add(phase, metric, median(bv), median(nv), "",
+                    "slower" if change > t else "improved" if change < -t else "ok")
+
+        # Frame-time spread: informational
+        bv, nv = collect(base_runs, phase, "frame_ms_sd"), collect(new_runs, phase, "frame_ms_sd")
+        if bv and nv:
+            change = rel_change(median(bv), median(nv))
+            t = thresholds["frame_ms_sd"]
+            add(phase, "frame_ms sd", median(bv), median(nv), "",
+                "worse" if change > t else "improved" if change < -t else "ok")
+
+    # Startup: one value per run
+    b = [r["startup_ms"] for r in base_runs if "startup_ms" in r]
+    n = [r["startup_ms"] for r in new_runs if "startup_ms" in r]
+    if b and n:
+        change = rel_change(median(b), median(n))
+        t = thresholds["startup_ms"]
+        if len(b) >= MIN_GATE_RUNS and len(n) >= MIN_GATE_RUNS:
+            p = mann_whitney_greater(b, n)
+            verdict = "REGRESSION" if change > t and p < alpha else "improved" if change < -t else "ok"
+            add("(startup)", "startup_ms", median(b), median(n), "p=%.3g" % p, verdict)
+        else:
+            add("(startup)", "startup_ms", median(b), median(n), "%d vs %d runs" % (len(b), len(n)),
+                "slower" if change > t else "improved" if change < -t else "ok")
+    return rows, regressions
+
+
+def print_table(rows):
+    header = ("phase", "metric", "base", "new", "change", "stat", "verdict")
+    fmt = "%-18s %-14s %12s %12s %9s %-30s %s"
+    print(fmt % header)
+    print("-" * 108)
+    for phase, metric, b, n, change, stat, verdict in rows:
+        ch = "" if verdict == "missing" else ("%+.1f%%" % (100 * change) if math.isfinite(change) else "new")
+        print(fmt % (phase[:18], metric, "%.3f" % b, "%.3f" % n, ch, stat, verdict))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("files", nargs="*", help="base.json new.json (without --base/--new)")
+    ap.add_argument("--base", nargs="+", default=[], help="result files of the baseline build")
+    ap.add_argument("--new", nargs="+", default=[], help="result files of the candidate build")
+    ap.add_argument("--thresholds", help="JSON object of relative limits per metric")
+    ap.add_argument("--alpha", type=float, default=0.01, help="significance level (default 0.01)")
+    ap.add_argument("--method", choices=["mwu", "bootstrap"], default="mwu")
+    args = ap.parse_args()
+
+    base_paths, new_paths = args.base, args.new
+    if not base_paths and not new_paths and len(args.files) == 2:
+        base_paths, new_paths = [args.files[0]], [args.files[1]]
+    if not base_paths or not new_paths:
+        ap.print_usage()
+        print("error: need baseline and candidate result files")
+        return 2
+
+    thresholds = dict(DEFAULT_THRESHOLDS)
+    if args.thresholds:
+        with open(args.thresholds) as f:
+            thresholds.update(json.load(f))
+
+    base_runs, new_runs = load_runs(base_paths), load_runs(new_paths)
+    for runs in (base_runs, new_runs):
+        if len({(r.get("bench"), r.get("backend")) for r in runs}) > 1:
+            print("error: runs on one side mix benches or backends")
+            return 2
+    b0, n0 = base_runs[0], new_runs[0]
+    if b0.get("bench") != n0.get("bench"):
+        print("error: comparing different benches (%s vs %s)" % (b0.get("bench"), n0.get("bench")))
+        return 2
+    if b0.get("backend") != n0.get("backend") or b0.get("fixed_dt") != n0.get("fixed_dt"):
+        print("warning: backend or fixed_dt differs between base and new")
+
+    print("bench %s (%s backend): %d base run(s) vs %d new run(s), %s, alpha %g"
+          % (b0.get("bench"), b0.get("backend"), len(base_runs), len(new_runs), args.method, args.alpha))
+    if b0.get("submit") != n0.get("submit"):
+        print("submit mode: %s -> %s" % (b0.get("submit", "uniforms"), n0.get("submit", "uniforms")))
+    if b0.get("sim") != n0.get("sim"):
+        print("sim mode: %s -> %s" % (b0.get("sim", "serial"), n0.get("sim", "serial")))
+    if b0.get("late_latch", False) != n0.get("late_latch", False):
+        print("late latch: %s -> %s" % (b0.get("late_latch", False), n0.get("late_latch", False)))
+    rows, regressions = compare(base_runs, new_runs, thresholds, args.alpha, args.method)
+    print_table(rows)
+    if regressions:
+        print("\n%d regression(s)" % regressions)
+        return 1
+    print("\nno regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
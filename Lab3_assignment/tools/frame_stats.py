@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Summarize a per-frame stats log written with `--stats`.
+
+Usage:
+    python tools/frame_stats.py frames.csv [--skip N]
+    python tools/frame_stats.py frames.jsonl
+
+Accepts the CSV or JSON Lines format from FrameStats.h and prints
+p50/p95/p99/max/mean for every timing and counter column, plus the
+stutter count (frames over 2x the median, as flagged by the app).
+latency_ms counts only frames that presented a new input, view_age_ms only
+frames with live mouse look (-1 elsewhere); logs from before they were
+added simply lack the rows.
+--skip drops the first N frames (startup, texture loading).
+"""
+
+import argparse
+import csv
+import json
+import sys
+
+COLUMNS = ["frame_ms", "sim_ms", "render_ms", "latency_ms", "view_age_ms", "draws", "triangles", "uniforms"]
+OPTIONAL = ("latency_ms", "view_age_ms")     # -1 = no sample
+
+
+def load(path):
+    with open(path, newline="") as f:
+        if path.endswith(".csv"):
+            rows = list(csv.DictReader(f))
+        else:
+            rows = [json.loads(line) for line in f if line.strip()]
+    for r in rows:
+        for c in COLUMNS:
+            r[c] = float(r.get(c, -1))
+        r["stutter"] = str(r["stutter"]).lower() in ("1", "true")
+    return rows
+
+
+def percentile(sorted_values, p):
+    # Nearest rank, matching FrameStats::percentile
+    rank = int(p / 100.0 * (len(sorted_values) - 1) + 0.5)
+    return sorted_values[rank]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("log")
+    ap.add_argument("--skip", type=int, default=0, help="ignore the first N frames")
+    args = ap.parse_args()
+
+    rows = load(args.log)[args.skip:]
+    if not rows:
+        print("no frames in %s" % args.log)
+        return 1
+
+    print("%s: %d frames" % (args.log, len(rows)))
+    print("%-12s %10s %10s %10s %10s %10s" % ("", "p50", "p95", "p99", "max", "mean"))
+    for c in COLUMNS:
+        v = sorted(r[c] for r in rows if c not in OPTIONAL or r[c] >= 0)
+        if not v:
+            continue
+        fmt = "%-12s" + (" %10.3f" if c.endswith("_ms") else " %10.0f") * 5
+        print(fmt % (c, percentile(v, 50), percentile(v, 95), percentile(v, 99),
+                     v[-1], sum(v) / len(v)))
+
+    stutters = [r for r in rows if r["stutter"]]
+    print("stutters:    %d (%.2f%%)" % (len(stutters), 100.0 * len(stutters) / len(rows)))
+    worst = sorted(stutters, key=lambda r: -r["frame_ms"])[:5]
+    if worst:
+        print("worst:       " + ", ".join("#%d %.2f ms" % (int(float(r["frame"])), r["frame_ms"]) for r in worst))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,203 @@
+// ============================================================================
+// GLM BENCH - ns/op of the glm calls the scene makes every frame
+// ============================================================================
+// Built once per glm configuration by tools/glm_bench.py, which passes the
+// GLM_FORCE_* defines and the matching arch flags, runs every build and
+// prints the comparison table. Each run prints JSON lines on stdout:
+//   {"config": ...}                                     glm setup it was built with
+//   {"op": "translate", "ns": 1.23, "check": [...]}     median ns per call and
+//                                                       the first results, for the
+//                                                       cross-configuration check
+//   {"self_check": "myLookAt", "max_abs_diff": ...}     myLookAt vs glm::lookAt
+//
+// Every op runs over GLM_BENCH_COUNT prepared inputs per round; results go
+// to an output array that is passed to clobber() after each round, so the
+// compiler can neither drop nor hoist the work.
+//
+//   glm_bench [--rounds N]      (default 41 timed rounds, median reported)
+// ============================================================================
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "../CameraMath.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const int GLM_BENCH_COUNT = 4096;     // inputs per round (fits in L2)
+const int GLM_BENCH_WARMUP = 3;
+const int GLM_BENCH_CHECK = 4;        // results per op printed for the cross-check
+
+static void clobber(void* p) {
+#if defined(_MSC_VER)
+    static void* volatile sink;
+    sink = p;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(p) : "memory");
+#endif
+}
+
+// Deterministic inputs: the same values in every build
+struct Lcg {
+    unsigned int state = 12345u;
+    float next(float lo, float hi) {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * (float)(state >> 8) / 16777216.0f;
+    }
+    glm::vec3 vec3(float lo, float hi) { return glm::vec3(next(lo, hi), next(lo, hi), next(lo, hi)); }
+};
+
+struct Inputs {
+    std::vector<glm::mat4> a, b;
+    std::vector<glm::vec3> v, axis, eye, center;
+    std::vector<glm::vec4> p;
+    std::vector<float> angle, fov, aspect;
+};
+
+static Inputs makeInputs() {
+    Lcg rng;
+    Inputs in;
+    for (int i = 0; i < GLM_BENCH_COUNT; i++) {
+        glm::mat4 m(1.0f), n(1.0f);
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++) {
+                m[c][r] = rng.next(-2.0f, 2.0f);
+                n[c][r] = rng.next(-2.0f, 2.0f);
+            }
+        in.a.push_back(m);
+        in.b.push_back(n);
+        in.v.push_back(rng.vec3(-10.0f, 10.0f));
+        in.axis.push_back(glm::normalize(rng.vec3(0.1f, 1.0f)));
+        in.eye.push_back(rng.vec3(-50.0f, 50.0f));
+        in.center.push_back(rng.vec3(-50.0f, 50.0f) + glm::vec3(0.0f, 0.0f, 120.0f));
+        in.p.push_back(glm::vec4(rng.vec3(-10.0f, 10.0f), 1.0f));
+        in.angle.push_back(rng.next(-3.1f, 3.1f));
+        in.fov.push_back(glm::radians(rng.next(30.0f, 90.0f)));
+        in.aspect.push_back(rng.next(1.0f, 2.4f));
+    }
+    return in;
+}
+
+const char* archName() {
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "AVX2";
+#elif GLM_ARCH & GLM_ARCH_AVX_BIT
+    return "AVX";
+#elif GLM_ARCH & GLM_ARCH_SSE42_BIT
+    return "SSE4.2";
+#elif GLM_ARCH & GLM_ARCH_SSE41_BIT
+    return "SSE4.1";
+#elif GLM_ARCH & GLM_ARCH_SSSE3_BIT
+    return "SSSE3";
+#elif GLM_ARCH & GLM_ARCH_SSE3_BIT
+    return "SSE3";
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    return "SSE2";
+#elif GLM_ARCH & GLM_ARCH_NEON_BIT
+    return "NEON";
+#else
+    return "pure";
+#endif
+}
+
+// Times fn(i) over every input index; returns the median ns per call
+template <typename T, typename Fn>
+double timeOp(std::vector<T>& out, Fn fn, int rounds) {
+    std::vector<double> samples;
+    for (int r = 0; r < GLM_BENCH_WARMUP + rounds; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < GLM_BENCH_COUNT; i++) out[i] = fn(i);
+        clobber(out.data());
+        auto t1 = std::chrono::steady_clock::now();
+        if (r >= GLM_BENCH_WARMUP)
+            samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / GLM_BENCH_COUNT);
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+static void printFloats(const float* f, int n) {
+    for (int i = 0; i < n; i++) printf("%s%.9g", i ? "," : "", f[i]);
+}
+
+static void report(const char* op, double ns, const std::vector<glm::mat4>& out) {
+    printf("{\"op\":\"%s\",\"ns\":%.4f,\"check\":[", op, ns);
+    for (int i = 0; i < GLM_BENCH_CHECK; i++) {
+        if (i) printf(",");
+        printFloats(&out[i][0][0], 16);
+    }
+    printf("]}\n");
+}
+
+static void report(const char* op, double ns, const std::vector<glm::vec4>& out) {
+    printf("{\"op\":\"%s\",\"ns\":%.4f,\"check\":[", op, ns);
+    for (int i = 0; i < GLM_BENCH_CHECK; i++) {
+        if (i) printf(",");
+        printFloats(&out[i][0], 4);
+    }
+    printf("]}\n");
+}
+
+int main(int argc, char** argv) {
+    int rounds = 41;
+    for (int i = 1; i < argc; i++)
+        if (!strcmp(argv[i], "--rounds") && i + 1 < argc) rounds = std::max(1, atoi(argv[++i]));
+
+    printf("{\"config\":{\"simd\":%d,\"arch\":\"%s\",\"aligned_gentypes\":%d,\"sizeof_vec3\":%d,\"sizeof_mat4\":%d}}\n",
+           GLM_CONFIG_SIMD == GLM_ENABLE ? 1 : 0, archName(),
+#if defined(GLM_FORCE_DEFAULT_ALIGNED_GENTYPES)
+           1,
+#else
+           0,
+#endif
+           (int)sizeof(glm::vec3), (int)sizeof(glm::mat4));
+
+    Inputs in = makeInputs();
+    std::vector<glm::mat4> out(GLM_BENCH_COUNT);
+    std::vector<glm::vec4> outv(GLM_BENCH_COUNT);
+    const glm::vec3 up(0.0f, 1.0f, 0.0f);
+    double ns;
+
+    ns = timeOp(out, [&](int i) { return in.a[i] * in.b[i]; }, rounds);
+    report("mat4 * mat4", ns, out);
+    ns = timeOp(outv, [&](int i) { return in.a[i] * in.p[i]; }, rounds);
+    report("mat4 * vec4", ns, outv);
+    ns = timeOp(out, [&](int i) { return glm::translate(in.a[i], in.v[i]); }, rounds);
+    report("translate", ns, out);
+    ns = timeOp(out, [&](int i) { return glm::scale(in.a[i], in.v[i]); }, rounds);
+    report("scale", ns, out);
+    ns = timeOp(out, [&](int i) { return glm::rotate(in.a[i], in.angle[i], in.axis[i]); }, rounds);
+    report("rotate", ns, out);
+    ns = timeOp(out, [&](int i) { return glm::perspective(in.fov[i], in.aspect[i], 0.1f, 1000.0f); }, rounds);
+    report("perspective", ns, out);
+    ns = timeOp(out, [&](int i) { return glm::lookAt(in.eye[i], in.center[i], up); }, rounds);
+    report("glm::lookAt", ns, out);
+    std::vector<glm::mat4> reference(out.begin(), out.end());
+    ns = timeOp(out, [&](int i) { return myLookAt(in.eye[i], in.center[i], up); }, rounds);
+    report("myLookAt", ns, out);
+    float maxDiff = 0.0f;
+    for (int i = 0; i < GLM_BENCH_COUNT; i++)
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                maxDiff = std::max(maxDiff, std::fabs(out[i][c][r] - reference[i][c][r]));
+    printf("{\"self_check\":\"myLookAt vs glm::lookAt\",\"max_abs_diff\":%.9g}\n", maxDiff);
+
+    // A scene part: T * R * S under its parent, as Bus::draw* builds them
+    ns = timeOp(out, [&](int i) {
+        glm::mat4 model = glm::translate(in.a[i], in.v[i]);
+        model = glm::rotate(model, in.angle[i], in.axis[i]);
+        model = glm::scale(model, glm::vec3(0.5f, 2.0f, 1.5f));
+        return in.b[i] * model;
+    }, rounds);
+    report("part transform", ns, out);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Build tools/glm_bench.cpp per glm configuration, run it and compare.
+
+Usage:
+    python tools/glm_bench.py [--cxx g++|clang++|cl] [--rounds 41]
+                              [--tolerance 1e-5] [--json results.json]
+                              [--build-dir tools/_glm_bench]
+
+Configurations (glm 0.9.9 from Lab_1/opengl/include):
+
+  default      no GLM_FORCE_* define: the scalar code the app builds with
+  intrinsics   GLM_FORCE_INTRINSICS: SIMD paths for the compiler's baseline
+               instruction set (SSE2 on x86-64)
+  avx2         GLM_FORCE_AVX2 (implies intrinsics) plus -mavx2 -mfma or
+               /arch:AVX2
+  aligned      GLM_FORCE_INTRINSICS + GLM_FORCE_DEFAULT_ALIGNED_GENTYPES:
+               vec3 padded to 16 bytes. Needs language extensions, so GCC
+               and Clang build every configuration with -std=gnu++14.
+
+Each build's first results per op are checked against the default build
+(|a - b| <= tolerance * max(1, |b|)), and myLookAt is checked against
+glm::lookAt inside every build. The table lists the median ns per call
+and the speed-up over default; the last row is the geometric mean.
+
+Exit status: 0 = all builds agree, 1 = a cross-check failed,
+2 = a build or run failed.
+"""
+
+import argparse
+import json
+import math
+import os
+import platform
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCE = os.path.join(HERE, "glm_bench.cpp")
+GLM_INCLUDE = os.path.normpath(os.path.join(HERE, "..", "..", "Lab_1", "opengl", "include"))
+
+CONFIGS = [
+    ("default", [], [], []),
+    ("intrinsics", ["GLM_FORCE_INTRINSICS"], [], []),
+    ("avx2", ["GLM_FORCE_AVX2"], ["-mavx2", "-mfma"], ["/arch:AVX2"]),
+    ("aligned", ["GLM_FORCE_INTRINSICS", "GLM_FORCE_DEFAULT_ALIGNED_GENTYPES"], [], []),
+]
+
+
+def pick_compiler(requested):
+    if requested:
+        return requested
+    if os.environ.get("CXX"):
+        return os.environ["CXX"]
+    candidates = ["cl", "clang++", "g++"] if platform.system() == "Windows" else ["g++", "clang++"]
+    for c in candidates:
+        if shutil.which(c):
+            return c
+    return None
+
+
+def build(cxx, name, defines, gcc_flags, msvc_flags, out_dir):
+    exe = os.path.join(out_dir, "glm_bench_" + name + (".exe" if platform.system() == "Windows" else ""))
+    if os.path.basename(cxx).lower().startswith("cl"):
+        cmd = [cxx, "/nologo", "/O2", "/EHsc", "/DNDEBUG", "/I", GLM_INCLUDE]
+        cmd += ["/D" + d for d in defines] + msvc_flags
+        cmd += [SOURCE, "/Fe" + exe, "/Fo" + os.path.join(out_dir, name + ".obj")]
+    else:
+        cmd = [cxx, "-O2", "-std=gnu++14", "-DNDEBUG", "-I", GLM_INCLUDE]
+        cmd += ["-D" + d for d in defines] + gcc_flags + [SOURCE, "-o", exe]
+    try:
+        r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    except OSError as e:
+        print("error: cannot run %s: %s" % (cxx, e))
+        return None
+    if r.returncode != 0:
+        print("error: building %s failed:\n  %s\n%s" % (name, " ".join(cmd), r.stdout))
+        return None
+    return exe
+
+
+def run(exe, rounds):
+    r = subprocess.run([exe, "--rounds", str(rounds)], stdout=subprocess.PIPE, universal_newlines=True)
+    if r.returncode != 0:
+        return None       # e.g. AVX2 build on a CPU without AVX2
+    result = {"config": None, "ops": {}, "order": [], "self_check": None}
+    for line in r.stdout.splitlines():
+        rec = json.loads(line)
+        if "config" in rec:
+            result["config"] = rec["config"]
+        elif "op" in rec:
+            result["ops"][rec["op"]] = rec
+            result["order"].append(rec["op"])
+        elif "self_check" in rec:
+            result["self_check"] = rec["max_abs_diff"]
+    return result
+
+
+def max_error(check, ref):
+    worst = 0.0
+    for a, b in zip(check, ref):
+        worst = max(worst, abs(a - b) / max(1.0, abs(b)))
+    return worst
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--cxx", help="compiler (default: $CXX, then cl / g++ / clang++)")
+    ap.add_argument("--rounds", type=int, default=41, help="timed rounds per op (median reported)")
+    ap.add_argument("--tolerance", type=float, default=1e-5, help="relative cross-check tolerance")
+    ap.add_argument("--build-dir", default=os.path.join(HERE, "_glm_bench"),
+                    help="where the executables go (default: tools/_glm_bench, git-ignored)")
+    ap.add_argument("--json", help="also write all results to this file")
+    args = ap.parse_args()
+
+    cxx = pick_compiler(args.cxx)
+    if not cxx:
+        print("error: no C++ compiler found (pass --cxx)")
+        return 2
+    os.makedirs(args.build_dir, exist_ok=True)
+
+    results = {}
+    for name, defines, gcc_flags, msvc_flags in CONFIGS:
+        exe = build(cxx, name, defines, gcc_flags, msvc_flags, args.build_dir)
+        if not exe:
+            return 2
+        r = run(exe, args.rounds)
+        if r is None:
+            print("warning: %s build did not run on this machine, skipped" % name)
+            continue
+        results[name] = r
+    if "default" not in results:
+        print("error: the default build did not run")
+        return 2
+
+    failures = 0
+    base = results["default"]
+    print("glm_bench: %s, %d rounds, tolerance %g" % (cxx, args.rounds, args.tolerance))
+    for name, r in results.items():
+        c = r["config"]
+        print("  %-11s simd %d  arch %-6s  aligned %d  sizeof(vec3) %d"
+              % (name, c["simd"], c["arch"], c["aligned_gentypes"], c["sizeof_vec3"]))
+        if r["self_check"] is None or r["self_check"] > args.tolerance:
+            print("    MISMATCH: myLookAt differs from glm::lookAt by %s" % r["self_check"])
+            failures += 1
+        for op in base["order"]:
+            if op not in r["ops"]:
+                continue
+            err = max_error(r["ops"][op]["check"], base["ops"][op]["check"])
+            if err > args.tolerance:
+                print("    MISMATCH: %s differs from default by %.3g" % (op, err))
+                failures += 1
+
+    names = list(results)
+    print()
+    print("%-16s" % "ns/op" + "".join("%18s" % n for n in names))
+    print("-" * (16 + 18 * len(names)))
+    logs = {n: [] for n in names}
+    for op in base["order"]:
+        row = "%-16s" % op
+        b = base["ops"][op]["ns"]
+        for n in names:
+            ns = results[n]["ops"][op]["ns"]
+            speedup = b / ns if ns > 0 else float("nan")
+            logs[n].append(math.log(speedup))
+            row += "%10.2f (%.2fx)" % (ns, speedup)
+        print(row)
+    print("%-16s" % "geomean speedup" + "".join("%18s" % ("%.2fx" % math.exp(sum(logs[n]) / len(logs[n]))) for n in names))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"compiler": cxx, "rounds": args.rounds, "results": results}, f, indent=1)
+    if failures:
+        print("\n%d cross-check failure(s)" % failures)
+        return 1
+    print("\nall configurations agree")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -40,7 +40,6 @@ public:
         glBindVertexArray(sphereVAO);
 
         // create VBO to copy vertex data to VBO
-        unsigned int sphereVBO;
         glGenBuffers(1, &sphereVBO);
         glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);           // for vertex data
         glBufferData(GL_ARRAY_BUFFER,                   // target
@@ -49,7 +48,6 @@ public:
             GL_STATIC_DRAW);                   // usage
 
         // create EBO to copy index data
-        unsigned int sphereEBO;
         glGenBuffers(1, &sphereEBO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);   // for index data
         glBufferData(GL_ELEMENT_ARRAY_BUFFER,           // target
@@ -73,6 +71,19 @@ public:
     }
     ~Sphere() {}
 
+    // owns GL names: not copyable, so the names are never deleted twice
+    Sphere(const Sphere&) = delete;
+    Sphere& operator=(const Sphere&) = delete;
+
+    // delete the GL objects; call while the context is still current
+    void cleanup()
+    {
+        glDeleteVertexArrays(1, &sphereVAO);
+        glDeleteBuffers(1, &sphereVBO);
+        glDeleteBuffers(1, &sphereEBO);
+        sphereVAO = sphereVBO = sphereEBO = 0;
+    }
+
     // getters/setters
 
     void set(float radius, int sectors, int stacks, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
@@ -305,6 +316,8 @@ private:
 
     // memeber vars
     unsigned int sphereVAO;
+    unsigned int sphereVBO;
+    unsigned int sphereEBO;
     float radius;
     int sectorCount;                        // longitude, # of slices
     int stackCount;                         // latitude, # of stacks
@@ -184,6 +184,7 @@ int main()
     Pyramid pyra = Pyramid(laughEmoji);
 	Hexagon hex = Hexagon(laughEmoji);
 	Cube cube = Cube(laughEmoji);
+    Cube lightCube = Cube(glm::vec3(0.8f, 0.8f, 0.8f));     // shared by all light bulbs
 
     //Sphere sphere = Sphere();
 
@@ -257,7 +258,6 @@ int main()
         // we now draw as many light bulbs as we have point lights.
         for (unsigned int i = 0; i < 4; i++)
         {
-            Cube lightCube = Cube(glm::vec3(0.8f, 0.8f, 0.8f));
             model = glm::mat4(1.0f);
             model = glm::translate(model, pointLightPositions[i]);
             model = glm::scale(model, glm::vec3(0.2f)); // Make it a smaller cube
@@ -272,7 +272,7 @@ int main()
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-
+    glDeleteTextures(1, &laughEmoji);
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
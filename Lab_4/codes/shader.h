@@ -96,11 +96,19 @@ public:
             glDeleteShader(geometry);
 
     }
-    // activate the shader
+    // activate the shader (skipped if it is already the current program)
     // ------------------------------------------------------------------------
     void use()
     {
+        if (currentProgram() == ID) return;
         glUseProgram(ID);
+        currentProgram() = ID;
+    }
+    // program last bound through use(), shared by every Shader
+    static unsigned int& currentProgram()
+    {
+        static unsigned int current = 0;
+        return current;
     }
     // utility uniform functions
     // ------------------------------------------------------------------------